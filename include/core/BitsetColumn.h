@@ -0,0 +1,108 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "ComponentManager.h"
+
+namespace railguard::core
+{
+    /**
+     * @brief Column of flags (e.g. enabled, visible, dirty) of the components of a manager, packed in 64 bits words.
+     *
+     * It is kept in sync with the other columns of the manager: a flag is pushed when a component is created, and
+     * RemoveSwap and Reorder move the flags the same way as ComponentManager::DestroyComponent and ReorderComponents.
+     *
+     * Unlike a vector<bool>, the set flags are iterated a word at a time, so that the cost depends on the number of set flags
+     * rather than on the number of components. The bits past the size are always 0.
+     *
+     * Flags sharing a word can't be written from several threads. Threads can write to ranges that start and end at multiples of WORD_BITS.
+     */
+    class BitsetColumn
+    {
+    private:
+        std::vector<uint64_t> _words;
+        component_id_t _size = 0;
+
+    public:
+        static constexpr component_id_t WORD_BITS = 64;
+
+        BitsetColumn() = default;
+        explicit BitsetColumn(component_id_t defaultCapacity);
+
+        void Reserve(component_id_t capacity);
+
+        // === Synchronization with the manager ===
+
+        void PushBack(bool value);
+        void PopBack();
+        /**
+         * @brief Moves the last flag to the given index, and removes the last one. Matches ComponentManager::DestroyComponent.
+         */
+        void RemoveSwap(component_id_t index);
+        /**
+         * @brief Moves the flags so that the one at index newOrder[i] ends up at index i. Matches ComponentManager::ReorderComponents.
+         */
+        void Reorder(const std::vector<component_id_t> &newOrder);
+        /**
+         * @brief Replaces the flags by the given words, as returned by GetWords, e.g. when a snapshot is loaded.
+         * Throws if the number of words doesn't match the size.
+         */
+        void Assign(std::span<const uint64_t> words, component_id_t size);
+
+        // === Access ===
+
+        [[nodiscard]] bool Get(component_id_t index) const
+        {
+            return (_words[index / WORD_BITS] >> (index % WORD_BITS)) & 1;
+        }
+
+        void Set(component_id_t index, bool value)
+        {
+            const uint64_t mask = uint64_t{1} << (index % WORD_BITS);
+            auto &word = _words[index / WORD_BITS];
+            word = value ? word | mask : word & ~mask;
+        }
+
+        /**
+         * @brief Sets every flag to the given value.
+         */
+        void Fill(bool value);
+        /**
+         * @brief Sets the flags in [begin, end) to false.
+         */
+        void Reset(component_id_t begin, component_id_t end);
+
+        [[nodiscard]] component_id_t GetSize() const;
+        /**
+         * @brief Returns the number of set flags.
+         */
+        [[nodiscard]] component_id_t Count() const;
+        [[nodiscard]] bool Any() const;
+
+        /**
+         * @brief Calls function(index) for each set flag, in increasing order.
+         * The function may clear the flag it receives, but must not change the size of the column.
+         */
+        template <typename Function>
+        void ForEachSet(Function &&function) const
+        {
+            for (size_t w = 0; w < _words.size(); w++)
+            {
+                // Read the word once, and clear its lowest set bit after each call
+                uint64_t word = _words[w];
+                while (word != 0)
+                {
+                    function(static_cast<component_id_t>(w * WORD_BITS + std::countr_zero(word)));
+                    word &= word - 1;
+                }
+            }
+        }
+
+        /**
+         * @brief Returns the words of the column. Bit i of word w is the flag of the component w * WORD_BITS + i.
+         */
+        [[nodiscard]] const std::vector<uint64_t> &GetWords() const;
+    };
+} // namespace railguard::core
@@ -1,8 +1,15 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
 #include <vector>
 #include <unordered_map>
 #include "Entity.h"
 #include "Match.h"
 #include "EntityManager.h"
+#include "ComponentStorage.h"
+#include "Snapshot.h"
+#include "Delta.h"
 
 namespace railguard::core
 {
@@ -11,7 +18,15 @@ namespace railguard::core
      */
     typedef size_t component_id_t;
 
-    class ComponentManager
+    /**
+     * Changes are tracked with versions: each component stores the version in which it last changed, and destroyed components are
+     * logged. Managers can then write a delta containing only what changed since a given version (see WriteDeltaHeader).
+     * Deltas identify components by entity, so they don't depend on the indices, which change when components are destroyed or reordered.
+     *
+     * @tparam Storage Vectors in which the components are stored (see ComponentStorage.h)
+     */
+    template <typename Storage = HeapStorage>
+    class BasicComponentManager
     {
     private:
         // === Manager data ===
@@ -24,25 +39,93 @@ namespace railguard::core
 
         // For a given component, the entity linked to it
         // Component -> Entity
-        std::vector<Entity> _entities;
+        typename Storage::template Vector<Entity> _entities;
+
+        // === Change tracking ===
+
+        // For a given component, the version in which it was created or last changed
+        // Component -> Version
+        typename Storage::template Vector<uint64_t> _changeVersions;
+        // Entities whose component was destroyed, with the version in which it happened, in increasing version order
+        std::vector<std::pair<uint64_t, Entity>> _destroyedComponents;
+        // Version in which the current changes are made
+        uint64_t _version = 1;
+        // Oldest version from which a delta can be written
+        uint64_t _historyStart = 0;
+
+        // Scratch of ReorderComponents, kept so that reordering doesn't allocate
+        std::vector<component_id_t> _reorderScratch;
 
     protected:
         // Create a new component for the given entity
         // It is protected because "real" component managers will add additional parameters
         Match RegisterComponent(const Entity &entity);
+        // Moves the components so that the one at index newOrder[i] ends up at index i
+        // Managers that need a specific order should call it and then reorder their own vectors the same way
+        void ReorderComponents(const std::vector<component_id_t> &newOrder);
+        // Destroys the component like DestroyComponent, but keeps the order of the other components (see EraseInOrder)
+        // The movedCount components that followed it are moved to the end
+        // Managers that need a specific order should call it and then erase from their own vectors the same way
+        void DestroyComponentInOrder(component_id_t index, component_id_t movedCount);
+        // Writes the entities in the SNAPSHOT_ENTITIES_COLUMN column of the given tag
+        // Managers should call it when they save their own columns
+        void SaveEntities(SnapshotWriter &writer, uint32_t tag) const;
+        // Replaces the components by the ones of the snapshot, and rebuilds the lookup map
+        // Managers should call it when they load their own columns
+        void LoadEntities(const Snapshot &snapshot, uint32_t tag);
+
+        // Records that the component changed in the current version
+        // Setters of the managers must call it for every data that is replicated
+        void MarkChanged(component_id_t index)
+        {
+            _changeVersions[index] = _version;
+        }
+        // Writes the start of a delta: its versions, the destroyed entities and the changed entities
+        // Fills changed with the indices of the changed components, whose data the manager must then write in the same order
+        void WriteDeltaHeader(DeltaWriter &writer, uint32_t tag, uint64_t fromVersion, std::vector<component_id_t> &changed) const;
+        // Reads the start of a delta and destroys the components of the destroyed entities
+        // appliedVersion is the version of the writer brought by the last delta applied to the manager (0 if none)
+        // Throws if the delta starts after it, since the changes in between would be lost, or if it is older than it
+        // Fills changed with the entities whose data follows, and returns the version that the delta brings the manager to
+        uint64_t ReadDeltaHeader(DeltaReader &reader, uint32_t tag, uint64_t appliedVersion, std::vector<Entity> &changed);
     public:
         // Inits the manager and preallocate space in the vectors and maps
-        explicit ComponentManager(const component_id_t defaultComponentCapacity);
+        explicit BasicComponentManager(const component_id_t defaultComponentCapacity);
+        virtual ~BasicComponentManager() = default;
         // Destroys the given component
         void DestroyComponent(const Match &match);
         virtual void DestroyComponent(component_id_t index);
         // Finds the component
         [[nodiscard]] const Match FindComponentOfEntity(const Entity &entity);
         // Finds the entity linked to this component
-        const Entity GetCorrespondingEntity(const Match &match);
+        const Entity GetCorrespondingEntity(const Match &match) const;
+        // Number of components currently stored in the manager
+        [[nodiscard]] component_id_t GetComponentCount() const;
         // Checks random components to check if the corresponding entities are still alive
         // Can be useful when there are a lot of entities
         void RunGarbageCollection(const EntityManager &em);
+
+        // === Versions ===
+
+        /**
+         * @brief Ends the current version, e.g. at the end of a frame, and returns its number. Later changes belong to the next version.
+         */
+        uint64_t CloseVersion();
+        /**
+         * @brief Returns the last closed version. Deltas bring the state from a previous version to this one.
+         */
+        [[nodiscard]] uint64_t GetClosedVersion() const;
+        /**
+         * @brief Forgets the destroyed components up to the given version, once no delta from an earlier version is needed
+         * (e.g. when every client acknowledged it). Deltas can then only be written from this version or a later one.
+         */
+        void DiscardHistory(uint64_t version);
     };
 
+    // Instantiated in ComponentManager.cpp
+    extern template class BasicComponentManager<HeapStorage>;
+    extern template class BasicComponentManager<PagedStorage<false>>;
+    extern template class BasicComponentManager<PagedStorage<true>>;
+
+    using ComponentManager = BasicComponentManager<HeapStorage>;
 }
\ No newline at end of file
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <vector>
+#include "../utils/PagedVector.h"
+
+namespace railguard::core
+{
+    /**
+     * @brief Storages define the vectors in which the managers keep their data. They are given as template parameter
+     * to BasicComponentManager and StandaloneManager, and derived managers can use Storage::Vector for their own vectors.
+     */
+
+    /**
+     * @brief Default storage: std::vectors, allocated on the heap. Best for managers with few items.
+     */
+    struct HeapStorage
+    {
+        template <typename T>
+        using Vector = std::vector<T>;
+    };
+
+    /**
+     * @brief Storage for managers that can hold a lot of items: each vector reserves its address space up front and commits
+     * pages as it grows, so adding an item never reallocates nor moves the other ones (see utils::PagedVector).
+     *
+     * @tparam UseHugePages If true, the vectors are backed by transparent huge pages when the system allows it.
+     * Each vector then commits at least 2 MiB, so it is only worth it when the manager holds at least thousands of items.
+     */
+    template <bool UseHugePages = false>
+    struct PagedStorage
+    {
+        template <typename T>
+        using Vector = utils::PagedVector<T, UseHugePages>;
+    };
+
+    /**
+     * @brief Moves the elements of the vector in place, so that the element at index newOrder[i] ends up at index i.
+     * Each cycle of the permutation is followed once, so every element is moved once.
+     *
+     * @param scratch Copy of the order, marked as the elements are placed. Kept by the caller so that reordering doesn't allocate.
+     */
+    template <typename Vector, typename Indices>
+    void ApplyOrder(Vector &vector, const Indices &newOrder, Indices &scratch)
+    {
+        scratch.assign(newOrder.begin(), newOrder.end());
+        for (size_t i = 0; i < scratch.size(); i++)
+        {
+            if (scratch[i] == i)
+            {
+                continue;
+            }
+
+            auto value = std::move(vector[i]);
+            size_t current = i;
+            while (scratch[current] != i)
+            {
+                const size_t next = scratch[current];
+                vector[current] = std::move(vector[next]);
+                scratch[current] = current;
+                current = next;
+            }
+            vector[current] = std::move(value);
+            scratch[current] = current;
+        }
+    }
+
+    /**
+     * @brief Removes the element at index while keeping the order of the others, then moves the movedCount elements
+     * that followed it to the end of the vector.
+     */
+    template <typename Vector>
+    void EraseInOrder(Vector &vector, size_t index, size_t movedCount = 0)
+    {
+        const auto first = vector.begin() + static_cast<std::ptrdiff_t>(index);
+        std::move(std::next(first), vector.end(), first);
+        vector.pop_back();
+        if (movedCount > 0)
+        {
+            std::rotate(vector.begin() + static_cast<std::ptrdiff_t>(index), vector.begin() + static_cast<std::ptrdiff_t>(index + movedCount), vector.end());
+        }
+    }
+} // namespace railguard::core
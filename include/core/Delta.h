@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace railguard::core
+{
+    /**
+     * @brief Buffer in which the managers write their changes since a given version, e.g. to send them to clients.
+     *
+     * Values are packed without padding, in the layout of the engine that writes them: the engine that reads a delta
+     * must be the same build. Each column of a manager is written as a contiguous run, which compresses well.
+     */
+    class DeltaWriter
+    {
+    private:
+        std::vector<std::byte> _data;
+
+    public:
+        template <typename T>
+        void Write(const T &value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be written in a delta.");
+            const size_t offset = _data.size();
+            _data.resize(offset + sizeof(T));
+            std::memcpy(_data.data() + offset, &value, sizeof(T));
+        }
+
+        /**
+         * @brief Writes element(i) for each i in [0, count), growing the buffer once.
+         */
+        template <typename T, typename Function>
+        void WriteColumn(size_t count, Function &&element)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be written in a delta.");
+            size_t offset = _data.size();
+            _data.resize(offset + count * sizeof(T));
+            for (size_t i = 0; i < count; i++)
+            {
+                const T value = element(i);
+                std::memcpy(_data.data() + offset, &value, sizeof(T));
+                offset += sizeof(T);
+            }
+        }
+
+        [[nodiscard]] std::span<const std::byte> GetData() const
+        {
+            return _data;
+        }
+
+        /**
+         * @brief Empties the buffer but keeps its memory, so that it can be reused for the next delta.
+         */
+        void Clear()
+        {
+            _data.clear();
+        }
+    };
+
+    /**
+     * @brief Reads a delta written by a DeltaWriter. Throws if it is truncated.
+     */
+    class DeltaReader
+    {
+    private:
+        std::span<const std::byte> _data;
+        size_t _offset = 0;
+
+        void CheckRemaining(size_t size) const
+        {
+            if (size > _data.size() - _offset)
+            {
+                throw std::runtime_error("The delta is truncated.");
+            }
+        }
+
+    public:
+        explicit DeltaReader(std::span<const std::byte> data) : _data(data)
+        {
+        }
+
+        template <typename T>
+        T Read()
+        {
+            CheckRemaining(sizeof(T));
+            T value;
+            std::memcpy(&value, _data.data() + _offset, sizeof(T));
+            _offset += sizeof(T);
+            return value;
+        }
+
+        /**
+         * @brief Reads count values, calling function(i, value) for each of them.
+         */
+        template <typename T, typename Function>
+        void ReadColumn(size_t count, Function &&function)
+        {
+            if (count > (_data.size() - _offset) / sizeof(T))
+            {
+                throw std::runtime_error("The delta is truncated.");
+            }
+            for (size_t i = 0; i < count; i++)
+            {
+                T value;
+                std::memcpy(&value, _data.data() + _offset, sizeof(T));
+                _offset += sizeof(T);
+                function(i, value);
+            }
+        }
+
+        [[nodiscard]] bool IsAtEnd() const
+        {
+            return _offset == _data.size();
+        }
+    };
+} // namespace railguard::core
@@ -1,9 +1,15 @@
 #pragma once
 
 #include "EntityManager.h"
+#include "JobPool.h"
+#include "TransformManager.h"
 #include "WindowManager.h"
+#include "init/EngineInitInfo.h"
 #include "../rendering/Renderer.h"
 #include <cmath>
+#include <optional>
+#include <span>
+#include <string>
 
 namespace railguard::core
 {
@@ -15,18 +21,28 @@ namespace railguard::core
     {
     private:
         EntityManager _entityManager;
-        WindowManager _windowManager;
+        JobPool _jobPool;
+        TransformManager _transformManager;
+        // Empty when the engine is headless
+        std::optional<WindowManager> _windowManager;
         rendering::Renderer _renderer;
         double_t _deltaTime;
+        // Number of frames after which the main loop stops, or 0 if it never stops on its own
+        uint64_t _frameCount;
+
+        // Test
+        rendering::shader_effect_id_t _triangleEffect;
 
     public:
         explicit Engine();
+        explicit Engine(const init::EngineInitInfo &initInfo);
         ~Engine();
 
         /**
          * @brief Starts the main loop of the engine.
          *
-         * The function closes when the execution should be terminated (for example, the game was stopped by the user).
+         * The function closes when the execution should be terminated (for example, the game was stopped by the user),
+         * or when the number of frames given at initialization was drawn.
          */
         void RunMainLoop();
 
@@ -37,6 +53,29 @@ namespace railguard::core
          */
         void OnWindowResized(const vk::Extent2D &newSize);
 
+        /**
+         * @brief Saves the entities and their components in a snapshot file (see SnapshotFormat.h), e.g. for a checkpoint.
+         * Throws if the file can't be written.
+         */
+        void SaveSnapshot(const std::string &filePath) const;
+        /**
+         * @brief Replaces the entities and their components by the ones saved in the snapshot file.
+         * The file is mapped and each column is copied to its manager at once. Throws if the file is not a valid snapshot.
+         */
+        void LoadSnapshot(const std::string &filePath);
+
+        /**
+         * @brief Writes the changes of the replicated components since the given frame version, e.g. to send them to a client.
+         * Each frame closes a version: the delta brings the receiver to the version of the last frame.
+         */
+        void WriteDelta(DeltaWriter &writer, uint64_t fromVersion) const;
+        /**
+         * @brief Applies a delta written by another engine, and returns the version to acknowledge.
+         * appliedVersion is the version returned by the previous call, or 0 for the first delta. Throws if the delta was written
+         * from a later version.
+         */
+        uint64_t ApplyDelta(std::span<const std::byte> delta, uint64_t appliedVersion);
+
     };
 
 } // namespace railguard::core
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Entity.h"
+#include "Snapshot.h"
 #include <vector>
 #include <deque>
 
@@ -26,5 +27,9 @@ namespace railguard::core
         void KillEntity(Entity entity);
         // Check if the given entity is alive
         [[nodiscard]] bool IsEntityAlive(Entity entity) const;
+        // Writes the lookup list and the freed indices in the snapshot
+        void SaveSnapshot(SnapshotWriter &writer) const;
+        // Replaces the state of the manager by the one stored in the snapshot
+        void LoadSnapshot(const Snapshot &snapshot);
     };
 }
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace railguard::core
+{
+    /**
+     * @brief Fixed set of worker threads executing jobs submitted from the main thread.
+     *
+     * The pool is created once by the engine, so that systems don't have to spawn threads each frame.
+     * While waiting for jobs, the calling thread helps the workers instead of blocking.
+     */
+    class JobPool
+    {
+    private:
+        std::vector<std::thread> _workers;
+        std::deque<std::function<void()>> _jobs;
+        std::mutex _mutex;
+        std::condition_variable _jobAvailable;
+        std::condition_variable _jobsFinished;
+        // Number of jobs that were submitted and are not finished yet (queued or running)
+        size_t _pendingJobs = 0;
+        bool _stopping = false;
+
+        void RunWorker();
+        // Pops and runs a job if there is one. Returns false if the queue was empty.
+        bool TryRunJob();
+
+    public:
+        /**
+         * @param threadCount Number of worker threads. When 0, one thread is created per hardware thread,
+         * minus the calling thread.
+         */
+        explicit JobPool(uint32_t threadCount = 0);
+        ~JobPool();
+
+        void Submit(std::function<void()> job);
+        /**
+         * @brief Waits until every submitted job is finished.
+         */
+        void Wait();
+
+        /**
+         * @brief Splits [0, count) in ranges of at least minBatchSize elements and runs the function on each of them,
+         * then waits for all of them to finish.
+         */
+        void ParallelFor(size_t count, size_t minBatchSize, const std::function<void(size_t begin, size_t end)> &function);
+
+        /**
+         * @brief Number of threads that can run jobs at the same time, including the one calling Wait.
+         */
+        [[nodiscard]] uint32_t GetConcurrency() const;
+    };
+} // namespace railguard::core
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "structs/SnapshotFormat.h"
+#include "../utils/MappedFile.h"
+
+namespace railguard::core
+{
+    /**
+     * @brief Collects the columns of the managers, then writes them in a snapshot file (see SnapshotFormat.h).
+     *
+     * Columns are referenced, not copied: the managers must not be modified until Write is called.
+     */
+    class SnapshotWriter
+    {
+    private:
+        struct Column
+        {
+            uint32_t tag;
+            uint32_t column;
+            uint32_t elementSize;
+            uint64_t elementCount;
+            const std::byte *data;
+        };
+
+        std::vector<Column> _columns;
+        // Columns that are not contiguous in the managers are copied here
+        std::vector<std::vector<std::byte>> _ownedData;
+
+    public:
+        template <typename T>
+        void AddColumn(uint32_t tag, uint32_t column, std::span<const T> data)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be written in a snapshot.");
+            _columns.push_back(Column{
+                .tag = tag,
+                .column = column,
+                .elementSize = sizeof(T),
+                .elementCount = data.size(),
+                .data = reinterpret_cast<const std::byte *>(data.data()),
+            });
+        }
+
+        /**
+         * @brief Adds a contiguous vector (std::vector, utils::PagedVector...).
+         */
+        template <typename Vector>
+        void AddColumn(uint32_t tag, uint32_t column, const Vector &vector)
+        {
+            AddColumn(tag, column, std::span<const typename Vector::value_type>(vector.data(), vector.size()));
+        }
+
+        /**
+         * @brief Adds a container that isn't contiguous (e.g. a std::deque). Its elements are copied.
+         */
+        template <typename Container>
+        void AddColumnCopy(uint32_t tag, uint32_t column, const Container &container)
+        {
+            using T = typename Container::value_type;
+            auto &copy = _ownedData.emplace_back(container.size() * sizeof(T));
+            size_t offset = 0;
+            for (const auto &element : container)
+            {
+                std::memcpy(copy.data() + offset, &element, sizeof(T));
+                offset += sizeof(T);
+            }
+            AddColumn(tag, column, std::span<const T>(reinterpret_cast<const T *>(copy.data()), container.size()));
+        }
+
+        /**
+         * @brief Writes the columns in the given file. Throws if it can't be written.
+         */
+        void Write(const std::string &filePath) const;
+    };
+
+    /**
+     * @brief Snapshot file mapped in memory. Columns are returned as spans pointing into the mapping, so nothing is parsed
+     * nor copied until the managers read them. They remain valid as long as the snapshot exists.
+     */
+    class Snapshot
+    {
+    private:
+        utils::MappedFile _file;
+        const structs::SnapshotColumn *_columns = nullptr;
+        uint32_t _columnCount = 0;
+
+        [[nodiscard]] const structs::SnapshotColumn *FindColumn(uint32_t tag, uint32_t column) const;
+        [[nodiscard]] const std::byte *GetColumnData(const structs::SnapshotColumn &column, size_t elementSize) const;
+
+    public:
+        /**
+         * @brief Maps the snapshot at the given path. Throws if it can't be opened, or if it is not a valid snapshot.
+         */
+        explicit Snapshot(const std::string &filePath);
+
+        [[nodiscard]] bool HasColumn(uint32_t tag, uint32_t column) const;
+
+        /**
+         * @brief Returns the elements of the column. Throws if it doesn't exist, or if it was written with another element size.
+         */
+        template <typename T>
+        [[nodiscard]] std::span<const T> GetColumn(uint32_t tag, uint32_t column) const
+        {
+            const auto *found = FindColumn(tag, column);
+            if (found == nullptr)
+            {
+                throw std::runtime_error("The snapshot doesn't contain a required column.");
+            }
+            return std::span<const T>(reinterpret_cast<const T *>(GetColumnData(*found, sizeof(T))), found->elementCount);
+        }
+
+        /**
+         * @brief Replaces the content of the vector by the elements of the column, in a single copy.
+         */
+        template <typename Vector>
+        void ReadColumn(uint32_t tag, uint32_t column, Vector &vector) const
+        {
+            const auto elements = GetColumn<typename Vector::value_type>(tag, column);
+            vector.clear();
+            vector.assign(elements.begin(), elements.end());
+        }
+    };
+} // namespace railguard::core
@@ -4,6 +4,7 @@
 #include <unordered_map>
 #include <vector>
 #include "Match.h"
+#include "ComponentStorage.h"
 #include "../utils/AdvancedCheck.h"
 
 namespace railguard::core
@@ -22,8 +23,10 @@ namespace railguard::core
      * @tparam T type that will be used to represent ids. Must be integral, but the size may vary depending on the needs.
      * @tparam U optional type that can be used to store a struct of values with the init function.
      * For example, the vulkan device is often required in methods, storing it here removes the need to require it everywhere.
+     * @tparam Storage optional type defining the vectors in which the items are stored (see ComponentStorage.h).
+     * Derived managers can use Storage::Vector for their own vectors, so that they grow the same way.
      */
-    template <std::integral T, typename U = nullptr_t>
+    template <std::integral T, typename U = nullptr_t, typename Storage = HeapStorage>
     class StandaloneManager
     {
     protected:
@@ -46,7 +49,7 @@ namespace railguard::core
         /**
          * @brief Allows to quickly retreive the id of an item from its index.
          */
-        std::vector<T> _ids;
+        typename Storage::template Vector<T> _ids;
 
 #ifdef USE_ADVANCED_CHECKS
         /**
@@ -106,8 +109,8 @@ namespace railguard::core
             {
                 T movedId = _ids[lastIndex];
                 _ids[index] = movedId;
-                // Update id in map
-                _idLookupMap[movedId] = index;
+                // Update id in map (indices are stored plus one, like in CreateItem)
+                _idLookupMap[movedId] = index + 1;
             }
 
             // Remove last item
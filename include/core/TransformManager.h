@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include "ComponentManager.h"
+#include "JobPool.h"
+#include "init/TransformInitInfo.h"
+
+namespace railguard::core
+{
+    /**
+     * @brief Stores the position, rotation and scale of entities, and computes their world matrices.
+     *
+     * The data is stored as a structure of arrays, so that the propagation only touches the arrays it needs.
+     * Components are kept sorted in depth-first order: a parent is always before its children, and the subtree
+     * of a root is a contiguous range. Thus, world matrices are computed in a single linear pass, and root subtrees
+     * can be processed in parallel.
+     *
+     * Changing the hierarchy (creating a child elsewhere than at the end of its parent's subtree, changing a parent) reorders the
+     * components on the next call to UpdateWorldMatrices, which invalidates the previously returned Matches. Destroying a component
+     * keeps the order, but moves the components after it.
+     *
+     * Scenes can hold millions of transforms, so they use paged storage: creating one never reallocates the vectors.
+     *
+     * Changing a local transform or a parent marks the component as changed, so that it is included in the next deltas.
+     * World matrices are not replicated: the receiver computes them.
+     */
+    class TransformManager : public BasicComponentManager<PagedStorage<>>
+    {
+    private:
+        template <typename T>
+        using Vector = PagedStorage<>::Vector<T>;
+
+        static constexpr component_id_t NO_PARENT = SIZE_MAX;
+
+        // === Local transform ===
+
+        Vector<glm::vec3> _positions;
+        Vector<glm::quat> _rotations;
+        Vector<glm::vec3> _scales;
+
+        // === Hierarchy ===
+
+        // Index of the parent of each component, or NO_PARENT for roots
+        Vector<component_id_t> _parents;
+        // Number of components in the subtree of each component, itself included
+        // Only valid when the hierarchy is sorted
+        Vector<component_id_t> _subtreeSizes;
+        // True when the components must be sorted again before the next update
+        bool _hierarchyChanged = false;
+        // Scratch of SortHierarchy, kept so that sorting doesn't allocate
+        std::vector<component_id_t> _firstChildren;
+        std::vector<component_id_t> _nextSiblings;
+        std::vector<component_id_t> _sortStack;
+        std::vector<component_id_t> _newOrder;
+        std::vector<component_id_t> _newIndices;
+        std::vector<component_id_t> _orderScratch;
+
+        // === World transform ===
+
+        Vector<glm::mat4> _worldMatrices;
+        // Components whose local transform changed since the last update. Their whole subtree will be recomputed.
+        // Not a vector<bool>: it packs flags in shared words, which could not be written from several threads
+        Vector<uint8_t> _dirty;
+        bool _hasDirtyComponents = false;
+        // Ranges of root subtrees updated by each job. Kept between updates, so that updating doesn't allocate.
+        std::vector<std::pair<component_id_t, component_id_t>> _updateRanges;
+
+        [[nodiscard]] component_id_t FindParentIndex(const std::optional<Entity> &parent);
+        void MarkDirty(component_id_t index);
+        // Sorts the components in depth-first order and recomputes the subtree sizes
+        void SortHierarchy();
+        // Recomputes the world matrices of the dirty components in the range, which must only contain whole root subtrees
+        void UpdateRange(component_id_t begin, component_id_t end);
+
+    public:
+        explicit TransformManager(component_id_t defaultComponentCapacity);
+
+        Match CreateComponent(const Entity &entity, const init::TransformInitInfo &initInfo);
+        using BasicComponentManager::DestroyComponent;
+        /**
+         * @brief Destroys the component. Its children become roots, and keep their local transform.
+         * The order of the other components is kept, so the hierarchy doesn't need to be sorted again.
+         */
+        void DestroyComponent(component_id_t index) override;
+
+        /**
+         * @brief Recomputes the world matrices of the transforms that changed since the last update, and of their children.
+         */
+        void UpdateWorldMatrices(JobPool &jobPool);
+
+        // === Getters ===
+
+        [[nodiscard]] const glm::vec3 &GetLocalPosition(const Match &match) const;
+        [[nodiscard]] const glm::quat &GetLocalRotation(const Match &match) const;
+        [[nodiscard]] const glm::vec3 &GetLocalScale(const Match &match) const;
+        /**
+         * @brief Returns the world matrix computed by the last call to UpdateWorldMatrices.
+         */
+        [[nodiscard]] const glm::mat4 &GetWorldMatrix(const Match &match) const;
+        [[nodiscard]] std::optional<Entity> GetParent(const Match &match) const;
+
+        // === Setters ===
+
+        void SetLocalPosition(const Match &match, const glm::vec3 &position);
+        void SetLocalRotation(const Match &match, const glm::quat &rotation);
+        void SetLocalScale(const Match &match, const glm::vec3 &scale);
+        /**
+         * @brief Attaches the transform to another one, or makes it a root if parent is empty.
+         * Fails if it would create a cycle.
+         */
+        void SetParent(const Match &match, const std::optional<Entity> &parent);
+
+        // === Snapshots ===
+
+        /**
+         * @brief Adds the columns of the manager to the snapshot. They are referenced, so the manager must not change until it is written.
+         */
+        void SaveSnapshot(SnapshotWriter &writer) const;
+        /**
+         * @brief Replaces the transforms by the ones of the snapshot. Each column is copied at once, and the world matrices are loaded
+         * with the rest, so they don't need to be recomputed.
+         */
+        void LoadSnapshot(const Snapshot &snapshot);
+
+        // === Replication ===
+
+        /**
+         * @brief Writes the transforms created, changed or destroyed since the given version, identified by their entity.
+         * Throws if the history was discarded past that version.
+         */
+        void WriteDelta(DeltaWriter &writer, uint64_t fromVersion) const;
+        /**
+         * @brief Applies a delta written by another engine, creating the transforms of unknown entities.
+         *
+         * @param appliedVersion Version returned by the last delta applied to the manager, or 0 for the first one.
+         * Throws if the delta was written from a later version, since the changes in between would be lost.
+         * @return The version of the writer that the manager now matches, to acknowledge it.
+         */
+        uint64_t ApplyDelta(DeltaReader &reader, uint64_t appliedVersion);
+    };
+} // namespace railguard::core
@@ -28,8 +28,8 @@ namespace railguard::core
         static void HandleError();
         void CreateWindow();
         void DestroyWindow();
-        [[nodiscard]] uint64_t GetPerformanceCounter();
-        [[nodiscard]] uint64_t GetPerformanceFrequency();
+        [[nodiscard]] static uint64_t GetPerformanceCounter();
+        [[nodiscard]] static uint64_t GetPerformanceFrequency();
         [[nodiscard]] std::vector<const char*> GetRequiredVulkanExtensions() const;
         [[nodiscard]] vk::SurfaceKHR GetVulkanSurface(vk::Instance instance) const;
         [[nodiscard]] vk::Extent2D GetWindowExtent() const;
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include "../../includes/Vulkan.h"
+
+namespace railguard::core::init
+{
+    struct EngineInitInfo
+    {
+    public:
+        // If true, no window is created and the frames are drawn in offscreen images
+        bool headless = false;
+        // Size of the window, or of the offscreen images when headless
+        vk::Extent2D extent{500, 500};
+        // Number of frames after which the main loop stops. 0 means that it runs until the window is closed.
+        uint64_t frameCount = 0;
+        // Directory in which the frames are written when headless. If empty, the frames are not read back.
+        std::string readbackDirectory{};
+    };
+} // namespace railguard::core::init
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <optional>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include "../Entity.h"
+
+namespace railguard::core::init
+{
+    struct TransformInitInfo
+    {
+    public:
+        glm::vec3 position{0.0f};
+        glm::quat rotation{1.0f, 0.0f, 0.0f, 0.0f};
+        glm::vec3 scale{1.0f};
+        // Entity whose transform this one is relative to. It must already have a transform component.
+        std::optional<Entity> parent = std::nullopt;
+    };
+} // namespace railguard::core::init
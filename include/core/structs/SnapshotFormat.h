@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+
+// Layout of a snapshot file, which contains the state of the entity and component managers. Every field is little endian.
+//
+// | SnapshotFileHeader | SnapshotColumn[columnCount] | padding | column 0 | padding | column 1 | ... |
+//
+// Each column is a vector of a manager (e.g. the positions of the transforms), written as is. The columns start at a multiple
+// of SNAPSHOT_FILE_ALIGNMENT, so that once the file is mapped, they can be used in place or copied to the managers in a
+// single memcpy, without parsing anything.
+// A column is identified by the tag of its manager and by its index in that manager. Column SNAPSHOT_ENTITIES_COLUMN of each
+// component manager contains its entities, the other indices are defined by each manager.
+// The elements are stored with the layout of the engine that wrote the file: elementSize is used to refuse a file written by
+// a build where a type has another size.
+
+#define SNAPSHOT_FILE_MAGIC 0x4E534752 // "RGSN"
+#define SNAPSHOT_FILE_VERSION 1
+// Cache line size, also enough for the aligned glm types
+#define SNAPSHOT_FILE_ALIGNMENT 64
+#define SNAPSHOT_ENTITIES_COLUMN 0
+
+namespace railguard::core::structs
+{
+    struct SnapshotColumn
+    {
+        // Tag of the manager that owns the column
+        uint32_t tag;
+        // Index of the column in the manager
+        uint32_t column;
+        uint32_t elementSize;
+        uint32_t padding;
+        uint64_t elementCount;
+        // Offset of the first element from the start of the file
+        uint64_t offset;
+    };
+
+    struct SnapshotFileHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t columnCount;
+        uint32_t padding;
+        // Total size of the file, used to check that it is complete
+        uint64_t fileSize;
+    };
+
+    /**
+     * @brief Creates the tag of a manager from its four characters name, e.g. SnapshotTag("TRFM").
+     */
+    constexpr uint32_t SnapshotTag(const char (&name)[5])
+    {
+        return static_cast<uint32_t>(static_cast<uint8_t>(name[0])) | static_cast<uint32_t>(static_cast<uint8_t>(name[1])) << 8 |
+               static_cast<uint32_t>(static_cast<uint8_t>(name[2])) << 16 | static_cast<uint32_t>(static_cast<uint8_t>(name[3])) << 24;
+    }
+
+    static_assert(sizeof(SnapshotColumn) == 32, "Snapshot columns must not contain padding.");
+    static_assert(sizeof(SnapshotFileHeader) == 24, "The snapshot file header must not contain padding.");
+} // namespace railguard::core::structs
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <map>
+#include <unordered_map>
+#include <cstring>
+#include "../includes/Vulkan.h"
+#include "../includes/Vma.h"
+#include "./Settings.h"
+#include "./structs/BufferRegion.h"
+
+namespace railguard::rendering
+{
+    /**
+     * @brief Gives regions of a few large buffers, instead of creating a vulkan buffer for each object.
+     *
+     * Two kinds of memory are available:
+     * - Frame data: a persistently mapped, host visible ring buffer with one segment per overlapping frame.
+     *   Allocations are linear and are all freed at once when the frame is reused. Used for uniforms and dynamic vertex data.
+     *   Data whose size depends on the scene goes in growable frame data instead: one mapped buffer per overlapping frame,
+     *   replaced by a larger one when it is full.
+     * - Device buffers: regions of device local blocks of DEVICE_BUFFER_BLOCK_SIZE bytes. Used for static data such as meshes.
+     *   They are not mapped, so their content must be copied with a transfer command.
+     */
+    class BufferManager
+    {
+    private:
+        struct MappedBuffer
+        {
+            vk::Buffer buffer = nullptr;
+            VmaAllocation allocation = nullptr;
+            uint8_t *mappedData = nullptr;
+            vk::DeviceSize size = 0;
+        };
+
+        /**
+         * @brief Device local buffer in which regions are sub-allocated.
+         */
+        struct DeviceBlock
+        {
+            vk::Buffer buffer = nullptr;
+            VmaAllocation allocation = nullptr;
+            vk::DeviceSize size = 0;
+            // Offset -> size of each free range, sorted by offset so that neighbours can be merged
+            std::map<vk::DeviceSize, vk::DeviceSize> freeRanges{};
+        };
+
+        // Handles
+        VmaAllocator _allocator = nullptr;
+        vk::DeviceSize _minUniformAlignment = 1;
+        // Queue families that access the buffers. If there are several, the buffers are shared between them.
+        std::vector<uint32_t> _queueFamilies;
+
+        // === Frame data ===
+
+        vk::Buffer _frameBuffer = nullptr;
+        VmaAllocation _frameAllocation = nullptr;
+        uint8_t *_frameMappedData = nullptr;
+        uint32_t _currentFrame = 0;
+        // Offset of the next allocation in the current segment
+        vk::DeviceSize _frameOffset = 0;
+
+        // === Growable frame data ===
+
+        MappedBuffer _growableBuffers[NB_OVERLAPPING_FRAMES];
+        // Offset of the next allocation in the growable buffer of the current frame
+        vk::DeviceSize _growableOffset = 0;
+        // Buffers that were replaced during each frame. They are destroyed when the frame is reused.
+        std::vector<MappedBuffer> _retiredGrowableBuffers[NB_OVERLAPPING_FRAMES];
+
+        // === Device buffers ===
+
+        std::vector<DeviceBlock> _deviceBlocks;
+        std::unordered_map<VkBuffer, uint32_t> _deviceBlockIndices;
+        // Regions freed during each frame. They are only given back when the frame is reused, since the GPU may still read them.
+        std::vector<structs::BufferRegion> _pendingFrees[NB_OVERLAPPING_FRAMES];
+
+#ifdef USE_ADVANCED_CHECKS
+        // In debug mode, keep track of the init status to ensure that Init is called first
+        bool _initialized = false;
+#endif
+
+        [[nodiscard]] VkBufferCreateInfo GetBufferCreateInfo(vk::DeviceSize size, vk::BufferUsageFlags usage) const;
+        // Creates a persistently mapped, coherent buffer usable for frame data
+        [[nodiscard]] MappedBuffer CreateMappedBuffer(vk::DeviceSize size) const;
+        void DestroyMappedBuffer(const MappedBuffer &buffer) const;
+        uint32_t CreateDeviceBlock(vk::DeviceSize size);
+        void ReleaseDeviceRegion(const structs::BufferRegion &region);
+
+    public:
+        /**
+         * @param queueFamilies Families of the queues that will use the buffers (graphics, transfer, async compute...).
+         * Duplicates are allowed. Buffers are created with concurrent sharing when there is more than one family,
+         * so that they don't need ownership transfers.
+         */
+        void Init(VmaAllocator allocator, const vk::PhysicalDeviceProperties &physicalDeviceProperties, const std::vector<uint32_t> &queueFamilies);
+        void Cleanup();
+        ~BufferManager();
+
+        /**
+         * @brief Starts using the segment of the given frame. Its previous allocations are discarded.
+         * The fence of that frame must have been waited for.
+         */
+        void BeginFrame(uint32_t frameIndex);
+
+        /**
+         * @brief Allocates mapped memory that is valid until the end of the current frame.
+         * @param alignment Required alignment of the offset. If 0, the minimum alignment of uniform buffers is used.
+         */
+        [[nodiscard]] structs::BufferRegion AllocateFrameData(vk::DeviceSize size, vk::DeviceSize alignment = 0);
+        /**
+         * @brief Allocates mapped memory that is valid until the end of the current frame, in the growable buffer of the frame.
+         * Unlike AllocateFrameData, it is not limited by FRAME_BUFFER_SEGMENT_SIZE, but the region is not in the frame ring buffer:
+         * its own buffer must be bound.
+         */
+        [[nodiscard]] structs::BufferRegion AllocateGrowableFrameData(vk::DeviceSize size, vk::DeviceSize alignment = 16);
+        /**
+         * @brief Allocates frame data and copies the given value in it.
+         */
+        template <typename T>
+        structs::BufferRegion PushFrameData(const T &data)
+        {
+            auto region = AllocateFrameData(sizeof(T));
+            std::memcpy(region.mappedData, &data, sizeof(T));
+            return region;
+        }
+
+        /**
+         * @brief Allocates a region of device local memory, usable as vertex, index or storage buffer and as transfer destination.
+         */
+        [[nodiscard]] structs::BufferRegion AllocateDeviceBuffer(vk::DeviceSize size, vk::DeviceSize alignment = 16);
+        /**
+         * @brief Gives the region back to its block once the frames that may still use it are finished.
+         */
+        void FreeDeviceBuffer(const structs::BufferRegion &region);
+
+        /**
+         * @brief Returns the ring buffer in which the frame data is allocated. The offsets of the frame data regions are relative to it.
+         */
+        [[nodiscard]] vk::Buffer GetFrameBuffer() const;
+        [[nodiscard]] vk::DeviceSize GetFrameDataUsage() const;
+        [[nodiscard]] size_t GetDeviceBlockCount() const;
+    };
+} // namespace railguard::rendering
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <memory_resource>
+#include <glm/glm.hpp>
+#include "../includes/Vulkan.h"
+#include "./BufferManager.h"
+#include "./PipelineLayoutCache.h"
+#include "./Settings.h"
+#include "./structs/ShaderReflection.h"
+#include "./structs/CameraData.h"
+
+namespace railguard::rendering
+{
+    /**
+     * @brief Culls the meshlets of the drawn meshes on the GPU, before the draws are recorded.
+     *
+     * Each meshlet of an instance gets its own indirect draw command. A compute shader tests its bounding sphere against the
+     * frustum and its normal cone against the camera position, and writes the command with an index count of 0 if it is not visible.
+     * The commands are not compacted (that would need drawIndirectCount), so each draw keeps a fixed range of commands that can be
+     * recorded before the shader runs.
+     *
+     * Cameras whose frusta overlap share their culling: they form a group, and a meshlet is kept for the group if it is visible
+     * from one of its cameras. Each group gets its own copy of the commands, so cameras looking in different directions
+     * (e.g. in split screen) don't draw each other's meshlets.
+     *
+     * The cone test assumes that back faces are culled by the pipelines that draw the meshlets.
+     */
+    class ClusterCuller
+    {
+    private:
+        /**
+         * @brief Instance of a mesh whose meshlets are culled. Read by the culling shader.
+         */
+        struct ClusterInstance
+        {
+            glm::mat4 transform;
+            uint32_t firstMeshlet;
+            uint32_t firstCommand;
+            uint32_t firstInstance;
+            int32_t baseVertex;
+        };
+
+        /**
+         * @brief Camera against which the meshlets are tested. Read by the culling shader.
+         */
+        struct CullingView
+        {
+            // Left, right, bottom, top, near and far planes. xyz is the normal, pointing inside the frustum, and w the distance.
+            glm::vec4 frustumPlanes[6];
+            glm::vec4 cameraPosition;
+        };
+
+        struct CullingPushConstants
+        {
+            // Number of commands of each group
+            uint32_t commandCount;
+            uint32_t groupCount;
+            // First view and number of views of each group. A group without views culls nothing.
+            glm::uvec2 groups[MAX_CULLING_GROUPS];
+        };
+
+        // Handles
+        vk::Device _device = nullptr;
+        PipelineLayoutCache *_pipelineLayoutCache = nullptr;
+        BufferManager *_bufferManager = nullptr;
+        vk::PipelineLayout _pipelineLayout = nullptr;
+        vk::DescriptorSetLayout _descriptorSetLayout = nullptr;
+        vk::Pipeline _pipeline = nullptr;
+        vk::DescriptorPool _descriptorPool = nullptr;
+        vk::DescriptorSet _descriptorSets[NB_OVERLAPPING_FRAMES] = {};
+        bool _multiDrawIndirect = false;
+        bool _drawIndirectFirstInstance = false;
+
+        // Meshlets of every mesh
+        structs::BufferRegion _meshletBuffer{};
+        // Draw commands written by the shader, one region per overlapping frame
+        structs::BufferRegion _commandBuffers[NB_OVERLAPPING_FRAMES] = {};
+
+        // === Current frame ===
+
+        uint32_t _currentFrame = 0;
+        std::vector<ClusterInstance> _instances;
+        // Index of the instance of each command
+        std::vector<uint32_t> _commandInstances;
+        // Views of every group, one group after the other
+        std::vector<CullingView> _views;
+        CullingPushConstants _pushConstants{};
+
+        [[nodiscard]] static CullingView GetCullingView(const structs::CameraView &camera);
+
+#ifdef USE_ADVANCED_CHECKS
+        // In debug mode, keep track of the init status to ensure that Init is called first
+        bool _initialized = false;
+#endif
+
+    public:
+        static constexpr uint32_t NO_COMMANDS = UINT32_MAX;
+
+        /**
+         * @param bufferManager Manager from which the commands and the per-frame data of the shader are allocated
+         * @param cullingShader Module of the cluster_cull.comp shader
+         * @param reflection Reflection of that module, from which the pipeline layout is created
+         * @param meshletBuffer Buffer containing the meshlets of every mesh (see MeshManager::GetMeshletBuffer)
+         * @param enabledFeatures Features of the device. Without multiDrawIndirect, the commands of a draw are recorded one by one,
+         * and without drawIndirectFirstInstance, only instances with a firstInstance of 0 can be culled.
+         */
+        void Init(const vk::Device &device, PipelineLayoutCache &pipelineLayoutCache, BufferManager &bufferManager,
+                  vk::ShaderModule cullingShader, const structs::ShaderReflection &reflection,
+                  const structs::BufferRegion &meshletBuffer, const vk::PhysicalDeviceFeatures &enabledFeatures);
+        void Cleanup();
+        ~ClusterCuller();
+
+        /**
+         * @brief Starts a new frame. The fence of that frame must have been waited for, since its commands are overwritten.
+         * Until SetViews is called, every meshlet is drawn.
+         */
+        void BeginFrame(uint32_t frameIndex);
+        /**
+         * @brief Sets the cameras against which the meshlets are tested during the current frame, and groups those whose frusta overlap.
+         * Must be called before the instances are added, since each group multiplies the number of commands.
+         *
+         * @param views Cameras of the frame. Their cullingGroup is set to the group with which they must be drawn.
+         * @param frameMemory Memory used while the views are grouped, usually the arena of the frame
+         */
+        void SetViews(std::vector<structs::CameraView> &views, std::pmr::memory_resource *frameMemory = std::pmr::get_default_resource());
+        /**
+         * @brief Returns true if the given number of commands can still be added during the current frame, for every group.
+         * @param usesFirstInstance True if one of the instances has a firstInstance other than 0
+         */
+        [[nodiscard]] bool CanAddCommands(uint32_t commandCount, bool usesFirstInstance) const;
+        /**
+         * @brief Adds an instance whose meshlets will be culled during the current frame.
+         *
+         * @return Index of the first of the meshletCount commands that draw the meshlets, or NO_COMMANDS if they can't be added
+         * (see CanAddCommands). In that case, the instance must be drawn without culling.
+         */
+        [[nodiscard]] uint32_t AddInstance(const glm::mat4 &transform, uint32_t firstMeshlet, uint32_t meshletCount, uint32_t firstInstance, int32_t baseVertex);
+        /**
+         * @brief Records the culling of every instance added since BeginFrame, on the async compute queue.
+         * The submission of the draws that use the commands must wait for it at the draw indirect stage.
+         */
+        void Record(const vk::CommandBuffer &cmd);
+        /**
+         * @brief Records the indirect draws of the given commands, as culled for a group of cameras. The index buffer of the mesh must be bound.
+         */
+        void DrawClusters(const vk::CommandBuffer &cmd, uint32_t firstCommand, uint32_t commandCount, uint32_t group) const;
+
+        /**
+         * @brief Returns the number of commands of each group.
+         */
+        [[nodiscard]] uint32_t GetCommandCount() const;
+        [[nodiscard]] uint32_t GetGroupCount() const;
+    };
+} // namespace railguard::rendering
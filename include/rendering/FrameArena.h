@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+namespace railguard::rendering
+{
+    /**
+     * @brief Linear allocator for the transient CPU data of a frame (barrier lists, semaphores to wait for, culling views...).
+     *
+     * Allocations only bump an offset in a block, and deallocations do nothing: the whole arena is reset at once when the fence of its
+     * frame is signaled. When a frame needs more than the current block, a new block is added, and on the next reset the blocks are
+     * merged into a single one large enough for that frame. Thus, once the peak usage is reached, the arena doesn't allocate anything.
+     * Scratch memory that is reused every frame, like the one of the render queue sort, is kept by its owner instead.
+     *
+     * It is a std::pmr::memory_resource, so it can back standard containers (e.g. std::pmr::vector). Those containers must not outlive the frame.
+     */
+    class FrameArena : public std::pmr::memory_resource
+    {
+    private:
+        struct Block
+        {
+            std::unique_ptr<std::byte[]> data;
+            size_t size = 0;
+        };
+
+        std::vector<Block> _blocks;
+        // Block in which the next allocation is tried, and offset in that block
+        size_t _currentBlock = 0;
+        size_t _offset = 0;
+        // Bytes allocated since the last reset, including the alignment padding
+        size_t _usedSize = 0;
+        size_t _peakSize = 0;
+
+    protected:
+        void *do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void *pointer, size_t bytes, size_t alignment) override;
+        [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+    public:
+        /**
+         * @param initialSize Size of the first block. If 0, FRAME_ARENA_BLOCK_SIZE is used.
+         */
+        explicit FrameArena(size_t initialSize = 0);
+        FrameArena(const FrameArena &) = delete;
+        FrameArena &operator=(const FrameArena &) = delete;
+
+        /**
+         * @brief Frees every allocation at once. The data of the frame must not be used anymore.
+         */
+        void Reset();
+
+        [[nodiscard]] size_t GetUsedSize() const;
+        /**
+         * @brief Returns the largest size used by a frame since the arena was created.
+         */
+        [[nodiscard]] size_t GetPeakSize() const;
+        [[nodiscard]] size_t GetCapacity() const;
+    };
+} // namespace railguard::rendering
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <vector>
 #include "../includes/Vulkan.h"
 #include "./Settings.h"
+#include "./FrameArena.h"
 
 namespace railguard::rendering
 {
@@ -11,6 +13,8 @@ namespace railguard::rendering
         vk::Fence renderFence;
         vk::Semaphore presentSemaphore;
         vk::Semaphore renderSemaphore;
+        vk::CommandBuffer computeCommandBuffer;
+        vk::Semaphore computeSemaphore;
     };
 
     class FrameManager
@@ -27,6 +31,14 @@ namespace railguard::rendering
         vk::Semaphore _presentSemaphores[NB_OVERLAPPING_FRAMES];
         vk::Semaphore _renderSemaphores[NB_OVERLAPPING_FRAMES];
         vk::Fence _renderFences[NB_OVERLAPPING_FRAMES];
+        // Async compute work is recorded in separate pools, since it can be submitted to another queue family
+        vk::CommandPool _computeCommandPools[NB_OVERLAPPING_FRAMES];
+        vk::CommandBuffer _computeCommandBuffers[NB_OVERLAPPING_FRAMES];
+        vk::Semaphore _computeSemaphores[NB_OVERLAPPING_FRAMES];
+        // When several swapchains are presented, each image is acquired with its own semaphore. The first one is the present semaphore.
+        std::vector<vk::Semaphore> _additionalPresentSemaphores[NB_OVERLAPPING_FRAMES];
+        // Transient CPU data of each frame
+        FrameArena _arenas[NB_OVERLAPPING_FRAMES];
 
 #ifdef USE_ADVANCED_CHECKS
         // In debug mode, keep track of the init status to ensure that Init is called first
@@ -34,7 +46,7 @@ namespace railguard::rendering
 #endif
 
     public:
-        void Init(const vk::Device &device, uint32_t graphicsQueueFamily);
+        void Init(const vk::Device &device, uint32_t graphicsQueueFamily, uint32_t computeQueueFamily);
         void Cleanup();
         ~FrameManager();
 
@@ -45,5 +57,16 @@ namespace railguard::rendering
         [[nodiscard]] const vk::Fence GetRenderFence(uint32_t index) const;
         [[nodiscard]] const vk::Semaphore GetRenderSemaphore(uint32_t index) const;
         [[nodiscard]] const vk::Semaphore GetPresentSemaphore(uint32_t index) const;
+        /**
+         * @brief Returns the semaphore with which the image of the n-th swapchain drawn during the frame is acquired.
+         * The first one is the present semaphore of the frame, and the other ones are created on first use.
+         */
+        [[nodiscard]] vk::Semaphore GetPresentSemaphore(uint32_t index, uint32_t swapchainIndex);
+        [[nodiscard]] const vk::CommandBuffer GetComputeCommandBuffer(uint32_t index) const;
+        [[nodiscard]] const vk::Semaphore GetComputeSemaphore(uint32_t index) const;
+        /**
+         * @brief Returns the arena of the frame. It must be reset once the fence of the frame is signaled.
+         */
+        [[nodiscard]] FrameArena &GetArena(uint32_t index);
     };
 }
\ No newline at end of file
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <array>
+#include <map>
+#include <string>
+#include "../core/StandaloneManager.h"
+#include "./BufferManager.h"
+#include "./UploadManager.h"
+#include "./structs/DrawItem.h"
+#include "./structs/MeshFormat.h"
+
+namespace railguard::rendering
+{
+    // Use a typedef to specify which type will be used for mesh ids
+    // That way, if we need to change that type, we only need to do it here
+    typedef uint32_t mesh_id_t;
+
+    /**
+     * @brief Storage that is used to store pointers to the managers that hold the geometry.
+     */
+    struct MeshManagerStorage
+    {
+        BufferManager *bufferManager = nullptr;
+        UploadManager *uploadManager = nullptr;
+    };
+
+    /**
+     * @brief Stores the meshes created by the meshconverter tool (see structs/MeshFormat.h).
+     *
+     * Mesh files are mapped in memory, and their vertex and index streams are copied as is to a device buffer region:
+     * nothing is parsed or converted at load time. The upload is asynchronous, so a mesh must not be drawn before IsMeshReady
+     * returns true.
+     *
+     * The meshlets of every mesh are stored in a single buffer of MAX_MESHLETS meshlets, so that the cluster culling shader can
+     * read them all with one binding. Meshes that don't fit in it are still drawn, but without cluster culling.
+     */
+    class MeshManager : public core::StandaloneManager<mesh_id_t, MeshManagerStorage>
+    {
+    private:
+        // Typedef the parent type to make it easier to call from the methods
+        typedef core::StandaloneManager<mesh_id_t, MeshManagerStorage> super;
+
+        // Region containing the vertices, directly followed by the indices
+        std::vector<structs::BufferRegion> _geometryRegions;
+        // Offset of the indices in the geometry region
+        std::vector<vk::DeviceSize> _indexOffsets;
+        std::vector<std::array<structs::MeshLod, MESH_MAX_LODS>> _lods;
+        std::vector<uint32_t> _lodCounts;
+        std::vector<structs::MeshBounds> _bounds;
+        std::vector<upload_ticket_t> _uploadTickets;
+        // Index of the first meshlet of each mesh in the meshlet buffer, or NO_MESHLETS
+        std::vector<uint32_t> _firstMeshlets;
+        std::vector<uint32_t> _meshletCounts;
+
+        // === Meshlets ===
+
+        structs::BufferRegion _meshletBuffer{};
+        // First meshlet -> number of meshlets of each free range, sorted so that neighbours can be merged
+        std::map<uint32_t, uint32_t> _freeMeshletRanges;
+        // Ranges freed during each frame. They are only given back when the frame is reused, since the culling shader may still read them.
+        std::vector<std::pair<uint32_t, uint32_t>> _pendingMeshletFrees[NB_OVERLAPPING_FRAMES];
+        uint32_t _currentFrame = 0;
+
+        [[nodiscard]] uint32_t AllocateMeshlets(uint32_t count);
+        void ReleaseMeshlets(uint32_t first, uint32_t count);
+
+    public:
+        static constexpr uint32_t NO_MESHLETS = UINT32_MAX;
+
+        void Init(MeshManagerStorage storage, size_t defaultCapacity = 5);
+        void Clear();
+
+        /**
+         * @brief Gives back the meshlets of the meshes destroyed during the last use of the given frame.
+         * The fence of that frame must have been waited for.
+         */
+        void BeginFrame(uint32_t frameIndex);
+
+        /**
+         * @brief Loads a mesh file and starts uploading its geometry.
+         *
+         * @param filePath Path to a file created by the meshconverter tool.
+         * @return core::CompleteMatch<mesh_id_t> match containing the Id of the created mesh, to be able to retreive it later.
+         */
+        [[nodiscard]] core::CompleteMatch<mesh_id_t> LoadMesh(const std::string &filePath);
+        /**
+         * @brief Destroys the mesh. Its geometry is freed once the frames that may use it are finished.
+         */
+        void DestroyMesh(const core::Match &match);
+
+        /**
+         * @brief Returns true once the geometry of the mesh is uploaded and can be drawn.
+         */
+        [[nodiscard]] bool IsMeshReady(const core::Match &match) const;
+        /**
+         * @brief Chooses the coarsest LOD whose error is not visible at the given distance (see MESH_LOD_ERROR_RATIO).
+         *
+         * @param distance Distance between the camera and the mesh
+         * @param scale Largest scale factor of the transform of the mesh, since the errors are in the units of the mesh
+         */
+        [[nodiscard]] uint32_t SelectLod(const core::Match &match, float distance, float scale = 1.0f) const;
+        /**
+         * @brief Sets the buffers and the index range of the draw item so that it draws the given LOD of the mesh.
+         * If the mesh has meshlets, the meshlet range of the LOD is also set, so that the item uses cluster culling.
+         */
+        void FillDrawItem(const core::Match &match, uint32_t lod, structs::DrawItem &item) const;
+
+        [[nodiscard]] uint32_t GetLodCount(const core::Match &match) const;
+        [[nodiscard]] const structs::MeshLod &GetLod(const core::Match &match, uint32_t lod) const;
+        [[nodiscard]] const structs::MeshBounds &GetBounds(const core::Match &match) const;
+        /**
+         * @brief Returns the region containing the meshlets of every mesh. Meshlet ranges of draw items are relative to it.
+         */
+        [[nodiscard]] const structs::BufferRegion &GetMeshletBuffer() const;
+    };
+} // namespace railguard::rendering
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <filesystem>
+#include "../includes/Vulkan.h"
+#include "../includes/Vma.h"
+#include "./Settings.h"
+
+namespace railguard::rendering
+{
+    /**
+     * @brief Images in which the renderer draws when it is headless, in place of the images of a swapchain.
+     *
+     * Each overlapping frame has its own image, so that a frame can be drawn while the previous ones are still executing.
+     * When a readback directory is given, each frame is copied to a host visible buffer after it is drawn, and written to
+     * a PPM file (frame_<number>.ppm) once its fence is signaled, so that the GPU never waits for the disk.
+     */
+    class OffscreenTarget
+    {
+    private:
+        /**
+         * @brief Host visible copy of a frame, written to disk when the frame is finished.
+         */
+        struct Readback
+        {
+            vk::Buffer buffer = nullptr;
+            VmaAllocation allocation = nullptr;
+            void *mappedData = nullptr;
+            uint64_t frameNumber = 0;
+            // True if a copy was recorded and not written to disk yet
+            bool pending = false;
+        };
+
+        // Handles
+        vk::Device _device = nullptr;
+        VmaAllocator _allocator = nullptr;
+
+        vk::Extent2D _extent{};
+        vk::Format _format = vk::Format::eUndefined;
+        vk::Image _images[NB_OVERLAPPING_FRAMES] = {};
+        VmaAllocation _imageAllocations[NB_OVERLAPPING_FRAMES] = {};
+        vk::ImageView _imageViews[NB_OVERLAPPING_FRAMES] = {};
+
+        // Readback, only used if the directory is not empty
+        std::filesystem::path _readbackDirectory;
+        Readback _readbacks[NB_OVERLAPPING_FRAMES] = {};
+
+#ifdef USE_ADVANCED_CHECKS
+        // In debug mode, keep track of the init status to ensure that Init is called first
+        bool _initialized = false;
+#endif
+
+        void WriteReadback(Readback &readback);
+
+    public:
+        /**
+         * @param format Format of the images. The readback expects a format with 4 bytes per pixel in BGRA order.
+         * @param readbackDirectory Directory in which the frames are written. If empty, the frames are not read back.
+         */
+        void Init(const vk::Device &device, VmaAllocator allocator, vk::Extent2D extent, vk::Format format, const std::filesystem::path &readbackDirectory);
+        /**
+         * @brief Writes the remaining readbacks and destroys the images. Every frame must be finished.
+         */
+        void Cleanup();
+        ~OffscreenTarget();
+
+        /**
+         * @brief Writes the readback of the last use of the frame to disk. The fence of that frame must have been waited for.
+         */
+        void BeginFrame(uint32_t frameIndex);
+        /**
+         * @brief Records a copy of the image of the frame to its readback buffer. The image must be in the transfer source layout.
+         * Does nothing if the readback is disabled.
+         */
+        void RecordReadback(const vk::CommandBuffer &cmd, uint32_t frameIndex, uint64_t frameNumber);
+
+        [[nodiscard]] vk::Image GetImage(uint32_t frameIndex) const;
+        [[nodiscard]] vk::ImageView GetImageView(uint32_t frameIndex) const;
+        [[nodiscard]] vk::Format GetFormat() const;
+        [[nodiscard]] vk::Extent2D GetExtent() const;
+        [[nodiscard]] bool IsReadbackEnabled() const;
+    };
+} // namespace railguard::rendering
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <unordered_map>
+#include "../includes/Vulkan.h"
+#include "./structs/PipelineLayoutDescription.h"
+
+namespace railguard::rendering
+{
+    /**
+     * @brief Hash functor allowing descriptor set layout descriptions to be used as map keys.
+     */
+    struct DescriptorSetLayoutDescriptionHash
+    {
+        size_t operator()(const structs::DescriptorSetLayoutDescription &description) const;
+    };
+
+    /**
+     * @brief Hash functor allowing pipeline layout descriptions to be used as map keys.
+     */
+    struct PipelineLayoutDescriptionHash
+    {
+        size_t operator()(const structs::PipelineLayoutDescription &description) const;
+    };
+
+    /**
+     * @brief Hash-consing cache for pipeline layouts and descriptor set layouts.
+     *
+     * Identical layouts are only created once. Each call to a Get method increments a reference count,
+     * and each call to the matching Release method decrements it. The vulkan object is destroyed when its
+     * count reaches zero.
+     *
+     * Sharing layouts between pipelines also allows them to stay compatible: descriptor sets bound with a layout
+     * stay bound when switching to another pipeline using the same layout.
+     */
+    class PipelineLayoutCache
+    {
+    private:
+        template <typename T>
+        struct CacheEntry
+        {
+            T handle = nullptr;
+            uint32_t referenceCount = 0;
+        };
+
+        // Ref to device
+        vk::Device _device = nullptr;
+
+        // Description -> created object
+        std::unordered_map<structs::DescriptorSetLayoutDescription, CacheEntry<vk::DescriptorSetLayout>, DescriptorSetLayoutDescriptionHash> _setLayouts;
+        std::unordered_map<structs::PipelineLayoutDescription, CacheEntry<vk::PipelineLayout>, PipelineLayoutDescriptionHash> _pipelineLayouts;
+
+        // Reverse maps used to find the description of an object when it is released
+        std::unordered_map<VkDescriptorSetLayout, structs::DescriptorSetLayoutDescription> _setLayoutDescriptions;
+        std::unordered_map<VkPipelineLayout, structs::PipelineLayoutDescription> _pipelineLayoutDescriptions;
+
+#ifdef USE_ADVANCED_CHECKS
+        // In debug mode, keep track of the init status to ensure that Init is called first
+        bool _initialized = false;
+#endif
+
+        /**
+         * @brief Sorts the content of the description so that equivalent descriptions compare equal.
+         */
+        static structs::DescriptorSetLayoutDescription Canonicalize(const structs::DescriptorSetLayoutDescription &description);
+        static structs::PipelineLayoutDescription Canonicalize(const structs::PipelineLayoutDescription &description);
+
+    public:
+        void Init(const vk::Device &device);
+        /**
+         * @brief Destroys every remaining layout, regardless of their reference count.
+         */
+        void Cleanup();
+        ~PipelineLayoutCache();
+
+        /**
+         * @brief Returns a descriptor set layout matching the description, creating it if needed.
+         * Every call must be balanced by a call to ReleaseDescriptorSetLayout.
+         */
+        [[nodiscard]] vk::DescriptorSetLayout GetDescriptorSetLayout(const structs::DescriptorSetLayoutDescription &description);
+        /**
+         * @brief Returns a pipeline layout matching the description, creating it (and its set layouts) if needed.
+         * Every call must be balanced by a call to ReleasePipelineLayout.
+         */
+        [[nodiscard]] vk::PipelineLayout GetPipelineLayout(const structs::PipelineLayoutDescription &description);
+
+        /**
+         * @brief Decrements the reference count of the given set layout, and destroys it if it is not used anymore.
+         */
+        void ReleaseDescriptorSetLayout(vk::DescriptorSetLayout setLayout);
+        /**
+         * @brief Decrements the reference count of the given pipeline layout, and destroys it if it is not used anymore.
+         */
+        void ReleasePipelineLayout(vk::PipelineLayout pipelineLayout);
+
+        /**
+         * @brief Increments the reference count of a layout that was previously returned by GetPipelineLayout.
+         */
+        void RetainPipelineLayout(vk::PipelineLayout pipelineLayout);
+
+        [[nodiscard]] const structs::PipelineLayoutDescription &GetDescription(vk::PipelineLayout pipelineLayout) const;
+        [[nodiscard]] size_t GetPipelineLayoutCount() const;
+        [[nodiscard]] size_t GetDescriptorSetLayoutCount() const;
+    };
+} // namespace railguard::rendering
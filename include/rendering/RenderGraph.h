@@ -0,0 +1,213 @@
+#pragma once
+
+#include <memory_resource>
+#include <unordered_map>
+#include "../includes/Vulkan.h"
+#include "../includes/Vma.h"
+#include "./structs/RenderGraphDescriptions.h"
+
+namespace railguard::rendering
+{
+    /**
+     * @brief Describes the passes of a frame and the images that they use, and handles the synchronization between them.
+     *
+     * Passes declare which images they read and write (see init::RenderGraphPassBuilder). When the graph is compiled:
+     * - passes that don't contribute to an output (see MarkAsOutput) are culled,
+     * - the layout transitions and pipeline barriers between passes are computed,
+     * - consecutive passes are merged in a single render pass when a pass reads an input attachment written just before,
+     *   so that tiled GPUs can keep the data on-chip,
+     * - transient images are created, and images whose lifetimes don't overlap share the same memory (VMA allocation).
+     *   Images that only live inside a single render pass use lazily allocated memory when the device supports it,
+     * - a render pass is created for each group of passes that uses attachments.
+     *
+     * Passes are executed in the order in which they were added, so producers must be added before consumers.
+     * Since resources and passes cannot be removed, their ids are simply their index in the vectors.
+     */
+    class RenderGraph
+    {
+    private:
+        /**
+         * @brief How an image is used at a given moment.
+         */
+        struct ResourceState
+        {
+            vk::ImageLayout layout = vk::ImageLayout::eUndefined;
+            vk::PipelineStageFlags stages = vk::PipelineStageFlagBits::eTopOfPipe;
+            vk::AccessFlags access{};
+        };
+
+        /**
+         * @brief Barrier that is recorded before a pass. The image is resolved at execution time,
+         * since imported images can change between frames.
+         */
+        struct ImageBarrier
+        {
+            render_resource_id_t resource;
+            ResourceState source;
+            ResourceState destination;
+        };
+
+        /**
+         * @brief Memory allocation shared by transient images whose lifetimes don't overlap.
+         */
+        struct AliasingBlock
+        {
+            vk::DeviceSize size = 0;
+            vk::DeviceSize alignment = 1;
+            uint32_t memoryTypeBits = ~0u;
+            std::vector<std::pair<uint32_t, uint32_t>> lifetimes{};
+            VmaAllocation allocation = nullptr;
+            // State of the last image that used the block, so that the next one can wait for it
+            ResourceState lastState{};
+        };
+
+        /**
+         * @brief Passes that are executed in the same render pass, one subpass each.
+         * Passes without attachments are alone in their group and don't have a render pass.
+         */
+        struct PassGroup
+        {
+            // Index of the first pass in the execution order
+            uint32_t first = 0;
+            uint32_t count = 1;
+            // Resources used as attachments, in the order of the render pass attachments
+            std::vector<render_resource_id_t> attachments{};
+            vk::Extent2D extent{};
+            // Barriers to record before the render pass
+            std::vector<ImageBarrier> barriers{};
+            vk::RenderPass renderPass = nullptr;
+            std::vector<vk::ClearValue> clearValues{};
+            // Cached framebuffers, indexed by a hash of their views
+            std::unordered_map<uint64_t, vk::Framebuffer> framebuffers{};
+        };
+
+        /**
+         * @brief A resource used by a pass.
+         */
+        struct ResourceUse
+        {
+            render_resource_id_t resource;
+            ResourceState state;
+            vk::ImageUsageFlags usage;
+            // True if the pass overwrites the whole content of the image
+            bool discardContent;
+        };
+
+        // Handles
+        vk::Device _device = nullptr;
+        VmaAllocator _allocator = nullptr;
+
+        // === Resources ===
+
+        std::vector<structs::RenderGraphImageDescription> _resourceDescriptions;
+        std::vector<bool> _resourceImported;
+        std::vector<vk::ImageLayout> _importedInitialLayouts;
+        std::vector<vk::ImageLayout> _importedFinalLayouts;
+        std::vector<vk::Image> _images;
+        std::vector<vk::ImageView> _imageViews;
+        std::vector<render_resource_id_t> _outputs;
+
+        // === Passes ===
+
+        std::vector<structs::RenderGraphPassDescription> _passDescriptions;
+
+        // === Compiled data ===
+
+        bool _compiled = false;
+        // Ids of the passes that were not culled, in execution order
+        std::vector<render_pass_id_t> _executionOrder;
+        std::vector<PassGroup> _groups;
+        // For each pass id, the index of its group (NO_GROUP if culled) and its subpass index in that group
+        std::vector<uint32_t> _passGroups;
+        std::vector<uint32_t> _passSubpasses;
+        // Barriers to record after the last pass, to put imported images in their final layout
+        std::vector<ImageBarrier> _finalBarriers;
+        // For each resource, the index of the aliasing block in which it is stored
+        std::vector<uint32_t> _resourceBlocks;
+        std::vector<AliasingBlock> _aliasingBlocks;
+        // For each resource, its own lazily allocated memory (null if it is in an aliasing block)
+        std::vector<VmaAllocation> _lazyAllocations;
+        vk::DeviceSize _transientMemorySize = 0;
+        vk::DeviceSize _unaliasedTransientMemorySize = 0;
+        vk::DeviceSize _lazyTransientMemorySize = 0;
+
+#ifdef USE_ADVANCED_CHECKS
+        // In debug mode, keep track of the init status to ensure that Init is called first
+        bool _initialized = false;
+#endif
+
+        render_resource_id_t AddResource(const structs::RenderGraphImageDescription &description, bool imported, vk::ImageLayout initialLayout, vk::ImageLayout finalLayout);
+        static std::vector<ResourceUse> GetResourceUses(const structs::RenderGraphPassDescription &pass);
+        void CullPasses();
+        bool CanMergeIntoLastGroup(const structs::RenderGraphPassDescription &pass) const;
+        void GroupPasses();
+        void CreateTransientImages(const std::vector<uint32_t> &firstUses, const std::vector<uint32_t> &lastUses, const std::vector<vk::ImageUsageFlags> &usages);
+        void ComputeBarriers(const std::vector<uint32_t> &lastUses);
+        void CreateRenderPasses(const std::vector<uint32_t> &lastUses);
+        void DestroyCompiledObjects();
+        void RecordBarriers(const vk::CommandBuffer &cmd, const std::vector<ImageBarrier> &barriers, std::pmr::memory_resource *memory) const;
+        vk::Framebuffer GetFramebuffer(PassGroup &group, std::pmr::memory_resource *memory);
+
+    public:
+        void Init(const vk::Device &device, VmaAllocator allocator);
+        void Cleanup();
+        ~RenderGraph();
+
+        /**
+         * @brief Declares an image that is created and owned by the graph. Its memory may be shared with other transient images.
+         */
+        [[nodiscard]] render_resource_id_t CreateTransientImage(const structs::RenderGraphImageDescription &description);
+        /**
+         * @brief Declares an image that is owned by something else, for example a swapchain.
+         * The actual image must be given with SetImportedImage before the graph is executed.
+         *
+         * @param initialLayout Layout of the image before the graph is executed
+         * @param finalLayout Layout in which the image will be left after the graph is executed
+         */
+        [[nodiscard]] render_resource_id_t ImportImage(const structs::RenderGraphImageDescription &description, vk::ImageLayout initialLayout, vk::ImageLayout finalLayout);
+        /**
+         * @brief Sets the image that an imported resource currently points to. Can change every frame.
+         */
+        void SetImportedImage(render_resource_id_t resource, vk::Image image, vk::ImageView imageView);
+        /**
+         * @brief Marks the resource as a result of the graph. Passes that don't contribute to any output are culled.
+         */
+        void MarkAsOutput(render_resource_id_t resource);
+
+        [[nodiscard]] render_pass_id_t AddPass(const structs::RenderGraphPassDescription &description);
+
+        /**
+         * @brief Culls the passes, computes the barriers, allocates transient images and creates the render passes.
+         * Can be called again after the graph changed, but the previous frames must be finished.
+         */
+        void Compile();
+        /**
+         * @brief Records every pass of the graph in the given command buffer.
+         *
+         * @param frameMemory Memory in which the barrier lists are built, usually the arena of the frame
+         */
+        void Execute(const vk::CommandBuffer &cmd, std::pmr::memory_resource *frameMemory = std::pmr::get_default_resource());
+
+        /**
+         * @brief Destroys cached framebuffers. Must be called when imported images are recreated (e.g. swapchain recreation).
+         */
+        void InvalidateFramebuffers();
+
+        /**
+         * @brief Returns the render pass in which the pass is executed. Pipelines used by the pass must be compatible with it.
+         */
+        [[nodiscard]] vk::RenderPass GetRenderPass(render_pass_id_t pass) const;
+        /**
+         * @brief Returns the index of the subpass of GetRenderPass(pass) in which the pass is executed.
+         */
+        [[nodiscard]] uint32_t GetSubpassIndex(render_pass_id_t pass) const;
+        [[nodiscard]] bool IsPassCulled(render_pass_id_t pass) const;
+        [[nodiscard]] vk::DeviceSize GetTransientMemorySize() const;
+        [[nodiscard]] vk::DeviceSize GetUnaliasedTransientMemorySize() const;
+        /**
+         * @brief Returns the size of the transient images that use lazily allocated memory.
+         * On tiled GPUs, that memory is usually never actually committed.
+         */
+        [[nodiscard]] vk::DeviceSize GetLazyTransientMemorySize() const;
+    };
+} // namespace railguard::rendering
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "../includes/Vulkan.h"
+#include "../utils/RadixSort.h"
+#include "./ShaderEffectManager.h"
+#include "./BufferManager.h"
+#include "./ClusterCuller.h"
+#include "./structs/DrawItem.h"
+#include "./structs/CameraData.h"
+
+namespace railguard::rendering
+{
+    /**
+     * @brief Collects the draw calls of a frame, sorts them to minimize state changes, and records them.
+     *
+     * Each item gets a 64-bit sort key: | pass (8 bits) | effect (16 bits) | material (16 bits) | depth (24 bits) |.
+     * The keys are sorted with a parallel radix sort, and binds that would not change the state are skipped when recording.
+     * For instanced items, the depth is replaced by a hash of the mesh, so that the instances of a mesh are next to each other and can be merged.
+     * Items with meshlets are given to the ClusterCuller, and drawn with the indirect commands that it writes.
+     */
+    class RenderQueue
+    {
+    private:
+        std::vector<structs::DrawItem> _items;
+        std::vector<utils::SortEntry> _sortedEntries;
+        utils::RadixSortScratch _sortScratch;
+
+        /**
+         * @brief Consecutive sorted items that are drawn with a single command.
+         */
+        struct DrawBatch
+        {
+            // Index of the first item in _sortedEntries
+            uint32_t first;
+            uint32_t count;
+            // Offset of the transforms of the batch in the instance buffer, if the batch is instanced
+            vk::DeviceSize instanceOffset;
+            // Indirect commands of the meshlets of the batch, if it is culled by the ClusterCuller
+            uint32_t firstCommand;
+            uint32_t commandCount;
+        };
+        std::vector<DrawBatch> _batches;
+        structs::BufferRegion _instanceBuffer{};
+        structs::RenderQueueStatistics _statistics;
+        structs::RenderQueueStatistics _lastStatistics;
+
+    public:
+        /**
+         * @brief Computes the key used to sort the item.
+         */
+        [[nodiscard]] static uint64_t GetSortKey(const structs::DrawItem &item);
+        /**
+         * @brief Returns true if the two instanced items can be drawn with the same command.
+         */
+        [[nodiscard]] static bool CanMergeInstances(const structs::DrawItem &a, const structs::DrawItem &b);
+
+        void Push(const structs::DrawItem &item);
+        /**
+         * @brief Sorts the items pushed since the last call to Reset, merges the instanced ones and writes their transforms
+         * in growable frame data. Items with meshlets are added to the cluster culler.
+         * Must be called before Record, after BufferManager::BeginFrame and ClusterCuller::BeginFrame.
+         *
+         * @param jobPool Pool used to sort large queues on several threads. May be null.
+         */
+        void Sort(BufferManager &bufferManager, ClusterCuller &clusterCuller, core::JobPool *jobPool = nullptr);
+        /**
+         * @brief Records the items of the given pass for a camera, in the sorted order. Can be called once per camera during a frame.
+         * The viewport of the camera must already be set.
+         *
+         * @param cameraDescriptorSet Set bound at CAMERA_DESCRIPTOR_SET for the effects that use it, with the offset of the data of the camera
+         */
+        void Record(const vk::CommandBuffer &cmd, const ShaderEffectManager &shaderEffectManager, const ClusterCuller &clusterCuller, uint32_t pass,
+                    const structs::CameraView &camera, vk::DescriptorSet cameraDescriptorSet);
+        /**
+         * @brief Removes every item, to prepare the next frame. The statistics of the frame are kept for GetLastStatistics.
+         */
+        void Reset();
+
+        [[nodiscard]] size_t GetItemCount() const;
+        /**
+         * @brief Returns the number of draws and binds recorded in the last frame (before the last call to Reset).
+         */
+        [[nodiscard]] const structs::RenderQueueStatistics &GetLastStatistics() const;
+    };
+} // namespace railguard::rendering
@@ -3,10 +3,25 @@
 #include "../core/WindowManager.h"
 #include "SwapchainCameraManager.h"
 #include "init/VulkanInit.h"
+#include "init/RendererInitInfo.h"
 #include "FrameManager.h"
 #include "Settings.h"
 #include "ShaderModuleManager.h"
 #include "ShaderEffectManager.h"
+#include "ShaderWatcher.h"
+#include "RenderQueue.h"
+#include "ClusterCuller.h"
+#include "PipelineLayoutCache.h"
+#include "RenderGraph.h"
+#include "BufferManager.h"
+#include "UploadManager.h"
+#include "MeshManager.h"
+#include "TextureManager.h"
+#include "OffscreenTarget.h"
+#include "structs/AsyncCompute.h"
+#include "structs/MemoryStatistics.h"
+#include "structs/CameraData.h"
+#include <span>
 
 namespace railguard::rendering
 {
@@ -20,37 +35,185 @@ namespace railguard::rendering
         vk::SurfaceKHR _surface = nullptr;
         vk::PhysicalDevice _physicalDevice = nullptr;
         vk::PhysicalDeviceProperties _physicalDeviceProperties = {};
+        vk::PhysicalDeviceFeatures _enabledFeatures = {};
         vk::Device _device = nullptr;
         vk::Queue _graphicsQueue = nullptr;
         uint32_t _graphicsQueueFamily = 0;
+        vk::Queue _transferQueue = nullptr;
+        uint32_t _transferQueueFamily = 0;
+        vk::Queue _computeQueue = nullptr;
+        uint32_t _computeQueueFamily = 0;
         VmaAllocator _allocator = nullptr;
-        vk::RenderPass _mainRenderPass = nullptr;
 
         // Other internal variables
         swapchain_id_t _mainWindowSwapchain = 0;
         uint64_t _drawnFramesCount = 0;
-        vk::Extent2D _windowExtent;
+        // Size of the images in which the frames are drawn (window or offscreen images)
+        vk::Extent2D _targetExtent;
+        // If true, there is no window: the frames are drawn in the images of the offscreen target
+        bool _headless = false;
+        // Not owned, may be null
+        core::JobPool *_jobPool = nullptr;
 
         // Various managers for core objects
         SwapchainManager _swapchainManager;
         SwapchainCameraManager _swapchainCameraManager;
+        OffscreenTarget _offscreenTarget;
         FrameManager _frameManager;
+        BufferManager _bufferManager;
+        UploadManager _uploadManager;
+        MeshManager _meshManager;
+        TextureManager _textureManager;
+        PipelineLayoutCache _pipelineLayoutCache;
+        RenderGraph _renderGraph;
         ShaderModuleManager _shaderModuleManager;
         ShaderEffectManager _shaderEffectManager;
+        RenderQueue _renderQueue;
+        ClusterCuller _clusterCuller;
+#ifdef USE_SHADER_HOT_RELOAD
+        ShaderWatcher _shaderWatcher;
+#endif
 
-        // Test
-        shader_effect_id_t _triangleEffect;
+        // Name of each loaded shader (e.g. "triangle.vert") -> id of its module
+        std::unordered_map<std::string, shader_module_id_t> _shaderModules;
+        // Name of each shader -> effects created with it. Several names can share a module, but a reload only concerns its own effects.
+        std::unordered_map<std::string, std::vector<shader_effect_id_t>> _shaderEffects;
+
+        // Render graph resources and passes
+        render_resource_id_t _backbuffer = 0;
+        render_resource_id_t _depthBuffer = 0;
+        render_pass_id_t _mainPass = 0;
+
+        // Cameras
+        // A single set is bound for every camera, with the offset of its data in the frame ring buffer as dynamic offset
+        vk::DescriptorSetLayout _cameraSetLayout = nullptr;
+        vk::DescriptorPool _cameraDescriptorPool = nullptr;
+        vk::DescriptorSet _cameraDescriptorSet = nullptr;
+        // Cameras rendered during the current frame, sorted by target
+        std::vector<structs::CameraView> _cameraViews;
+        // Cameras drawing in the target for which the render graph is being executed
+        std::span<const structs::CameraView> _targetCameraViews;
+
+        // Async compute
+        std::vector<structs::AsyncComputeJob> _asyncComputeJobs;
+
+        // GPU timings. Each frame writes 2 timestamps in each pool: at the beginning and at the end of its work.
+        bool _gpuTimingsSupported = false;
+        vk::QueryPool _graphicsTimestamps = nullptr;
+        vk::QueryPool _computeTimestamps = nullptr;
+        bool _graphicsTimestampsWritten[NB_OVERLAPPING_FRAMES] = {};
+        bool _computeTimestampsWritten[NB_OVERLAPPING_FRAMES] = {};
+        uint64_t _previousGraphicsInterval[2] = {};
+        structs::GpuTimings _lastGpuTimings;
+#ifdef USE_RENDER_STATISTICS_REPORTS
+        structs::GpuTimings _accumulatedGpuTimings;
+        uint32_t _accumulatedGpuTimingsCount = 0;
+#endif
 
         // Internal methods
         [[nodiscard]] const FrameData GetCurrentFrame() const;
         void WaitForFence(const vk::Fence &fence) const;
+        void SubmitAsyncCompute(const FrameData &frame, uint32_t frameIndex);
+        /**
+         * @brief Reads the timestamps written the last time the frame was used. Its fence must have been waited for.
+         */
+        void ReadGpuTimings(uint32_t frameIndex);
+#ifdef USE_SHADER_HOT_RELOAD
+        /**
+         * @brief Swaps the modules of the shaders that were recompiled, and starts rebuilding the effects that use them.
+         */
+        void ReloadShaders();
+#endif
     public:
+        /**
+         * @brief Creates a renderer that draws in the window, or in offscreen images if initInfo.windowManager is null.
+         */
+        explicit Renderer(const init::RendererInitInfo &initInfo);
         explicit Renderer(const core::WindowManager &windowManager);
 
         /**
-         * @brief Renders an image for every camera
+         * @brief Adds compute work that will be submitted on the async compute queue every frame.
+         */
+        void AddAsyncComputeJob(const std::string &name, const std::function<void(const vk::CommandBuffer &)> &record);
+        /**
+         * @brief Returns the GPU timings of the last finished frame. Only measured if the queues support timestamps.
+         */
+        [[nodiscard]] const structs::GpuTimings &GetLastGpuTimings() const;
+        [[nodiscard]] bool AreGpuTimingsSupported() const;
+        /**
+         * @brief Returns the memory currently allocated by the renderer. Cheap enough to be called every frame.
+         */
+        [[nodiscard]] structs::MemoryStatistics GetMemoryStatistics() const;
+
+        /**
+         * @brief Creates and builds an effect from shaders of the loaded shader pack.
+         *
+         * @param shaderNames Names of the shaders of each stage (e.g. "triangle.vert")
+         */
+        [[nodiscard]] shader_effect_id_t CreateShaderEffect(const std::vector<std::string> &shaderNames);
+        /**
+         * @brief Returns the pass in which the items of the scene are drawn, to be used in DrawItem::pass.
+         */
+        [[nodiscard]] render_pass_id_t GetMainPass() const;
+        /**
+         * @brief Adds a draw call to the current frame. Draws are sorted to minimize state changes before being recorded.
+         */
+        void SubmitDraw(const structs::DrawItem &item);
+        /**
+         * @brief Loads a mesh created by the meshconverter tool. Its geometry is uploaded in the background.
+         */
+        [[nodiscard]] mesh_id_t LoadMesh(const std::string &filePath);
+        void DestroyMesh(mesh_id_t mesh);
+        /**
+         * @brief Returns true once the geometry of the mesh is uploaded, and it can be drawn.
+         */
+        [[nodiscard]] bool IsMeshReady(mesh_id_t mesh) const;
+        /**
+         * @brief Draws a mesh with the LOD matching its distance to the camera, given in item.depth.
+         * The buffers and the index range of the item are set from the mesh. Nothing is drawn until the mesh is uploaded.
+         */
+        void SubmitMeshDraw(mesh_id_t mesh, structs::DrawItem item);
+        /**
+         * @brief Loads a KTX2 texture. Its coarse mip levels are uploaded in the background, and the finer ones are streamed when requested.
+         */
+        [[nodiscard]] texture_id_t LoadTexture(const std::string &filePath);
+        void DestroyTexture(texture_id_t texture);
+        /**
+         * @brief Tells that the texture is drawn during the current frame, and covers up to screenSize pixels along its largest side.
+         */
+        void RequestTextureResolution(texture_id_t texture, float screenSize);
+        /**
+         * @brief Returns the view of the resident mip levels of the texture, or null if it is not uploaded yet. Can change every frame.
+         */
+        [[nodiscard]] vk::ImageView GetTextureView(texture_id_t texture) const;
+        /**
+         * @brief Returns the memory used by the textures and the streaming activity of the last frame.
+         */
+        [[nodiscard]] const structs::TextureStreamingStatistics &GetTextureStreamingStatistics() const;
+        /**
+         * @brief Returns the number of draws and binds recorded in the last frame.
+         */
+        [[nodiscard]] const structs::RenderQueueStatistics &GetLastRenderQueueStatistics() const;
+
+        /**
+         * @brief Renders an image for every camera. Every swapchain in which a camera draws is presented with a single call.
+         * The swapchains must have the same extent as the main one.
          */
         void Draw();
+        /**
+         * @brief Returns true if the renderer draws in offscreen images instead of a window.
+         */
+        [[nodiscard]] bool IsHeadless() const;
+        /**
+         * @brief Returns the manager of the cameras. Each enabled camera is rendered in its swapchain every frame.
+         * Without any enabled camera, the main target is drawn without transform.
+         */
+        [[nodiscard]] SwapchainCameraManager &GetSwapchainCameraManager();
+        [[nodiscard]] const SwapchainCameraManager &GetSwapchainCameraManager() const;
+        /**
+         * @brief Returns the swapchain of the window given at creation. Unused when the renderer is headless.
+         */
+        [[nodiscard]] swapchain_id_t GetMainWindowSwapchain() const;
 
         ~Renderer();
     };
@@ -9,6 +9,53 @@
 #define NB_OVERLAPPING_FRAMES 3
 #define SWAPCHAIN_FORMAT VK_FORMAT_B8G8R8A8_UNORM
 #define SWAPCHAIN_COLOR_SPACE VK_COLOR_SPACE_SRGB_NONLINEAR_KHR
+#define DEPTH_FORMAT VK_FORMAT_D32_SFLOAT
 #define WAIT_FOR_FENCES_TIMEOUT 1000000000
 #define SEMAPHORE_TIMEOUT 1000000000
 
+
+// Size of the part of the frame ring buffer that each overlapping frame can use for its uniforms and dynamic vertex data
+#define FRAME_BUFFER_SEGMENT_SIZE (4 * 1024 * 1024)
+// Initial size of the growable frame buffers, which hold the frame data whose size depends on the scene (e.g. instance transforms)
+#define GROWABLE_FRAME_BUFFER_MIN_SIZE (1024 * 1024)
+// Size of the device local buffers in which static data (e.g. meshes) is sub-allocated
+#define DEVICE_BUFFER_BLOCK_SIZE (64 * 1024 * 1024)
+// Size of the host visible buffer through which data is uploaded to device local memory
+#define STAGING_BUFFER_SIZE (32 * 1024 * 1024)
+// Maximum number of upload submissions that can be in flight at the same time
+#define NB_UPLOAD_BATCHES 4
+// Number of frames between two reports of the GPU timings in the console, when USE_RENDER_STATISTICS_REPORTS is defined
+#define GPU_TIMINGS_REPORT_INTERVAL 600
+// Number of frames between two reports of the draw and bind counts in the console, when USE_RENDER_STATISTICS_REPORTS is defined
+#define RENDER_QUEUE_REPORT_INTERVAL 600
+// Directories used to recompile shaders when they are modified, relative to the working directory
+#define SHADER_SOURCE_DIRECTORY "./shaders"
+#define SHADER_BINARY_DIRECTORY "./bin/shaders"
+// Command used to compile GLSL to SPIR-V. Must be in the PATH.
+#define SHADER_COMPILER_COMMAND "glslangValidator"
+// Bindings of the vertex buffers. Vertex shader inputs at FIRST_INSTANCE_INPUT_LOCATION or above are read per instance.
+#define VERTEX_INPUT_BINDING 0
+#define INSTANCE_INPUT_BINDING 1
+#define FIRST_INSTANCE_INPUT_LOCATION 8
+// Largest error, relative to the distance to the camera, that a mesh LOD can have to be selected.
+// It is roughly the angle covered by a pixel, in radians, with a 1080p image and a 60 degrees field of view.
+#define MESH_LOD_ERROR_RATIO 0.001f
+// Video memory that the images of the streamed textures can use
+#define TEXTURE_STREAMING_BUDGET (256 * 1024 * 1024)
+// Mip levels with a largest side of that many texels or less are loaded with the texture, and never evicted
+#define TEXTURE_RESIDENT_MIP_SIZE 64
+// Maximum amount of texture data streamed in during a frame, to leave space in the staging buffer for other uploads
+#define TEXTURE_STREAMING_BYTES_PER_FRAME (8 * 1024 * 1024)
+// Number of meshlets that can be loaded at the same time. They are stored in a single buffer, read by the cluster culling shader.
+#define MAX_MESHLETS (256 * 1024)
+// Number of meshlets that can be culled on the GPU during a frame. Draws that don't fit are drawn without cluster culling.
+// Must stay below 65535, the smallest maxDrawIndirectCount of the devices that support multiDrawIndirect.
+#define MAX_CULLED_CLUSTERS (32 * 1024)
+// Descriptor set in which shaders find the data of the camera they are drawn for (see structs::CameraData).
+// It must only contain a uniform buffer at binding 0.
+#define CAMERA_DESCRIPTOR_SET 1
+// Cameras whose frusta overlap are culled together. Above that many groups of cameras, the last groups are merged.
+// Must match the value in cluster_cull.comp.
+#define MAX_CULLING_GROUPS 4
+// Initial size of the arena in which each overlapping frame allocates its transient CPU data. It grows to the peak usage of a frame.
+#define FRAME_ARENA_BLOCK_SIZE (64 * 1024)
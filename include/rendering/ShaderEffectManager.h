@@ -1,10 +1,16 @@
 #pragma once
 
+#include <future>
+#include <span>
+#include <unordered_map>
 #include "../includes/Vulkan.h"
 #include "../core/Match.h"
 #include "../core/StandaloneManager.h"
 #include "./ShaderModuleManager.h"
+#include "./PipelineLayoutCache.h"
 #include "./init/ShaderEffectInitInfo.h"
+#include "./init/PipelineBuilder.h"
+#include "./structs/ShaderVariant.h"
 #include "../core/WindowManager.h"
 
 namespace railguard::rendering
@@ -13,15 +19,37 @@ namespace railguard::rendering
     // That way, if we need to change that type, we only need to do it here
     typedef uint32_t shader_effect_id_t;
 
+    /**
+     * @brief Identifies a pipeline built for a variant of an effect.
+     */
+    struct ShaderVariantKey
+    {
+        shader_effect_id_t effect;
+        structs::ShaderVariant variant;
+
+        bool operator==(const ShaderVariantKey &other) const = default;
+    };
+
+    /**
+     * @brief Hash functor allowing variant keys to be used as map keys.
+     */
+    struct ShaderVariantKeyHash
+    {
+        size_t operator()(const ShaderVariantKey &key) const;
+    };
+
     /**
      * @brief Storage that is used to store the device as well as a pointer to the shader module manager.
+     * Pipeline layouts are owned by the layout cache, so that effects can share them.
      */
     struct ShaderEffectManagerStorage
     {
         vk::Device vulkanDevice = nullptr;
         vk::RenderPass renderPass = nullptr;
         const ShaderModuleManager *shaderModuleManager = nullptr;
-        const core::WindowManager *windowManager = nullptr;
+        // Size of the images that the pipelines draw in. The viewport is dynamic, so it is only the default one.
+        const vk::Extent2D *targetExtent = nullptr;
+        PipelineLayoutCache *pipelineLayoutCache = nullptr;
     };
 
     /**
@@ -38,8 +66,47 @@ namespace railguard::rendering
         std::vector<vk::PipelineLayout> _pipelineLayouts;
         std::vector<std::vector<shader_module_id_t>> _shaderStages;
         std::vector<vk::Pipeline> _pipelines;
+        // True if the layout was derived from the shader stages, and should be derived again when they are reloaded
+        std::vector<bool> _derivedLayouts;
+
+        // Pipelines of the variants that were requested, built on demand
+        std::unordered_map<ShaderVariantKey, vk::Pipeline, ShaderVariantKeyHash> _variantPipelines;
+
+        // Module -> effects that use it, to know which effects to rebuild when a module changes
+        std::unordered_map<shader_module_id_t, std::vector<shader_effect_id_t>> _moduleEffects;
+
+        /**
+         * @brief Pipelines being built on a background thread, in the same order as the effects.
+         */
+        struct PendingRebuild
+        {
+            std::vector<shader_effect_id_t> effects;
+            // Layouts used by the new pipelines. Each one holds a reference in the layout cache.
+            std::vector<vk::PipelineLayout> layouts;
+            std::future<std::vector<vk::Pipeline>> pipelines;
+        };
+        std::vector<PendingRebuild> _pendingRebuilds;
+        // Replaced pipelines, with the frame at which they were replaced. They may still be used by frames in flight.
+        std::vector<std::pair<uint64_t, vk::Pipeline>> _retiredPipelines;
+
+        [[nodiscard]] init::PipelineBuilder GetPipelineBuilder(size_t index, vk::PipelineLayout pipelineLayout, const structs::SpecializationConstants &specialization = {}) const;
+        /**
+         * @brief Moves the pipelines of the variants of the effect to the retired pipelines. They will be built again when requested.
+         */
+        void RetireVariants(shader_effect_id_t effect, uint64_t frameNumber);
+        /**
+         * @brief Merges the descriptor bindings and push constant ranges of the given shader modules.
+         * Throws if two stages declare the same binding differently.
+         */
+        [[nodiscard]] structs::PipelineLayoutDescription DeriveLayoutDescription(const std::vector<shader_module_id_t> &shaderStages) const;
 
     public:
+        /**
+         * @brief Returns the layout of CAMERA_DESCRIPTOR_SET. Effects that use that set get exactly this layout,
+         * so that the camera set created by the renderer is compatible with all of them.
+         */
+        [[nodiscard]] static structs::DescriptorSetLayoutDescription GetCameraSetLayoutDescription();
+
         void Init(ShaderEffectManagerStorage storage, size_t defaultCapacity = 5);
         /**
          * @brief Destroys every remaining shader effect.
@@ -59,6 +126,39 @@ namespace railguard::rendering
 
         vk::Pipeline BuildEffect(const core::Match &match);
 
+        /**
+         * @brief Returns the pipeline of a variant of the effect, building it the first time that it is requested.
+         * Variants use the shaders and the layout of the effect, with other specialization constants and render state.
+         */
+        vk::Pipeline GetVariantPipeline(const core::Match &match, const structs::ShaderVariant &variant);
+        /**
+         * @brief Binds the pipeline of a variant of the effect, building it if needed.
+         */
+        void BindVariant(const core::Match &match, const structs::ShaderVariant &variant, const vk::CommandBuffer &cmd);
+        [[nodiscard]] size_t GetVariantCount() const;
+
+        /**
+         * @brief Starts building new pipelines for the given effects on a background thread, for example after a shader module was reloaded.
+         * The effects keep their current pipeline until UpdateRebuilds finds that the new one is ready.
+         *
+         * The modules used by the effects must not be replaced or destroyed while IsRebuilding returns true.
+         */
+        void RebuildEffectsAsync(const std::vector<shader_effect_id_t> &effects);
+        /**
+         * @brief Swaps the pipelines that finished building, and destroys the replaced pipelines that are no longer used.
+         * Must be called once per frame, after waiting for the fence of the frame.
+         *
+         * @param frameNumber Number of the frame being drawn.
+         */
+        void UpdateRebuilds(uint64_t frameNumber);
+        [[nodiscard]] bool IsRebuilding() const;
+
+        /**
+         * @brief Makes the given effects use another module in place of one of their stages, e.g. when a reloaded shader got
+         * its own module. The effects must then be rebuilt to use it.
+         */
+        void ReplaceShaderModule(const std::vector<shader_effect_id_t> &effects, shader_module_id_t previousModule, shader_module_id_t newModule);
+
         /**
          * @brief Destroys the shader effect pointed by the given match
          *
@@ -70,6 +170,14 @@ namespace railguard::rendering
 
         [[nodiscard]] const vk::PipelineLayout GetPipelineLayout(const core::Match &match) const;
         [[nodiscard]] const vk::Pipeline GetPipeline(const core::Match &match) const;
-        [[nodiscard]] const std::vector<shader_module_id_t> GetShaderStages(const core::Match &match) const;
+        /**
+         * @brief Returns true if the shaders of the effect read the camera data in CAMERA_DESCRIPTOR_SET.
+         */
+        [[nodiscard]] bool UsesCamera(const core::Match &match) const;
+        [[nodiscard]] std::span<const shader_module_id_t> GetShaderStages(const core::Match &match) const;
+        /**
+         * @brief Returns the ids of the effects that use the given module in one of their stages.
+         */
+        [[nodiscard]] std::vector<shader_effect_id_t> GetEffectsUsingModule(shader_module_id_t shaderModule) const;
     };
 } // namespace railguard::rendering
@@ -1,8 +1,11 @@
 #pragma once
 
+#include <string>
+#include <unordered_map>
 #include "../includes/Vulkan.h"
 #include "../core/StandaloneManager.h"
 #include "./structs/Storages.h"
+#include "./structs/ShaderReflection.h"
 
 namespace railguard::rendering
 {
@@ -10,6 +13,13 @@ namespace railguard::rendering
     // That way, if we need to change that type, we only need to do it here
     typedef uint32_t shader_module_id_t;
 
+    /**
+     * @brief Stores the shader modules.
+     *
+     * Modules are deduplicated: loading SPIR-V code that was already loaded for the same stage returns the existing module,
+     * and increments its reference count. Code is identified by its hash and its size, and by its bytes inside a shader pack. The module is only destroyed when DestroyShaderModule was called as many times
+     * as it was loaded.
+     */
     class ShaderModuleManager : public core::StandaloneManager<shader_module_id_t, structs::DeviceStorage>
     {
     private:
@@ -18,6 +28,17 @@ namespace railguard::rendering
 
         std::vector<vk::ShaderStageFlagBits> _stages;
         std::vector<vk::ShaderModule> _modules;
+        std::vector<uint64_t> _codeHashes;
+        // Size of the code in bytes, compared on a hash match so that a collision doesn't return another shader
+        std::vector<size_t> _codeSizes;
+        std::vector<uint32_t> _referenceCounts;
+        // Interface of each module, extracted from its code when it is loaded
+        std::vector<structs::ShaderReflection> _reflections;
+
+        // Hash of the code and stage -> id of the module
+        std::unordered_map<uint64_t, shader_module_id_t> _hashLookupMap;
+
+        static uint64_t HashCode(vk::ShaderStageFlagBits stage, const uint32_t *code, size_t codeSize);
 
     public:
         void Init(structs::DeviceStorage storage, size_t defaultCapacity = 5);
@@ -31,17 +52,50 @@ namespace railguard::rendering
          * @return core::CompleteMatch<shader_module_id_t> match containing the Id of the created module, to be able to retreive it later.
          */
         [[nodiscard]] core::CompleteMatch<shader_module_id_t> LoadShaderModule(vk::ShaderStageFlagBits stage, const std::vector<uint32_t> &codeBuffer);
+        /**
+         * @brief Creates a shader module from a SPIR-V bytecode passed as an argument.
+         *
+         * @param stage Stage that this shader will be used in.
+         * @param code Pointer to the SPIR-V bytecode. It only needs to be valid during the call.
+         * @param codeSize Size of the code in bytes. Must be a multiple of 4.
+         * @return core::CompleteMatch<shader_module_id_t> match containing the Id of the created module, to be able to retreive it later.
+         */
+        [[nodiscard]] core::CompleteMatch<shader_module_id_t> LoadShaderModule(vk::ShaderStageFlagBits stage, const uint32_t *code, size_t codeSize);
         /**
          * @brief Creates a shader module from a SPIR-V file of which the path is passed as an argument.
+         * The file is mapped in memory and given directly to vulkan, without being copied.
          *
          * @param stage Stage that this shader will be used in.
          * @param filePath Path to a SPIR-V file containing the shader code.
          * @return core::CompleteMatch<shader_module_id_t> match containing the Id of the created module, to be able to retreive it later.
          */
         [[nodiscard]] core::CompleteMatch<shader_module_id_t> LoadShaderModule(vk::ShaderStageFlagBits stage, const std::string &filePath);
+        /**
+         * @brief Loads every shader of a pack created by the shaderpacker tool. The pack is mapped in memory, and the
+         * modules that are not already loaded are created in parallel.
+         *
+         * Each returned id holds a reference, like an id returned by LoadShaderModule.
+         *
+         * @param packPath Path to the shader pack.
+         * @return Name of each shader in the pack (e.g. "triangle.vert") -> id of its module
+         */
+        [[nodiscard]] std::unordered_map<std::string, shader_module_id_t> LoadShaderPack(const std::string &packPath);
+
+        /**
+         * @brief Replaces the code of a loaded module for the caller, keeping its stage. Used to hot reload shaders.
+         * If the module holds a single reference, it is replaced in place and keeps its id. Otherwise, it was deduplicated
+         * with other shaders that must keep their code: the reference of the caller is moved to a module containing the new code.
+         * Pipelines are not affected: effects using the module must be rebuilt to use the new code.
+         *
+         * @param match match representing the position of the module
+         * @param code Pointer to the new SPIR-V bytecode. It only needs to be valid during the call.
+         * @param codeSize Size of the code in bytes. Must be a multiple of 4.
+         * @return core::CompleteMatch<shader_module_id_t> match of the module containing the new code.
+         */
+        [[nodiscard]] core::CompleteMatch<shader_module_id_t> ReplaceShaderModule(const core::Match &match, const uint32_t *code, size_t codeSize);
 
         /**
-         * @brief Destroys the shader module pointed by the given match
+         * @brief Releases a reference to the shader module pointed by the given match, and destroys it if it was the last one.
          *
          * @param match match representing the position of the module
          */
@@ -49,7 +103,10 @@ namespace railguard::rendering
 
         [[nodiscard]] vk::ShaderStageFlagBits GetStage(const core::Match &match) const;
         [[nodiscard]] const vk::ShaderModule GetModule(const core::Match &match) const;
-
-        
+        [[nodiscard]] uint32_t GetReferenceCount(const core::Match &match) const;
+        /**
+         * @brief Returns the descriptor bindings, push constant ranges and vertex inputs declared by the module.
+         */
+        [[nodiscard]] const structs::ShaderReflection &GetReflection(const core::Match &match) const;
     };
 }
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include "../utils/MappedFile.h"
+#include "./structs/ShaderPackFormat.h"
+
+namespace railguard::rendering
+{
+    /**
+     * @brief Read-only access to a shader pack created by the shaderpacker tool. The file is mapped in memory.
+     */
+    class ShaderPack
+    {
+    private:
+        utils::MappedFile _file;
+        const structs::ShaderPackHeader *_header = nullptr;
+        const structs::ShaderPackEntry *_entries = nullptr;
+        const uint32_t *_buckets = nullptr;
+        const char *_names = nullptr;
+
+    public:
+        /**
+         * @brief Maps the pack and checks its header. Throws if the file is not a valid pack.
+         */
+        explicit ShaderPack(const std::string &filePath);
+
+        [[nodiscard]] uint32_t GetEntryCount() const;
+        [[nodiscard]] const structs::ShaderPackEntry &GetEntry(uint32_t index) const;
+        [[nodiscard]] std::string_view GetName(const structs::ShaderPackEntry &entry) const;
+        [[nodiscard]] const uint32_t *GetCode(const structs::ShaderPackEntry &entry) const;
+        /**
+         * @brief Finds an entry by name (e.g. "triangle.vert") using the hash table of the pack.
+         * @return The entry, or nullptr if there is none with that name.
+         */
+        [[nodiscard]] const structs::ShaderPackEntry *Find(std::string_view name) const;
+    };
+} // namespace railguard::rendering
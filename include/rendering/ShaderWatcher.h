@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "./structs/ShaderReload.h"
+
+namespace railguard::rendering
+{
+    /**
+     * @brief Watches the shader sources on a background thread, and recompiles the ones that are modified.
+     *
+     * The compiled code is kept until the renderer polls it, which allows it to swap the modules between two frames.
+     * Only supported on Linux (inotify). On other platforms, the watcher does nothing.
+     */
+    class ShaderWatcher
+    {
+    private:
+        std::string _sourceDirectory;
+        std::string _binaryDirectory;
+
+        std::thread _thread;
+        std::atomic<bool> _running = false;
+        int _inotifyDescriptor = -1;
+
+        // Shaders that were recompiled since the last poll. Protected by the mutex since they are filled by the thread.
+        std::mutex _reloadsMutex;
+        std::vector<structs::ShaderReload> _reloads;
+
+#ifdef USE_ADVANCED_CHECKS
+        // In debug mode, keep track of the init status to ensure that Init is called first
+        bool _initialized = false;
+#endif
+
+        void Watch();
+        void Recompile(const std::string &name);
+
+    public:
+        /**
+         * @brief Starts watching the directory.
+         *
+         * @param sourceDirectory Directory containing the GLSL sources (.vert, .frag, .comp)
+         * @param binaryDirectory Directory where the compiled SPIR-V files are written
+         */
+        void Init(const std::string &sourceDirectory, const std::string &binaryDirectory);
+        /**
+         * @brief Stops the background thread.
+         */
+        void Cleanup();
+        ~ShaderWatcher();
+
+        /**
+         * @brief Returns the shaders recompiled since the last call. If a shader was modified several times, only the last version is returned.
+         */
+        [[nodiscard]] std::vector<structs::ShaderReload> PollReloads();
+    };
+} // namespace railguard::rendering
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "../includes/Vulkan.h"
+#include "./structs/ShaderReflection.h"
+
+namespace railguard::rendering
+{
+    /**
+     * @brief Minimal SPIR-V parser that extracts what is needed to create pipelines from shader modules:
+     * descriptor bindings, push constant ranges and vertex inputs.
+     *
+     * Only the declarations are read, so every resource declared in the module is reported, even if the entry point doesn't use it.
+     */
+    class SpirvReflector
+    {
+    private:
+        /**
+         * @brief What is known about a SPIR-V id: the instruction that defines it and its decorations.
+         */
+        struct IdInfo
+        {
+            uint32_t opcode = 0;
+            // Operands of the defining instruction, after the result id (types) or after the result type and id (constants, variables)
+            std::vector<uint32_t> operands{};
+            uint32_t typeId = 0;
+
+            // Decorations
+            uint32_t set = 0;
+            uint32_t binding = 0;
+            uint32_t location = 0;
+            uint32_t arrayStride = 0;
+            bool hasLocation = false;
+            bool isBuiltIn = false;
+            bool isBufferBlock = false;
+            std::vector<uint32_t> memberOffsets{};
+            std::vector<uint32_t> memberMatrixStrides{};
+        };
+
+        std::vector<IdInfo> _ids;
+        std::vector<uint32_t> _variables;
+
+        explicit SpirvReflector(const uint32_t *code, size_t codeSize);
+
+        [[nodiscard]] uint32_t GetConstantValue(uint32_t constantId) const;
+        [[nodiscard]] uint32_t GetTypeSize(uint32_t typeId, uint32_t matrixStride = 0) const;
+        [[nodiscard]] vk::DescriptorType GetDescriptorType(uint32_t typeId, uint32_t storageClass) const;
+        [[nodiscard]] vk::Format GetVertexFormat(uint32_t typeId) const;
+
+        void ReflectDescriptor(const IdInfo &variable, uint32_t storageClass, vk::ShaderStageFlagBits stage, structs::ShaderReflection &reflection) const;
+        void ReflectPushConstants(const IdInfo &variable, vk::ShaderStageFlagBits stage, structs::ShaderReflection &reflection) const;
+        void ReflectVertexInputs(structs::ShaderReflection &reflection) const;
+
+    public:
+        /**
+         * @brief Parses the given SPIR-V code. Throws if it is not valid SPIR-V or uses unsupported resources.
+         *
+         * @param stage Stage of the entry point of the module
+         * @param code Pointer to the SPIR-V bytecode
+         * @param codeSize Size of the code in bytes
+         */
+        [[nodiscard]] static structs::ShaderReflection Reflect(vk::ShaderStageFlagBits stage, const uint32_t *code, size_t codeSize);
+    };
+} // namespace railguard::rendering
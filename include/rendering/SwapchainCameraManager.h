@@ -1,23 +1,33 @@
 #pragma once
 
 #include <vector>
+#include <glm/glm.hpp>
 #include "./init/CameraInitInfo.h"
 #include "../core/ComponentManager.h"
+#include "../core/BitsetColumn.h"
 #include "./SwapchainManager.h"
+#include "./BufferManager.h"
+#include "./structs/CameraData.h"
 
 namespace railguard::rendering
 {
-    class SwapchainCameraManager : core::ComponentManager
+    class SwapchainCameraManager : public core::ComponentManager
     {
     private:
         /**
          * @brief Is the camera enabled or not ? Disabled cameras do not render anything.
          */
-        std::vector<bool> _enabledCameras;
+        core::BitsetColumn _enabledCameras;
         /**
          * @brief Id of the swapchain used for the camera in the swapchain manager.
          */
         std::vector<swapchain_id_t> _swapchainIds;
+        /**
+         * @brief Part of the swapchain image covered by the camera, in normalized coordinates (x, y, width, height).
+         */
+        std::vector<glm::vec4> _viewports;
+        std::vector<glm::mat4> _viewMatrices;
+        std::vector<glm::mat4> _projectionMatrices;
 
     public:
         explicit SwapchainCameraManager(const core::component_id_t defaultComponentCapacity = 1);
@@ -36,12 +46,34 @@ namespace railguard::rendering
 
         [[nodiscard]] bool GetEnabled(const core::Match &match) const;
         [[nodiscard]] swapchain_id_t GetSwapchainId(const core::Match &match) const;
+        [[nodiscard]] glm::vec4 GetViewport(const core::Match &match) const;
+        [[nodiscard]] const glm::mat4 &GetView(const core::Match &match) const;
+        [[nodiscard]] const glm::mat4 &GetProjection(const core::Match &match) const;
+
+        // Setters
+
+        void SetEnabled(const core::Match &match, bool enabled);
+        void SetViewport(const core::Match &match, const glm::vec4 &viewport);
+        void SetView(const core::Match &match, const glm::mat4 &view);
+        void SetProjection(const core::Match &match, const glm::mat4 &projection);
+
+        // Snapshots
+
+        /**
+         * @brief Adds the columns of the manager to the snapshot. The swapchain ids are saved as is, so a snapshot should be loaded
+         * by an engine that created its swapchains in the same order.
+         */
+        void SaveSnapshot(core::SnapshotWriter &writer) const;
+        void LoadSnapshot(const core::Snapshot &snapshot);
 
         // Systems
 
         /**
-         * @brief For each camera, render an image.
+         * @brief For each enabled camera, writes its matrices in the frame ring buffer and adds the view with which
+         * it will be rendered during the current frame.
+         *
+         * Must be called after BufferManager::BeginFrame.
          */
-        void Draw();
+        void Draw(BufferManager &bufferManager, std::vector<structs::CameraView> &views) const;
     };
-}
\ No newline at end of file
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <span>
 #include "../core/WindowManager.h"
 #include "../core/Match.h"
 #include "../core/StandaloneManager.h"
@@ -19,10 +20,14 @@ namespace railguard::rendering
 
         std::vector<vk::SwapchainKHR> _swapchains;
         std::vector<vk::Format> _swapchainImageFormats;
+        std::vector<vk::Extent2D> _swapchainExtents;
         // std::vector<vk::Format> _depthImageFormat;
         std::vector<std::vector<vk::Image>> _swapchainsImages;
         std::vector<std::vector<vk::ImageView>> _swapchainsImageViews;
-        std::vector<std::vector<vk::Framebuffer>> _frameBuffers;
+
+        // Scratch vectors of PresentImages
+        std::vector<vk::SwapchainKHR> _presentedSwapchains;
+        std::vector<vk::Result> _presentResults;
 
     public:
         void Init(structs::FullDeviceStorage storage, size_t defaultCapacity = 1);
@@ -37,7 +42,7 @@ namespace railguard::rendering
          *
          * @return swapchain_id_t The id of the new swapchain
          */
-        [[nodiscard]] core::CompleteMatch<swapchain_id_t> CreateWindowSwapchain(const vk::SurfaceKHR &surface, const core::WindowManager &windowManager, const vk::RenderPass &renderPass);
+        [[nodiscard]] core::CompleteMatch<swapchain_id_t> CreateWindowSwapchain(const vk::SurfaceKHR &surface, const core::WindowManager &windowManager);
 
         /**
          * @brief Destroys the swapchain pointed by the given match
@@ -55,7 +60,7 @@ namespace railguard::rendering
          * @param surface Vulkan surface
          * @param windowManager Window manager
          */
-        void RecreateWindowSwapchain(const core::Match &match, const vk::SurfaceKHR &surface, const core::WindowManager &windowManager, const vk::RenderPass &renderPass);
+        void RecreateWindowSwapchain(const core::Match &match, const vk::SurfaceKHR &surface, const core::WindowManager &windowManager);
 
         /**
          * @brief Requests the next image of the given swapchain.
@@ -69,13 +74,25 @@ namespace railguard::rendering
         [[nodiscard]] uint32_t RequestNextImageIndex(const core::Match &match, const vk::Semaphore &presentSemaphore);
 
         void PresentImage(const core::Match &match, uint32_t imageIndex, const vk::Semaphore &renderSemaphore, const vk::Queue &graphicsQueue);
+        /**
+         * @brief Presents an image of each of the given swapchains with a single call, once the rendering is complete.
+         *
+         * @param matches Matches mapping the swapchain ids to their slots
+         * @param imageIndices Index of the image to present, for each swapchain
+         *
+         * @throws runtime_error If one of the images could not be presented.
+         */
+        void PresentImages(std::span<const core::Match> matches, std::span<const uint32_t> imageIndices, const vk::Semaphore &renderSemaphore, const vk::Queue &graphicsQueue);
 
         // Getters
 
         [[nodiscard]] vk::SwapchainKHR GetSwapchain(const core::Match &match) const;
         [[nodiscard]] vk::Format GetSwapchainImageFormat(const core::Match &match) const;
-        [[nodiscard]] std::vector<vk::Image> GetSwapchainImages(const core::Match &match) const;
-        [[nodiscard]] std::vector<vk::ImageView> GetSwapchainImageViews(const core::Match &match) const;
-        [[nodiscard]] std::vector<vk::Framebuffer> GetFramebuffers(const core::Match &match) const;
+        [[nodiscard]] vk::Extent2D GetSwapchainExtent(const core::Match &match) const;
+        /**
+         * @brief Returns the images of the swapchain. They are valid until the swapchain is recreated or destroyed.
+         */
+        [[nodiscard]] std::span<const vk::Image> GetSwapchainImages(const core::Match &match) const;
+        [[nodiscard]] std::span<const vk::ImageView> GetSwapchainImageViews(const core::Match &match) const;
     };
 }
\ No newline at end of file
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <memory_resource>
+#include <string>
+#include "../core/StandaloneManager.h"
+#include "../includes/Vma.h"
+#include "../utils/MappedFile.h"
+#include "./UploadManager.h"
+#include "./structs/Ktx2Format.h"
+#include "./structs/TextureStreamingStatistics.h"
+
+namespace railguard::rendering
+{
+    // Use a typedef to specify which type will be used for texture ids
+    // That way, if we need to change that type, we only need to do it here
+    typedef uint32_t texture_id_t;
+
+    /**
+     * @brief Storage that is used to store the device and the allocator, as well as a pointer to the upload manager.
+     */
+    struct TextureManagerStorage
+    {
+        vk::Device vulkanDevice = nullptr;
+        VmaAllocator allocator = nullptr;
+        UploadManager *uploadManager = nullptr;
+    };
+
+    /**
+     * @brief Stores block compressed textures loaded from KTX2 files, and streams their mip levels.
+     *
+     * Files stay mapped in memory while the texture exists. When a texture is loaded, only its coarse mip levels
+     * (TEXTURE_RESIDENT_MIP_SIZE or smaller) are uploaded. Each frame, the users of the texture report how big it appears on screen
+     * with RequestResolution, and Update streams in the finer levels that are needed.
+     *
+     * The resident levels of a texture are stored in a single image. When they change, a new image is created and uploaded from the
+     * mapped file, and the previous one is used until the new one is ready. Thus, the view returned by GetImageView can change
+     * between frames.
+     *
+     * The images of all the textures must fit in TEXTURE_STREAMING_BUDGET: when it is full, the textures that were used the least
+     * recently are brought back to their coarse levels.
+     */
+    class TextureManager : public core::StandaloneManager<texture_id_t, TextureManagerStorage>
+    {
+    private:
+        // Typedef the parent type to make it easier to call from the methods
+        typedef core::StandaloneManager<texture_id_t, TextureManagerStorage> super;
+
+        /**
+         * @brief Image containing the levels of a texture from baseLevel to the last one.
+         */
+        struct ResidentImage
+        {
+            vk::Image image = nullptr;
+            VmaAllocation allocation = nullptr;
+            vk::ImageView view = nullptr;
+            uint32_t baseLevel = 0;
+            vk::DeviceSize size = 0;
+            upload_ticket_t ticket = 0;
+        };
+
+        /**
+         * @brief Image that is not used anymore, but may still be read by a frame or written by an upload.
+         */
+        struct RetiredImage
+        {
+            uint64_t frame;
+            ResidentImage image;
+        };
+
+        // === Source data ===
+
+        std::vector<utils::MappedFile> _files;
+        // Points to the mapped file
+        std::vector<const structs::Ktx2LevelIndex *> _levelIndices;
+        std::vector<vk::Format> _formats;
+        std::vector<vk::Extent2D> _extents;
+        std::vector<uint32_t> _levelCounts;
+        // Finest level that can be streamed. Levels bigger than the staging buffer can't be uploaded.
+        std::vector<uint32_t> _finestLoadableLevels;
+        // Coarsest set of levels, loaded with the texture and never evicted
+        std::vector<uint32_t> _residentBaseLevels;
+
+        // === Residency ===
+
+        // Image used for rendering. Null until the first upload is finished.
+        std::vector<ResidentImage> _currentImages;
+        // Image being uploaded, which will replace the current one when it is ready. Null if there is none.
+        std::vector<ResidentImage> _pendingImages;
+        // Finest level requested during the current frame, or UINT32_MAX if the texture was not used
+        std::vector<uint32_t> _requestedLevels;
+        std::vector<uint64_t> _lastUsedFrames;
+
+        std::vector<RetiredImage> _retiredImages;
+        // Size of every image, including the ones that wait for the frames using them to finish before being destroyed
+        vk::DeviceSize _residentSize = 0;
+        // Part of the resident size that will be released: retired images, and current images that are being replaced
+        vk::DeviceSize _releasingSize = 0;
+        structs::TextureStreamingStatistics _lastStatistics;
+
+        [[nodiscard]] vk::DeviceSize GetLevelsSize(size_t index, uint32_t baseLevel) const;
+        [[nodiscard]] uint32_t GetTargetLevel(size_t index) const;
+        ResidentImage CreateResidentImage(size_t index, uint32_t baseLevel);
+        void Retire(ResidentImage &image, uint64_t frameNumber);
+        void DestroyResidentImage(const ResidentImage &image) const;
+        // Starts replacing the image of the texture by one that starts at the given level
+        void StreamLevels(size_t index, uint32_t baseLevel);
+        // Brings the least recently used texture back to its coarse levels. Returns false if no texture can be evicted.
+        bool EvictLeastRecentlyUsed(uint64_t frameNumber);
+
+    public:
+        void Init(TextureManagerStorage storage, size_t defaultCapacity = 5);
+        /**
+         * @brief Destroys every texture. The uploads and frames that use them must be finished.
+         */
+        void Clear();
+
+        /**
+         * @brief Loads a KTX2 texture, and starts uploading its coarse mip levels.
+         * The texture must be 2D, without supercompression, and use a block compressed format (BC1 to BC7).
+         *
+         * @param filePath Path to the KTX2 file
+         * @return core::CompleteMatch<texture_id_t> match containing the Id of the created texture, to be able to retreive it later.
+         */
+        [[nodiscard]] core::CompleteMatch<texture_id_t> LoadTexture(const std::string &filePath);
+        /**
+         * @brief Destroys the texture once the frames and uploads that may use it are finished.
+         */
+        void DestroyTexture(const core::Match &match, uint64_t frameNumber);
+
+        /**
+         * @brief Tells that the texture is drawn during the current frame, and covers up to screenSize pixels along its largest side.
+         * The mip level matching that size will be streamed in, if the budget allows it.
+         */
+        void RequestResolution(const core::Match &match, float screenSize);
+        /**
+         * @brief Swaps the images that finished uploading, destroys the old ones, and streams the requested levels.
+         * Must be called once per frame, before UploadManager::Update so that the uploads are submitted in the same frame.
+         *
+         * @param frameMemory Memory in which the list of textures to stream is built, usually the arena of the frame
+         */
+        void Update(uint64_t frameNumber, std::pmr::memory_resource *frameMemory = std::pmr::get_default_resource());
+
+        /**
+         * @brief Returns true once at least the coarse mip levels of the texture are uploaded.
+         */
+        [[nodiscard]] bool IsTextureReady(const core::Match &match) const;
+        /**
+         * @brief Returns the view of the current image of the texture, in the shader read only layout. Can change after each Update.
+         */
+        [[nodiscard]] vk::ImageView GetImageView(const core::Match &match) const;
+        /**
+         * @brief Returns the finest mip level of the texture that can currently be sampled.
+         */
+        [[nodiscard]] uint32_t GetResidentLevel(const core::Match &match) const;
+        [[nodiscard]] const structs::TextureStreamingStatistics &GetLastStatistics() const;
+    };
+} // namespace railguard::rendering
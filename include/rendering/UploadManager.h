@@ -0,0 +1,125 @@
+#pragma once
+
+#include <memory_resource>
+#include "../includes/Vulkan.h"
+#include "../includes/Vma.h"
+#include "./Settings.h"
+#include "./structs/BufferRegion.h"
+
+namespace railguard::rendering
+{
+    // Use a typedef to specify which type will be used for upload tickets
+    // That way, if we need to change that type, we only need to do it here
+    typedef uint64_t upload_ticket_t;
+
+    /**
+     * @brief Copies data to device local buffers and images through the transfer queue.
+     *
+     * Uploads are written in a host visible staging ring and batched in a command buffer. The batch is submitted
+     * on the transfer queue when Update is called (once per frame) or when it runs out of staging space. Each submission
+     * is tracked with a fence, so the frame never waits for it.
+     *
+     * If the transfer queue belongs to another family, images are released by the transfer queue and acquired by
+     * the graphics queue: the acquire barriers are recorded in the graphics command buffer given to Update, once the
+     * batch is finished. Buffers must be shared with the transfer family (see BufferManager::Init).
+     * Resources must not be used before IsUploadReady returns true for their ticket.
+     */
+    class UploadManager
+    {
+    private:
+        /**
+         * @brief Barrier that gives a resource to the graphics queue once its upload is finished.
+         */
+        struct PendingAcquire
+        {
+            vk::Buffer buffer = nullptr;
+            vk::DeviceSize offset = 0;
+            vk::DeviceSize size = 0;
+            vk::Image image = nullptr;
+            vk::ImageSubresourceRange subresourceRange{};
+            vk::ImageLayout finalLayout = vk::ImageLayout::eUndefined;
+        };
+
+        struct UploadBatch
+        {
+            vk::CommandBuffer commandBuffer = nullptr;
+            vk::Fence fence = nullptr;
+            // Ticket of the uploads recorded in this batch
+            upload_ticket_t ticket = 0;
+            // Bytes of the staging ring used by the batch, including the padding
+            vk::DeviceSize stagingSize = 0;
+            bool recording = false;
+            bool submitted = false;
+            std::vector<PendingAcquire> acquires{};
+        };
+
+        // Handles
+        vk::Device _device = nullptr;
+        VmaAllocator _allocator = nullptr;
+        vk::Queue _transferQueue = nullptr;
+        uint32_t _transferQueueFamily = 0;
+        uint32_t _graphicsQueueFamily = 0;
+        vk::CommandPool _commandPool = nullptr;
+
+        // Staging ring
+        vk::Buffer _stagingBuffer = nullptr;
+        VmaAllocation _stagingAllocation = nullptr;
+        uint8_t *_stagingMappedData = nullptr;
+        vk::DeviceSize _stagingHead = 0;
+        vk::DeviceSize _stagingUsed = 0;
+
+        // Batches are used in a circular way: the oldest one is the next after the current one
+        UploadBatch _batches[NB_UPLOAD_BATCHES];
+        uint32_t _currentBatch = 0;
+        upload_ticket_t _nextTicket = 1;
+        upload_ticket_t _lastRetiredTicket = 0;
+        upload_ticket_t _lastReadyTicket = 0;
+        // Acquire barriers of finished batches, waiting to be recorded in a graphics command buffer
+        std::vector<PendingAcquire> _readyAcquires;
+
+#ifdef USE_ADVANCED_CHECKS
+        // In debug mode, keep track of the init status to ensure that Init is called first
+        bool _initialized = false;
+#endif
+
+        [[nodiscard]] bool IsOwnershipTransferNeeded() const;
+        UploadBatch &GetRecordingBatch();
+        vk::DeviceSize AllocateStaging(vk::DeviceSize size, vk::DeviceSize alignment);
+        void Submit(std::pmr::memory_resource *memory = std::pmr::get_default_resource());
+        void Retire(UploadBatch &batch);
+        void WaitForOldestBatch();
+        void RetireFinishedBatches();
+
+    public:
+        void Init(const vk::Device &device, VmaAllocator allocator, vk::Queue transferQueue, uint32_t transferQueueFamily, uint32_t graphicsQueueFamily);
+        /**
+         * @brief Waits for the uploads in flight and destroys the staging ring.
+         */
+        void Cleanup();
+        ~UploadManager();
+
+        /**
+         * @brief Copies data to a device buffer region.
+         * @return A ticket that can be given to IsUploadReady to know when the region can be used.
+         */
+        upload_ticket_t UploadToBuffer(const void *data, vk::DeviceSize size, const structs::BufferRegion &destination);
+        /**
+         * @brief Copies tightly packed texels to a mip level of an image. The previous content of that level is discarded.
+         * @param finalLayout Layout in which the image will be once it is ready
+         * @return A ticket that can be given to IsUploadReady to know when the image can be used.
+         */
+        upload_ticket_t UploadToImage(const void *data, vk::DeviceSize size, vk::Image image, vk::Extent3D extent,
+                                      vk::ImageAspectFlags aspect, uint32_t mipLevel, vk::ImageLayout finalLayout);
+
+        /**
+         * @brief Submits the recorded uploads, and records the acquire barriers of the finished ones in the given graphics command buffer.
+         * Should be called at the beginning of each frame, before the resources are used.
+         *
+         * @param frameMemory Memory in which the barrier lists are built, usually the arena of the frame
+         */
+        void Update(const vk::CommandBuffer &graphicsCommandBuffer, std::pmr::memory_resource *frameMemory = std::pmr::get_default_resource());
+
+        [[nodiscard]] bool IsUploadReady(upload_ticket_t ticket) const;
+        [[nodiscard]] vk::DeviceSize GetStagingUsage() const;
+    };
+} // namespace railguard::rendering
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <glm/glm.hpp>
 #include "../SwapchainManager.h"
 
 namespace railguard::rendering::init
@@ -9,5 +10,11 @@ namespace railguard::rendering::init
     public:
         bool enabled;
         railguard::rendering::swapchain_id_t swapchainId;
+        // Part of the swapchain image covered by the camera, in normalized coordinates (x, y, width, height).
+        // Several cameras can share a swapchain with different viewports (e.g. split screen).
+        glm::vec4 viewport{0.0f, 0.0f, 1.0f, 1.0f};
+        glm::mat4 view{1.0f};
+        // Projection to clip space, with a depth range of [0, 1]
+        glm::mat4 projection{1.0f};
     };
-}
\ No newline at end of file
+}
@@ -2,6 +2,7 @@
 
 #include "../../includes/Vulkan.h"
 #include "../structs/VertexInputDescription.h"
+#include "../structs/ShaderVariant.h"
 
 namespace railguard::rendering::init
 {
@@ -10,6 +11,12 @@ namespace railguard::rendering::init
 
     private:
         std::vector<vk::PipelineShaderStageCreateInfo> _shaderStages;
+        // Specialization of each stage. The create infos point to them, so they are updated in Build.
+        std::vector<structs::SpecializationConstants> _specializations;
+        std::vector<std::vector<vk::SpecializationMapEntry>> _specializationEntries;
+        std::vector<vk::SpecializationInfo> _specializationInfos;
+        // Copy of the description, so that the builder can outlive it (e.g. when the pipeline is built on another thread)
+        structs::VertexInputDescription _vertexInputDescription;
         vk::PipelineVertexInputStateCreateInfo _vertexInputInfo;
         vk::PipelineInputAssemblyStateCreateInfo _inputAssembly;
         vk::Viewport _viewport;
@@ -25,6 +32,7 @@ namespace railguard::rendering::init
         bool _inputAssemblyInitialized = false;
         bool _vertexInputInitialized = false;
         bool _depthSettingsProvided = false;
+        bool _dynamicViewport = false;
 #ifdef USE_ADVANCED_CHECKS
         bool _pipelineLayoutInitialized = false;
         bool _scissorsInitialized = false;
@@ -32,7 +40,16 @@ namespace railguard::rendering::init
 #endif
 
     public:
-        PipelineBuilder AddShaderStage(vk::ShaderStageFlagBits stage, vk::ShaderModule shaderModule);
+        /**
+         * @brief Adds a stage to the pipeline.
+         *
+         * @param specialization Values of the specialization constants of the shader. Constants that are not given keep their default value.
+         */
+        PipelineBuilder AddShaderStage(vk::ShaderStageFlagBits stage, vk::ShaderModule shaderModule, const structs::SpecializationConstants &specialization = {});
+        /**
+         * @brief Applies the topology, polygon mode and depth settings of the render state.
+         */
+        PipelineBuilder WithRenderState(const structs::RenderState &renderState);
         PipelineBuilder WithVertexInput(const structs::VertexInputDescription &vertexInputDescription);
         PipelineBuilder WithAssemblyTopology(vk::PrimitiveTopology topology);
         PipelineBuilder WithPolygonMode(vk::PolygonMode polygonMode);
@@ -43,6 +60,14 @@ namespace railguard::rendering::init
         PipelineBuilder WithViewport(float x, float y, float width, float height, float minDepth, float maxDepth);
         PipelineBuilder WithViewport(vk::Viewport viewport);
         PipelineBuilder GetDefaultsForExtent(vk::Extent2D windowExtent);
-        vk::Pipeline Build(vk::Device device, vk::RenderPass pass);
+        /**
+         * @brief Makes the viewport and the scissors dynamic, so that they must be set in the command buffer before drawing.
+         * Allows a pipeline to be used by cameras that draw in different parts of the image.
+         */
+        PipelineBuilder WithDynamicViewport();
+        /**
+         * @brief Creates the pipeline. It can only be used in the given subpass of render passes compatible with the given one.
+         */
+        vk::Pipeline Build(vk::Device device, vk::RenderPass pass, uint32_t subpass = 0);
     };
 } // namespace railguard::rendering::init
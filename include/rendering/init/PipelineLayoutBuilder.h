@@ -1,18 +1,37 @@
 #pragma once
 
 #include "../../includes/Vulkan.h"
+#include "../structs/PipelineLayoutDescription.h"
+#include "../PipelineLayoutCache.h"
 
 namespace railguard::rendering::init
 {
     /**
      * @brief Helper class that can be used to generate vk::PipelineLayout objects easily.
+     *
+     * Layouts are obtained through a PipelineLayoutCache, so building the same layout twice returns the same handle.
      */
     class PipelineLayoutBuilder
     {
     private:
-
+        structs::PipelineLayoutDescription _description;
 
     public:
-        [[nodiscard]] vk::PipelineLayout Build(const vk::Device &vulkanDevice);
+        /**
+         * @brief Adds a descriptor set layout. Sets are numbered in the order in which they are added.
+         */
+        PipelineLayoutBuilder AddDescriptorSetLayout(const structs::DescriptorSetLayoutDescription &setLayout);
+        /**
+         * @brief Adds a binding to the set at the given index. Creates the missing sets if needed.
+         */
+        PipelineLayoutBuilder AddDescriptorBinding(uint32_t set, uint32_t binding, vk::DescriptorType type, vk::ShaderStageFlags stages, uint32_t count = 1);
+        PipelineLayoutBuilder AddPushConstantRange(vk::ShaderStageFlags stages, uint32_t offset, uint32_t size);
+
+        [[nodiscard]] const structs::PipelineLayoutDescription &GetDescription() const;
+        /**
+         * @brief Gets the layout from the cache, creating it if it doesn't exist yet.
+         * The returned layout must be released with PipelineLayoutCache::ReleasePipelineLayout.
+         */
+        [[nodiscard]] vk::PipelineLayout Build(PipelineLayoutCache &cache) const;
     };
 } // namespace railguard::rendering::init
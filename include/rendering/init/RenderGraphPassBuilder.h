@@ -0,0 +1,55 @@
+#pragma once
+
+#include "../../includes/Vulkan.h"
+#include "../structs/RenderGraphDescriptions.h"
+
+namespace railguard::rendering::init
+{
+    /**
+     * @brief Helper class used to declare the resources that a render graph pass reads and writes.
+     */
+    class RenderGraphPassBuilder
+    {
+    private:
+        structs::RenderGraphPassDescription _description;
+
+    public:
+        explicit RenderGraphPassBuilder(const std::string &name);
+
+        /**
+         * @brief The pass renders to the given image, which is cleared with the given color at the start of the pass.
+         */
+        RenderGraphPassBuilder WriteColor(render_resource_id_t resource, const std::array<float, 4> &clearColor);
+        /**
+         * @brief The pass renders to the given image, on top of what previous passes wrote in it.
+         */
+        RenderGraphPassBuilder WriteColor(render_resource_id_t resource);
+        /**
+         * @brief The pass uses the given image as a depth buffer, which is cleared with the given value at the start of the pass.
+         */
+        RenderGraphPassBuilder WriteDepth(render_resource_id_t resource, float clearDepth = 1.0f);
+        /**
+         * @brief The pass tests against a depth buffer filled by a previous pass (e.g. a depth prepass), without writing it.
+         */
+        RenderGraphPassBuilder ReadDepth(render_resource_id_t resource);
+        /**
+         * @brief The pass reads the given image at the current pixel in its fragment shaders (subpassInput in GLSL).
+         * If the image was written by the previous pass, both passes can be merged in a single render pass.
+         */
+        RenderGraphPassBuilder ReadInputAttachment(render_resource_id_t resource);
+        /**
+         * @brief The pass samples the given image in its shaders.
+         */
+        RenderGraphPassBuilder ReadTexture(render_resource_id_t resource);
+        /**
+         * @brief Prevents the pass from being culled, even if its outputs are not used.
+         */
+        RenderGraphPassBuilder WithSideEffects();
+        /**
+         * @brief Sets the function that will record the commands of the pass. It is called inside the render pass.
+         */
+        RenderGraphPassBuilder Execute(const std::function<void(const vk::CommandBuffer &)> &callback);
+
+        [[nodiscard]] structs::RenderGraphPassDescription Build() const;
+    };
+} // namespace railguard::rendering::init
@@ -1,3 +1,5 @@
+#pragma once
+
 #include "./VkInitIncludes.h"
 
 namespace railguard::rendering::init
@@ -10,30 +12,86 @@ namespace railguard::rendering::init
         vk::AttachmentStoreOp _storeOp = vk::AttachmentStoreOp::eDontCare;
         vk::AttachmentLoadOp _stencilLoadOp = vk::AttachmentLoadOp::eDontCare;
         vk::AttachmentStoreOp _stencilStoreOp = vk::AttachmentStoreOp::eDontCare;
+        vk::ImageLayout _initialLayout = vk::ImageLayout::eUndefined;
         vk::ImageLayout _finalLayout = vk::ImageLayout::eUndefined;
 
     public:
         AttachmentBuilder SetFormat(vk::Format format);
         AttachmentBuilder ClearOnLoad();
+        AttachmentBuilder KeepOnLoad();
         AttachmentBuilder StoreAtEnd();
         AttachmentBuilder ClearStencilOnLoad();
         AttachmentBuilder StoreStencilAtEnd();
+        AttachmentBuilder SetInitialLayout(vk::ImageLayout layout);
         AttachmentBuilder SetFinalLayout(vk::ImageLayout layout);
 
         [[nodiscard]] vk::AttachmentDescription Build();
     };
 
+    /**
+     * @brief Helper class used to create render passes.
+     *
+     * Attachments are registered once with AddAttachment, then referenced by their index in one or several subpasses.
+     * The Use* methods apply to the current subpass. NextSubpass starts a new one.
+     *
+     * When a subpass uses an attachment written by a previous subpass (e.g. as an input attachment), a by-region dependency
+     * is automatically added between them. This allows tiled GPUs to keep the data on-chip between the subpasses.
+     * Subpasses that don't use such an attachment automatically preserve it.
+     */
     class RenderPassBuilder
     {
     private:
+        struct SubpassInfo
+        {
+            vk::PipelineBindPoint bindPoint = vk::PipelineBindPoint::eGraphics;
+            std::vector<vk::AttachmentReference> colorAttachments{};
+            std::vector<vk::AttachmentReference> inputAttachments{};
+            vk::AttachmentReference depthAttachment{};
+            bool hasDepthAttachment = false;
+            bool depthReadOnly = false;
+        };
+
         std::vector<vk::AttachmentDescription> _attachments;
-        std::vector<vk::AttachmentReference> _attachmentReferences;
-        vk::SubpassDescription _subpass;
+        std::vector<SubpassInfo> _subpasses{SubpassInfo{}};
+        std::vector<vk::SubpassDependency> _dependencies;
+
+        // Returns the dependencies given by the user, followed by the automatic ones
+        [[nodiscard]] std::vector<vk::SubpassDependency> ComputeDependencies() const;
+        // For each subpass, the attachments it must preserve because an earlier subpass wrote them and a later one uses them
+        [[nodiscard]] std::vector<std::vector<uint32_t>> ComputePreservedAttachments() const;
+
     public:
+        /**
+         * @brief Registers an attachment without using it in a subpass. Its index is the number of previously added attachments.
+         */
+        RenderPassBuilder AddAttachment(const vk::AttachmentDescription &attachment);
+        /**
+         * @brief Registers an attachment and uses it as a color attachment in the current subpass.
+         */
         RenderPassBuilder AddColorAttachment(const vk::AttachmentDescription &attachment);
-        RenderPassBuilder AddDepthAttachment(const vk::AttachmentDescription &attachment);
+        /**
+         * @brief Registers an attachment and uses it as the depth attachment of the current subpass.
+         */
+        RenderPassBuilder AddDepthAttachment(const vk::AttachmentDescription &attachment, bool readOnly = false);
+
+        RenderPassBuilder UseColorAttachment(uint32_t attachmentIndex);
+        RenderPassBuilder UseDepthAttachment(uint32_t attachmentIndex, bool readOnly = false);
+        /**
+         * @brief Reads the attachment at the same pixel in the shaders of the current subpass (subpassInput in GLSL).
+         */
+        RenderPassBuilder UseInputAttachment(uint32_t attachmentIndex, vk::ImageLayout layout = vk::ImageLayout::eShaderReadOnlyOptimal);
+
+        /**
+         * @brief Starts a new subpass. Following Use* calls will apply to it.
+         */
+        RenderPassBuilder NextSubpass();
         RenderPassBuilder SetPipelineBindPoint(vk::PipelineBindPoint bindPoint);
+        /**
+         * @brief Adds a dependency in addition to the ones that are deduced automatically.
+         */
+        RenderPassBuilder AddDependency(const vk::SubpassDependency &dependency);
 
+        [[nodiscard]] uint32_t GetSubpassCount() const;
         [[nodiscard]] vk::RenderPass Build(const vk::Device &device);
     };
 
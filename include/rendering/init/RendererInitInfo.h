@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include "VkInitIncludes.h"
+
+namespace railguard::core
+{
+    class JobPool;
+}
+
+namespace railguard::rendering::init
+{
+    /**
+     * @brief Describes where the renderer draws its frames.
+     */
+    struct RendererInitInfo
+    {
+        /**
+         * @brief Window to draw in. If null, the renderer is headless: it draws in offscreen images,
+         * and doesn't need a surface nor the VK_KHR_swapchain extension.
+         */
+        const core::WindowManager *windowManager = nullptr;
+        /**
+         * @brief Size of the offscreen images. Only used when the renderer is headless.
+         */
+        vk::Extent2D headlessExtent{1280, 720};
+        /**
+         * @brief Directory in which the frames are written when the renderer is headless. If empty, the frames are not read back.
+         */
+        std::string readbackDirectory{};
+        /**
+         * @brief Pool used to sort the draws on several threads. If null, they are sorted on the rendering thread.
+         */
+        core::JobPool *jobPool = nullptr;
+    };
+} // namespace railguard::rendering::init
@@ -6,7 +6,11 @@
 namespace railguard::rendering::init
 {
     struct ShaderEffectInitInfo {
-        vk::PipelineLayout pipelineLayout;
+        /**
+         * @brief Layout obtained from the PipelineLayoutCache. The effect takes ownership of that reference.
+         * If null, the layout is derived from the descriptors and push constants declared by the shader stages.
+         */
+        vk::PipelineLayout pipelineLayout = nullptr;
         std::vector<shader_module_id_t> shaderStages;
     };
 } // namespace railguard::rendering::init
@@ -27,10 +27,6 @@ namespace railguard::rendering::init
          * @brief Readonly reference to the window manager
          */
         const railguard::core::WindowManager &windowManager;
-        /**
-         * @brief Pointer to the renderpass that should be linked to the framebuffers
-         * */
-        const vk::RenderPass &renderPass;
         /**
          * @brief Pointer to the destination variable for the swapchain
          */
@@ -47,10 +43,6 @@ namespace railguard::rendering::init
          * @brief Pointer to the destination variable of the swapchain image views
          */
         std::vector<vk::ImageView> *swapchainImageViews;
-        /**
-         * @brief Pointer to the destination variable of the framebuffers
-         */
-        std::vector<vk::Framebuffer> *swapchainFramebuffers;
     };
 
 }
\ No newline at end of file
@@ -11,9 +11,9 @@ namespace railguard::rendering::init
     struct VulkanInitInfo
     {
         /**
-         * @brief Reference to the window manager
+         * @brief Pointer to the window manager, or null to create a headless instance and device (without surface nor swapchain)
          */
-        const core::WindowManager &windowManager;
+        const core::WindowManager *windowManager;
         /**
          * @brief Pointer to a variable that will hold the vulkan instance
          */
@@ -23,7 +23,7 @@ namespace railguard::rendering::init
          */
         vk::DebugUtilsMessengerEXT *debugMessenger;
         /**
-         * @brief Pointer to a variable that will hold the vulkan surface
+         * @brief Pointer to a variable that will hold the vulkan surface. It is null when there is no window manager.
          */
         vk::SurfaceKHR *surface;
         /**
@@ -34,6 +34,10 @@ namespace railguard::rendering::init
          * @brief Pointer to a variable that will hold the physical device properties
          */
         vk::PhysicalDeviceProperties *physicalDeviceProperties;
+        /**
+         * @brief Pointer to a variable that will hold the optional features that were enabled on the device
+         */
+        vk::PhysicalDeviceFeatures *enabledFeatures;
         /**
          * @brief Pointer to a variable that will hold the vulkan device
          */
@@ -46,6 +50,24 @@ namespace railguard::rendering::init
          * @brief Pointer to a variable that will hold the vulkan device
          */
         uint32_t *graphicsQueueFamily;
+        /**
+         * @brief Pointer to a variable that will hold the transfer queue.
+         * It is a dedicated queue if the device has one, otherwise it falls back to the graphics queue.
+         */
+        vk::Queue *transferQueue;
+        /**
+         * @brief Pointer to a variable that will hold the family of the transfer queue
+         */
+        uint32_t *transferQueueFamily;
+        /**
+         * @brief Pointer to a variable that will hold the async compute queue.
+         * It is in another family than the graphics queue if the device has one, otherwise it falls back to the graphics queue.
+         */
+        vk::Queue *computeQueue;
+        /**
+         * @brief Pointer to a variable that will hold the family of the compute queue
+         */
+        uint32_t *computeQueueFamily;
         /**
          * @brief Pointer to a variable that will hold the VMA allocator
          */
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+#include <functional>
+#include "../../includes/Vulkan.h"
+
+namespace railguard::rendering::structs
+{
+    /**
+     * @brief Compute work (culling, particle simulation, post-processing...) that is submitted on the async compute queue
+     * every frame, once the draws of the frame are sorted. The graphics work of the same frame waits for it.
+     *
+     * Resources written by the job must be shared with the compute queue family (e.g. buffers of the BufferManager).
+     */
+    struct AsyncComputeJob
+    {
+        std::string name;
+        std::function<void(const vk::CommandBuffer &)> record{};
+    };
+
+    /**
+     * @brief GPU durations of a frame, in milliseconds, measured with timestamp queries.
+     */
+    struct GpuTimings
+    {
+        double computeTime = 0;
+        double graphicsTime = 0;
+        // Time during which the async compute work of the frame ran at the same time as the graphics work of the previous frame
+        double overlapTime = 0;
+    };
+} // namespace railguard::rendering::structs
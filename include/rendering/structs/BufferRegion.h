@@ -0,0 +1,19 @@
+#pragma once
+
+#include "../../includes/Vulkan.h"
+
+namespace railguard::rendering::structs
+{
+    /**
+     * @brief Part of a larger buffer that was given by the BufferManager.
+     * Several regions share the same vk::Buffer, so the offset must be used when binding it.
+     */
+    struct BufferRegion
+    {
+        vk::Buffer buffer = nullptr;
+        vk::DeviceSize offset = 0;
+        vk::DeviceSize size = 0;
+        // Pointer to the start of the region if the buffer is mapped, nullptr otherwise
+        void *mappedData = nullptr;
+    };
+} // namespace railguard::rendering::structs
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include "../../includes/Vulkan.h"
+#include "../SwapchainManager.h"
+
+namespace railguard::rendering::structs
+{
+    /**
+     * @brief Uniform block given to the shaders at the binding 0 of CAMERA_DESCRIPTOR_SET.
+     * Written in the frame ring buffer for each camera, every frame.
+     */
+    struct CameraData
+    {
+        glm::mat4 view;
+        glm::mat4 projection;
+        glm::mat4 viewProjection;
+        // xyz: position of the camera in world space
+        glm::vec4 position;
+    };
+
+    /**
+     * @brief A camera that is rendered during the current frame.
+     */
+    struct CameraView
+    {
+        // Swapchain in which the camera draws
+        swapchain_id_t swapchainId = 0;
+        // Part of the image covered by the camera, in normalized coordinates (x, y, width, height)
+        glm::vec4 viewport{0.0f, 0.0f, 1.0f, 1.0f};
+        // Offset of the CameraData of the camera in the frame ring buffer, used as dynamic offset
+        uint32_t uniformOffset = 0;
+        glm::mat4 viewProjection{1.0f};
+        glm::vec3 position{0.0f};
+        // If false, the items drawn for that camera are not culled against its frustum
+        bool culled = true;
+        // Group of cameras culled together, set by the ClusterCuller
+        uint32_t cullingGroup = 0;
+    };
+} // namespace railguard::rendering::structs
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include "../../includes/Vulkan.h"
+#include "../ShaderEffectManager.h"
+
+namespace railguard::rendering::structs
+{
+    /**
+     * @brief A draw call submitted to the RenderQueue.
+     *
+     * Items are sorted by pass, then effect, then material, then depth, so that consecutive items share as much state as possible.
+     *
+     * Instanced items that use the same effect, material and mesh are merged in a single draw. Their transforms are streamed
+     * in a per-frame buffer, bound at INSTANCE_INPUT_BINDING.
+     *
+     * Items with meshlets are culled cluster by cluster on the GPU (see ClusterCuller): each meshlet is drawn by its own
+     * indirect command, whose index count is set to 0 when the meshlet is outside the frustum or back facing.
+     */
+    struct DrawItem
+    {
+        // Items are recorded by the render graph pass with that number. Only the 8 lower bits are used for sorting.
+        uint32_t pass = 0;
+        // Id of the ShaderEffect used to draw the item
+        shader_effect_id_t effect = 0;
+        // Items with the same material must use the same descriptor set. Only the 16 lower bits are used for sorting.
+        uint32_t material = 0;
+        // Bound in the set 0 of the layout of the effect, if not null
+        vk::DescriptorSet descriptorSet = nullptr;
+        // Distance to the camera, used to draw opaque items front to back
+        float depth = 0.0f;
+
+        vk::Buffer vertexBuffer = nullptr;
+        vk::DeviceSize vertexOffset = 0;
+        // If given, the item is drawn with drawIndexed
+        vk::Buffer indexBuffer = nullptr;
+        vk::DeviceSize indexOffset = 0;
+        vk::IndexType indexType = vk::IndexType::eUint32;
+
+        // Number of vertices, or of indices if there is an index buffer
+        uint32_t elementCount = 0;
+        uint32_t firstElement = 0;
+        int32_t baseVertex = 0;
+        // Ignored for instanced items, which are a single instance each
+        uint32_t instanceCount = 1;
+        uint32_t firstInstance = 0;
+        // Range of the meshlets of the item in the meshlet buffer of the MeshManager. Their triangles must be in the index range of the item.
+        uint32_t firstMeshlet = 0;
+        uint32_t meshletCount = 0;
+
+        // If true, the item can be merged with identical items, and its transform is given to the shader as a per-instance input.
+        // The transform is also used to cull the meshlets of the item.
+        bool instanced = false;
+        glm::mat4 transform{1.0f};
+    };
+
+    /**
+     * @brief Number of commands recorded by the RenderQueue during a frame.
+     */
+    struct RenderQueueStatistics
+    {
+        uint32_t drawCount = 0;
+        uint32_t pipelineBinds = 0;
+        uint32_t descriptorSetBinds = 0;
+        uint32_t vertexBufferBinds = 0;
+        uint32_t indexBufferBinds = 0;
+        uint32_t instanceBufferBinds = 0;
+        // Number of instances drawn by the instanced draws
+        uint32_t instanceCount = 0;
+        // Number of meshlet instances sent to the cluster culling shader
+        uint32_t clusterCount = 0;
+        // Number of meshlet instances drawn without culling, because the culler was full or couldn't draw the item
+        uint32_t unculledClusterCount = 0;
+    };
+} // namespace railguard::rendering::structs
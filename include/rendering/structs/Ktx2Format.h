@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+
+// Layout of the KTX 2.0 files read by the TextureManager (see the Khronos KTX 2.0 specification). Every field is little endian.
+//
+// | Ktx2Header | Ktx2LevelIndex[max(1, levelCount)] | data format descriptor | key/value data | supercompression data | mip levels |
+//
+// Level 0 is the largest mip level. The data of each level is tightly packed, and its offset is a multiple of the texel block size,
+// so that it can be copied to the GPU directly from the mapped file.
+
+#define KTX2_IDENTIFIER_SIZE 12
+#define KTX2_SUPERCOMPRESSION_NONE 0
+
+namespace railguard::rendering::structs
+{
+    constexpr uint8_t KTX2_IDENTIFIER[KTX2_IDENTIFIER_SIZE] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+    struct Ktx2Header
+    {
+        uint8_t identifier[KTX2_IDENTIFIER_SIZE];
+        // VkFormat of the texels
+        uint32_t vkFormat;
+        uint32_t typeSize;
+        uint32_t pixelWidth;
+        uint32_t pixelHeight;
+        // 0 for 2D textures
+        uint32_t pixelDepth;
+        // 0 if the texture is not an array
+        uint32_t layerCount;
+        // 6 for cube maps, 1 otherwise
+        uint32_t faceCount;
+        // 0 means that the mip levels should be generated at load time
+        uint32_t levelCount;
+        uint32_t supercompressionScheme;
+        uint32_t dfdByteOffset;
+        uint32_t dfdByteLength;
+        uint32_t kvdByteOffset;
+        uint32_t kvdByteLength;
+        uint64_t sgdByteOffset;
+        uint64_t sgdByteLength;
+    };
+
+    struct Ktx2LevelIndex
+    {
+        uint64_t byteOffset;
+        uint64_t byteLength;
+        uint64_t uncompressedByteLength;
+    };
+
+    static_assert(sizeof(Ktx2Header) == 80, "The KTX2 header must not contain padding.");
+    static_assert(sizeof(Ktx2LevelIndex) == 24, "KTX2 level indices must not contain padding.");
+} // namespace railguard::rendering::structs
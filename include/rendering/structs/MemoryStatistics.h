@@ -0,0 +1,19 @@
+#pragma once
+
+#include "../../includes/Vulkan.h"
+
+namespace railguard::rendering::structs
+{
+    /**
+     * @brief Video and host memory used by the allocator of the renderer, in bytes.
+     */
+    struct MemoryStatistics
+    {
+        // Sum of the sizes of the allocations, in every heap
+        vk::DeviceSize allocatedSize = 0;
+        // Sum of the sizes of the memory blocks from which the allocations are made, in every heap
+        vk::DeviceSize blockSize = 0;
+        // Blocks allocated in the device local heaps
+        vk::DeviceSize deviceLocalBlockSize = 0;
+    };
+} // namespace railguard::rendering::structs
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+
+// Layout of a mesh file, created by the meshconverter tool. Every field is little endian.
+//
+// | MeshFileHeader | MeshLod[lodCount] | Meshlet[meshletCount] | padding | MeshVertex[vertexCount] | uint32_t indices[indexCount] |
+// | padding | uint32_t meshletVertices[meshletVertexCount] | uint8_t meshletTriangles[3 * meshletTriangleCount] |
+//
+// The vertex and index streams are contiguous and start at a multiple of MESH_FILE_ALIGNMENT, so that they can be copied to
+// the GPU in a single upload, straight from the mapped file. Every LOD uses the same vertices: a LOD is a range of the index stream.
+// Meshlets are optional (meshletCount can be 0). Their vertices index the vertex stream, and their triangles index their vertices.
+// Each LOD is split in meshlets, in the order of its triangles: the meshlet triangle stream has one entry per triangle of the index
+// stream, so the triangles of a meshlet are also drawn by the index range [3 * firstTriangle, 3 * (firstTriangle + triangleCount)).
+
+#define MESH_FILE_MAGIC 0x484D4752 // "RGMH"
+#define MESH_FILE_VERSION 1
+#define MESH_FILE_ALIGNMENT 16
+#define MESH_MAX_LODS 8
+// Limits of a meshlet. They fit the recommended sizes for mesh shaders, so that the meshlets can also be used by them later.
+#define MESHLET_MAX_VERTICES 64
+#define MESHLET_MAX_TRIANGLES 124
+
+namespace railguard::rendering::structs
+{
+    struct MeshVertex
+    {
+        float position[3];
+        float normal[3];
+        float uv[2];
+    };
+
+    struct MeshBounds
+    {
+        // Bounding sphere
+        float center[3];
+        float radius;
+        // Axis aligned bounding box
+        float min[3];
+        float max[3];
+    };
+
+    struct MeshLod
+    {
+        uint32_t firstIndex;
+        uint32_t indexCount;
+        uint32_t firstMeshlet;
+        uint32_t meshletCount;
+        // Largest distance, in the units of the mesh, between the simplified surface and the original one. 0 for the first LOD.
+        float error;
+    };
+
+    struct Meshlet
+    {
+        // Offsets in the meshlet vertices and meshlet triangles streams
+        uint32_t firstVertex;
+        uint32_t firstTriangle;
+        uint32_t vertexCount;
+        uint32_t triangleCount;
+        // Bounding sphere
+        float center[3];
+        float radius;
+        // Normal cone: every triangle of the meshlet is back facing if
+        // dot(center - cameraPosition, coneAxis) >= coneCutoff * length(center - cameraPosition) + radius.
+        // coneCutoff is 1 when the normals are too spread for the test to ever succeed.
+        float coneAxis[3];
+        float coneCutoff;
+    };
+
+    struct MeshFileHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        uint32_t lodCount;
+        uint32_t meshletCount;
+        uint32_t meshletVertexCount;
+        uint32_t meshletTriangleCount;
+        MeshBounds bounds;
+        uint64_t lodsOffset;
+        uint64_t meshletsOffset;
+        uint64_t verticesOffset;
+        uint64_t indicesOffset;
+        uint64_t meshletVerticesOffset;
+        uint64_t meshletTrianglesOffset;
+        // Total size of the file, used to check that it is complete
+        uint64_t fileSize;
+    };
+
+    static_assert(sizeof(MeshVertex) == 32, "Mesh vertices must not contain padding.");
+    static_assert(sizeof(MeshLod) == 20, "Mesh LODs must not contain padding.");
+    static_assert(sizeof(Meshlet) == 48, "Meshlets must not contain padding.");
+    static_assert(sizeof(MeshFileHeader) == 128, "The mesh file header must not contain padding.");
+} // namespace railguard::rendering::structs
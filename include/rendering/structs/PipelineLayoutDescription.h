@@ -0,0 +1,30 @@
+#pragma once
+#include "../../includes/Vulkan.h"
+
+namespace railguard::rendering::structs
+{
+    /**
+     * @brief Describes the content of a vk::DescriptorSetLayout. Used as a key in the PipelineLayoutCache.
+     */
+    struct DescriptorSetLayoutDescription
+    {
+        std::vector<vk::DescriptorSetLayoutBinding> bindings{};
+        vk::DescriptorSetLayoutCreateFlags flags{};
+
+        bool operator==(const DescriptorSetLayoutDescription &other) const = default;
+    };
+
+    /**
+     * @brief Describes the content of a vk::PipelineLayout. Used as a key in the PipelineLayoutCache.
+     *
+     * The set layouts are stored as descriptions instead of handles so that identical set layouts
+     * can be deduplicated as well.
+     */
+    struct PipelineLayoutDescription
+    {
+        std::vector<DescriptorSetLayoutDescription> setLayouts{};
+        std::vector<vk::PushConstantRange> pushConstantRanges{};
+
+        bool operator==(const PipelineLayoutDescription &other) const = default;
+    };
+} // namespace railguard::rendering::structs
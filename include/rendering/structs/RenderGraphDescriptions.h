@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string>
+#include <optional>
+#include <functional>
+#include "../../includes/Vulkan.h"
+
+namespace railguard::rendering
+{
+    // Use a typedef to specify which type will be used for render graph ids
+    // That way, if we need to change that type, we only need to do it here
+    typedef uint32_t render_resource_id_t;
+    typedef uint32_t render_pass_id_t;
+}
+
+namespace railguard::rendering::structs
+{
+    /**
+     * @brief Describes an image used by the render graph.
+     */
+    struct RenderGraphImageDescription
+    {
+        std::string name;
+        vk::Format format = vk::Format::eUndefined;
+        vk::Extent2D extent{};
+    };
+
+    /**
+     * @brief Describes how a pass uses an image as an attachment.
+     */
+    struct RenderGraphAttachmentUse
+    {
+        render_resource_id_t resource = 0;
+        vk::AttachmentLoadOp loadOp = vk::AttachmentLoadOp::eDontCare;
+        vk::ClearValue clearValue{};
+        // For depth attachments only: the pass only tests against the depth, without writing it
+        bool readOnly = false;
+    };
+
+    /**
+     * @brief Describes a pass of the render graph: the resources that it reads and writes, and the commands that it records.
+     * Created with init::RenderGraphPassBuilder.
+     */
+    struct RenderGraphPassDescription
+    {
+        std::string name;
+        std::vector<RenderGraphAttachmentUse> colorAttachments{};
+        std::optional<RenderGraphAttachmentUse> depthAttachment{};
+        // Images written by a previous pass and read at the same pixel (subpassInput in GLSL)
+        std::vector<render_resource_id_t> inputAttachments{};
+        std::vector<render_resource_id_t> sampledImages{};
+        // Passes with side effects are never culled, even if nothing reads their outputs
+        bool hasSideEffects = false;
+        std::function<void(const vk::CommandBuffer &)> execute{};
+    };
+} // namespace railguard::rendering::structs
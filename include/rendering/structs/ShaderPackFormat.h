@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+
+// Layout of a shader pack file. Every field is little endian.
+//
+// | ShaderPackHeader | ShaderPackEntry[entryCount] | uint32_t buckets[bucketCount] | names | padding | code... |
+//
+// The code of each entry starts at a multiple of SHADER_PACK_ALIGNMENT, so that it can be given to vulkan
+// directly from the mapped file. Entries can be found by name with the hash table: the bucket of a name is
+// HashBytes(name) & (bucketCount - 1), and entries of the same bucket are chained with nextInBucket.
+
+#define SHADER_PACK_MAGIC 0x4B504752 // "RGPK"
+#define SHADER_PACK_VERSION 1
+#define SHADER_PACK_ALIGNMENT 16
+#define SHADER_PACK_NO_ENTRY UINT32_MAX
+
+namespace railguard::rendering::structs
+{
+    struct ShaderPackHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t entryCount;
+        // Always a power of two
+        uint32_t bucketCount;
+        uint64_t entriesOffset;
+        uint64_t bucketsOffset;
+        uint64_t namesOffset;
+        // Total size of the file, used to check that it is complete
+        uint64_t fileSize;
+    };
+
+    struct ShaderPackEntry
+    {
+        uint64_t nameHash;
+        // Offset of the name relative to namesOffset. Names are not null terminated.
+        uint32_t nameOffset;
+        uint32_t nameLength;
+        uint64_t codeOffset;
+        uint64_t codeSize;
+        // VkShaderStageFlagBits
+        uint32_t stage;
+        // Index of the next entry in the same bucket, or SHADER_PACK_NO_ENTRY
+        uint32_t nextInBucket;
+    };
+
+    static_assert(sizeof(ShaderPackHeader) == 48, "The shader pack header must not contain padding.");
+    static_assert(sizeof(ShaderPackEntry) == 40, "Shader pack entries must not contain padding.");
+} // namespace railguard::rendering::structs
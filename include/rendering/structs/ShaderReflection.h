@@ -0,0 +1,21 @@
+#pragma once
+
+#include "../../includes/Vulkan.h"
+#include "./PipelineLayoutDescription.h"
+#include "./VertexInputDescription.h"
+
+namespace railguard::rendering::structs
+{
+    /**
+     * @brief Interface of a shader module, extracted from its SPIR-V code by the SpirvReflector.
+     */
+    struct ShaderReflection
+    {
+        // Descriptor sets used by the shader. The set number is the index in the vector, so unused sets are empty.
+        std::vector<DescriptorSetLayoutDescription> setLayouts{};
+        std::vector<vk::PushConstantRange> pushConstantRanges{};
+        // Attributes read by a vertex shader, interleaved in the order of their locations.
+        // Per-vertex attributes use VERTEX_INPUT_BINDING, and per-instance ones INSTANCE_INPUT_BINDING.
+        VertexInputDescription vertexInput{};
+    };
+} // namespace railguard::rendering::structs
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace railguard::rendering::structs
+{
+    /**
+     * @brief A shader source file that was modified and successfully recompiled by the ShaderWatcher.
+     */
+    struct ShaderReload
+    {
+        // Name of the source file, e.g. "triangle.vert". Same as the name of the shader in the shader pack.
+        std::string name;
+        std::vector<uint32_t> code{};
+    };
+} // namespace railguard::rendering::structs
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include "../../includes/Vulkan.h"
+
+namespace railguard::rendering::structs
+{
+    /**
+     * @brief Values given to the specialization constants of a shader (layout(constant_id = X) in GLSL).
+     * Every value is 32 bits, which covers int, uint, float and bool constants.
+     */
+    struct SpecializationConstants
+    {
+        // Constant id -> raw value, sorted by id so that equal sets of values compare equal
+        std::vector<std::pair<uint32_t, uint32_t>> values{};
+
+        SpecializationConstants &Set(uint32_t constantId, uint32_t value)
+        {
+            auto it = std::lower_bound(values.begin(), values.end(), constantId, [](const std::pair<uint32_t, uint32_t> &v, uint32_t id)
+                                       { return v.first < id; });
+            if (it != values.end() && it->first == constantId)
+            {
+                it->second = value;
+            }
+            else
+            {
+                values.insert(it, {constantId, value});
+            }
+            return *this;
+        }
+        SpecializationConstants &Set(uint32_t constantId, int32_t value)
+        {
+            return Set(constantId, static_cast<uint32_t>(value));
+        }
+        SpecializationConstants &Set(uint32_t constantId, float value)
+        {
+            return Set(constantId, std::bit_cast<uint32_t>(value));
+        }
+        SpecializationConstants &Set(uint32_t constantId, bool value)
+        {
+            // Booleans are VkBool32 in SPIR-V
+            return Set(constantId, static_cast<uint32_t>(value ? VK_TRUE : VK_FALSE));
+        }
+
+        [[nodiscard]] bool IsEmpty() const
+        {
+            return values.empty();
+        }
+
+        bool operator==(const SpecializationConstants &other) const = default;
+    };
+
+    /**
+     * @brief Fixed function state that can differ between variants of the same shader effect.
+     */
+    struct RenderState
+    {
+        vk::PrimitiveTopology topology = vk::PrimitiveTopology::eTriangleList;
+        vk::PolygonMode polygonMode = vk::PolygonMode::eFill;
+        bool depthTest = false;
+        bool depthWrite = false;
+        vk::CompareOp depthCompareOp = vk::CompareOp::eAlways;
+
+        bool operator==(const RenderState &other) const = default;
+    };
+
+    /**
+     * @brief A permutation of a shader effect: the same shaders, compiled with other specialization constants and render state.
+     */
+    struct ShaderVariant
+    {
+        // Given to every stage of the effect
+        SpecializationConstants specialization{};
+        RenderState renderState{};
+
+        bool operator==(const ShaderVariant &other) const = default;
+    };
+} // namespace railguard::rendering::structs
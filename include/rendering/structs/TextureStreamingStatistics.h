@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include "../../includes/Vulkan.h"
+
+namespace railguard::rendering::structs
+{
+    /**
+     * @brief Residency of the textures of the TextureManager, updated every frame.
+     */
+    struct TextureStreamingStatistics
+    {
+        // Memory that the textures are allowed to use (TEXTURE_STREAMING_BUDGET)
+        vk::DeviceSize budget = 0;
+        // Memory used by the resident mip levels, including the images being uploaded and the ones waiting to be destroyed
+        vk::DeviceSize residentSize = 0;
+        // Memory that would be needed for every texture to have the mip levels requested during the frame
+        vk::DeviceSize requestedSize = 0;
+        uint32_t textureCount = 0;
+        // Textures that have every mip level they were asked for
+        uint32_t satisfiedTextureCount = 0;
+        // Mip levels uploaded and textures evicted during the frame
+        uint32_t streamedLevelCount = 0;
+        uint32_t evictionCount = 0;
+    };
+} // namespace railguard::rendering::structs
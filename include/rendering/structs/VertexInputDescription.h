@@ -1,12 +1,73 @@
 #pragma once
+#include <stdexcept>
 #include "../../includes/Vulkan.h"
 
 namespace railguard::rendering::structs
 {
+    /**
+     * @brief Describes the vertex buffers read by a pipeline. Bindings with vk::VertexInputRate::eInstance advance once per instance
+     * instead of once per vertex, which allows per-instance data such as transforms to be given in a buffer.
+     */
     struct VertexInputDescription
     {
         std::vector<vk::VertexInputBindingDescription> bindings{};
         std::vector<vk::VertexInputAttributeDescription> attributes{};
         vk::PipelineVertexInputStateCreateFlags flags{};
+
+        /**
+         * @brief Adds a binding in which the given attributes are interleaved, in the given order and without padding.
+         *
+         * @param binding Index of the binding
+         * @param inputRate Whether the binding advances per vertex or per instance
+         * @param locationFormats Location and format of each attribute. Only formats with 32-bit components are supported.
+         */
+        VertexInputDescription &AddBinding(uint32_t binding, vk::VertexInputRate inputRate, const std::vector<std::pair<uint32_t, vk::Format>> &locationFormats)
+        {
+            uint32_t offset = 0;
+            for (const auto &[location, format] : locationFormats)
+            {
+                attributes.push_back(vk::VertexInputAttributeDescription{
+                    .location = location,
+                    .binding = binding,
+                    .format = format,
+                    .offset = offset,
+                });
+                offset += GetFormatSize(format);
+            }
+            bindings.push_back(vk::VertexInputBindingDescription{
+                .binding = binding,
+                .stride = offset,
+                .inputRate = inputRate,
+            });
+            return *this;
+        }
+
+        /**
+         * @brief Returns the size of a vertex attribute of that format.
+         */
+        static uint32_t GetFormatSize(vk::Format format)
+        {
+            switch (format)
+            {
+            case vk::Format::eR32Sfloat:
+            case vk::Format::eR32Sint:
+            case vk::Format::eR32Uint:
+                return 4;
+            case vk::Format::eR32G32Sfloat:
+            case vk::Format::eR32G32Sint:
+            case vk::Format::eR32G32Uint:
+                return 8;
+            case vk::Format::eR32G32B32Sfloat:
+            case vk::Format::eR32G32B32Sint:
+            case vk::Format::eR32G32B32Uint:
+                return 12;
+            case vk::Format::eR32G32B32A32Sfloat:
+            case vk::Format::eR32G32B32A32Sint:
+            case vk::Format::eR32G32B32A32Uint:
+                return 16;
+            default:
+                throw std::runtime_error("Unsupported vertex attribute format.");
+            }
+        }
     };
 } // namespace railguard::rendering::structs
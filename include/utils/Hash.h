@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cinttypes>
+#include <functional>
+
+namespace railguard::utils
+{
+    /**
+     * @brief Mixes the hash of the given value into the seed.
+     *
+     * Useful to compute the hash of a struct from the hashes of its fields.
+     *
+     * @tparam T Type of the value. std::hash must be defined for it.
+     * @param seed Current value of the hash. Will be updated.
+     * @param value Value to mix into the hash.
+     */
+    template <typename T>
+    inline void HashCombine(size_t &seed, const T &value)
+    {
+        // Same formula as boost::hash_combine
+        seed ^= std::hash<T>{}(value) + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+    }
+
+    /**
+     * @brief Computes the 64-bit FNV-1a hash of a raw buffer.
+     *
+     * @param data Pointer to the first byte of the buffer
+     * @param size Size of the buffer in bytes
+     * @return uint64_t The hash of the content of the buffer
+     */
+    inline uint64_t HashBytes(const void *data, size_t size)
+    {
+        const auto *bytes = static_cast<const uint8_t *>(data);
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= bytes[i];
+            hash *= 0x100000001b3ULL;
+        }
+        return hash;
+    }
+} // namespace railguard::utils
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+namespace railguard::utils
+{
+    /**
+     * @brief Read-only view of a whole file, mapped in memory by the OS.
+     * Pages are only loaded when they are accessed, and nothing is copied. The file is unmapped when the object is destroyed.
+     */
+    class MappedFile
+    {
+    private:
+        const void *_data = nullptr;
+        size_t _size = 0;
+#ifdef _WIN32
+        void *_fileHandle = nullptr;
+        void *_mappingHandle = nullptr;
+#endif
+
+        void Unmap();
+
+    public:
+        /**
+         * @brief Maps the file at the given path. Throws if it can't be opened.
+         */
+        explicit MappedFile(const std::string &filePath);
+        ~MappedFile();
+
+        // The mapping is owned by a single object
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+        MappedFile(MappedFile &&other) noexcept;
+        MappedFile &operator=(MappedFile &&other) noexcept;
+
+        [[nodiscard]] const void *GetData() const;
+        [[nodiscard]] size_t GetSize() const;
+    };
+} // namespace railguard::utils
@@ -0,0 +1,259 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include "VirtualMemoryBlock.h"
+
+// Address space reserved by default for each paged vector. It costs no memory until it is used.
+#define PAGED_VECTOR_DEFAULT_RESERVED_SIZE (size_t{1} << 30)
+
+namespace railguard::utils
+{
+    /**
+     * @brief Vector whose storage is a range of address space reserved up front, in which pages are committed as it grows.
+     *
+     * Growing never reallocates: the elements are never copied or moved, and pointers to them stay valid until they are removed.
+     * This avoids the spikes of std::vector when it passes its capacity with a lot of elements. In exchange, the vector
+     * can't hold more than its maximum capacity, given at construction.
+     *
+     * It implements the subset of the std::vector interface used by the managers, and can be used in their place (see core::PagedStorage).
+     *
+     * @tparam T Type of the elements
+     * @tparam UseHugePages If true, the storage is backed by transparent huge pages when the system allows it
+     */
+    template <typename T, bool UseHugePages = false>
+    class PagedVector
+    {
+    private:
+        VirtualMemoryBlock _memory;
+        size_t _maxCapacity = 0;
+        size_t _size = 0;
+
+        void Grow(size_t size)
+        {
+            if (size > _maxCapacity)
+            {
+                throw std::length_error("PagedVector exceeded its maximum capacity.");
+            }
+            // The address space is only reserved once something is stored, so that empty vectors are free
+            if (_memory.GetReservedSize() == 0)
+            {
+                _memory = VirtualMemoryBlock(_maxCapacity * sizeof(T), UseHugePages);
+            }
+            _memory.Commit(size * sizeof(T));
+        }
+
+    public:
+        using value_type = T;
+        using size_type = size_t;
+        using reference = T &;
+        using const_reference = const T &;
+        using iterator = T *;
+        using const_iterator = const T *;
+
+        /**
+         * @param maxCapacity Maximum number of elements. Only address space is reserved for them.
+         */
+        explicit PagedVector(size_t maxCapacity = PAGED_VECTOR_DEFAULT_RESERVED_SIZE / sizeof(T))
+            : _maxCapacity(maxCapacity)
+        {
+        }
+
+        ~PagedVector()
+        {
+            clear();
+        }
+
+        PagedVector(const PagedVector &) = delete;
+        PagedVector &operator=(const PagedVector &) = delete;
+
+        PagedVector(PagedVector &&other) noexcept
+        {
+            *this = std::move(other);
+        }
+
+        PagedVector &operator=(PagedVector &&other) noexcept
+        {
+            if (this != &other)
+            {
+                clear();
+                _memory = std::move(other._memory);
+                std::swap(_maxCapacity, other._maxCapacity);
+                std::swap(_size, other._size);
+            }
+            return *this;
+        }
+
+        // === Capacity ===
+
+        /**
+         * @brief Commits the memory of the given number of elements. Unlike std::vector, the elements never move, so it is only
+         * useful to avoid committing pages later.
+         */
+        void reserve(size_t capacity)
+        {
+            if (capacity > 0)
+            {
+                Grow(capacity);
+            }
+        }
+
+        [[nodiscard]] size_t size() const
+        {
+            return _size;
+        }
+
+        [[nodiscard]] bool empty() const
+        {
+            return _size == 0;
+        }
+
+        [[nodiscard]] size_t capacity() const
+        {
+            return _memory.GetCommittedSize() / sizeof(T);
+        }
+
+        [[nodiscard]] size_t max_size() const
+        {
+            return _maxCapacity;
+        }
+
+        // === Modifiers ===
+
+        template <typename... Args>
+        T &emplace_back(Args &&...args)
+        {
+            Grow(_size + 1);
+            T *element = new (data() + _size) T(std::forward<Args>(args)...);
+            _size++;
+            return *element;
+        }
+
+        void push_back(const T &value)
+        {
+            emplace_back(value);
+        }
+
+        void push_back(T &&value)
+        {
+            emplace_back(std::move(value));
+        }
+
+        void pop_back()
+        {
+            _size--;
+            std::destroy_at(data() + _size);
+        }
+
+        void resize(size_t size, const T &value = T())
+        {
+            if (size > _size)
+            {
+                Grow(size);
+                std::uninitialized_fill(data() + _size, data() + size, value);
+            }
+            else
+            {
+                std::destroy(data() + size, data() + _size);
+            }
+            _size = size;
+        }
+
+        void assign(size_t size, const T &value)
+        {
+            clear();
+            resize(size, value);
+        }
+
+        template <std::forward_iterator Iterator>
+        void assign(Iterator first, Iterator last)
+        {
+            clear();
+            const auto size = static_cast<size_t>(std::distance(first, last));
+            if (size > 0)
+            {
+                Grow(size);
+                std::uninitialized_copy(first, last, data());
+            }
+            _size = size;
+        }
+
+        /**
+         * @brief Destroys the elements. The committed pages are kept for the next elements.
+         */
+        void clear()
+        {
+            if (_size > 0)
+            {
+                std::destroy(data(), data() + _size);
+            }
+            _size = 0;
+        }
+
+        // === Access ===
+
+        [[nodiscard]] T *data()
+        {
+            return reinterpret_cast<T *>(_memory.GetData());
+        }
+
+        [[nodiscard]] const T *data() const
+        {
+            return reinterpret_cast<const T *>(_memory.GetData());
+        }
+
+        [[nodiscard]] T &operator[](size_t index)
+        {
+            return data()[index];
+        }
+
+        [[nodiscard]] const T &operator[](size_t index) const
+        {
+            return data()[index];
+        }
+
+        [[nodiscard]] T &front()
+        {
+            return data()[0];
+        }
+
+        [[nodiscard]] const T &front() const
+        {
+            return data()[0];
+        }
+
+        [[nodiscard]] T &back()
+        {
+            return data()[_size - 1];
+        }
+
+        [[nodiscard]] const T &back() const
+        {
+            return data()[_size - 1];
+        }
+
+        [[nodiscard]] iterator begin()
+        {
+            return data();
+        }
+
+        [[nodiscard]] iterator end()
+        {
+            return data() + _size;
+        }
+
+        [[nodiscard]] const_iterator begin() const
+        {
+            return data();
+        }
+
+        [[nodiscard]] const_iterator end() const
+        {
+            return data() + _size;
+        }
+    };
+} // namespace railguard::utils
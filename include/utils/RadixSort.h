@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cinttypes>
+#include <vector>
+
+namespace railguard::core
+{
+    class JobPool;
+}
+
+namespace railguard::utils
+{
+    /**
+     * @brief Value sorted by the radix sort: a 64-bit key and the index of the element it belongs to.
+     */
+    struct SortEntry
+    {
+        uint64_t key;
+        uint32_t index;
+    };
+
+    /**
+     * @brief Memory used by the radix sort. Keep it between calls, so that sorting only allocates when the arrays grow.
+     */
+    struct RadixSortScratch
+    {
+        std::vector<SortEntry> buffer;
+        // One histogram and one list of write positions per chunk, one after the other
+        std::vector<uint32_t> histograms;
+        std::vector<uint32_t> offsets;
+    };
+
+    /**
+     * @brief Sorts the entries by key with a stable LSD radix sort, 8 bits at a time.
+     *
+     * Large arrays are split in chunks that are processed by the jobs of the pool: each job counts the keys of its chunk,
+     * then moves them to their place. Bytes that are the same in every key are skipped.
+     *
+     * @param entries Entries to sort. Sorted in place, but their memory may be exchanged with the one of the scratch buffer.
+     * @param scratch Temporary arrays, resized if needed.
+     * @param jobPool Pool running the chunks. If null, the entries are sorted on the calling thread.
+     */
+    void RadixSort(std::vector<SortEntry> &entries, RadixSortScratch &scratch, core::JobPool *jobPool = nullptr);
+} // namespace railguard::utils
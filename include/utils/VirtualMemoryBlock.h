@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+
+namespace railguard::utils
+{
+    /**
+     * @brief Range of virtual address space reserved up front, in which pages are committed on demand.
+     *
+     * Reserving costs no memory: only the committed pages are backed by physical memory. Since the range never moves,
+     * data stored in it keeps its address while it grows. The range is released when the object is destroyed.
+     *
+     * With huge pages, the range is aligned on 2 MiB and the kernel is asked to back it with transparent huge pages,
+     * which reduces TLB misses when large arrays are iterated. It is only a hint, and it is ignored on Windows,
+     * where large pages need a privilege and can't be committed progressively.
+     */
+    class VirtualMemoryBlock
+    {
+    private:
+        std::byte *_data = nullptr;
+        size_t _reservedSize = 0;
+        size_t _committedSize = 0;
+        bool _hugePages = false;
+#ifndef _WIN32
+        // Start and size of the whole mapping, which can be larger than the reserved range to align it
+        void *_mapping = nullptr;
+        size_t _mappingSize = 0;
+#endif
+
+        void Release();
+
+    public:
+        VirtualMemoryBlock() = default;
+        /**
+         * @brief Reserves the given size, rounded up to a whole number of pages. Throws if the address space is exhausted.
+         */
+        explicit VirtualMemoryBlock(size_t reservedSize, bool hugePages = false);
+        ~VirtualMemoryBlock();
+
+        // The range is owned by a single object
+        VirtualMemoryBlock(const VirtualMemoryBlock &) = delete;
+        VirtualMemoryBlock &operator=(const VirtualMemoryBlock &) = delete;
+        VirtualMemoryBlock(VirtualMemoryBlock &&other) noexcept;
+        VirtualMemoryBlock &operator=(VirtualMemoryBlock &&other) noexcept;
+
+        /**
+         * @brief Makes sure that at least the first size bytes are committed. Pages are committed by chunks, to limit the number of system calls.
+         * Throws if size is larger than the reserved size, or if the memory can't be committed.
+         */
+        void Commit(size_t size);
+
+        [[nodiscard]] std::byte *GetData() const;
+        [[nodiscard]] size_t GetReservedSize() const;
+        [[nodiscard]] size_t GetCommittedSize() const;
+    };
+} // namespace railguard::utils
@@ -1,4 +1,61 @@
 
+-- Settings shared by the projects that compile the engine
+function UseEngineDependencies()
+   -- Use the SSE implementations of glm (aligned vectors and matrices)
+   defines { "GLM_FORCE_INTRINSICS", "GLM_FORCE_DEFAULT_ALIGNED_GENTYPES" }
+
+   -- Find SDL2
+   sdl_include_dir = os.findheader(
+      "SDL.h", {
+         "$(SDL2_PATH)/include/SDL2",
+         "/usr/include",
+         "$(sdl2_image_DIR)/include"
+      })
+      sdl_lib_dir = os.findlib(
+         "SDL2", {
+            "$(SDL2_PATH)/lib",
+            "/usr/lib/x86_64-linux-gnu/",
+            "$(sdl2_image_DIR)/lib",
+            "/usr/lib64"
+         }
+      )
+      if (sdl_include_dir == nil) then
+         print("Using default value for SDL")
+         sdl_include_dir = "$(SDL2_PATH)/include"
+      end
+      if (sdl_include_dir == nil or sdl_lib_dir == nil) then
+         error("\n--> SDL2 must be installed.\n")
+      end
+
+      -- Add header dependencies
+      includedirs {
+         "$(VULKAN_SDK)/include",
+         sdl_include_dir,
+         "external/glm",
+         "external/vk-bootstrap/src",
+         "external/vma"
+      }
+
+
+   -- Add lib dependencies
+   libdirs {
+      "$(VULKAN_SDK)/Lib",
+      sdl_lib_dir
+   }
+
+   links {"SDL2", "vkbootstrap"}
+
+   -- Only link SDL2main on windows
+   filter {"platforms:Win64"}
+      links { "SDL2main"}
+
+   -- Only link dl and pthread on Linux
+   filter {"platforms:Linux"}
+      links {"dl", "pthread"}
+   -- Reset filter
+   filter{}
+end
+
 workspace "railguard"
    configurations { "Debug", "Release" }
    platforms {"Win64", "Linux"}
@@ -8,7 +65,7 @@ workspace "railguard"
 
    -- Debug config
    filter "configurations:Debug"
-      defines { "DEBUG", "USE_ADVANCED_CHECKS", "USE_VK_VALIDATION_LAYERS" }
+      defines { "DEBUG", "USE_ADVANCED_CHECKS", "USE_VK_VALIDATION_LAYERS", "USE_SHADER_HOT_RELOAD", "USE_RENDER_STATISTICS_REPORTS" }
       symbols "On"
    -- Release config
    filter "configurations:Release"
@@ -32,9 +89,29 @@ workspace "railguard"
       includedirs {"$(VULKAN_SDK)/include"}
       libdirs {"$(VULKAN_SDK)/Lib"}
 
+   project "shaderpacker"
+      kind "ConsoleApp"
+      language "C++"
+      buildoptions(iif(os.istarget("windows"), "/std:c++latest", "--std=c++20"))
+      architecture "x64"
+      targetdir "bin/tools"
+      location "build/shaderpacker"
+      files {"./tools/shaderpacker/**.cpp"}
+
+   project "meshconverter"
+      kind "ConsoleApp"
+      language "C++"
+      buildoptions(iif(os.istarget("windows"), "/std:c++latest", "--std=c++20"))
+      architecture "x64"
+      targetdir "bin/tools"
+      location "build/meshconverter"
+      files {"./tools/meshconverter/**.cpp"}
+
    project "shaders"
       kind "Utility"
       location "build/shaders"
+      -- The pack is created with the shaderpacker tool
+      dependson {"shaderpacker"}
       -- Build shaders with glslangValidator
       filter {"files:**"}
       buildcommands { '"$(VULKAN_SDK)/Bin/glslangValidator.exe" -V "%{file.relpath}" -o "../../bin/shaders/%{file.name}.spv"' }
@@ -42,6 +119,21 @@ workspace "railguard"
       filter {}
       -- Take all shader files
       files { "shaders/**.vert", "shaders/**.frag", "shaders/**.glsl", "shaders/**.comp" }
+      -- Bundle every compiled shader in a single pack, loaded at startup
+      postbuildcommands { '"../../bin/tools/shaderpacker" "../../bin/shaders" "../../bin/shaders/shaders.rgpack"' }
+
+   project "assets"
+      kind "Utility"
+      location "build/assets"
+      -- The converter doesn't create the output directory
+      os.mkdir "bin/assets"
+      -- Meshes are converted with the meshconverter tool
+      dependson {"meshconverter"}
+      filter {"files:**.obj"}
+      buildcommands { '"../../bin/tools/meshconverter" "%{file.relpath}" "../../bin/assets/%{file.basename}.rgmesh"' }
+      buildoutputs {"bin/assets/%{file.basename}.rgmesh"}
+      filter {}
+      files { "assets/**.obj" }
 
    -- Main Project
    project "railguard"
@@ -51,57 +143,7 @@ workspace "railguard"
       architecture "x64"
       targetdir "bin/%{cfg.buildcfg}"
       location "build/railguard"
-      
-      -- Find SDL2
-      sdl_include_dir = os.findheader(
-         "SDL.h", {
-            "$(SDL2_PATH)/include/SDL2",
-            "/usr/include",
-            "$(sdl2_image_DIR)/include"
-         })
-         sdl_lib_dir = os.findlib(
-            "SDL2", {
-               "$(SDL2_PATH)/lib",
-               "/usr/lib/x86_64-linux-gnu/",
-               "$(sdl2_image_DIR)/lib",
-               "/usr/lib64"
-            }
-         )
-         if (sdl_include_dir == nil) then
-            print("Using default value for SDL")
-            sdl_include_dir = "$(SDL2_PATH)/include"
-         end
-         if (sdl_include_dir == nil or sdl_lib_dir == nil) then
-            error("\n--> SDL2 must be installed.\n")
-         end
-         
-         -- Add header dependencies
-         includedirs {
-            "$(VULKAN_SDK)/include",
-            sdl_include_dir,
-            "external/glm",
-            "external/vk-bootstrap/src",
-            "external/vma"
-         }
-         
-         
-      -- Add lib dependencies
-      libdirs {
-         "$(VULKAN_SDK)/Lib",
-         sdl_lib_dir
-      }
-
-      links {"SDL2", "vkbootstrap"}
-
-      -- Only link SDL2main on windows
-      filter {"platforms:Win64"}
-         links { "SDL2main"}
-
-      -- Only link dl on Linux
-      filter {"platforms:Linux"}
-         links {"dl"}
-      -- Reset filter
-      filter{}
+      UseEngineDependencies()
 
       -- Same as above, fix directory creation bug
       os.mkdir "build/railguard/obj"
@@ -110,3 +152,19 @@ workspace "railguard"
       files { "include/**.h" }
 	   files { "src/**.cpp" }
 
+   -- Renders benchmark scenes in headless mode and writes frame statistics as JSON
+   project "railguard_renderbench"
+      kind "ConsoleApp"
+      language "C++"
+      buildoptions(iif(os.istarget("windows"), "/std:c++latest", "--std=c++20"))
+      architecture "x64"
+      targetdir "bin/%{cfg.buildcfg}"
+      location "build/railguard_renderbench"
+      dependson {"shaders", "assets"}
+      UseEngineDependencies()
+
+      os.mkdir "build/railguard_renderbench/obj"
+
+      -- The engine sources, without its entry point
+      files { "include/**.h", "src/**.cpp", "tools/renderbench/**.cpp" }
+      removefiles { "src/main.cpp" }
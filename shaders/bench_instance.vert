@@ -0,0 +1,21 @@
+#version 450
+
+// Small triangle drawn once per instance by the render benchmark. The transform goes directly to clip space.
+
+layout (location = 8) in mat4 instanceTransform;
+
+layout (location = 0) out vec3 outColor;
+
+void main() {
+
+    const vec3 positions[3] = vec3[3](
+        vec3(1.0f, 1.0f, 0.0f),
+        vec3(-1.0f, 1.0f, 0.0f),
+        vec3(0.0f, -1.0f, 0.0f)
+    );
+
+    // Vary the color with the instance, so that the readbacks show each of them
+    uint hash = uint(gl_InstanceIndex) * 2654435761u;
+    outColor = vec3(hash & 0xFFu, (hash >> 8) & 0xFFu, (hash >> 16) & 0xFFu) / 255.0f;
+    gl_Position = instanceTransform * vec4(positions[gl_VertexIndex], 1.0f);
+}
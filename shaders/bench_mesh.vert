@@ -0,0 +1,26 @@
+#version 450
+
+// Mesh created by meshconverter, drawn once per instance by the render benchmark and seen by a perspective camera.
+
+layout (location = 0) in vec3 position;
+layout (location = 1) in vec3 normal;
+layout (location = 2) in vec2 uv;
+
+layout (location = 8) in mat4 instanceTransform;
+
+layout (set = 1, binding = 0) uniform CameraData {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec4 position;
+} camera;
+
+layout (location = 0) out vec3 outColor;
+
+void main() {
+    // Color the mesh with its normals, so that the readbacks show the missing clusters. The UVs are read too, since the
+    // inputs must keep the layout of MeshVertex.
+    const float checker = mod(floor(uv.x * 16.0f) + floor(uv.y * 8.0f), 2.0f);
+    outColor = (normalize(mat3(instanceTransform) * normal) * 0.5f + 0.5f) * (0.75f + 0.25f * checker);
+    gl_Position = camera.viewProjection * instanceTransform * vec4(position, 1.0f);
+}
@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+#include "../../include/core/BitsetColumn.h"
+
+namespace railguard::core
+{
+    BitsetColumn::BitsetColumn(component_id_t defaultCapacity)
+    {
+        Reserve(defaultCapacity);
+    }
+
+    void BitsetColumn::Reserve(component_id_t capacity)
+    {
+        _words.reserve((capacity + WORD_BITS - 1) / WORD_BITS);
+    }
+
+    void BitsetColumn::PushBack(bool value)
+    {
+        if (_size % WORD_BITS == 0)
+        {
+            _words.push_back(0);
+        }
+        _size++;
+        Set(_size - 1, value);
+    }
+
+    void BitsetColumn::PopBack()
+    {
+        assert(_size > 0);
+
+        // Keep the bits past the size at 0, so that the words can be counted and iterated without masking
+        Set(_size - 1, false);
+        _size--;
+        if (_size % WORD_BITS == 0)
+        {
+            _words.pop_back();
+        }
+    }
+
+    void BitsetColumn::RemoveSwap(component_id_t index)
+    {
+        assert(index < _size);
+
+        if (index < _size - 1)
+        {
+            Set(index, Get(_size - 1));
+        }
+        PopBack();
+    }
+
+    void BitsetColumn::Reorder(const std::vector<component_id_t> &newOrder)
+    {
+        assert(newOrder.size() == _size);
+
+        std::vector<uint64_t> reorderedWords(_words.size(), 0);
+        for (component_id_t i = 0; i < newOrder.size(); i++)
+        {
+            if (Get(newOrder[i]))
+            {
+                reorderedWords[i / WORD_BITS] |= uint64_t{1} << (i % WORD_BITS);
+            }
+        }
+        _words = std::move(reorderedWords);
+    }
+
+    void BitsetColumn::Fill(bool value)
+    {
+        std::fill(_words.begin(), _words.end(), value ? ~uint64_t{0} : 0);
+        // Clear the bits past the size
+        if (value && _size % WORD_BITS != 0)
+        {
+            _words.back() = (uint64_t{1} << (_size % WORD_BITS)) - 1;
+        }
+    }
+
+    void BitsetColumn::Reset(component_id_t begin, component_id_t end)
+    {
+        assert(begin <= end && end <= _size);
+
+        // Bit by bit until the first whole word, then whole words, then bit by bit again
+        while (begin < end && begin % WORD_BITS != 0)
+        {
+            Set(begin++, false);
+        }
+        while (end - begin >= WORD_BITS)
+        {
+            _words[begin / WORD_BITS] = 0;
+            begin += WORD_BITS;
+        }
+        while (begin < end)
+        {
+            Set(begin++, false);
+        }
+    }
+
+    void BitsetColumn::Assign(std::span<const uint64_t> words, component_id_t size)
+    {
+        if (words.size() != (size + WORD_BITS - 1) / WORD_BITS)
+        {
+            throw std::runtime_error("The number of words doesn't match the size of the bitset column.");
+        }
+        _words.assign(words.begin(), words.end());
+        _size = size;
+        // Keep the bits past the size cleared
+        if (size % WORD_BITS != 0)
+        {
+            _words.back() &= (uint64_t{1} << (size % WORD_BITS)) - 1;
+        }
+    }
+
+    component_id_t BitsetColumn::GetSize() const
+    {
+        return _size;
+    }
+
+    component_id_t BitsetColumn::Count() const
+    {
+        // Independent sums let the compiler vectorize the population counts when the target supports it
+        component_id_t sums[4] = {};
+        size_t w = 0;
+        for (; w + 4 <= _words.size(); w += 4)
+        {
+            sums[0] += std::popcount(_words[w]);
+            sums[1] += std::popcount(_words[w + 1]);
+            sums[2] += std::popcount(_words[w + 2]);
+            sums[3] += std::popcount(_words[w + 3]);
+        }
+        for (; w < _words.size(); w++)
+        {
+            sums[0] += std::popcount(_words[w]);
+        }
+        return sums[0] + sums[1] + sums[2] + sums[3];
+    }
+
+    bool BitsetColumn::Any() const
+    {
+        return std::any_of(_words.begin(), _words.end(), [](uint64_t word)
+                           { return word != 0; });
+    }
+
+    const std::vector<uint64_t> &BitsetColumn::GetWords() const
+    {
+        return _words;
+    }
+} // namespace railguard::core
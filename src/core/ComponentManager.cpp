@@ -1,6 +1,9 @@
+#include <algorithm>
 #include <cassert>
 #include <random>
 #include <iostream>
+#include <stdexcept>
+#include <utility>
 #include "../../include/core/ComponentManager.h"
 
 #define REQUIRED_FOUND_ALIVE_TO_END_GC 5
@@ -8,17 +11,22 @@
 namespace railguard::core
 {
 
-    ComponentManager::ComponentManager(const component_id_t defaultComponentCapacity)
+    template <typename Storage>
+    BasicComponentManager<Storage>::BasicComponentManager(const component_id_t defaultComponentCapacity)
     {
         // Pre allocate the given size
         _entities.reserve(defaultComponentCapacity);
+        _changeVersions.reserve(defaultComponentCapacity);
         _entityLookUpMap.reserve(defaultComponentCapacity);
     }
 
-    Match ComponentManager::RegisterComponent(const Entity &entity)
+    template <typename Storage>
+    Match BasicComponentManager<Storage>::RegisterComponent(const Entity &entity)
     {
         // Add the entity in the list
         _entities.push_back(entity);
+        // A new component is a change, so that it is included in the next deltas
+        _changeVersions.push_back(_version);
         // Store the index of the new variable + 1
         // + 1 because the maps returns 0 if a value does not exist in the map
         // Thus, we reserve 0 for the "no entity" case
@@ -28,28 +36,98 @@ namespace railguard::core
         return Match(_entities.size());
     }
 
-    const Match ComponentManager::FindComponentOfEntity(const Entity &entity)
+    template <typename Storage>
+    const Match BasicComponentManager<Storage>::FindComponentOfEntity(const Entity &entity)
     {
         component_id_t index = _entityLookUpMap[entity.eid];
         return Match(index);
     }
 
-    const Entity ComponentManager::GetCorrespondingEntity(const Match &match)
+    template <typename Storage>
+    const Entity BasicComponentManager<Storage>::GetCorrespondingEntity(const Match &match) const
     {
         return _entities[match.GetIndex()];
     }
 
-    void ComponentManager::DestroyComponent(const Match &match)
+    template <typename Storage>
+    component_id_t BasicComponentManager<Storage>::GetComponentCount() const
+    {
+        return _entities.size();
+    }
+
+    template <typename Storage>
+    void BasicComponentManager<Storage>::ReorderComponents(const std::vector<component_id_t> &newOrder)
+    {
+        assert(newOrder.size() == _entities.size());
+
+        ApplyOrder(_entities, newOrder, _reorderScratch);
+        ApplyOrder(_changeVersions, newOrder, _reorderScratch);
+        for (component_id_t i = 0; i < _entities.size(); i++)
+        {
+            _entityLookUpMap[_entities[i].eid] = i + 1;
+        }
+    }
+
+    template <typename Storage>
+    void BasicComponentManager<Storage>::DestroyComponentInOrder(component_id_t index, component_id_t movedCount)
+    {
+        assert(index + movedCount < _entities.size());
+
+        // Remove the match from the lookup map
+        _entityLookUpMap.erase(_entities[index].eid);
+        // Remember it, so that the deltas can include it
+        _destroyedComponents.emplace_back(_version, _entities[index]);
+
+        EraseInOrder(_entities, index, movedCount);
+        EraseInOrder(_changeVersions, index, movedCount);
+
+        // Every component after the destroyed one moved
+        for (component_id_t i = index; i < _entities.size(); i++)
+        {
+            _entityLookUpMap[_entities[i].eid] = i + 1;
+        }
+    }
+
+    template <typename Storage>
+    void BasicComponentManager<Storage>::SaveEntities(SnapshotWriter &writer, uint32_t tag) const
+    {
+        writer.AddColumn(tag, SNAPSHOT_ENTITIES_COLUMN, _entities);
+    }
+
+    template <typename Storage>
+    void BasicComponentManager<Storage>::LoadEntities(const Snapshot &snapshot, uint32_t tag)
+    {
+        snapshot.ReadColumn(tag, SNAPSHOT_ENTITIES_COLUMN, _entities);
+
+        // The map can't be stored in the file, since its layout depends on the standard library
+        _entityLookUpMap.clear();
+        _entityLookUpMap.reserve(_entities.size());
+        for (component_id_t i = 0; i < _entities.size(); i++)
+        {
+            _entityLookUpMap[_entities[i].eid] = i + 1;
+        }
+
+        // Everything changed: previous deltas don't apply anymore. A client that loads the same snapshot is at the closed version.
+        _changeVersions.assign(_entities.size(), _version);
+        _destroyedComponents.clear();
+        _historyStart = CloseVersion();
+    }
+
+    template <typename Storage>
+    void BasicComponentManager<Storage>::DestroyComponent(const Match &match)
     {
         component_id_t index = match.GetIndex();
         DestroyComponent(index);
     }
-    void ComponentManager::DestroyComponent(component_id_t index)
+    template <typename Storage>
+    void BasicComponentManager<Storage>::DestroyComponent(component_id_t index)
     {
         assert(index < _entities.size());
 
         // Remove the match from the lookup map
         _entityLookUpMap.erase(_entities[index].eid);
+        // Remember it, so that the deltas can include it
+        _destroyedComponents.emplace_back(_version, _entities[index]);
 
         // Remove the component data when it is not at the end
         if (index < _entities.size() - 1)
@@ -57,14 +135,17 @@ namespace railguard::core
             // To keep everything tightly packed, we move the last element to the deleted slot
             auto movedEntity = _entities[_entities.size() - 1];
             _entities[index] = movedEntity;
+            // Moving a component is not a change: deltas identify components by entity
+            _changeVersions[index] = _changeVersions[_changeVersions.size() - 1];
             // Update the map for the updated index
-            _entityLookUpMap[movedEntity.eid] = index;
+            _entityLookUpMap[movedEntity.eid] = index + 1;
         }
         _entities.pop_back();
-
+        _changeVersions.pop_back();
     }
 
-    void ComponentManager::RunGarbageCollection(const EntityManager &em)
+    template <typename Storage>
+    void BasicComponentManager<Storage>::RunGarbageCollection(const EntityManager &em)
     {
         uint8_t foundAliveInARow = 0;
 
@@ -89,4 +170,97 @@ namespace railguard::core
         }
     }
 
+    template <typename Storage>
+    uint64_t BasicComponentManager<Storage>::CloseVersion()
+    {
+        return _version++;
+    }
+
+    template <typename Storage>
+    uint64_t BasicComponentManager<Storage>::GetClosedVersion() const
+    {
+        return _version - 1;
+    }
+
+    template <typename Storage>
+    void BasicComponentManager<Storage>::DiscardHistory(uint64_t version)
+    {
+        const auto end = std::find_if(_destroyedComponents.begin(), _destroyedComponents.end(),
+                                      [version](const auto &destroyed) { return destroyed.first > version; });
+        _destroyedComponents.erase(_destroyedComponents.begin(), end);
+        _historyStart = std::max(_historyStart, version);
+    }
+
+    template <typename Storage>
+    void BasicComponentManager<Storage>::WriteDeltaHeader(DeltaWriter &writer, uint32_t tag, uint64_t fromVersion, std::vector<component_id_t> &changed) const
+    {
+        if (fromVersion < _historyStart)
+        {
+            throw std::runtime_error("The history of the manager doesn't go back to the requested version. A full snapshot is needed.");
+        }
+
+        // The delta contains the current state, so it includes the changes of the open version.
+        // They will be sent again in the next delta, which is harmless since applying a delta is idempotent.
+        changed.clear();
+        for (component_id_t i = 0; i < _changeVersions.size(); i++)
+        {
+            if (_changeVersions[i] > fromVersion)
+            {
+                changed.push_back(i);
+            }
+        }
+        const auto firstDestroyed = std::find_if(_destroyedComponents.begin(), _destroyedComponents.end(),
+                                                 [fromVersion](const auto &destroyed) { return destroyed.first > fromVersion; });
+        const auto destroyedCount = static_cast<uint64_t>(_destroyedComponents.end() - firstDestroyed);
+
+        writer.Write(tag);
+        writer.Write(fromVersion);
+        writer.Write(GetClosedVersion());
+        // Destroyed entities come first, so that an entity that was destroyed and then got a new component ends up with it
+        writer.Write(destroyedCount);
+        writer.WriteColumn<eid_t>(destroyedCount, [&](size_t i) { return firstDestroyed[static_cast<ptrdiff_t>(i)].second.eid; });
+        writer.Write(static_cast<uint64_t>(changed.size()));
+        writer.WriteColumn<eid_t>(changed.size(), [&](size_t i) { return _entities[changed[i]].eid; });
+    }
+
+    template <typename Storage>
+    uint64_t BasicComponentManager<Storage>::ReadDeltaHeader(DeltaReader &reader, uint32_t tag, uint64_t appliedVersion, std::vector<Entity> &changed)
+    {
+        if (reader.Read<uint32_t>() != tag)
+        {
+            throw std::runtime_error("The delta was written by another manager.");
+        }
+        const auto fromVersion = reader.Read<uint64_t>();
+        const auto toVersion = reader.Read<uint64_t>();
+        // Check before changing anything, so that a rejected delta leaves the manager as it was
+        if (fromVersion > appliedVersion)
+        {
+            throw std::runtime_error("The delta starts after the version of the manager: the changes in between would be lost.");
+        }
+        if (toVersion < appliedVersion)
+        {
+            throw std::runtime_error("The delta is older than the version of the manager.");
+        }
+
+        const auto destroyedCount = reader.Read<uint64_t>();
+        reader.ReadColumn<eid_t>(destroyedCount, [this](size_t, eid_t eid)
+                                 {
+                                     // The component may never have been received, if it was created and destroyed between two deltas
+                                     const auto it = _entityLookUpMap.find(eid);
+                                     if (it != _entityLookUpMap.end())
+                                     {
+                                         this->DestroyComponent(it->second - 1);
+                                     }
+                                 });
+
+        const auto changedCount = reader.Read<uint64_t>();
+        changed.clear();
+        reader.ReadColumn<eid_t>(changedCount, [&changed](size_t, eid_t eid) { changed.emplace_back(eid); });
+        return toVersion;
+    }
+
+    template class BasicComponentManager<HeapStorage>;
+    template class BasicComponentManager<PagedStorage<false>>;
+    template class BasicComponentManager<PagedStorage<true>>;
+
 } // namespace core
@@ -1,22 +1,60 @@
 #include "../../include/core/Engine.h"
 #include <iostream>
 #include <functional>
+#include <stdexcept>
 
 #define DEFAULT_ENTITY_MANAGER_CAPACITY 1000
+#define DEFAULT_TRANSFORM_MANAGER_CAPACITY 1000
 
 namespace railguard::core
 {
-    Engine::Engine() : _entityManager(DEFAULT_ENTITY_MANAGER_CAPACITY),
-                       _windowManager(500, 500, "Railguard"),
-                       _renderer(_windowManager),
-                       _deltaTime{0}
+    namespace
     {
+        std::optional<WindowManager> CreateWindowManager(const init::EngineInitInfo &initInfo)
+        {
+            if (initInfo.headless)
+            {
+                return std::nullopt;
+            }
+            return std::make_optional<WindowManager>(static_cast<int>(initInfo.extent.width), static_cast<int>(initInfo.extent.height), "Railguard");
+        }
+
+        rendering::init::RendererInitInfo GetRendererInitInfo(const std::optional<WindowManager> &windowManager, JobPool &jobPool, const init::EngineInitInfo &initInfo)
+        {
+            return rendering::init::RendererInitInfo{
+                .windowManager = windowManager.has_value() ? &windowManager.value() : nullptr,
+                .headlessExtent = initInfo.extent,
+                .readbackDirectory = initInfo.readbackDirectory,
+                .jobPool = &jobPool,
+            };
+        }
+    } // namespace
+
+    Engine::Engine() : Engine(init::EngineInitInfo{})
+    {
+    }
+
+    Engine::Engine(const init::EngineInitInfo &initInfo)
+        : _entityManager(DEFAULT_ENTITY_MANAGER_CAPACITY),
+          _jobPool(),
+          _transformManager(DEFAULT_TRANSFORM_MANAGER_CAPACITY),
+          _windowManager(CreateWindowManager(initInfo)),
+          _renderer(GetRendererInitInfo(_windowManager, _jobPool, initInfo)),
+          _deltaTime{0},
+          _frameCount(initInfo.frameCount)
+    {
+        // Test
+        _triangleEffect = _renderer.CreateShaderEffect({"triangle.vert", "triangle.frag"});
+
         std::cout << "Engine initialized successfully.\n";
     }
 
     Engine::~Engine()
     {
-        _windowManager.DestroyWindow();
+        if (_windowManager.has_value())
+        {
+            _windowManager->DestroyWindow();
+        }
         std::cout << "Engine destructed successfully.\n";
     }
 
@@ -25,23 +63,79 @@ namespace railguard::core
         // Init variables
         bool shouldQuit = false;
         uint64_t currentFrameTime = 0;
+        uint64_t drawnFrames = 0;
 
         // Main loop
         while (!shouldQuit)
         {
             // Update deltatime
             uint64_t previousFrameTime = currentFrameTime;
-            currentFrameTime = _windowManager.GetPerformanceCounter();
+            currentFrameTime = WindowManager::GetPerformanceCounter();
             _deltaTime = static_cast<double_t>(currentFrameTime - previousFrameTime) /
-                         static_cast<double_t>(_windowManager.GetPerformanceFrequency());
+                         static_cast<double_t>(WindowManager::GetPerformanceFrequency());
 
             // Handle window events
-            shouldQuit = _windowManager.HandleEvents();
+            if (_windowManager.has_value())
+            {
+                shouldQuit = _windowManager->HandleEvents();
+            }
+
+            // Propagate the transforms that changed during this frame
+            _transformManager.UpdateWorldMatrices(_jobPool);
+            // Each frame is a version of the transforms, from which deltas can be written
+            _transformManager.CloseVersion();
+
+            // Test
+            _renderer.SubmitDraw(rendering::structs::DrawItem{
+                .pass = _renderer.GetMainPass(),
+                .effect = _triangleEffect,
+                .elementCount = 3,
+            });
 
             // Render objects
             _renderer.Draw();
-            
+
+            // Stop after the requested number of frames
+            drawnFrames++;
+            if (_frameCount != 0 && drawnFrames >= _frameCount)
+            {
+                shouldQuit = true;
+            }
+        }
+    }
+
+    void Engine::SaveSnapshot(const std::string &filePath) const
+    {
+        SnapshotWriter writer;
+        _entityManager.SaveSnapshot(writer);
+        _transformManager.SaveSnapshot(writer);
+        _renderer.GetSwapchainCameraManager().SaveSnapshot(writer);
+        writer.Write(filePath);
+    }
+
+    void Engine::LoadSnapshot(const std::string &filePath)
+    {
+        const Snapshot snapshot(filePath);
+        _entityManager.LoadSnapshot(snapshot);
+        _transformManager.LoadSnapshot(snapshot);
+        _renderer.GetSwapchainCameraManager().LoadSnapshot(snapshot);
+    }
+
+    void Engine::WriteDelta(DeltaWriter &writer, uint64_t fromVersion) const
+    {
+        // Cameras are bound to the swapchains of each engine, so they are not replicated
+        _transformManager.WriteDelta(writer, fromVersion);
+    }
+
+    uint64_t Engine::ApplyDelta(std::span<const std::byte> delta, uint64_t appliedVersion)
+    {
+        DeltaReader reader(delta);
+        const auto version = _transformManager.ApplyDelta(reader, appliedVersion);
+        if (!reader.IsAtEnd())
+        {
+            throw std::runtime_error("The delta contains unexpected data.");
         }
+        return version;
     }
 
 } // namespace core
@@ -2,9 +2,19 @@
 #include <cassert>
 
 #define MIN_FREED_INDICES_BEFORE_REUSE 1024
+#define SNAPSHOT_TAG structs::SnapshotTag("ENTS")
 
 namespace railguard::core
 {
+    namespace
+    {
+        // Columns of the entity manager in snapshots
+        enum SnapshotColumns : uint32_t
+        {
+            LOOKUP_LIST_COLUMN = 0,
+            FREED_INDICES_COLUMN = 1,
+        };
+    } // namespace
 
     EntityManager::EntityManager(size_t defaultCapacity)
     {
@@ -58,4 +68,18 @@ namespace railguard::core
         return _lookupList[entity.GetIndex()] == entity.GetUnique();
     }
 
+    void EntityManager::SaveSnapshot(SnapshotWriter &writer) const
+    {
+        writer.AddColumn(SNAPSHOT_TAG, LOOKUP_LIST_COLUMN, _lookupList);
+        // The deque is not contiguous, so it needs to be copied
+        writer.AddColumnCopy(SNAPSHOT_TAG, FREED_INDICES_COLUMN, _freedIndices);
+    }
+
+    void EntityManager::LoadSnapshot(const Snapshot &snapshot)
+    {
+        snapshot.ReadColumn(SNAPSHOT_TAG, LOOKUP_LIST_COLUMN, _lookupList);
+        const auto freedIndices = snapshot.GetColumn<eid_t>(SNAPSHOT_TAG, FREED_INDICES_COLUMN);
+        _freedIndices.assign(freedIndices.begin(), freedIndices.end());
+    }
+
 } // namespace core
\ No newline at end of file
@@ -0,0 +1,136 @@
+#include "../../include/core/JobPool.h"
+#include <algorithm>
+
+namespace railguard::core
+{
+    JobPool::JobPool(uint32_t threadCount)
+    {
+        if (threadCount == 0)
+        {
+            // The calling thread also runs jobs in Wait, so leave a hardware thread for it
+            threadCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+        }
+
+        _workers.reserve(threadCount);
+        for (uint32_t i = 0; i < threadCount; i++)
+        {
+            _workers.emplace_back(&JobPool::RunWorker, this);
+        }
+    }
+
+    JobPool::~JobPool()
+    {
+        {
+            std::lock_guard lock(_mutex);
+            _stopping = true;
+        }
+        _jobAvailable.notify_all();
+
+        for (auto &worker : _workers)
+        {
+            worker.join();
+        }
+    }
+
+    void JobPool::RunWorker()
+    {
+        while (true)
+        {
+            std::function<void()> job;
+            {
+                std::unique_lock lock(_mutex);
+                _jobAvailable.wait(lock, [this] { return _stopping || !_jobs.empty(); });
+
+                if (_jobs.empty())
+                {
+                    // Stopping and nothing left to do
+                    return;
+                }
+                job = std::move(_jobs.front());
+                _jobs.pop_front();
+            }
+
+            job();
+
+            std::lock_guard lock(_mutex);
+            if (--_pendingJobs == 0)
+            {
+                _jobsFinished.notify_all();
+            }
+        }
+    }
+
+    bool JobPool::TryRunJob()
+    {
+        std::function<void()> job;
+        {
+            std::lock_guard lock(_mutex);
+            if (_jobs.empty())
+            {
+                return false;
+            }
+            job = std::move(_jobs.front());
+            _jobs.pop_front();
+        }
+
+        job();
+
+        std::lock_guard lock(_mutex);
+        if (--_pendingJobs == 0)
+        {
+            _jobsFinished.notify_all();
+        }
+        return true;
+    }
+
+    void JobPool::Submit(std::function<void()> job)
+    {
+        {
+            std::lock_guard lock(_mutex);
+            _jobs.push_back(std::move(job));
+            _pendingJobs++;
+        }
+        _jobAvailable.notify_one();
+    }
+
+    void JobPool::Wait()
+    {
+        // Help the workers while there are queued jobs
+        while (TryRunJob())
+        {
+        }
+
+        // Then wait for the ones that are still running
+        std::unique_lock lock(_mutex);
+        _jobsFinished.wait(lock, [this] { return _pendingJobs == 0; });
+    }
+
+    void JobPool::ParallelFor(size_t count, size_t minBatchSize, const std::function<void(size_t begin, size_t end)> &function)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+
+        const size_t batchCount = std::clamp<size_t>(count / std::max<size_t>(minBatchSize, 1), 1, GetConcurrency());
+        if (batchCount == 1)
+        {
+            // Not worth the synchronization
+            function(0, count);
+            return;
+        }
+
+        const size_t batchSize = (count + batchCount - 1) / batchCount;
+        for (size_t begin = 0; begin < count; begin += batchSize)
+        {
+            const size_t end = std::min(begin + batchSize, count);
+            Submit([&function, begin, end] { function(begin, end); });
+        }
+        Wait();
+    }
+
+    uint32_t JobPool::GetConcurrency() const
+    {
+        return static_cast<uint32_t>(_workers.size()) + 1;
+    }
+} // namespace railguard::core
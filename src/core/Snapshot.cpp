@@ -0,0 +1,127 @@
+#include "../../include/core/Snapshot.h"
+#include <fstream>
+
+namespace railguard::core
+{
+    namespace
+    {
+        uint64_t AlignUp(uint64_t value)
+        {
+            return (value + SNAPSHOT_FILE_ALIGNMENT - 1) / SNAPSHOT_FILE_ALIGNMENT * SNAPSHOT_FILE_ALIGNMENT;
+        }
+    } // namespace
+
+    // === Writer ===
+
+    void SnapshotWriter::Write(const std::string &filePath) const
+    {
+        // Place the columns after the header and the column table
+        std::vector<structs::SnapshotColumn> table;
+        table.reserve(_columns.size());
+        uint64_t offset = sizeof(structs::SnapshotFileHeader) + _columns.size() * sizeof(structs::SnapshotColumn);
+        for (const auto &column : _columns)
+        {
+            offset = AlignUp(offset);
+            table.push_back(structs::SnapshotColumn{
+                .tag = column.tag,
+                .column = column.column,
+                .elementSize = column.elementSize,
+                .padding = 0,
+                .elementCount = column.elementCount,
+                .offset = offset,
+            });
+            offset += column.elementCount * column.elementSize;
+        }
+
+        const structs::SnapshotFileHeader header{
+            .magic = SNAPSHOT_FILE_MAGIC,
+            .version = SNAPSHOT_FILE_VERSION,
+            .columnCount = static_cast<uint32_t>(_columns.size()),
+            .padding = 0,
+            .fileSize = offset,
+        };
+
+        std::ofstream stream(filePath, std::ios::binary | std::ios::trunc);
+        stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        stream.write(reinterpret_cast<const char *>(table.data()), static_cast<std::streamsize>(table.size() * sizeof(structs::SnapshotColumn)));
+
+        // Each column is written in one call, straight from the manager
+        const char zeros[SNAPSHOT_FILE_ALIGNMENT] = {};
+        uint64_t written = sizeof(header) + table.size() * sizeof(structs::SnapshotColumn);
+        for (size_t i = 0; i < _columns.size(); i++)
+        {
+            stream.write(zeros, static_cast<std::streamsize>(table[i].offset - written));
+            const uint64_t size = _columns[i].elementCount * _columns[i].elementSize;
+            stream.write(reinterpret_cast<const char *>(_columns[i].data), static_cast<std::streamsize>(size));
+            written = table[i].offset + size;
+        }
+
+        if (!stream)
+        {
+            throw std::runtime_error("Unable to write \"" + filePath + "\".");
+        }
+    }
+
+    // === Reader ===
+
+    Snapshot::Snapshot(const std::string &filePath) : _file(filePath)
+    {
+        const auto *data = static_cast<const std::byte *>(_file.GetData());
+        const auto *header = reinterpret_cast<const structs::SnapshotFileHeader *>(data);
+
+        // Check that the file is valid before trusting its offsets
+        if (_file.GetSize() < sizeof(structs::SnapshotFileHeader) || header->magic != SNAPSHOT_FILE_MAGIC)
+        {
+            throw std::runtime_error("\"" + filePath + "\" is not a snapshot file.");
+        }
+        if (header->version != SNAPSHOT_FILE_VERSION)
+        {
+            throw std::runtime_error("The snapshot \"" + filePath + "\" was created with another version of the engine.");
+        }
+        if (header->fileSize != _file.GetSize() ||
+            _file.GetSize() < sizeof(structs::SnapshotFileHeader) + uint64_t{header->columnCount} * sizeof(structs::SnapshotColumn))
+        {
+            throw std::runtime_error("The snapshot \"" + filePath + "\" is truncated.");
+        }
+
+        _columns = reinterpret_cast<const structs::SnapshotColumn *>(data + sizeof(structs::SnapshotFileHeader));
+        _columnCount = header->columnCount;
+
+        for (uint32_t i = 0; i < _columnCount; i++)
+        {
+            const auto &column = _columns[i];
+            if (column.offset % SNAPSHOT_FILE_ALIGNMENT != 0 || column.offset > _file.GetSize() ||
+                (column.elementSize != 0 && column.elementCount > (_file.GetSize() - column.offset) / column.elementSize))
+            {
+                throw std::runtime_error("The snapshot \"" + filePath + "\" is corrupted.");
+            }
+        }
+    }
+
+    const structs::SnapshotColumn *Snapshot::FindColumn(uint32_t tag, uint32_t column) const
+    {
+        // There are a few columns per manager, a linear search is enough
+        for (uint32_t i = 0; i < _columnCount; i++)
+        {
+            if (_columns[i].tag == tag && _columns[i].column == column)
+            {
+                return &_columns[i];
+            }
+        }
+        return nullptr;
+    }
+
+    const std::byte *Snapshot::GetColumnData(const structs::SnapshotColumn &column, size_t elementSize) const
+    {
+        if (column.elementSize != elementSize)
+        {
+            throw std::runtime_error("A column of the snapshot was written with another layout.");
+        }
+        return static_cast<const std::byte *>(_file.GetData()) + column.offset;
+    }
+
+    bool Snapshot::HasColumn(uint32_t tag, uint32_t column) const
+    {
+        return FindColumn(tag, column) != nullptr;
+    }
+} // namespace railguard::core
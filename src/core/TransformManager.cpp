@@ -0,0 +1,509 @@
+#include "../../include/core/TransformManager.h"
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <utility>
+
+// Below this number of transforms, splitting the propagation in jobs costs more than it saves
+#define MIN_TRANSFORMS_PER_JOB 256
+// Identifies the transform manager in snapshots and deltas
+#define MANAGER_TAG structs::SnapshotTag("TRFM")
+
+namespace railguard::core
+{
+    namespace
+    {
+        // Columns of the transform manager in snapshots. The entities are in SNAPSHOT_ENTITIES_COLUMN.
+        enum SnapshotColumns : uint32_t
+        {
+            POSITIONS_COLUMN = 1,
+            ROTATIONS_COLUMN = 2,
+            SCALES_COLUMN = 3,
+            PARENTS_COLUMN = 4,
+            SUBTREE_SIZES_COLUMN = 5,
+            WORLD_MATRICES_COLUMN = 6,
+            DIRTY_COLUMN = 7,
+            // hierarchyChanged and hasDirtyComponents
+            FLAGS_COLUMN = 8,
+        };
+
+        // glm::vec3 is padded to 16 bytes, deltas only send the components
+        struct PackedVec3
+        {
+            float x;
+            float y;
+            float z;
+        };
+
+        // Parent written in deltas for the roots
+        constexpr eid_t NO_PARENT_EID = UINT64_MAX;
+    } // namespace
+
+    TransformManager::TransformManager(const component_id_t defaultComponentCapacity) : BasicComponentManager(defaultComponentCapacity)
+    {
+        _positions.reserve(defaultComponentCapacity);
+        _rotations.reserve(defaultComponentCapacity);
+        _scales.reserve(defaultComponentCapacity);
+        _parents.reserve(defaultComponentCapacity);
+        _subtreeSizes.reserve(defaultComponentCapacity);
+        _worldMatrices.reserve(defaultComponentCapacity);
+        _dirty.reserve(defaultComponentCapacity);
+    }
+
+    component_id_t TransformManager::FindParentIndex(const std::optional<Entity> &parent)
+    {
+        if (!parent.has_value())
+        {
+            return NO_PARENT;
+        }
+
+        auto match = FindComponentOfEntity(parent.value());
+        if (!match.HasResult())
+        {
+            throw std::runtime_error("The parent entity does not have a transform component.");
+        }
+        return match.GetIndex();
+    }
+
+    void TransformManager::MarkDirty(component_id_t index)
+    {
+        _dirty[index] = true;
+        _hasDirtyComponents = true;
+        // The local transform or the parent changed, so it must be replicated
+        MarkChanged(index);
+    }
+
+    Match TransformManager::CreateComponent(const Entity &entity, const init::TransformInitInfo &initInfo)
+    {
+        const component_id_t index = _positions.size();
+        const component_id_t parentIndex = FindParentIndex(initInfo.parent);
+
+        // Create a new transform
+        _positions.push_back(initInfo.position);
+        _rotations.push_back(initInfo.rotation);
+        _scales.push_back(initInfo.scale);
+        _parents.push_back(parentIndex);
+        _subtreeSizes.push_back(1);
+        _worldMatrices.emplace_back(1.0f);
+        _dirty.push_back(true);
+        _hasDirtyComponents = true;
+
+        // Roots can be appended without breaking the order
+        if (parentIndex != NO_PARENT)
+        {
+            if (!_hierarchyChanged && parentIndex + _subtreeSizes[parentIndex] == index)
+            {
+                // The subtree of the parent ends at the end of the vectors, and so does the subtree of its ancestors.
+                // This is the common case when a hierarchy is created from top to bottom: simply extend them.
+                for (auto ancestor = parentIndex; ancestor != NO_PARENT; ancestor = _parents[ancestor])
+                {
+                    _subtreeSizes[ancestor]++;
+                }
+            }
+            else
+            {
+                _hierarchyChanged = true;
+            }
+        }
+
+        // Run boilerplate for entity management
+        return this->RegisterComponent(entity);
+    }
+
+    void TransformManager::DestroyComponent(component_id_t index)
+    {
+        // When the hierarchy is sorted, the descendants are in [index + 1, index + subtreeSize), and no component before
+        // the destroyed one can reference it
+        const bool sorted = !_hierarchyChanged;
+        const component_id_t subtreeSize = sorted ? _subtreeSizes[index] : 1;
+        // The children become roots. If the destroyed component is not a root, their subtrees are in the middle of the subtree
+        // of its root: move them to the end, where they are valid roots.
+        const component_id_t movedCount = sorted && _parents[index] != NO_PARENT ? subtreeSize - 1 : 0;
+        if (sorted)
+        {
+            for (auto ancestor = _parents[index]; ancestor != NO_PARENT; ancestor = _parents[ancestor])
+            {
+                _subtreeSizes[ancestor] -= subtreeSize;
+            }
+        }
+
+        // Run boilerplate deletion
+        BasicComponentManager::DestroyComponentInOrder(index, movedCount);
+        EraseInOrder(_positions, index, movedCount);
+        EraseInOrder(_rotations, index, movedCount);
+        EraseInOrder(_scales, index, movedCount);
+        EraseInOrder(_parents, index, movedCount);
+        EraseInOrder(_subtreeSizes, index, movedCount);
+        EraseInOrder(_worldMatrices, index, movedCount);
+        EraseInOrder(_dirty, index, movedCount);
+
+        // Components after the destroyed one moved by one, or by the size of the subtree if its descendants moved to the end
+        const component_id_t count = _parents.size();
+        const component_id_t subtreeEnd = index + subtreeSize;
+        for (component_id_t i = sorted ? index : 0; i < count; i++)
+        {
+            const auto parent = _parents[i];
+            if (parent == index)
+            {
+                // Detach the children
+                _parents[i] = NO_PARENT;
+                MarkDirty(i);
+            }
+            else if (parent != NO_PARENT && parent > index)
+            {
+                if (parent >= subtreeEnd)
+                {
+                    _parents[i] = parent - 1 - movedCount;
+                }
+                else
+                {
+                    _parents[i] = movedCount > 0 ? count - movedCount + (parent - index - 1) : parent - 1;
+                }
+            }
+        }
+    }
+
+    void TransformManager::SortHierarchy()
+    {
+        const component_id_t count = _parents.size();
+
+        // Build the list of children of each component as a linked list
+        // Children are prepended, so each list is in decreasing index order
+        auto &firstChild = _firstChildren;
+        auto &nextSibling = _nextSiblings;
+        firstChild.assign(count, NO_PARENT);
+        nextSibling.assign(count, NO_PARENT);
+        for (component_id_t i = 0; i < count; i++)
+        {
+            const auto parent = _parents[i];
+            if (parent != NO_PARENT)
+            {
+                nextSibling[i] = firstChild[parent];
+                firstChild[parent] = i;
+            }
+        }
+
+        // Depth-first traversal from each root
+        // Children are pushed in decreasing order, so that they are popped in their previous order
+        auto &newOrder = _newOrder;
+        newOrder.clear();
+        auto &stack = _sortStack;
+        for (component_id_t root = 0; root < count; root++)
+        {
+            if (_parents[root] != NO_PARENT)
+            {
+                continue;
+            }
+
+            stack.push_back(root);
+            while (!stack.empty())
+            {
+                const auto current = stack.back();
+                stack.pop_back();
+                newOrder.push_back(current);
+
+                for (auto child = firstChild[current]; child != NO_PARENT; child = nextSibling[child])
+                {
+                    stack.push_back(child);
+                }
+            }
+        }
+
+        // Remap the parents to the new indices
+        auto &newIndices = _newIndices;
+        newIndices.resize(count);
+        for (component_id_t i = 0; i < count; i++)
+        {
+            newIndices[newOrder[i]] = i;
+        }
+        for (component_id_t i = 0; i < count; i++)
+        {
+            const auto oldParent = _parents[i];
+            if (oldParent != NO_PARENT)
+            {
+                _parents[i] = newIndices[oldParent];
+            }
+        }
+
+        // Move the data
+        BasicComponentManager::ReorderComponents(newOrder);
+        ApplyOrder(_parents, newOrder, _orderScratch);
+        ApplyOrder(_positions, newOrder, _orderScratch);
+        ApplyOrder(_rotations, newOrder, _orderScratch);
+        ApplyOrder(_scales, newOrder, _orderScratch);
+        ApplyOrder(_worldMatrices, newOrder, _orderScratch);
+        ApplyOrder(_dirty, newOrder, _orderScratch);
+
+        // Children are after their parent, so iterating backwards accumulates the sizes from the leaves to the roots
+        std::fill(_subtreeSizes.begin(), _subtreeSizes.end(), 1);
+        for (component_id_t i = count; i-- > 0;)
+        {
+            if (_parents[i] != NO_PARENT)
+            {
+                _subtreeSizes[_parents[i]] += _subtreeSizes[i];
+            }
+        }
+
+        _hierarchyChanged = false;
+    }
+
+    void TransformManager::UpdateRange(component_id_t begin, component_id_t end)
+    {
+        for (component_id_t i = begin; i < end; i++)
+        {
+            const auto parent = _parents[i];
+
+            // The parent was updated just before, so its flag tells if its matrix changed
+            if (parent != NO_PARENT && _dirty[parent])
+            {
+                _dirty[i] = true;
+            }
+            if (!_dirty[i])
+            {
+                continue;
+            }
+
+            // Local matrix = translation * rotation * scale
+            glm::mat4 local = glm::mat4_cast(_rotations[i]);
+            local[0] *= _scales[i].x;
+            local[1] *= _scales[i].y;
+            local[2] *= _scales[i].z;
+            local[3] = glm::vec4(_positions[i], 1.0f);
+
+            _worldMatrices[i] = parent == NO_PARENT ? local : _worldMatrices[parent] * local;
+        }
+
+        // Clear the flags only once the range is done, since the children read the flags of their parent
+        std::fill(_dirty.begin() + static_cast<ptrdiff_t>(begin), _dirty.begin() + static_cast<ptrdiff_t>(end), false);
+    }
+
+    void TransformManager::UpdateWorldMatrices(JobPool &jobPool)
+    {
+        if (_hierarchyChanged)
+        {
+            SortHierarchy();
+        }
+        if (!_hasDirtyComponents)
+        {
+            return;
+        }
+
+        // Split the components in ranges of whole root subtrees, so that a parent is always updated in the same job as its children
+        const component_id_t count = _parents.size();
+        const component_id_t targetRangeSize = std::max<component_id_t>(count / jobPool.GetConcurrency(), MIN_TRANSFORMS_PER_JOB);
+        auto &ranges = _updateRanges;
+        ranges.clear();
+        component_id_t rangeBegin = 0;
+        for (component_id_t root = 0; root < count; root += _subtreeSizes[root])
+        {
+            const component_id_t rangeEnd = root + _subtreeSizes[root];
+            if (rangeEnd - rangeBegin >= targetRangeSize)
+            {
+                ranges.emplace_back(rangeBegin, rangeEnd);
+                rangeBegin = rangeEnd;
+            }
+        }
+        if (rangeBegin < count)
+        {
+            ranges.emplace_back(rangeBegin, count);
+        }
+
+        jobPool.ParallelFor(ranges.size(), 1, [this, &ranges](size_t begin, size_t end)
+                            {
+                                for (size_t r = begin; r < end; r++)
+                                {
+                                    UpdateRange(ranges[r].first, ranges[r].second);
+                                }
+                            });
+
+        _hasDirtyComponents = false;
+    }
+
+    // ===== GETTERS =====
+
+    const glm::vec3 &TransformManager::GetLocalPosition(const Match &match) const
+    {
+        return _positions[match.GetIndex()];
+    }
+
+    const glm::quat &TransformManager::GetLocalRotation(const Match &match) const
+    {
+        return _rotations[match.GetIndex()];
+    }
+
+    const glm::vec3 &TransformManager::GetLocalScale(const Match &match) const
+    {
+        return _scales[match.GetIndex()];
+    }
+
+    const glm::mat4 &TransformManager::GetWorldMatrix(const Match &match) const
+    {
+        return _worldMatrices[match.GetIndex()];
+    }
+
+    std::optional<Entity> TransformManager::GetParent(const Match &match) const
+    {
+        const auto parent = _parents[match.GetIndex()];
+        if (parent == NO_PARENT)
+        {
+            return std::nullopt;
+        }
+        return GetCorrespondingEntity(Match(parent + 1));
+    }
+
+    // ===== SETTERS =====
+
+    void TransformManager::SetLocalPosition(const Match &match, const glm::vec3 &position)
+    {
+        const auto index = match.GetIndex();
+        _positions[index] = position;
+        MarkDirty(index);
+    }
+
+    void TransformManager::SetLocalRotation(const Match &match, const glm::quat &rotation)
+    {
+        const auto index = match.GetIndex();
+        _rotations[index] = rotation;
+        MarkDirty(index);
+    }
+
+    void TransformManager::SetLocalScale(const Match &match, const glm::vec3 &scale)
+    {
+        const auto index = match.GetIndex();
+        _scales[index] = scale;
+        MarkDirty(index);
+    }
+
+    void TransformManager::SetParent(const Match &match, const std::optional<Entity> &parent)
+    {
+        const auto index = match.GetIndex();
+        const auto parentIndex = FindParentIndex(parent);
+
+        // Check that the transform is not an ancestor of its new parent
+        for (auto ancestor = parentIndex; ancestor != NO_PARENT; ancestor = _parents[ancestor])
+        {
+            if (ancestor == index)
+            {
+                throw std::runtime_error("A transform cannot be attached to one of its descendants.");
+            }
+        }
+
+        if (_parents[index] != parentIndex)
+        {
+            _parents[index] = parentIndex;
+            _hierarchyChanged = true;
+            MarkDirty(index);
+        }
+    }
+
+    void TransformManager::SaveSnapshot(SnapshotWriter &writer) const
+    {
+        SaveEntities(writer, MANAGER_TAG);
+        writer.AddColumn(MANAGER_TAG, POSITIONS_COLUMN, _positions);
+        writer.AddColumn(MANAGER_TAG, ROTATIONS_COLUMN, _rotations);
+        writer.AddColumn(MANAGER_TAG, SCALES_COLUMN, _scales);
+        writer.AddColumn(MANAGER_TAG, PARENTS_COLUMN, _parents);
+        writer.AddColumn(MANAGER_TAG, SUBTREE_SIZES_COLUMN, _subtreeSizes);
+        writer.AddColumn(MANAGER_TAG, WORLD_MATRICES_COLUMN, _worldMatrices);
+        writer.AddColumn(MANAGER_TAG, DIRTY_COLUMN, _dirty);
+        const std::array<uint8_t, 2> flags = {_hierarchyChanged, _hasDirtyComponents};
+        writer.AddColumnCopy(MANAGER_TAG, FLAGS_COLUMN, flags);
+    }
+
+    void TransformManager::LoadSnapshot(const Snapshot &snapshot)
+    {
+        LoadEntities(snapshot, MANAGER_TAG);
+        snapshot.ReadColumn(MANAGER_TAG, POSITIONS_COLUMN, _positions);
+        snapshot.ReadColumn(MANAGER_TAG, ROTATIONS_COLUMN, _rotations);
+        snapshot.ReadColumn(MANAGER_TAG, SCALES_COLUMN, _scales);
+        snapshot.ReadColumn(MANAGER_TAG, PARENTS_COLUMN, _parents);
+        snapshot.ReadColumn(MANAGER_TAG, SUBTREE_SIZES_COLUMN, _subtreeSizes);
+        snapshot.ReadColumn(MANAGER_TAG, WORLD_MATRICES_COLUMN, _worldMatrices);
+        snapshot.ReadColumn(MANAGER_TAG, DIRTY_COLUMN, _dirty);
+        const auto flags = snapshot.GetColumn<uint8_t>(MANAGER_TAG, FLAGS_COLUMN);
+
+        const auto count = GetComponentCount();
+        if (_positions.size() != count || _rotations.size() != count || _scales.size() != count || _parents.size() != count ||
+            _subtreeSizes.size() != count || _worldMatrices.size() != count || _dirty.size() != count || flags.size() != 2)
+        {
+            throw std::runtime_error("The transforms of the snapshot are corrupted.");
+        }
+        _hierarchyChanged = flags[0];
+        _hasDirtyComponents = flags[1];
+    }
+
+    void TransformManager::WriteDelta(DeltaWriter &writer, uint64_t fromVersion) const
+    {
+        std::vector<component_id_t> changed;
+        WriteDeltaHeader(writer, MANAGER_TAG, fromVersion, changed);
+
+        // One column after the other, in the order of the changed entities
+        writer.WriteColumn<PackedVec3>(changed.size(), [&](size_t i)
+                                       {
+                                           const auto &position = _positions[changed[i]];
+                                           return PackedVec3{position.x, position.y, position.z};
+                                       });
+        writer.WriteColumn<glm::quat>(changed.size(), [&](size_t i) { return _rotations[changed[i]]; });
+        writer.WriteColumn<PackedVec3>(changed.size(), [&](size_t i)
+                                       {
+                                           const auto &scale = _scales[changed[i]];
+                                           return PackedVec3{scale.x, scale.y, scale.z};
+                                       });
+        // Indices differ between the engines, so parents are sent as entities
+        writer.WriteColumn<eid_t>(changed.size(), [&](size_t i)
+                                  {
+                                      const auto parent = _parents[changed[i]];
+                                      return parent == NO_PARENT ? NO_PARENT_EID : GetCorrespondingEntity(Match(parent + 1)).eid;
+                                  });
+    }
+
+    uint64_t TransformManager::ApplyDelta(DeltaReader &reader, uint64_t appliedVersion)
+    {
+        std::vector<Entity> changed;
+        const auto toVersion = ReadDeltaHeader(reader, MANAGER_TAG, appliedVersion, changed);
+
+        // Create the missing transforms first, so that parents can be found whatever their order in the delta.
+        // Creating components doesn't reorder them, so the indices stay valid until the end.
+        std::vector<component_id_t> indices;
+        indices.reserve(changed.size());
+        for (const auto &entity : changed)
+        {
+            auto match = FindComponentOfEntity(entity);
+            if (!match.HasResult())
+            {
+                match = CreateComponent(entity, init::TransformInitInfo{});
+            }
+            indices.push_back(match.GetIndex());
+        }
+
+        reader.ReadColumn<PackedVec3>(changed.size(), [this, &indices](size_t i, const PackedVec3 &position)
+                                      {
+                                          _positions[indices[i]] = glm::vec3(position.x, position.y, position.z);
+                                          MarkDirty(indices[i]);
+                                      });
+        reader.ReadColumn<glm::quat>(changed.size(), [this, &indices](size_t i, const glm::quat &rotation)
+                                     { _rotations[indices[i]] = rotation; });
+        reader.ReadColumn<PackedVec3>(changed.size(), [this, &indices](size_t i, const PackedVec3 &scale)
+                                      { _scales[indices[i]] = glm::vec3(scale.x, scale.y, scale.z); });
+
+        // Detach the changed transforms before attaching them to their new parents.
+        // Otherwise, swapping a parent and its child would temporarily create a cycle.
+        for (auto index : indices)
+        {
+            if (_parents[index] != NO_PARENT)
+            {
+                _parents[index] = NO_PARENT;
+                _hierarchyChanged = true;
+            }
+        }
+        reader.ReadColumn<eid_t>(changed.size(), [this, &indices](size_t i, eid_t parent)
+                                 {
+                                     if (parent != NO_PARENT_EID)
+                                     {
+                                         SetParent(Match(indices[i] + 1), Entity(parent));
+                                     }
+                                 });
+
+        return toVersion;
+    }
+} // namespace railguard::core
@@ -3,21 +3,89 @@
 #define SDL_MAIN_HANDLED
 
 #include <SDL2/SDL.h>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
 #include "../include/core/Engine.h"
 
 using namespace railguard::core;
 
-int main() {
-    // Init SDL2
+namespace
+{
+    void PrintUsage(const char *program)
+    {
+        std::cerr << "Usage: " << program << " [--headless] [--frames N] [--readback DIR] [--size WIDTHxHEIGHT]\n"
+                  << "  --headless       Draw in offscreen images instead of a window\n"
+                  << "  --frames N       Stop after N frames\n"
+                  << "  --readback DIR   When headless, write every frame to DIR as a PPM image\n"
+                  << "  --size WxH       Size of the window or of the offscreen images\n";
+    }
+
+    /**
+     * @brief Fills the engine init info from the command line arguments.
+     * @return False if the arguments are invalid.
+     */
+    bool ParseArguments(int argc, char **argv, init::EngineInitInfo &initInfo)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            const bool hasValue = i + 1 < argc;
+            if (std::strcmp(argv[i], "--headless") == 0)
+            {
+                initInfo.headless = true;
+            }
+            else if (std::strcmp(argv[i], "--frames") == 0 && hasValue)
+            {
+                unsigned long long frameCount = 0;
+                if (std::sscanf(argv[++i], "%llu", &frameCount) != 1)
+                {
+                    return false;
+                }
+                initInfo.frameCount = frameCount;
+            }
+            else if (std::strcmp(argv[i], "--readback") == 0 && hasValue)
+            {
+                initInfo.readbackDirectory = argv[++i];
+            }
+            else if (std::strcmp(argv[i], "--size") == 0 && hasValue)
+            {
+                uint32_t width = 0;
+                uint32_t height = 0;
+                if (std::sscanf(argv[++i], "%ux%u", &width, &height) != 2 || width == 0 || height == 0)
+                {
+                    return false;
+                }
+                initInfo.extent = vk::Extent2D{width, height};
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    init::EngineInitInfo initInfo{};
+    if (!ParseArguments(argc, argv, initInfo))
+    {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    // Init SDL2. The video subsystem is only needed for the window.
     SDL_SetMainReady();
-    SDL_Init(SDL_INIT_VIDEO);
+    SDL_Init(initInfo.headless ? 0 : SDL_INIT_VIDEO);
 
     // Init engine
-    auto engine = Engine();
+    {
+        auto engine = Engine(initInfo);
 
-    engine.RunMainLoop();
+        engine.RunMainLoop();
+    }
 
     // Quit SDL2
     SDL_Quit();
     return 0;
-}
\ No newline at end of file
+}
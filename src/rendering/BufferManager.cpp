@@ -0,0 +1,333 @@
+#include "../../include/rendering/BufferManager.h"
+#include "../../include/utils/AdvancedCheck.h"
+#include <algorithm>
+
+#ifdef USE_ADVANCED_CHECKS
+// Define local error messages
+#define INITIALIZED_TWICE_ERROR "BufferManager should not be initialized twice."
+#define NOT_INITIALIZED_ERROR "BufferManager should be initialized with Init before calling this method."
+#define NOT_CLEANED_ERROR "BufferManager should be cleaned up with Cleanup before it is destroyed."
+#define INDEX_OUT_OF_RANGE_ERROR "The provided index references an nonexisting frame. The index must be lower than NB_OVERLAPPING_FRAMES."
+#define UNKNOWN_REGION_ERROR "The given region was not allocated with AllocateDeviceBuffer."
+#endif
+
+// Frame data can be used for anything that changes every frame
+#define FRAME_BUFFER_USAGE (vk::BufferUsageFlagBits::eUniformBuffer | vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eTransferSrc)
+#define DEVICE_BUFFER_USAGE (vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eTransferDst)
+
+namespace railguard::rendering
+{
+    static vk::DeviceSize AlignUp(vk::DeviceSize value, vk::DeviceSize alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    void BufferManager::Init(VmaAllocator allocator, const vk::PhysicalDeviceProperties &physicalDeviceProperties, const std::vector<uint32_t> &queueFamilies)
+    {
+        ADVANCED_CHECK(!_initialized, INITIALIZED_TWICE_ERROR);
+
+        _allocator = allocator;
+        _minUniformAlignment = physicalDeviceProperties.limits.minUniformBufferOffsetAlignment;
+
+        // Remove duplicate families, since concurrent sharing requires unique ones
+        _queueFamilies = queueFamilies;
+        std::sort(_queueFamilies.begin(), _queueFamilies.end());
+        _queueFamilies.erase(std::unique(_queueFamilies.begin(), _queueFamilies.end()), _queueFamilies.end());
+
+        // Create the frame ring buffer. It stays mapped during its whole lifetime.
+        const auto frameBuffer = CreateMappedBuffer(FRAME_BUFFER_SEGMENT_SIZE * NB_OVERLAPPING_FRAMES);
+        _frameBuffer = frameBuffer.buffer;
+        _frameAllocation = frameBuffer.allocation;
+        _frameMappedData = frameBuffer.mappedData;
+
+#ifdef USE_ADVANCED_CHECKS
+        _initialized = true;
+#endif
+    }
+
+    void BufferManager::Cleanup()
+    {
+        ADVANCED_CHECK(_initialized, NOT_INITIALIZED_ERROR);
+
+        // The memory is freed with the buffers, so pending frees can be ignored
+        for (auto &pendingFrees : _pendingFrees)
+        {
+            pendingFrees.clear();
+        }
+        for (const auto &block : _deviceBlocks)
+        {
+            vmaDestroyBuffer(_allocator, static_cast<VkBuffer>(block.buffer), block.allocation);
+        }
+        _deviceBlocks.clear();
+        _deviceBlockIndices.clear();
+        _queueFamilies.clear();
+
+        for (uint32_t i = 0; i < NB_OVERLAPPING_FRAMES; i++)
+        {
+            for (const auto &retired : _retiredGrowableBuffers[i])
+            {
+                DestroyMappedBuffer(retired);
+            }
+            _retiredGrowableBuffers[i].clear();
+            DestroyMappedBuffer(_growableBuffers[i]);
+            _growableBuffers[i] = MappedBuffer{};
+        }
+
+        vmaDestroyBuffer(_allocator, static_cast<VkBuffer>(_frameBuffer), _frameAllocation);
+        _frameBuffer = nullptr;
+        _frameAllocation = nullptr;
+        _frameMappedData = nullptr;
+
+#ifdef USE_ADVANCED_CHECKS
+        // Back to the beginning
+        _initialized = false;
+#endif
+    }
+
+    BufferManager::~BufferManager()
+    {
+        ADVANCED_CHECK(!_initialized, NOT_CLEANED_ERROR);
+    }
+
+    // ===== FRAME DATA =====
+
+    void BufferManager::BeginFrame(uint32_t frameIndex)
+    {
+        ADVANCED_CHECK(_initialized, NOT_INITIALIZED_ERROR);
+        ADVANCED_CHECK(frameIndex < NB_OVERLAPPING_FRAMES, INDEX_OUT_OF_RANGE_ERROR);
+
+        _currentFrame = frameIndex;
+        _frameOffset = 0;
+        _growableOffset = 0;
+
+        // Buffers replaced during the last use of the frame are not used anymore
+        for (const auto &retired : _retiredGrowableBuffers[frameIndex])
+        {
+            DestroyMappedBuffer(retired);
+        }
+        _retiredGrowableBuffers[frameIndex].clear();
+
+        // The GPU finished this frame, so the regions that were freed during it are not used anymore
+        for (const auto &region : _pendingFrees[frameIndex])
+        {
+            ReleaseDeviceRegion(region);
+        }
+        _pendingFrees[frameIndex].clear();
+    }
+
+    structs::BufferRegion BufferManager::AllocateFrameData(vk::DeviceSize size, vk::DeviceSize alignment)
+    {
+        ADVANCED_CHECK(_initialized, NOT_INITIALIZED_ERROR);
+
+        if (alignment == 0)
+        {
+            alignment = _minUniformAlignment;
+        }
+
+        // The segments are aligned on their size, which is a multiple of every alignment, so aligning the local offset is enough
+        const vk::DeviceSize offset = AlignUp(_frameOffset, alignment);
+        if (offset + size > FRAME_BUFFER_SEGMENT_SIZE)
+        {
+            throw std::runtime_error("The frame buffer segment is full. Increase FRAME_BUFFER_SEGMENT_SIZE.");
+        }
+        _frameOffset = offset + size;
+
+        const vk::DeviceSize globalOffset = static_cast<vk::DeviceSize>(_currentFrame) * FRAME_BUFFER_SEGMENT_SIZE + offset;
+        return structs::BufferRegion{
+            .buffer = _frameBuffer,
+            .offset = globalOffset,
+            .size = size,
+            .mappedData = _frameMappedData + globalOffset,
+        };
+    }
+
+    structs::BufferRegion BufferManager::AllocateGrowableFrameData(vk::DeviceSize size, vk::DeviceSize alignment)
+    {
+        ADVANCED_CHECK(_initialized, NOT_INITIALIZED_ERROR);
+
+        auto &current = _growableBuffers[_currentFrame];
+        vk::DeviceSize offset = AlignUp(_growableOffset, alignment);
+        if (offset + size > current.size)
+        {
+            // Replace it with a larger one. If regions were already given during this frame, they stay valid until the frame is reused.
+            if (_growableOffset > 0)
+            {
+                _retiredGrowableBuffers[_currentFrame].push_back(current);
+            }
+            else
+            {
+                DestroyMappedBuffer(current);
+            }
+            current = CreateMappedBuffer(std::max({size, 2 * current.size, static_cast<vk::DeviceSize>(GROWABLE_FRAME_BUFFER_MIN_SIZE)}));
+            offset = 0;
+        }
+        _growableOffset = offset + size;
+
+        return structs::BufferRegion{
+            .buffer = current.buffer,
+            .offset = offset,
+            .size = size,
+            .mappedData = current.mappedData + offset,
+        };
+    }
+
+    BufferManager::MappedBuffer BufferManager::CreateMappedBuffer(vk::DeviceSize size) const
+    {
+        // Its memory is coherent, so that the data written during the frame is visible to the GPU without flushing it.
+        auto bufferCreateInfo = GetBufferCreateInfo(size, FRAME_BUFFER_USAGE);
+        VmaAllocationCreateInfo allocationCreateInfo{
+            .flags = VMA_ALLOCATION_CREATE_MAPPED_BIT,
+            .usage = VMA_MEMORY_USAGE_CPU_TO_GPU,
+            .requiredFlags = VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        };
+        VkBuffer buffer;
+        VmaAllocation allocation;
+        VmaAllocationInfo allocationInfo;
+        if (vmaCreateBuffer(_allocator, &bufferCreateInfo, &allocationCreateInfo, &buffer, &allocation, &allocationInfo) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to create a frame buffer.");
+        }
+        return MappedBuffer{
+            .buffer = buffer,
+            .allocation = allocation,
+            .mappedData = static_cast<uint8_t *>(allocationInfo.pMappedData),
+            .size = size,
+        };
+    }
+
+    void BufferManager::DestroyMappedBuffer(const MappedBuffer &buffer) const
+    {
+        if (buffer.buffer != static_cast<vk::Buffer>(nullptr))
+        {
+            vmaDestroyBuffer(_allocator, static_cast<VkBuffer>(buffer.buffer), buffer.allocation);
+        }
+    }
+
+    // ===== DEVICE BUFFERS =====
+
+    VkBufferCreateInfo BufferManager::GetBufferCreateInfo(vk::DeviceSize size, vk::BufferUsageFlags usage) const
+    {
+        const bool shared = _queueFamilies.size() > 1;
+        return vk::BufferCreateInfo{
+            .size = size,
+            .usage = usage,
+            .sharingMode = shared ? vk::SharingMode::eConcurrent : vk::SharingMode::eExclusive,
+            .queueFamilyIndexCount = shared ? static_cast<uint32_t>(_queueFamilies.size()) : 0,
+            .pQueueFamilyIndices = shared ? _queueFamilies.data() : nullptr,
+        };
+    }
+
+    uint32_t BufferManager::CreateDeviceBlock(vk::DeviceSize size)
+    {
+        auto bufferCreateInfo = GetBufferCreateInfo(size, DEVICE_BUFFER_USAGE);
+        VmaAllocationCreateInfo allocationCreateInfo{
+            .usage = VMA_MEMORY_USAGE_GPU_ONLY,
+        };
+
+        DeviceBlock block{
+            .size = size,
+        };
+        VkBuffer buffer;
+        if (vmaCreateBuffer(_allocator, &bufferCreateInfo, &allocationCreateInfo, &buffer, &block.allocation, nullptr) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to create a device buffer block.");
+        }
+        block.buffer = buffer;
+        block.freeRanges[0] = size;
+
+        const auto index = static_cast<uint32_t>(_deviceBlocks.size());
+        _deviceBlocks.push_back(block);
+        _deviceBlockIndices[buffer] = index;
+        return index;
+    }
+
+    structs::BufferRegion BufferManager::AllocateDeviceBuffer(vk::DeviceSize size, vk::DeviceSize alignment)
+    {
+        ADVANCED_CHECK(_initialized, NOT_INITIALIZED_ERROR);
+
+        // First fit in the existing blocks
+        for (auto &block : _deviceBlocks)
+        {
+            for (auto it = block.freeRanges.begin(); it != block.freeRanges.end(); ++it)
+            {
+                const auto [rangeOffset, rangeSize] = *it;
+                const auto offset = AlignUp(rangeOffset, alignment);
+                if (offset + size > rangeOffset + rangeSize)
+                {
+                    continue;
+                }
+
+                // Split the range: the padding before and the remaining space after stay free
+                block.freeRanges.erase(it);
+                if (offset > rangeOffset)
+                {
+                    block.freeRanges[rangeOffset] = offset - rangeOffset;
+                }
+                if (offset + size < rangeOffset + rangeSize)
+                {
+                    block.freeRanges[offset + size] = rangeOffset + rangeSize - (offset + size);
+                }
+
+                return structs::BufferRegion{
+                    .buffer = block.buffer,
+                    .offset = offset,
+                    .size = size,
+                };
+            }
+        }
+
+        // No space left: create a new block. Bigger regions get a block of their own.
+        CreateDeviceBlock(std::max<vk::DeviceSize>(DEVICE_BUFFER_BLOCK_SIZE, size));
+        return AllocateDeviceBuffer(size, alignment);
+    }
+
+    void BufferManager::FreeDeviceBuffer(const structs::BufferRegion &region)
+    {
+        ADVANCED_CHECK(_initialized, NOT_INITIALIZED_ERROR);
+        ADVANCED_CHECK(_deviceBlockIndices.contains(static_cast<VkBuffer>(region.buffer)), UNKNOWN_REGION_ERROR);
+
+        // Frames that are still in flight may use the region
+        _pendingFrees[_currentFrame].push_back(region);
+    }
+
+    void BufferManager::ReleaseDeviceRegion(const structs::BufferRegion &region)
+    {
+        auto &ranges = _deviceBlocks[_deviceBlockIndices.at(static_cast<VkBuffer>(region.buffer))].freeRanges;
+        auto [it, _] = ranges.emplace(region.offset, region.size);
+
+        // Merge with the next range
+        auto next = std::next(it);
+        if (next != ranges.end() && it->first + it->second == next->first)
+        {
+            it->second += next->second;
+            ranges.erase(next);
+        }
+        // Merge with the previous range
+        if (it != ranges.begin())
+        {
+            auto previous = std::prev(it);
+            if (previous->first + previous->second == it->first)
+            {
+                previous->second += it->second;
+                ranges.erase(it);
+            }
+        }
+    }
+
+    // ===== GETTERS =====
+
+    vk::Buffer BufferManager::GetFrameBuffer() const
+    {
+        return _frameBuffer;
+    }
+
+    vk::DeviceSize BufferManager::GetFrameDataUsage() const
+    {
+        return _frameOffset;
+    }
+
+    size_t BufferManager::GetDeviceBlockCount() const
+    {
+        return _deviceBlocks.size();
+    }
+} // namespace railguard::rendering
@@ -0,0 +1,380 @@
+#include "../../include/rendering/ClusterCuller.h"
+#include "../../include/utils/AdvancedCheck.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#ifdef USE_ADVANCED_CHECKS
+// Define local error messages
+#define INITIALIZED_TWICE_ERROR "ClusterCuller should not be initialized twice."
+#define NOT_INITIALIZED_ERROR "ClusterCuller should be initialized with Init before calling this method."
+#define NOT_CLEANED_ERROR "ClusterCuller should be cleaned up with Cleanup before it is destroyed."
+#define VIEWS_AFTER_INSTANCES_ERROR "The views of the frame must be set before the instances are added to the ClusterCuller."
+#endif
+
+// Must match the local size of cluster_cull.comp
+#define CLUSTER_CULL_GROUP_SIZE 64
+// Largest value of minStorageBufferOffsetAlignment allowed by the specification
+#define STORAGE_BUFFER_ALIGNMENT 256
+// Meshlets, instances, command instances, commands and views
+#define CLUSTER_CULL_BINDING_COUNT 5
+
+namespace railguard::rendering
+{
+    void ClusterCuller::Init(const vk::Device &device, PipelineLayoutCache &pipelineLayoutCache, BufferManager &bufferManager,
+                             vk::ShaderModule cullingShader, const structs::ShaderReflection &reflection,
+                             const structs::BufferRegion &meshletBuffer, const vk::PhysicalDeviceFeatures &enabledFeatures)
+    {
+        ADVANCED_CHECK(!_initialized, INITIALIZED_TWICE_ERROR);
+
+        _device = device;
+        _pipelineLayoutCache = &pipelineLayoutCache;
+        _bufferManager = &bufferManager;
+        _meshletBuffer = meshletBuffer;
+        _multiDrawIndirect = enabledFeatures.multiDrawIndirect;
+        _drawIndirectFirstInstance = enabledFeatures.drawIndirectFirstInstance;
+
+        if (reflection.setLayouts.size() != 1 || reflection.setLayouts[0].bindings.size() != CLUSTER_CULL_BINDING_COUNT)
+        {
+            throw std::runtime_error("The cluster culling shader doesn't have the expected interface.");
+        }
+
+        // Create the pipeline
+        _pipelineLayout = _pipelineLayoutCache->GetPipelineLayout(structs::PipelineLayoutDescription{
+            .setLayouts = reflection.setLayouts,
+            .pushConstantRanges = reflection.pushConstantRanges,
+        });
+        _descriptorSetLayout = _pipelineLayoutCache->GetDescriptorSetLayout(reflection.setLayouts[0]);
+
+        vk::ComputePipelineCreateInfo pipelineCreateInfo{
+            .stage = vk::PipelineShaderStageCreateInfo{
+                .stage = vk::ShaderStageFlagBits::eCompute,
+                .module = cullingShader,
+                .pName = "main",
+            },
+            .layout = _pipelineLayout,
+        };
+        auto result = _device.createComputePipeline(nullptr, pipelineCreateInfo);
+        // Handle result
+        switch (result.result)
+        {
+        case vk::Result::eSuccess:
+            _pipeline = result.value;
+            break;
+        // Default returns an exception
+        default:
+            throw std::runtime_error("Failed to create the cluster culling pipeline");
+        }
+
+        // Each overlapping frame has its own set, since the per-frame buffers change every frame
+        vk::DescriptorPoolSize poolSize{
+            .type = vk::DescriptorType::eStorageBuffer,
+            .descriptorCount = CLUSTER_CULL_BINDING_COUNT * NB_OVERLAPPING_FRAMES,
+        };
+        _descriptorPool = _device.createDescriptorPool(vk::DescriptorPoolCreateInfo{
+            .maxSets = NB_OVERLAPPING_FRAMES,
+            .poolSizeCount = 1,
+            .pPoolSizes = &poolSize,
+        });
+        std::vector<vk::DescriptorSetLayout> setLayouts(NB_OVERLAPPING_FRAMES, _descriptorSetLayout);
+        auto descriptorSets = _device.allocateDescriptorSets(vk::DescriptorSetAllocateInfo{
+            .descriptorPool = _descriptorPool,
+            .descriptorSetCount = NB_OVERLAPPING_FRAMES,
+            .pSetLayouts = setLayouts.data(),
+        });
+
+        for (uint32_t i = 0; i < NB_OVERLAPPING_FRAMES; i++)
+        {
+            _descriptorSets[i] = descriptorSets[i];
+            _commandBuffers[i] = _bufferManager->AllocateDeviceBuffer(MAX_CULLED_CLUSTERS * sizeof(vk::DrawIndexedIndirectCommand));
+        }
+
+        _instances.reserve(MAX_CULLED_CLUSTERS / 8);
+        _commandInstances.reserve(MAX_CULLED_CLUSTERS);
+
+#ifdef USE_ADVANCED_CHECKS
+        _initialized = true;
+#endif
+    }
+
+    void ClusterCuller::Cleanup()
+    {
+        ADVANCED_CHECK(_initialized, NOT_INITIALIZED_ERROR);
+
+        for (auto &commandBuffer : _commandBuffers)
+        {
+            _bufferManager->FreeDeviceBuffer(commandBuffer);
+            commandBuffer = structs::BufferRegion{};
+        }
+        // Destroying the pool frees its sets
+        _device.destroyDescriptorPool(_descriptorPool);
+        _device.destroyPipeline(_pipeline);
+        _pipelineLayoutCache->ReleaseDescriptorSetLayout(_descriptorSetLayout);
+        _pipelineLayoutCache->ReleasePipelineLayout(_pipelineLayout);
+
+        _instances.clear();
+        _commandInstances.clear();
+
+#ifdef USE_ADVANCED_CHECKS
+        // Back to the beginning
+        _initialized = false;
+#endif
+    }
+
+    ClusterCuller::~ClusterCuller()
+    {
+        ADVANCED_CHECK(!_initialized, NOT_CLEANED_ERROR);
+    }
+
+    ClusterCuller::CullingView ClusterCuller::GetCullingView(const structs::CameraView &camera)
+    {
+        // Extract the planes from the rows of the matrix (Gribb-Hartmann). glm matrices are column major.
+        const auto &viewProjection = camera.viewProjection;
+        const glm::vec4 rows[4] = {
+            glm::vec4(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]),
+            glm::vec4(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]),
+            glm::vec4(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]),
+            glm::vec4(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]),
+        };
+        const glm::vec4 planes[6] = {
+            rows[3] + rows[0],
+            rows[3] - rows[0],
+            rows[3] + rows[1],
+            rows[3] - rows[1],
+            // The depth range is [0, 1] in vulkan
+            rows[2],
+            rows[3] - rows[2],
+        };
+
+        CullingView view{};
+        // Normalize them so that the distances can be compared to the radius of the spheres
+        for (uint32_t i = 0; i < 6; i++)
+        {
+            view.frustumPlanes[i] = planes[i] / glm::length(glm::vec3(planes[i]));
+        }
+        view.cameraPosition = glm::vec4(camera.position, 1.0f);
+        return view;
+    }
+
+    void ClusterCuller::BeginFrame(uint32_t frameIndex)
+    {
+        ADVANCED_CHECK(_initialized, NOT_INITIALIZED_ERROR);
+
+        _currentFrame = frameIndex;
+        _instances.clear();
+        _commandInstances.clear();
+
+        // A single group that culls nothing, until the views are set
+        _views.clear();
+        _pushConstants.groupCount = 1;
+        _pushConstants.groups[0] = glm::uvec2(0, 0);
+    }
+
+    void ClusterCuller::SetViews(std::vector<structs::CameraView> &views, std::pmr::memory_resource *frameMemory)
+    {
+        ADVANCED_CHECK(_initialized, NOT_INITIALIZED_ERROR);
+        ADVANCED_CHECK(_commandInstances.empty(), VIEWS_AFTER_INSTANCES_ERROR);
+
+        if (views.empty())
+        {
+            return;
+        }
+
+        // Bounding sphere of the frustum of each view
+        std::pmr::vector<glm::vec4> spheres(frameMemory);
+        spheres.reserve(views.size());
+        // True if the group culls against the frusta of its views
+        bool groupCulls[MAX_CULLING_GROUPS] = {};
+        uint32_t groupCount = 0;
+
+        for (uint32_t i = 0; i < views.size(); i++)
+        {
+            // Bound the frustum with the sphere around its corners. Infinite frusta overlap every other one.
+            glm::vec4 sphere(0.0f, 0.0f, 0.0f, std::numeric_limits<float>::infinity());
+            if (views[i].culled)
+            {
+                const glm::mat4 inverse = glm::inverse(views[i].viewProjection);
+                glm::vec3 corners[8];
+                glm::vec3 center(0.0f);
+                for (uint32_t corner = 0; corner < 8; corner++)
+                {
+                    const glm::vec4 clip((corner & 1) ? 1.0f : -1.0f, (corner & 2) ? 1.0f : -1.0f, (corner & 4) ? 1.0f : 0.0f, 1.0f);
+                    const glm::vec4 world = inverse * clip;
+                    corners[corner] = glm::vec3(world) / world.w;
+                    center += corners[corner] / 8.0f;
+                }
+                float radius = 0.0f;
+                for (const auto &corner : corners)
+                {
+                    radius = std::max(radius, glm::length(corner - center));
+                }
+                // With an infinite far plane, the far corners are at infinity
+                if (std::isfinite(radius) && std::isfinite(center.x) && std::isfinite(center.y) && std::isfinite(center.z))
+                {
+                    sphere = glm::vec4(center, radius);
+                }
+            }
+            spheres.push_back(sphere);
+
+            // Find a group of the same kind that has a view overlapping this one
+            uint32_t group = 0;
+            for (; group < groupCount; group++)
+            {
+                if (groupCulls[group] != views[i].culled)
+                {
+                    continue;
+                }
+                if (!groupCulls[group])
+                {
+                    break;
+                }
+                bool overlaps = false;
+                for (uint32_t j = 0; j < i && !overlaps; j++)
+                {
+                    overlaps = views[j].cullingGroup == group &&
+                               glm::length(glm::vec3(spheres[j]) - glm::vec3(sphere)) <= spheres[j].w + sphere.w;
+                }
+                if (overlaps)
+                {
+                    break;
+                }
+            }
+            if (group == groupCount)
+            {
+                if (groupCount < MAX_CULLING_GROUPS)
+                {
+                    groupCulls[groupCount++] = views[i].culled;
+                }
+                else
+                {
+                    // Merging is conservative: a meshlet is kept if any view of the group sees it
+                    group = groupCount - 1;
+                    groupCulls[group] = groupCulls[group] && views[i].culled;
+                }
+            }
+            views[i].cullingGroup = group;
+        }
+
+        // Store the views one group after the other
+        _views.clear();
+        _pushConstants.groupCount = groupCount;
+        for (uint32_t g = 0; g < groupCount; g++)
+        {
+            const auto firstView = static_cast<uint32_t>(_views.size());
+            if (groupCulls[g])
+            {
+                for (const auto &view : views)
+                {
+                    if (view.cullingGroup == g)
+                    {
+                        _views.push_back(GetCullingView(view));
+                    }
+                }
+            }
+            _pushConstants.groups[g] = glm::uvec2(firstView, static_cast<uint32_t>(_views.size()) - firstView);
+        }
+    }
+
+    bool ClusterCuller::CanAddCommands(uint32_t commandCount, bool usesFirstInstance) const
+    {
+        // Each group has its own copy of the commands
+        return (_commandInstances.size() + commandCount) * _pushConstants.groupCount <= MAX_CULLED_CLUSTERS && (!usesFirstInstance || _drawIndirectFirstInstance);
+    }
+
+    uint32_t ClusterCuller::AddInstance(const glm::mat4 &transform, uint32_t firstMeshlet, uint32_t meshletCount, uint32_t firstInstance, int32_t baseVertex)
+    {
+        if (meshletCount == 0 || !CanAddCommands(meshletCount, firstInstance != 0))
+        {
+            return NO_COMMANDS;
+        }
+        const auto firstCommand = static_cast<uint32_t>(_commandInstances.size());
+
+        _commandInstances.insert(_commandInstances.end(), meshletCount, static_cast<uint32_t>(_instances.size()));
+        _instances.push_back(ClusterInstance{
+            .transform = transform,
+            .firstMeshlet = firstMeshlet,
+            .firstCommand = firstCommand,
+            .firstInstance = firstInstance,
+            .baseVertex = baseVertex,
+        });
+        return firstCommand;
+    }
+
+    void ClusterCuller::Record(const vk::CommandBuffer &cmd)
+    {
+        ADVANCED_CHECK(_initialized, NOT_INITIALIZED_ERROR);
+
+        if (_commandInstances.empty())
+        {
+            return;
+        }
+
+        // Copy the instances of the frame to the ring buffer
+        const auto instances = _bufferManager->AllocateFrameData(_instances.size() * sizeof(ClusterInstance), STORAGE_BUFFER_ALIGNMENT);
+        std::memcpy(instances.mappedData, _instances.data(), instances.size);
+        const auto commandInstances = _bufferManager->AllocateFrameData(_commandInstances.size() * sizeof(uint32_t), STORAGE_BUFFER_ALIGNMENT);
+        std::memcpy(commandInstances.mappedData, _commandInstances.data(), commandInstances.size);
+        // The buffer can't be empty, even if nothing is culled
+        const auto views = _bufferManager->AllocateFrameData(std::max<size_t>(_views.size(), 1) * sizeof(CullingView), STORAGE_BUFFER_ALIGNMENT);
+        std::memcpy(views.mappedData, _views.data(), _views.size() * sizeof(CullingView));
+
+        // The set of the frame is not used by the GPU anymore, so it can be updated
+        const vk::DescriptorBufferInfo bufferInfos[CLUSTER_CULL_BINDING_COUNT] = {
+            {.buffer = _meshletBuffer.buffer, .offset = _meshletBuffer.offset, .range = _meshletBuffer.size},
+            {.buffer = instances.buffer, .offset = instances.offset, .range = instances.size},
+            {.buffer = commandInstances.buffer, .offset = commandInstances.offset, .range = commandInstances.size},
+            {.buffer = _commandBuffers[_currentFrame].buffer, .offset = _commandBuffers[_currentFrame].offset, .range = _commandBuffers[_currentFrame].size},
+            {.buffer = views.buffer, .offset = views.offset, .range = views.size},
+        };
+        vk::WriteDescriptorSet writes[CLUSTER_CULL_BINDING_COUNT];
+        for (uint32_t binding = 0; binding < CLUSTER_CULL_BINDING_COUNT; binding++)
+        {
+            writes[binding] = vk::WriteDescriptorSet{
+                .dstSet = _descriptorSets[_currentFrame],
+                .dstBinding = binding,
+                .dstArrayElement = 0,
+                .descriptorCount = 1,
+                .descriptorType = vk::DescriptorType::eStorageBuffer,
+                .pBufferInfo = &bufferInfos[binding],
+            };
+        }
+        _device.updateDescriptorSets(writes, {});
+
+        // One invocation per command and per group
+        _pushConstants.commandCount = static_cast<uint32_t>(_commandInstances.size());
+        cmd.bindPipeline(vk::PipelineBindPoint::eCompute, _pipeline);
+        cmd.bindDescriptorSets(vk::PipelineBindPoint::eCompute, _pipelineLayout, 0, _descriptorSets[_currentFrame], {});
+        cmd.pushConstants(_pipelineLayout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(CullingPushConstants), &_pushConstants);
+        cmd.dispatch((_pushConstants.commandCount + CLUSTER_CULL_GROUP_SIZE - 1) / CLUSTER_CULL_GROUP_SIZE, _pushConstants.groupCount, 1);
+    }
+
+    void ClusterCuller::DrawClusters(const vk::CommandBuffer &cmd, uint32_t firstCommand, uint32_t commandCount, uint32_t group) const
+    {
+        // The commands of each group follow the ones of the previous group
+        const auto &commands = _commandBuffers[_currentFrame];
+        const vk::DeviceSize offset = commands.offset + (static_cast<vk::DeviceSize>(group) * GetCommandCount() + firstCommand) * sizeof(vk::DrawIndexedIndirectCommand);
+        if (_multiDrawIndirect)
+        {
+            cmd.drawIndexedIndirect(commands.buffer, offset, commandCount, sizeof(vk::DrawIndexedIndirectCommand));
+        }
+        else
+        {
+            for (uint32_t i = 0; i < commandCount; i++)
+            {
+                cmd.drawIndexedIndirect(commands.buffer, offset + i * sizeof(vk::DrawIndexedIndirectCommand), 1, sizeof(vk::DrawIndexedIndirectCommand));
+            }
+        }
+    }
+
+    uint32_t ClusterCuller::GetCommandCount() const
+    {
+        return static_cast<uint32_t>(_commandInstances.size());
+    }
+
+    uint32_t ClusterCuller::GetGroupCount() const
+    {
+        return _pushConstants.groupCount;
+    }
+} // namespace railguard::rendering
@@ -0,0 +1,93 @@
+#include "../../include/rendering/FrameArena.h"
+#include "../../include/rendering/Settings.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace railguard::rendering
+{
+    FrameArena::FrameArena(size_t initialSize)
+    {
+        const size_t size = initialSize > 0 ? initialSize : FRAME_ARENA_BLOCK_SIZE;
+        _blocks.push_back(Block{
+            .data = std::make_unique<std::byte[]>(size),
+            .size = size,
+        });
+    }
+
+    void *FrameArena::do_allocate(size_t bytes, size_t alignment)
+    {
+        while (true)
+        {
+            auto &block = _blocks[_currentBlock];
+            const auto address = reinterpret_cast<uintptr_t>(block.data.get()) + _offset;
+            const size_t padding = (alignment - address % alignment) % alignment;
+            if (_offset + padding + bytes <= block.size)
+            {
+                _offset += padding + bytes;
+                _usedSize += padding + bytes;
+                _peakSize = std::max(_peakSize, _usedSize);
+                return block.data.get() + _offset - bytes;
+            }
+
+            // Continue in the next block, or create one that is large enough
+            _currentBlock++;
+            _offset = 0;
+            if (_currentBlock == _blocks.size())
+            {
+                const size_t size = std::max<size_t>(FRAME_ARENA_BLOCK_SIZE, bytes + alignment);
+                _blocks.push_back(Block{
+                    .data = std::make_unique<std::byte[]>(size),
+                    .size = size,
+                });
+            }
+        }
+    }
+
+    void FrameArena::do_deallocate(void *, size_t, size_t)
+    {
+        // Everything is freed by Reset
+    }
+
+    bool FrameArena::do_is_equal(const std::pmr::memory_resource &other) const noexcept
+    {
+        return this == &other;
+    }
+
+    void FrameArena::Reset()
+    {
+        // Merge the blocks, so that the next frames fit in a single one
+        if (_blocks.size() > 1)
+        {
+            const size_t size = GetCapacity();
+            _blocks.clear();
+            _blocks.push_back(Block{
+                .data = std::make_unique<std::byte[]>(size),
+                .size = size,
+            });
+        }
+
+        _currentBlock = 0;
+        _offset = 0;
+        _usedSize = 0;
+    }
+
+    size_t FrameArena::GetUsedSize() const
+    {
+        return _usedSize;
+    }
+
+    size_t FrameArena::GetPeakSize() const
+    {
+        return _peakSize;
+    }
+
+    size_t FrameArena::GetCapacity() const
+    {
+        size_t capacity = 0;
+        for (const auto &block : _blocks)
+        {
+            capacity += block.size;
+        }
+        return capacity;
+    }
+} // namespace railguard::rendering
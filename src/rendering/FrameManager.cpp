@@ -13,7 +13,7 @@
 
 namespace railguard::rendering
 {
-    void FrameManager::Init(const vk::Device &device, uint32_t graphicsQueueFamily)
+    void FrameManager::Init(const vk::Device &device, uint32_t graphicsQueueFamily, uint32_t computeQueueFamily)
     {
         ADVANCED_CHECK(!_initialized, INITIALIZED_TWICE_ERROR);
 
@@ -42,6 +42,24 @@ namespace railguard::rendering
             _commandBuffers[i] = device.allocateCommandBuffers(commandBufferAllocateInfo)[0];
         }
 
+        // Same for async compute
+        vk::CommandPoolCreateInfo computeCommandPoolCreateInfo{
+            .flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
+            .queueFamilyIndex = computeQueueFamily,
+        };
+
+        for (uint32_t i = 0; i < NB_OVERLAPPING_FRAMES; i++)
+        {
+            _computeCommandPools[i] = device.createCommandPool(computeCommandPoolCreateInfo);
+
+            vk::CommandBufferAllocateInfo commandBufferAllocateInfo{
+                .commandPool = _computeCommandPools[i],
+                .level = vk::CommandBufferLevel::ePrimary,
+                .commandBufferCount = 1,
+            };
+            _computeCommandBuffers[i] = device.allocateCommandBuffers(commandBufferAllocateInfo)[0];
+        }
+
         // Create fences
         // We separate the for loops so that we can really focus on one vector at a time
 
@@ -66,6 +84,10 @@ namespace railguard::rendering
         {
             renderSemaphore = device.createSemaphore(semaphoreCreateInfo);
         }
+        for (auto &computeSemaphore : _computeSemaphores)
+        {
+            computeSemaphore = device.createSemaphore(semaphoreCreateInfo);
+        }
 
 #ifdef USE_ADVANCED_CHECKS
         _initialized = true;
@@ -78,6 +100,11 @@ namespace railguard::rendering
 
         // Destroy semaphores
 
+        for (auto &computeSemaphore : _computeSemaphores)
+        {
+            _device.destroySemaphore(computeSemaphore);
+            computeSemaphore = nullptr;
+        }
         for (auto &renderSemaphore : _renderSemaphores)
         {
             _device.destroySemaphore(renderSemaphore);
@@ -88,6 +115,14 @@ namespace railguard::rendering
             _device.destroySemaphore(presentSemaphore);
             presentSemaphore = nullptr;
         }
+        for (auto &presentSemaphores : _additionalPresentSemaphores)
+        {
+            for (auto presentSemaphore : presentSemaphores)
+            {
+                _device.destroySemaphore(presentSemaphore);
+            }
+            presentSemaphores.clear();
+        }
 
         // Destroy fences
 
@@ -104,6 +139,11 @@ namespace railguard::rendering
             _device.destroyCommandPool(pool);
             pool = nullptr;
         }
+        for (auto &pool : _computeCommandPools)
+        {
+            _device.destroyCommandPool(pool);
+            pool = nullptr;
+        }
 
 #ifdef USE_ADVANCED_CHECKS
         // Back to the beginning
@@ -127,6 +167,8 @@ namespace railguard::rendering
             .renderFence = _renderFences[index],
             .presentSemaphore = _presentSemaphores[index],
             .renderSemaphore = _renderSemaphores[index],
+            .computeCommandBuffer = _computeCommandBuffers[index],
+            .computeSemaphore = _computeSemaphores[index],
         };
     }
 
@@ -176,4 +218,45 @@ namespace railguard::rendering
         return _presentSemaphores[index];
     }
 
+    vk::Semaphore FrameManager::GetPresentSemaphore(uint32_t index, uint32_t swapchainIndex)
+    {
+        ADVANCED_CHECK(_initialized, NOT_INITIALIZED_ERROR);
+        ADVANCED_CHECK(index < NB_OVERLAPPING_FRAMES, INDEX_OUT_OF_RANGE_ERROR);
+
+        if (swapchainIndex == 0)
+        {
+            return _presentSemaphores[index];
+        }
+
+        auto &presentSemaphores = _additionalPresentSemaphores[index];
+        while (presentSemaphores.size() < swapchainIndex)
+        {
+            presentSemaphores.push_back(_device.createSemaphore(vk::SemaphoreCreateInfo{}));
+        }
+        return presentSemaphores[swapchainIndex - 1];
+    }
+
+    const vk::CommandBuffer FrameManager::GetComputeCommandBuffer(uint32_t index) const
+    {
+        ADVANCED_CHECK(_initialized, NOT_INITIALIZED_ERROR);
+        ADVANCED_CHECK(index < NB_OVERLAPPING_FRAMES, INDEX_OUT_OF_RANGE_ERROR);
+
+        return _computeCommandBuffers[index];
+    }
+    const vk::Semaphore FrameManager::GetComputeSemaphore(uint32_t index) const
+    {
+        ADVANCED_CHECK(_initialized, NOT_INITIALIZED_ERROR);
+        ADVANCED_CHECK(index < NB_OVERLAPPING_FRAMES, INDEX_OUT_OF_RANGE_ERROR);
+
+        return _computeSemaphores[index];
+    }
+
+    FrameArena &FrameManager::GetArena(uint32_t index)
+    {
+        ADVANCED_CHECK(_initialized, NOT_INITIALIZED_ERROR);
+        ADVANCED_CHECK(index < NB_OVERLAPPING_FRAMES, INDEX_OUT_OF_RANGE_ERROR);
+
+        return _arenas[index];
+    }
+
 }
\ No newline at end of file
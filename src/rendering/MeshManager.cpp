@@ -0,0 +1,320 @@
+#include "../../include/rendering/MeshManager.h"
+#include "../../include/utils/MappedFile.h"
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+// Size of the parts in which big meshes are uploaded, so that they fit in the staging ring
+#define MESH_UPLOAD_CHUNK_SIZE (STAGING_BUFFER_SIZE / 2)
+
+namespace railguard::rendering
+{
+    void MeshManager::Init(MeshManagerStorage storage, size_t defaultCapacity)
+    {
+        super::Init(storage, defaultCapacity);
+
+        _geometryRegions.reserve(defaultCapacity);
+        _indexOffsets.reserve(defaultCapacity);
+        _lods.reserve(defaultCapacity);
+        _lodCounts.reserve(defaultCapacity);
+        _bounds.reserve(defaultCapacity);
+        _uploadTickets.reserve(defaultCapacity);
+        _firstMeshlets.reserve(defaultCapacity);
+        _meshletCounts.reserve(defaultCapacity);
+
+        // The whole meshlet buffer is free at first
+        _meshletBuffer = _storage.bufferManager->AllocateDeviceBuffer(MAX_MESHLETS * sizeof(structs::Meshlet));
+        _freeMeshletRanges[0] = MAX_MESHLETS;
+    }
+
+    void MeshManager::Clear()
+    {
+        for (const auto &region : _geometryRegions)
+        {
+            _storage.bufferManager->FreeDeviceBuffer(region);
+        }
+
+        _geometryRegions.clear();
+        _indexOffsets.clear();
+        _lods.clear();
+        _lodCounts.clear();
+        _bounds.clear();
+        _uploadTickets.clear();
+        _firstMeshlets.clear();
+        _meshletCounts.clear();
+
+        _storage.bufferManager->FreeDeviceBuffer(_meshletBuffer);
+        _meshletBuffer = structs::BufferRegion{};
+        _freeMeshletRanges.clear();
+        for (auto &pendingFrees : _pendingMeshletFrees)
+        {
+            pendingFrees.clear();
+        }
+
+        super::Clear();
+    }
+
+    void MeshManager::BeginFrame(uint32_t frameIndex)
+    {
+        _currentFrame = frameIndex;
+        for (const auto &[first, count] : _pendingMeshletFrees[frameIndex])
+        {
+            ReleaseMeshlets(first, count);
+        }
+        _pendingMeshletFrees[frameIndex].clear();
+    }
+
+    uint32_t MeshManager::AllocateMeshlets(uint32_t count)
+    {
+        // First fit
+        for (auto range = _freeMeshletRanges.begin(); range != _freeMeshletRanges.end(); ++range)
+        {
+            const auto [first, rangeCount] = *range;
+            if (rangeCount >= count)
+            {
+                _freeMeshletRanges.erase(range);
+                if (rangeCount > count)
+                {
+                    _freeMeshletRanges[first + count] = rangeCount - count;
+                }
+                return first;
+            }
+        }
+        return NO_MESHLETS;
+    }
+
+    void MeshManager::ReleaseMeshlets(uint32_t first, uint32_t count)
+    {
+        auto range = _freeMeshletRanges.emplace(first, count).first;
+
+        // Merge with the next range
+        auto next = std::next(range);
+        if (next != _freeMeshletRanges.end() && range->first + range->second == next->first)
+        {
+            range->second += next->second;
+            _freeMeshletRanges.erase(next);
+        }
+        // Merge with the previous range
+        if (range != _freeMeshletRanges.begin())
+        {
+            auto previous = std::prev(range);
+            if (previous->first + previous->second == range->first)
+            {
+                previous->second += range->second;
+                _freeMeshletRanges.erase(range);
+            }
+        }
+    }
+
+    core::CompleteMatch<mesh_id_t> MeshManager::LoadMesh(const std::string &filePath)
+    {
+        utils::MappedFile file(filePath);
+        const auto *data = static_cast<const uint8_t *>(file.GetData());
+
+        // Check that the file is a complete mesh of the current version
+        const auto *header = reinterpret_cast<const structs::MeshFileHeader *>(data);
+        if (file.GetSize() < sizeof(structs::MeshFileHeader) || header->magic != MESH_FILE_MAGIC)
+        {
+            throw std::runtime_error("\"" + filePath + "\" is not a mesh file.");
+        }
+        if (header->version != MESH_FILE_VERSION)
+        {
+            throw std::runtime_error("The mesh \"" + filePath + "\" was created with another version of the converter.");
+        }
+        if (header->fileSize != file.GetSize())
+        {
+            throw std::runtime_error("The mesh \"" + filePath + "\" is truncated.");
+        }
+        if (header->lodCount == 0 || header->lodCount > MESH_MAX_LODS || header->indexCount == 0)
+        {
+            throw std::runtime_error("The mesh \"" + filePath + "\" is empty or has too many LODs.");
+        }
+
+        // The vertex and index streams are contiguous in the file, so they are copied to the GPU together, without any conversion
+        const vk::DeviceSize indexOffset = header->indicesOffset - header->verticesOffset;
+        const vk::DeviceSize geometrySize = indexOffset + header->indexCount * sizeof(uint32_t);
+        if (header->indicesOffset < header->verticesOffset || header->verticesOffset + geometrySize > file.GetSize() ||
+            indexOffset < uint64_t{header->vertexCount} * sizeof(structs::MeshVertex) || header->indicesOffset % sizeof(uint32_t) != 0)
+        {
+            throw std::runtime_error("The mesh \"" + filePath + "\" is corrupted.");
+        }
+        // The GPU reads the vertices through the indices: they must stay in the vertex stream
+        const auto *indices = reinterpret_cast<const uint32_t *>(data + header->indicesOffset);
+        if (*std::max_element(indices, indices + header->indexCount) >= header->vertexCount)
+        {
+            throw std::runtime_error("The mesh \"" + filePath + "\" is corrupted.");
+        }
+        if (header->meshletCount > 0 && header->meshletsOffset + header->meshletCount * sizeof(structs::Meshlet) > file.GetSize())
+        {
+            throw std::runtime_error("The mesh \"" + filePath + "\" is corrupted.");
+        }
+        if (header->lodsOffset > file.GetSize() || file.GetSize() - header->lodsOffset < header->lodCount * sizeof(structs::MeshLod))
+        {
+            throw std::runtime_error("The mesh \"" + filePath + "\" is corrupted.");
+        }
+
+        // Keep the small metadata on the CPU, for LOD selection and culling
+        std::array<structs::MeshLod, MESH_MAX_LODS> lods{};
+        std::copy_n(reinterpret_cast<const structs::MeshLod *>(data + header->lodsOffset), header->lodCount, lods.begin());
+
+        // The LODs and meshlets are turned into draws: their ranges must stay in the streams
+        for (uint32_t i = 0; i < header->lodCount; i++)
+        {
+            const auto &lod = lods[i];
+            if (uint64_t{lod.firstIndex} + lod.indexCount > header->indexCount || uint64_t{lod.firstMeshlet} + lod.meshletCount > header->meshletCount)
+            {
+                throw std::runtime_error("The mesh \"" + filePath + "\" is corrupted.");
+            }
+        }
+        for (uint32_t i = 0; i < header->meshletCount; i++)
+        {
+            const auto &meshlet = reinterpret_cast<const structs::Meshlet *>(data + header->meshletsOffset)[i];
+            if (3 * (uint64_t{meshlet.firstTriangle} + meshlet.triangleCount) > header->indexCount)
+            {
+                throw std::runtime_error("The mesh \"" + filePath + "\" is corrupted.");
+            }
+        }
+
+        const auto region = _storage.bufferManager->AllocateDeviceBuffer(geometrySize, MESH_FILE_ALIGNMENT);
+
+        // The meshlets are uploaded first, so that the ticket of the geometry covers them too
+        uint32_t firstMeshlet = NO_MESHLETS;
+        if (header->meshletCount > 0)
+        {
+            firstMeshlet = AllocateMeshlets(header->meshletCount);
+        }
+        if (firstMeshlet != NO_MESHLETS)
+        {
+            const vk::DeviceSize meshletsSize = header->meshletCount * sizeof(structs::Meshlet);
+            _storage.uploadManager->UploadToBuffer(data + header->meshletsOffset, meshletsSize, structs::BufferRegion{
+                                                                                                     .buffer = _meshletBuffer.buffer,
+                                                                                                     .offset = _meshletBuffer.offset + firstMeshlet * sizeof(structs::Meshlet),
+                                                                                                     .size = meshletsSize,
+                                                                                                 });
+        }
+
+        upload_ticket_t ticket = 0;
+        for (vk::DeviceSize offset = 0; offset < geometrySize; offset += MESH_UPLOAD_CHUNK_SIZE)
+        {
+            const auto size = std::min<vk::DeviceSize>(MESH_UPLOAD_CHUNK_SIZE, geometrySize - offset);
+            ticket = _storage.uploadManager->UploadToBuffer(data + header->verticesOffset + offset, size, structs::BufferRegion{
+                                                                                                               .buffer = region.buffer,
+                                                                                                               .offset = region.offset + offset,
+                                                                                                               .size = size,
+                                                                                                           });
+        }
+
+        _geometryRegions.push_back(region);
+        _indexOffsets.push_back(indexOffset);
+        _lods.push_back(lods);
+        _lodCounts.push_back(header->lodCount);
+        _bounds.push_back(header->bounds);
+        _uploadTickets.push_back(ticket);
+        _firstMeshlets.push_back(firstMeshlet);
+        _meshletCounts.push_back(firstMeshlet == NO_MESHLETS ? 0 : header->meshletCount);
+
+        return super::CreateItem();
+    }
+
+    void MeshManager::DestroyMesh(const core::Match &match)
+    {
+        const auto index = match.GetIndex();
+        _storage.bufferManager->FreeDeviceBuffer(_geometryRegions[index]);
+        if (_firstMeshlets[index] != NO_MESHLETS)
+        {
+            _pendingMeshletFrees[_currentFrame].emplace_back(_firstMeshlets[index], _meshletCounts[index]);
+        }
+
+        // Run boilerplate deletion
+        super::DestroyItem(match);
+
+        // Move the last item of vectors to the destroyed index if it is not the last
+        size_t lastIndex = _ids.size();
+        if (index < lastIndex)
+        {
+            _geometryRegions[index] = _geometryRegions[lastIndex];
+            _indexOffsets[index] = _indexOffsets[lastIndex];
+            _lods[index] = _lods[lastIndex];
+            _lodCounts[index] = _lodCounts[lastIndex];
+            _bounds[index] = _bounds[lastIndex];
+            _uploadTickets[index] = _uploadTickets[lastIndex];
+            _firstMeshlets[index] = _firstMeshlets[lastIndex];
+            _meshletCounts[index] = _meshletCounts[lastIndex];
+        }
+        // Remove the last element
+        _geometryRegions.pop_back();
+        _indexOffsets.pop_back();
+        _lods.pop_back();
+        _lodCounts.pop_back();
+        _bounds.pop_back();
+        _uploadTickets.pop_back();
+        _firstMeshlets.pop_back();
+        _meshletCounts.pop_back();
+    }
+
+    bool MeshManager::IsMeshReady(const core::Match &match) const
+    {
+        return _storage.uploadManager->IsUploadReady(_uploadTickets[match.GetIndex()]);
+    }
+
+    uint32_t MeshManager::SelectLod(const core::Match &match, float distance, float scale) const
+    {
+        const auto index = match.GetIndex();
+        const auto &lods = _lods[index];
+        const float maxError = distance * MESH_LOD_ERROR_RATIO;
+
+        // Errors increase with the LODs, so stop at the first one that is too coarse
+        uint32_t lod = 0;
+        while (lod + 1 < _lodCounts[index] && lods[lod + 1].error * scale <= maxError)
+        {
+            lod++;
+        }
+        return lod;
+    }
+
+    void MeshManager::FillDrawItem(const core::Match &match, uint32_t lod, structs::DrawItem &item) const
+    {
+        const auto index = match.GetIndex();
+        const auto &region = _geometryRegions[index];
+        const auto &meshLod = _lods[index][lod];
+
+        item.vertexBuffer = region.buffer;
+        item.vertexOffset = region.offset;
+        item.indexBuffer = region.buffer;
+        item.indexOffset = region.offset + _indexOffsets[index];
+        item.indexType = vk::IndexType::eUint32;
+        item.elementCount = meshLod.indexCount;
+        item.firstElement = meshLod.firstIndex;
+        item.baseVertex = 0;
+
+        if (_firstMeshlets[index] != NO_MESHLETS)
+        {
+            item.firstMeshlet = _firstMeshlets[index] + meshLod.firstMeshlet;
+            item.meshletCount = meshLod.meshletCount;
+        }
+        else
+        {
+            item.meshletCount = 0;
+        }
+    }
+
+    uint32_t MeshManager::GetLodCount(const core::Match &match) const
+    {
+        return _lodCounts[match.GetIndex()];
+    }
+
+    const structs::MeshLod &MeshManager::GetLod(const core::Match &match, uint32_t lod) const
+    {
+        return _lods[match.GetIndex()][lod];
+    }
+
+    const structs::MeshBounds &MeshManager::GetBounds(const core::Match &match) const
+    {
+        return _bounds[match.GetIndex()];
+    }
+
+    const structs::BufferRegion &MeshManager::GetMeshletBuffer() const
+    {
+        return _meshletBuffer;
+    }
+} // namespace railguard::rendering
@@ -0,0 +1,252 @@
+#include "../../include/rendering/OffscreenTarget.h"
+#include "../../include/utils/AdvancedCheck.h"
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#ifdef USE_ADVANCED_CHECKS
+// Define local error messages
+#define INITIALIZED_TWICE_ERROR "OffscreenTarget should not be initialized twice."
+#define NOT_INITIALIZED_ERROR "OffscreenTarget should be initialized with Init before calling this method."
+#define NOT_CLEANED_ERROR "OffscreenTarget should be cleaned up with Cleanup before it is destroyed."
+#endif
+
+// The readback reads the pixels as BGRA bytes
+#define READBACK_PIXEL_SIZE 4
+
+namespace railguard::rendering
+{
+    void OffscreenTarget::Init(const vk::Device &device, VmaAllocator allocator, vk::Extent2D extent, vk::Format format, const std::filesystem::path &readbackDirectory)
+    {
+        ADVANCED_CHECK(!_initialized, INITIALIZED_TWICE_ERROR);
+
+        _device = device;
+        _allocator = allocator;
+        _extent = extent;
+        _format = format;
+        _readbackDirectory = readbackDirectory;
+
+        if (!_readbackDirectory.empty())
+        {
+            std::filesystem::create_directories(_readbackDirectory);
+        }
+
+        for (uint32_t i = 0; i < NB_OVERLAPPING_FRAMES; i++)
+        {
+            // Create the image
+            VkImageCreateInfo imageCreateInfo = vk::ImageCreateInfo{
+                .imageType = vk::ImageType::e2D,
+                .format = _format,
+                .extent = vk::Extent3D{
+                    .width = _extent.width,
+                    .height = _extent.height,
+                    .depth = 1,
+                },
+                .mipLevels = 1,
+                .arrayLayers = 1,
+                .samples = vk::SampleCountFlagBits::e1,
+                .tiling = vk::ImageTiling::eOptimal,
+                .usage = vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc,
+                .sharingMode = vk::SharingMode::eExclusive,
+                .initialLayout = vk::ImageLayout::eUndefined,
+            };
+            VmaAllocationCreateInfo imageAllocationCreateInfo{
+                .usage = VMA_MEMORY_USAGE_GPU_ONLY,
+            };
+            VkImage image;
+            if (vmaCreateImage(_allocator, &imageCreateInfo, &imageAllocationCreateInfo, &image, &_imageAllocations[i], nullptr) != VK_SUCCESS)
+            {
+                throw std::runtime_error("Failed to create an offscreen image.");
+            }
+            _images[i] = image;
+
+            vk::ImageViewCreateInfo imageViewCreateInfo{
+                .image = _images[i],
+                .viewType = vk::ImageViewType::e2D,
+                .format = _format,
+                .subresourceRange{
+                    .aspectMask = vk::ImageAspectFlagBits::eColor,
+                    .baseMipLevel = 0,
+                    .levelCount = 1,
+                    .baseArrayLayer = 0,
+                    .layerCount = 1,
+                },
+            };
+            _imageViews[i] = _device.createImageView(imageViewCreateInfo);
+
+            // Create the readback buffer. It stays mapped during its whole lifetime.
+            if (!_readbackDirectory.empty())
+            {
+                VkBufferCreateInfo bufferCreateInfo = vk::BufferCreateInfo{
+                    .size = static_cast<vk::DeviceSize>(_extent.width) * _extent.height * READBACK_PIXEL_SIZE,
+                    .usage = vk::BufferUsageFlagBits::eTransferDst,
+                    .sharingMode = vk::SharingMode::eExclusive,
+                };
+                VmaAllocationCreateInfo bufferAllocationCreateInfo{
+                    .flags = VMA_ALLOCATION_CREATE_MAPPED_BIT,
+                    .usage = VMA_MEMORY_USAGE_GPU_TO_CPU,
+                };
+                VkBuffer buffer;
+                VmaAllocationInfo allocationInfo;
+                if (vmaCreateBuffer(_allocator, &bufferCreateInfo, &bufferAllocationCreateInfo, &buffer, &_readbacks[i].allocation, &allocationInfo) != VK_SUCCESS)
+                {
+                    throw std::runtime_error("Failed to create a readback buffer.");
+                }
+                _readbacks[i].buffer = buffer;
+                _readbacks[i].mappedData = allocationInfo.pMappedData;
+            }
+        }
+
+#ifdef USE_ADVANCED_CHECKS
+        _initialized = true;
+#endif
+    }
+
+    void OffscreenTarget::Cleanup()
+    {
+        ADVANCED_CHECK(_initialized, NOT_INITIALIZED_ERROR);
+
+        for (uint32_t i = 0; i < NB_OVERLAPPING_FRAMES; i++)
+        {
+            // The last frames were not written yet
+            if (_readbacks[i].pending)
+            {
+                WriteReadback(_readbacks[i]);
+            }
+            if (_readbacks[i].buffer)
+            {
+                vmaDestroyBuffer(_allocator, _readbacks[i].buffer, _readbacks[i].allocation);
+            }
+            _readbacks[i] = Readback{};
+
+            _device.destroyImageView(_imageViews[i]);
+            vmaDestroyImage(_allocator, _images[i], _imageAllocations[i]);
+            _imageViews[i] = nullptr;
+            _images[i] = nullptr;
+            _imageAllocations[i] = nullptr;
+        }
+
+#ifdef USE_ADVANCED_CHECKS
+        // Back to the beginning
+        _initialized = false;
+#endif
+    }
+
+    OffscreenTarget::~OffscreenTarget()
+    {
+        ADVANCED_CHECK(!_initialized, NOT_CLEANED_ERROR);
+    }
+
+    void OffscreenTarget::WriteReadback(Readback &readback)
+    {
+        // The memory may not be coherent
+        vmaInvalidateAllocation(_allocator, readback.allocation, 0, VK_WHOLE_SIZE);
+
+        // Binary PPM, which only stores RGB
+        const auto *pixels = static_cast<const uint8_t *>(readback.mappedData);
+        const size_t pixelCount = static_cast<size_t>(_extent.width) * _extent.height;
+        std::vector<uint8_t> rgb(pixelCount * 3);
+        for (size_t i = 0; i < pixelCount; i++)
+        {
+            rgb[i * 3] = pixels[i * READBACK_PIXEL_SIZE + 2];
+            rgb[i * 3 + 1] = pixels[i * READBACK_PIXEL_SIZE + 1];
+            rgb[i * 3 + 2] = pixels[i * READBACK_PIXEL_SIZE];
+        }
+
+        char fileName[32];
+        std::snprintf(fileName, sizeof(fileName), "frame_%06llu.ppm", static_cast<unsigned long long>(readback.frameNumber));
+        const auto path = _readbackDirectory / fileName;
+        std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+        stream << "P6\n"
+               << _extent.width << ' ' << _extent.height << "\n255\n";
+        stream.write(reinterpret_cast<const char *>(rgb.data()), static_cast<std::streamsize>(rgb.size()));
+        if (!stream)
+        {
+            throw std::runtime_error("Unable to write \"" + path.string() + "\".");
+        }
+
+        readback.pending = false;
+    }
+
+    void OffscreenTarget::BeginFrame(uint32_t frameIndex)
+    {
+        ADVANCED_CHECK(_initialized, NOT_INITIALIZED_ERROR);
+
+        if (_readbacks[frameIndex].pending)
+        {
+            WriteReadback(_readbacks[frameIndex]);
+        }
+    }
+
+    void OffscreenTarget::RecordReadback(const vk::CommandBuffer &cmd, uint32_t frameIndex, uint64_t frameNumber)
+    {
+        ADVANCED_CHECK(_initialized, NOT_INITIALIZED_ERROR);
+
+        if (_readbackDirectory.empty())
+        {
+            return;
+        }
+
+        auto &readback = _readbacks[frameIndex];
+        vk::BufferImageCopy region{
+            .bufferOffset = 0,
+            // Tightly packed
+            .bufferRowLength = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource{
+                .aspectMask = vk::ImageAspectFlagBits::eColor,
+                .mipLevel = 0,
+                .baseArrayLayer = 0,
+                .layerCount = 1,
+            },
+            .imageOffset{0, 0, 0},
+            .imageExtent{
+                .width = _extent.width,
+                .height = _extent.height,
+                .depth = 1,
+            },
+        };
+        cmd.copyImageToBuffer(_images[frameIndex], vk::ImageLayout::eTransferSrcOptimal, readback.buffer, region);
+
+        // Make the copy visible to the host once the fence is signaled
+        vk::BufferMemoryBarrier barrier{
+            .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+            .dstAccessMask = vk::AccessFlagBits::eHostRead,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .buffer = readback.buffer,
+            .offset = 0,
+            .size = VK_WHOLE_SIZE,
+        };
+        cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost, {}, nullptr, barrier, nullptr);
+
+        readback.frameNumber = frameNumber;
+        readback.pending = true;
+    }
+
+    vk::Image OffscreenTarget::GetImage(uint32_t frameIndex) const
+    {
+        return _images[frameIndex];
+    }
+
+    vk::ImageView OffscreenTarget::GetImageView(uint32_t frameIndex) const
+    {
+        return _imageViews[frameIndex];
+    }
+
+    vk::Format OffscreenTarget::GetFormat() const
+    {
+        return _format;
+    }
+
+    vk::Extent2D OffscreenTarget::GetExtent() const
+    {
+        return _extent;
+    }
+
+    bool OffscreenTarget::IsReadbackEnabled() const
+    {
+        return !_readbackDirectory.empty();
+    }
+} // namespace railguard::rendering
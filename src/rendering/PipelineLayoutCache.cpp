@@ -0,0 +1,243 @@
+#include "../../include/rendering/PipelineLayoutCache.h"
+#include "../../include/utils/AdvancedCheck.h"
+#include "../../include/utils/Hash.h"
+#include <algorithm>
+
+#ifdef USE_ADVANCED_CHECKS
+// Define local error messages
+#define INITIALIZED_TWICE_ERROR "PipelineLayoutCache should not be initialized twice."
+#define NOT_INITIALIZED_ERROR "PipelineLayoutCache should be initialized with Init before calling this method."
+#define NOT_CLEANED_ERROR "PipelineLayoutCache should be cleaned up with Cleanup before it is destroyed."
+#define UNKNOWN_LAYOUT_ERROR "The given layout was not created by this PipelineLayoutCache."
+#endif
+
+namespace railguard::rendering
+{
+    // ===== HASH FUNCTORS =====
+
+    size_t DescriptorSetLayoutDescriptionHash::operator()(const structs::DescriptorSetLayoutDescription &description) const
+    {
+        size_t seed = description.bindings.size();
+        utils::HashCombine(seed, static_cast<VkDescriptorSetLayoutCreateFlags>(description.flags));
+
+        for (const auto &binding : description.bindings)
+        {
+            utils::HashCombine(seed, binding.binding);
+            utils::HashCombine(seed, binding.descriptorType);
+            utils::HashCombine(seed, binding.descriptorCount);
+            utils::HashCombine(seed, static_cast<VkShaderStageFlags>(binding.stageFlags));
+            utils::HashCombine(seed, binding.pImmutableSamplers);
+        }
+        return seed;
+    }
+
+    size_t PipelineLayoutDescriptionHash::operator()(const structs::PipelineLayoutDescription &description) const
+    {
+        size_t seed = description.setLayouts.size();
+        DescriptorSetLayoutDescriptionHash setLayoutHash;
+
+        for (const auto &setLayout : description.setLayouts)
+        {
+            utils::HashCombine(seed, setLayoutHash(setLayout));
+        }
+        for (const auto &range : description.pushConstantRanges)
+        {
+            utils::HashCombine(seed, static_cast<VkShaderStageFlags>(range.stageFlags));
+            utils::HashCombine(seed, range.offset);
+            utils::HashCombine(seed, range.size);
+        }
+        return seed;
+    }
+
+    // ===== CACHE =====
+
+    void PipelineLayoutCache::Init(const vk::Device &device)
+    {
+        ADVANCED_CHECK(!_initialized, INITIALIZED_TWICE_ERROR);
+
+        _device = device;
+
+#ifdef USE_ADVANCED_CHECKS
+        _initialized = true;
+#endif
+    }
+
+    void PipelineLayoutCache::Cleanup()
+    {
+        ADVANCED_CHECK(_initialized, NOT_INITIALIZED_ERROR);
+
+        // Destroy pipeline layouts first since they use the set layouts
+        for (const auto &[_, entry] : _pipelineLayouts)
+        {
+            _device.destroyPipelineLayout(entry.handle);
+        }
+        for (const auto &[_, entry] : _setLayouts)
+        {
+            _device.destroyDescriptorSetLayout(entry.handle);
+        }
+
+        _pipelineLayouts.clear();
+        _setLayouts.clear();
+        _pipelineLayoutDescriptions.clear();
+        _setLayoutDescriptions.clear();
+
+#ifdef USE_ADVANCED_CHECKS
+        // Back to the beginning
+        _initialized = false;
+#endif
+    }
+
+    PipelineLayoutCache::~PipelineLayoutCache()
+    {
+        ADVANCED_CHECK(!_initialized, NOT_CLEANED_ERROR);
+    }
+
+    structs::DescriptorSetLayoutDescription PipelineLayoutCache::Canonicalize(const structs::DescriptorSetLayoutDescription &description)
+    {
+        // The order in which bindings are declared doesn't matter to vulkan, so sort them
+        structs::DescriptorSetLayoutDescription result = description;
+        std::sort(result.bindings.begin(), result.bindings.end(),
+                  [](const vk::DescriptorSetLayoutBinding &a, const vk::DescriptorSetLayoutBinding &b)
+                  { return a.binding < b.binding; });
+        return result;
+    }
+
+    structs::PipelineLayoutDescription PipelineLayoutCache::Canonicalize(const structs::PipelineLayoutDescription &description)
+    {
+        structs::PipelineLayoutDescription result;
+        result.setLayouts.reserve(description.setLayouts.size());
+
+        // The order of the sets matters (it defines the set index), but not the order of the bindings inside them
+        for (const auto &setLayout : description.setLayouts)
+        {
+            result.setLayouts.push_back(Canonicalize(setLayout));
+        }
+
+        // Same for push constant ranges
+        result.pushConstantRanges = description.pushConstantRanges;
+        std::sort(result.pushConstantRanges.begin(), result.pushConstantRanges.end(),
+                  [](const vk::PushConstantRange &a, const vk::PushConstantRange &b)
+                  { return a.offset < b.offset || (a.offset == b.offset && static_cast<VkShaderStageFlags>(a.stageFlags) < static_cast<VkShaderStageFlags>(b.stageFlags)); });
+
+        return result;
+    }
+
+    vk::DescriptorSetLayout PipelineLayoutCache::GetDescriptorSetLayout(const structs::DescriptorSetLayoutDescription &description)
+    {
+        ADVANCED_CHECK(_initialized, NOT_INITIALIZED_ERROR);
+
+        auto key = Canonicalize(description);
+        auto &entry = _setLayouts[key];
+
+        // Create it if it is the first time that this layout is requested
+        if (entry.referenceCount == 0)
+        {
+            vk::DescriptorSetLayoutCreateInfo createInfo{
+                .flags = key.flags,
+                .bindingCount = static_cast<uint32_t>(key.bindings.size()),
+                .pBindings = key.bindings.data(),
+            };
+            entry.handle = _device.createDescriptorSetLayout(createInfo);
+            _setLayoutDescriptions[static_cast<VkDescriptorSetLayout>(entry.handle)] = key;
+        }
+
+        entry.referenceCount++;
+        return entry.handle;
+    }
+
+    vk::PipelineLayout PipelineLayoutCache::GetPipelineLayout(const structs::PipelineLayoutDescription &description)
+    {
+        ADVANCED_CHECK(_initialized, NOT_INITIALIZED_ERROR);
+
+        auto key = Canonicalize(description);
+        auto &entry = _pipelineLayouts[key];
+
+        if (entry.referenceCount == 0)
+        {
+            // Get the set layouts. The pipeline layout holds a reference to each of them until it is destroyed.
+            std::vector<vk::DescriptorSetLayout> setLayouts;
+            setLayouts.reserve(key.setLayouts.size());
+            for (const auto &setLayout : key.setLayouts)
+            {
+                setLayouts.push_back(GetDescriptorSetLayout(setLayout));
+            }
+
+            vk::PipelineLayoutCreateInfo createInfo{
+                .flags = {},
+                .setLayoutCount = static_cast<uint32_t>(setLayouts.size()),
+                .pSetLayouts = setLayouts.data(),
+                .pushConstantRangeCount = static_cast<uint32_t>(key.pushConstantRanges.size()),
+                .pPushConstantRanges = key.pushConstantRanges.data(),
+            };
+            entry.handle = _device.createPipelineLayout(createInfo);
+            _pipelineLayoutDescriptions[static_cast<VkPipelineLayout>(entry.handle)] = key;
+        }
+
+        entry.referenceCount++;
+        return entry.handle;
+    }
+
+    void PipelineLayoutCache::ReleaseDescriptorSetLayout(vk::DescriptorSetLayout setLayout)
+    {
+        ADVANCED_CHECK(_initialized, NOT_INITIALIZED_ERROR);
+        ADVANCED_CHECK(_setLayoutDescriptions.contains(static_cast<VkDescriptorSetLayout>(setLayout)), UNKNOWN_LAYOUT_ERROR);
+
+        auto descriptionIt = _setLayoutDescriptions.find(static_cast<VkDescriptorSetLayout>(setLayout));
+        auto entryIt = _setLayouts.find(descriptionIt->second);
+
+        if (--entryIt->second.referenceCount == 0)
+        {
+            _device.destroyDescriptorSetLayout(setLayout);
+            _setLayouts.erase(entryIt);
+            _setLayoutDescriptions.erase(descriptionIt);
+        }
+    }
+
+    void PipelineLayoutCache::ReleasePipelineLayout(vk::PipelineLayout pipelineLayout)
+    {
+        ADVANCED_CHECK(_initialized, NOT_INITIALIZED_ERROR);
+        ADVANCED_CHECK(_pipelineLayoutDescriptions.contains(static_cast<VkPipelineLayout>(pipelineLayout)), UNKNOWN_LAYOUT_ERROR);
+
+        auto descriptionIt = _pipelineLayoutDescriptions.find(static_cast<VkPipelineLayout>(pipelineLayout));
+        auto entryIt = _pipelineLayouts.find(descriptionIt->second);
+
+        if (--entryIt->second.referenceCount == 0)
+        {
+            _device.destroyPipelineLayout(pipelineLayout);
+
+            // Release the set layouts that were retained by this layout
+            for (const auto &setLayout : descriptionIt->second.setLayouts)
+            {
+                auto &setEntry = _setLayouts.at(setLayout);
+                ReleaseDescriptorSetLayout(setEntry.handle);
+            }
+
+            _pipelineLayouts.erase(entryIt);
+            _pipelineLayoutDescriptions.erase(descriptionIt);
+        }
+    }
+
+    void PipelineLayoutCache::RetainPipelineLayout(vk::PipelineLayout pipelineLayout)
+    {
+        ADVANCED_CHECK(_initialized, NOT_INITIALIZED_ERROR);
+        ADVANCED_CHECK(_pipelineLayoutDescriptions.contains(static_cast<VkPipelineLayout>(pipelineLayout)), UNKNOWN_LAYOUT_ERROR);
+
+        _pipelineLayouts.at(_pipelineLayoutDescriptions.at(static_cast<VkPipelineLayout>(pipelineLayout))).referenceCount++;
+    }
+
+    const structs::PipelineLayoutDescription &PipelineLayoutCache::GetDescription(vk::PipelineLayout pipelineLayout) const
+    {
+        return _pipelineLayoutDescriptions.at(static_cast<VkPipelineLayout>(pipelineLayout));
+    }
+
+    size_t PipelineLayoutCache::GetPipelineLayoutCount() const
+    {
+        return _pipelineLayouts.size();
+    }
+
+    size_t PipelineLayoutCache::GetDescriptorSetLayoutCount() const
+    {
+        return _setLayouts.size();
+    }
+
+} // namespace railguard::rendering
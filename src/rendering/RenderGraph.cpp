@@ -0,0 +1,1003 @@
+#include "../../include/rendering/RenderGraph.h"
+#include "../../include/rendering/init/RenderPassBuilder.h"
+#include "../../include/utils/AdvancedCheck.h"
+#include "../../include/utils/Hash.h"
+#include <algorithm>
+
+#ifdef USE_ADVANCED_CHECKS
+// Define local error messages
+#define INITIALIZED_TWICE_ERROR "RenderGraph should not be initialized twice."
+#define NOT_INITIALIZED_ERROR "RenderGraph should be initialized with Init before calling this method."
+#define NOT_CLEANED_ERROR "RenderGraph should be cleaned up with Cleanup before it is destroyed."
+#define NOT_COMPILED_ERROR "RenderGraph should be compiled with Compile before it is executed."
+#define NOT_IMPORTED_ERROR "Only imported resources can be set with SetImportedImage."
+#define IMPORTED_IMAGE_NOT_SET_ERROR "An imported resource is used by the graph, but no image was given with SetImportedImage."
+#endif
+
+// Accesses that need to be made available before another access
+#define WRITE_ACCESS_MASK (vk::AccessFlagBits::eColorAttachmentWrite | vk::AccessFlagBits::eDepthStencilAttachmentWrite | vk::AccessFlagBits::eShaderWrite | vk::AccessFlagBits::eTransferWrite | vk::AccessFlagBits::eHostWrite | vk::AccessFlagBits::eMemoryWrite)
+#define NO_BLOCK UINT32_MAX
+#define NO_USE UINT32_MAX
+#define NO_GROUP UINT32_MAX
+
+namespace railguard::rendering
+{
+    static bool IsDepthFormat(vk::Format format)
+    {
+        switch (format)
+        {
+        case vk::Format::eD16Unorm:
+        case vk::Format::eX8D24UnormPack32:
+        case vk::Format::eD32Sfloat:
+        case vk::Format::eD16UnormS8Uint:
+        case vk::Format::eD24UnormS8Uint:
+        case vk::Format::eD32SfloatS8Uint:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    static vk::ImageAspectFlags GetAspectMask(vk::Format format)
+    {
+        switch (format)
+        {
+        case vk::Format::eD16UnormS8Uint:
+        case vk::Format::eD24UnormS8Uint:
+        case vk::Format::eD32SfloatS8Uint:
+            return vk::ImageAspectFlagBits::eDepth | vk::ImageAspectFlagBits::eStencil;
+        default:
+            return IsDepthFormat(format) ? vk::ImageAspectFlagBits::eDepth : vk::ImageAspectFlagBits::eColor;
+        }
+    }
+
+    // ===== INIT AND CLEANUP =====
+
+    void RenderGraph::Init(const vk::Device &device, VmaAllocator allocator)
+    {
+        ADVANCED_CHECK(!_initialized, INITIALIZED_TWICE_ERROR);
+
+        _device = device;
+        _allocator = allocator;
+
+#ifdef USE_ADVANCED_CHECKS
+        _initialized = true;
+#endif
+    }
+
+    void RenderGraph::Cleanup()
+    {
+        ADVANCED_CHECK(_initialized, NOT_INITIALIZED_ERROR);
+
+        DestroyCompiledObjects();
+
+        // Forget the declarations
+        _resourceDescriptions.clear();
+        _resourceImported.clear();
+        _importedInitialLayouts.clear();
+        _importedFinalLayouts.clear();
+        _images.clear();
+        _imageViews.clear();
+        _outputs.clear();
+        _passDescriptions.clear();
+
+#ifdef USE_ADVANCED_CHECKS
+        // Back to the beginning
+        _initialized = false;
+#endif
+    }
+
+    RenderGraph::~RenderGraph()
+    {
+        ADVANCED_CHECK(!_initialized, NOT_CLEANED_ERROR);
+    }
+
+    // ===== DECLARATION =====
+
+    render_resource_id_t RenderGraph::AddResource(const structs::RenderGraphImageDescription &description, bool imported, vk::ImageLayout initialLayout, vk::ImageLayout finalLayout)
+    {
+        ADVANCED_CHECK(_initialized, NOT_INITIALIZED_ERROR);
+
+        _resourceDescriptions.push_back(description);
+        _resourceImported.push_back(imported);
+        _importedInitialLayouts.push_back(initialLayout);
+        _importedFinalLayouts.push_back(finalLayout);
+        _images.push_back(nullptr);
+        _imageViews.push_back(nullptr);
+
+        return static_cast<render_resource_id_t>(_resourceDescriptions.size() - 1);
+    }
+
+    render_resource_id_t RenderGraph::CreateTransientImage(const structs::RenderGraphImageDescription &description)
+    {
+        return AddResource(description, false, vk::ImageLayout::eUndefined, vk::ImageLayout::eUndefined);
+    }
+
+    render_resource_id_t RenderGraph::ImportImage(const structs::RenderGraphImageDescription &description, vk::ImageLayout initialLayout, vk::ImageLayout finalLayout)
+    {
+        return AddResource(description, true, initialLayout, finalLayout);
+    }
+
+    void RenderGraph::SetImportedImage(render_resource_id_t resource, vk::Image image, vk::ImageView imageView)
+    {
+        ADVANCED_CHECK(_resourceImported[resource], NOT_IMPORTED_ERROR);
+
+        _images[resource] = image;
+        _imageViews[resource] = imageView;
+    }
+
+    void RenderGraph::MarkAsOutput(render_resource_id_t resource)
+    {
+        _outputs.push_back(resource);
+    }
+
+    render_pass_id_t RenderGraph::AddPass(const structs::RenderGraphPassDescription &description)
+    {
+        ADVANCED_CHECK(_initialized, NOT_INITIALIZED_ERROR);
+
+        _passDescriptions.push_back(description);
+        return static_cast<render_pass_id_t>(_passDescriptions.size() - 1);
+    }
+
+    // ===== COMPILATION =====
+
+    std::vector<RenderGraph::ResourceUse> RenderGraph::GetResourceUses(const structs::RenderGraphPassDescription &pass)
+    {
+        std::vector<ResourceUse> uses;
+        uses.reserve(pass.colorAttachments.size() + pass.inputAttachments.size() + pass.sampledImages.size() + 1);
+
+        for (const auto &attachment : pass.colorAttachments)
+        {
+            const bool load = attachment.loadOp == vk::AttachmentLoadOp::eLoad;
+            uses.push_back(ResourceUse{
+                .resource = attachment.resource,
+                .state = ResourceState{
+                    .layout = vk::ImageLayout::eColorAttachmentOptimal,
+                    .stages = vk::PipelineStageFlagBits::eColorAttachmentOutput,
+                    .access = load ? vk::AccessFlagBits::eColorAttachmentWrite | vk::AccessFlagBits::eColorAttachmentRead
+                                   : vk::AccessFlags(vk::AccessFlagBits::eColorAttachmentWrite),
+                },
+                .usage = vk::ImageUsageFlagBits::eColorAttachment,
+                .discardContent = !load,
+            });
+        }
+        if (pass.depthAttachment.has_value())
+        {
+            const auto &attachment = pass.depthAttachment.value();
+            const bool load = attachment.readOnly || attachment.loadOp == vk::AttachmentLoadOp::eLoad;
+            uses.push_back(ResourceUse{
+                .resource = attachment.resource,
+                .state = ResourceState{
+                    .layout = attachment.readOnly ? vk::ImageLayout::eDepthStencilReadOnlyOptimal : vk::ImageLayout::eDepthStencilAttachmentOptimal,
+                    .stages = vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests,
+                    .access = attachment.readOnly ? vk::AccessFlags(vk::AccessFlagBits::eDepthStencilAttachmentRead)
+                                                  : vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+                },
+                .usage = vk::ImageUsageFlagBits::eDepthStencilAttachment,
+                .discardContent = !load,
+            });
+        }
+        // Depth input attachments use another layout, which is set by the caller since the format is not known here
+        for (auto resource : pass.inputAttachments)
+        {
+            uses.push_back(ResourceUse{
+                .resource = resource,
+                .state = ResourceState{
+                    .layout = vk::ImageLayout::eShaderReadOnlyOptimal,
+                    .stages = vk::PipelineStageFlagBits::eFragmentShader,
+                    .access = vk::AccessFlagBits::eInputAttachmentRead,
+                },
+                .usage = vk::ImageUsageFlagBits::eInputAttachment,
+                .discardContent = false,
+            });
+        }
+        for (auto resource : pass.sampledImages)
+        {
+            uses.push_back(ResourceUse{
+                .resource = resource,
+                .state = ResourceState{
+                    .layout = vk::ImageLayout::eShaderReadOnlyOptimal,
+                    .stages = vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eComputeShader,
+                    .access = vk::AccessFlagBits::eShaderRead,
+                },
+                .usage = vk::ImageUsageFlagBits::eSampled,
+                .discardContent = false,
+            });
+        }
+
+        return uses;
+    }
+
+    void RenderGraph::Compile()
+    {
+        ADVANCED_CHECK(_initialized, NOT_INITIALIZED_ERROR);
+
+        // Start from a clean state if the graph was already compiled
+        DestroyCompiledObjects();
+
+        CullPasses();
+        GroupPasses();
+
+        // Compute the lifetime of each resource, as well as the usage flags that it needs
+        // Lifetimes are expressed in groups, since a resource used in a render pass is alive during the whole render pass
+        const size_t resourceCount = _resourceDescriptions.size();
+        std::vector<uint32_t> firstUses(resourceCount, NO_USE);
+        std::vector<uint32_t> lastUses(resourceCount, 0);
+        std::vector<vk::ImageUsageFlags> usages(resourceCount);
+
+        for (uint32_t g = 0; g < _groups.size(); g++)
+        {
+            const auto &group = _groups[g];
+            for (uint32_t i = group.first; i < group.first + group.count; i++)
+            {
+                for (const auto &use : GetResourceUses(_passDescriptions[_executionOrder[i]]))
+                {
+                    firstUses[use.resource] = std::min(firstUses[use.resource], g);
+                    lastUses[use.resource] = g;
+                    usages[use.resource] |= use.usage;
+                }
+            }
+        }
+
+        CreateTransientImages(firstUses, lastUses, usages);
+        ComputeBarriers(lastUses);
+        CreateRenderPasses(lastUses);
+
+        _compiled = true;
+    }
+
+    void RenderGraph::CullPasses()
+    {
+        // Walk the passes backwards from the outputs, and keep those that write a resource that is still needed
+        std::vector<bool> neededResources(_resourceDescriptions.size(), false);
+        std::vector<bool> alivePasses(_passDescriptions.size(), false);
+
+        for (auto output : _outputs)
+        {
+            neededResources[output] = true;
+        }
+
+        for (size_t p = _passDescriptions.size(); p-- > 0;)
+        {
+            const auto &pass = _passDescriptions[p];
+
+            bool alive = pass.hasSideEffects;
+            for (const auto &attachment : pass.colorAttachments)
+            {
+                alive |= neededResources[attachment.resource];
+            }
+            if (pass.depthAttachment.has_value() && !pass.depthAttachment->readOnly)
+            {
+                alive |= neededResources[pass.depthAttachment->resource];
+            }
+
+            if (!alive)
+            {
+                continue;
+            }
+            alivePasses[p] = true;
+
+            // A cleared attachment doesn't depend on what previous passes wrote in it
+            // A loaded one does, so the previous writers are still needed
+            for (const auto &attachment : pass.colorAttachments)
+            {
+                neededResources[attachment.resource] = attachment.loadOp == vk::AttachmentLoadOp::eLoad;
+            }
+            if (pass.depthAttachment.has_value())
+            {
+                neededResources[pass.depthAttachment->resource] = pass.depthAttachment->readOnly || pass.depthAttachment->loadOp == vk::AttachmentLoadOp::eLoad;
+            }
+            for (auto resource : pass.inputAttachments)
+            {
+                neededResources[resource] = true;
+            }
+            for (auto resource : pass.sampledImages)
+            {
+                neededResources[resource] = true;
+            }
+        }
+
+        // Keep the declaration order for the remaining passes
+        _passGroups.assign(_passDescriptions.size(), NO_GROUP);
+        _passSubpasses.assign(_passDescriptions.size(), 0);
+        for (render_pass_id_t p = 0; p < _passDescriptions.size(); p++)
+        {
+            if (alivePasses[p])
+            {
+                _executionOrder.push_back(p);
+            }
+        }
+    }
+
+    bool RenderGraph::CanMergeIntoLastGroup(const structs::RenderGraphPassDescription &pass) const
+    {
+        if (_groups.empty() || _groups.back().attachments.empty())
+        {
+            return false;
+        }
+        const auto &group = _groups.back();
+        auto inGroup = [&](render_resource_id_t resource)
+        {
+            return std::find(group.attachments.begin(), group.attachments.end(), resource) != group.attachments.end();
+        };
+
+        // Merging is only useful if the pass reads the result of the group at the same pixel
+        if (std::none_of(pass.inputAttachments.begin(), pass.inputAttachments.end(), inGroup))
+        {
+            return false;
+        }
+        // Sampling an attachment requires it to be stored first, so it can't be done in the same render pass
+        if (std::any_of(pass.sampledImages.begin(), pass.sampledImages.end(), inGroup))
+        {
+            return false;
+        }
+
+        // Every attachment of a render pass must have the same size
+        auto sameExtent = [&](render_resource_id_t resource)
+        {
+            return _resourceDescriptions[resource].extent == group.extent;
+        };
+        bool result = std::all_of(pass.inputAttachments.begin(), pass.inputAttachments.end(), sameExtent);
+        for (const auto &attachment : pass.colorAttachments)
+        {
+            result &= sameExtent(attachment.resource);
+        }
+        if (pass.depthAttachment.has_value())
+        {
+            result &= sameExtent(pass.depthAttachment->resource);
+        }
+        return result;
+    }
+
+    void RenderGraph::GroupPasses()
+    {
+        for (uint32_t i = 0; i < _executionOrder.size(); i++)
+        {
+            const auto passId = _executionOrder[i];
+            const auto &pass = _passDescriptions[passId];
+
+            if (CanMergeIntoLastGroup(pass))
+            {
+                _groups.back().count++;
+            }
+            else
+            {
+                _groups.push_back(PassGroup{.first = i});
+            }
+
+            auto &group = _groups.back();
+            _passGroups[passId] = static_cast<uint32_t>(_groups.size() - 1);
+            _passSubpasses[passId] = group.count - 1;
+
+            // Register the attachments of the pass, in the order of the render pass
+            auto addAttachment = [&](render_resource_id_t resource)
+            {
+                if (group.attachments.empty())
+                {
+                    group.extent = _resourceDescriptions[resource].extent;
+                }
+                if (std::find(group.attachments.begin(), group.attachments.end(), resource) == group.attachments.end())
+                {
+                    group.attachments.push_back(resource);
+                }
+            };
+            for (const auto &attachment : pass.colorAttachments)
+            {
+                addAttachment(attachment.resource);
+            }
+            if (pass.depthAttachment.has_value())
+            {
+                addAttachment(pass.depthAttachment->resource);
+            }
+            for (auto resource : pass.inputAttachments)
+            {
+                addAttachment(resource);
+            }
+        }
+    }
+
+    void RenderGraph::CreateTransientImages(const std::vector<uint32_t> &firstUses, const std::vector<uint32_t> &lastUses, const std::vector<vk::ImageUsageFlags> &usages)
+    {
+        const size_t resourceCount = _resourceDescriptions.size();
+        _resourceBlocks.assign(resourceCount, NO_BLOCK);
+        _lazyAllocations.assign(resourceCount, nullptr);
+
+        // Lazily allocated memory is usually only available on tiled GPUs
+        VmaAllocationCreateInfo lazyAllocationCreateInfo{
+            .usage = VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED,
+        };
+        uint32_t lazyMemoryTypeIndex;
+        const bool lazyMemorySupported = vmaFindMemoryTypeIndex(_allocator, UINT32_MAX, &lazyAllocationCreateInfo, &lazyMemoryTypeIndex) == VK_SUCCESS;
+        const vk::ImageUsageFlags attachmentUsages = vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eDepthStencilAttachment | vk::ImageUsageFlagBits::eInputAttachment;
+
+        // Create the images of the transient resources that are used by at least one pass
+        std::vector<render_resource_id_t> transientResources;
+        std::vector<vk::MemoryRequirements> requirements(resourceCount);
+
+        for (render_resource_id_t resource = 0; resource < resourceCount; resource++)
+        {
+            if (_resourceImported[resource] || firstUses[resource] == NO_USE)
+            {
+                continue;
+            }
+
+            // An image that only lives inside a render pass and is never stored doesn't need actual memory on tiled GPUs
+            const bool lazy = lazyMemorySupported && firstUses[resource] == lastUses[resource] && !(usages[resource] & ~attachmentUsages) &&
+                              std::find(_outputs.begin(), _outputs.end(), resource) == _outputs.end();
+
+            const auto &description = _resourceDescriptions[resource];
+            vk::ImageCreateInfo imageCreateInfo{
+                .imageType = vk::ImageType::e2D,
+                .format = description.format,
+                .extent = vk::Extent3D{
+                    .width = description.extent.width,
+                    .height = description.extent.height,
+                    .depth = 1,
+                },
+                .mipLevels = 1,
+                .arrayLayers = 1,
+                .samples = vk::SampleCountFlagBits::e1,
+                .tiling = vk::ImageTiling::eOptimal,
+                .usage = lazy ? usages[resource] | vk::ImageUsageFlagBits::eTransientAttachment : usages[resource],
+                .sharingMode = vk::SharingMode::eExclusive,
+                .initialLayout = vk::ImageLayout::eUndefined,
+            };
+            _images[resource] = _device.createImage(imageCreateInfo);
+            requirements[resource] = _device.getImageMemoryRequirements(_images[resource]);
+            _unaliasedTransientMemorySize += requirements[resource].size;
+
+            // If the lazy allocation fails, the image can still be stored in regular memory
+            if (lazy)
+            {
+                VkMemoryRequirements lazyRequirements = requirements[resource];
+                VmaAllocationInfo allocationInfo;
+                if (vmaAllocateMemory(_allocator, &lazyRequirements, &lazyAllocationCreateInfo, &_lazyAllocations[resource], &allocationInfo) == VK_SUCCESS)
+                {
+                    _lazyTransientMemorySize += allocationInfo.size;
+                    continue;
+                }
+                _lazyAllocations[resource] = nullptr;
+            }
+
+            transientResources.push_back(resource);
+        }
+
+        // Place the biggest images first, so that the smaller ones fit in their blocks
+        std::sort(transientResources.begin(), transientResources.end(),
+                  [&](render_resource_id_t a, render_resource_id_t b)
+                  { return requirements[a].size > requirements[b].size; });
+
+        // Greedily assign each image to the first block that is free during its whole lifetime
+        for (auto resource : transientResources)
+        {
+            const auto &requirement = requirements[resource];
+            const std::pair<uint32_t, uint32_t> lifetime{firstUses[resource], lastUses[resource]};
+
+            uint32_t chosenBlock = NO_BLOCK;
+            for (uint32_t b = 0; b < _aliasingBlocks.size() && chosenBlock == NO_BLOCK; b++)
+            {
+                const auto &block = _aliasingBlocks[b];
+                if ((block.memoryTypeBits & requirement.memoryTypeBits) == 0)
+                {
+                    continue;
+                }
+
+                bool overlaps = std::any_of(block.lifetimes.begin(), block.lifetimes.end(),
+                                            [&](const std::pair<uint32_t, uint32_t> &other)
+                                            { return lifetime.first <= other.second && other.first <= lifetime.second; });
+                if (!overlaps)
+                {
+                    chosenBlock = b;
+                }
+            }
+
+            if (chosenBlock == NO_BLOCK)
+            {
+                _aliasingBlocks.emplace_back();
+                chosenBlock = static_cast<uint32_t>(_aliasingBlocks.size() - 1);
+            }
+
+            auto &block = _aliasingBlocks[chosenBlock];
+            block.size = std::max(block.size, requirement.size);
+            block.alignment = std::max(block.alignment, requirement.alignment);
+            block.memoryTypeBits &= requirement.memoryTypeBits;
+            block.lifetimes.push_back(lifetime);
+            _resourceBlocks[resource] = chosenBlock;
+        }
+
+        // Allocate the blocks
+        VmaAllocationCreateInfo allocationCreateInfo{
+            .usage = VMA_MEMORY_USAGE_GPU_ONLY,
+        };
+        for (auto &block : _aliasingBlocks)
+        {
+            VkMemoryRequirements blockRequirements{
+                .size = block.size,
+                .alignment = block.alignment,
+                .memoryTypeBits = block.memoryTypeBits,
+            };
+            if (vmaAllocateMemory(_allocator, &blockRequirements, &allocationCreateInfo, &block.allocation, nullptr) != VK_SUCCESS)
+            {
+                throw std::runtime_error("Failed to allocate memory for the transient images of the render graph.");
+            }
+            _transientMemorySize += block.size;
+        }
+
+        // Bind the images to their memory and create their views
+        for (render_resource_id_t resource = 0; resource < resourceCount; resource++)
+        {
+            VmaAllocation allocation = _lazyAllocations[resource];
+            if (_resourceBlocks[resource] != NO_BLOCK)
+            {
+                allocation = _aliasingBlocks[_resourceBlocks[resource]].allocation;
+            }
+            if (allocation == nullptr)
+            {
+                continue;
+            }
+            vmaBindImageMemory(_allocator, allocation, static_cast<VkImage>(_images[resource]));
+
+            const auto &description = _resourceDescriptions[resource];
+            vk::ImageViewCreateInfo imageViewCreateInfo{
+                .image = _images[resource],
+                .viewType = vk::ImageViewType::e2D,
+                .format = description.format,
+                .subresourceRange{
+                    .aspectMask = GetAspectMask(description.format),
+                    .baseMipLevel = 0,
+                    .levelCount = 1,
+                    .baseArrayLayer = 0,
+                    .layerCount = 1,
+                },
+            };
+            _imageViews[resource] = _device.createImageView(imageViewCreateInfo);
+        }
+    }
+
+    void RenderGraph::ComputeBarriers(const std::vector<uint32_t> &lastUses)
+    {
+        const size_t resourceCount = _resourceDescriptions.size();
+        std::vector<ResourceState> states(resourceCount);
+        std::vector<bool> touched(resourceCount, false);
+        // Group and index of the barrier of the first use of each transient image
+        std::vector<std::pair<uint32_t, size_t>> firstUseBarriers(resourceCount);
+
+        // Imported images may have been used by anything before the graph
+        for (render_resource_id_t resource = 0; resource < resourceCount; resource++)
+        {
+            if (_resourceImported[resource])
+            {
+                states[resource] = ResourceState{
+                    .layout = _importedInitialLayouts[resource],
+                    .stages = vk::PipelineStageFlagBits::eAllCommands,
+                    .access = {},
+                };
+            }
+        }
+
+        for (uint32_t g = 0; g < _groups.size(); g++)
+        {
+            auto &group = _groups[g];
+            std::vector<bool> usedInGroup(resourceCount, false);
+
+            auto transition = [&](render_resource_id_t resource, const ResourceState &target, bool discardContent)
+            {
+                auto &current = states[resource];
+                const bool firstUseOfTransient = !_resourceImported[resource] && !touched[resource];
+                const bool currentWrites = static_cast<bool>(current.access & WRITE_ACCESS_MASK);
+                const bool targetWrites = static_cast<bool>(target.access & WRITE_ACCESS_MASK);
+                touched[resource] = true;
+
+                // Two reads in the same layout don't need a barrier, but a later write will need to wait for both
+                if (!firstUseOfTransient && current.layout == target.layout && !currentWrites && !targetWrites)
+                {
+                    current.stages |= target.stages;
+                    current.access |= target.access;
+                    return;
+                }
+
+                ImageBarrier barrier{
+                    .resource = resource,
+                    .source = current,
+                    .destination = target,
+                };
+                // Skip the layout conversion if the content will be overwritten anyway
+                if (discardContent)
+                {
+                    barrier.source.layout = vk::ImageLayout::eUndefined;
+                }
+                // The memory may have been used by another image before: wait for it
+                if (firstUseOfTransient && _resourceBlocks[resource] != NO_BLOCK)
+                {
+                    const auto &block = _aliasingBlocks[_resourceBlocks[resource]];
+                    barrier.source.stages |= block.lastState.stages;
+                    barrier.source.access |= block.lastState.access;
+                }
+                // Only writes need to be made available
+                barrier.source.access &= WRITE_ACCESS_MASK;
+
+                if (firstUseOfTransient)
+                {
+                    firstUseBarriers[resource] = {g, group.barriers.size()};
+                }
+                group.barriers.push_back(barrier);
+                current = target;
+            };
+
+            for (uint32_t i = group.first; i < group.first + group.count; i++)
+            {
+                for (auto use : GetResourceUses(_passDescriptions[_executionOrder[i]]))
+                {
+                    if (use.usage == vk::ImageUsageFlagBits::eInputAttachment && IsDepthFormat(_resourceDescriptions[use.resource].format))
+                    {
+                        use.state.layout = vk::ImageLayout::eDepthStencilReadOnlyOptimal;
+                    }
+
+                    // Inside a render pass, the subpass dependencies handle the synchronization.
+                    // Keep track of every access so that the next barrier waits for all of them.
+                    if (usedInGroup[use.resource])
+                    {
+                        auto &current = states[use.resource];
+                        current.layout = use.state.layout;
+                        current.stages |= use.state.stages;
+                        current.access |= use.state.access;
+                        continue;
+                    }
+
+                    usedInGroup[use.resource] = true;
+                    transition(use.resource, use.state, use.discardContent);
+                }
+            }
+
+            // Transient images that are not used anymore give their memory to the next image of the block
+            for (render_resource_id_t resource = 0; resource < resourceCount; resource++)
+            {
+                if (_resourceBlocks[resource] != NO_BLOCK && touched[resource] && lastUses[resource] == g)
+                {
+                    _aliasingBlocks[_resourceBlocks[resource]].lastState = states[resource];
+                }
+            }
+        }
+
+        // Transient images keep their memory between executions, and the previous frame may still be in flight.
+        // The first use of an image must thus also wait for the last use of its memory in the previous execution.
+        for (render_resource_id_t resource = 0; resource < resourceCount; resource++)
+        {
+            if (_resourceImported[resource] || !touched[resource])
+            {
+                continue;
+            }
+            const auto blockIndex = _resourceBlocks[resource];
+            const auto &previousState = blockIndex != NO_BLOCK ? _aliasingBlocks[blockIndex].lastState : states[resource];
+            const auto [g, b] = firstUseBarriers[resource];
+            auto &source = _groups[g].barriers[b].source;
+            source.stages |= previousState.stages;
+            source.access |= previousState.access & WRITE_ACCESS_MASK;
+        }
+
+        // Put the imported images in the layout expected by their owner
+        for (render_resource_id_t resource = 0; resource < resourceCount; resource++)
+        {
+            const auto finalLayout = _importedFinalLayouts[resource];
+            if (_resourceImported[resource] && touched[resource] && finalLayout != vk::ImageLayout::eUndefined && states[resource].layout != finalLayout)
+            {
+                // Presentation is synchronized with semaphores, but copies recorded after the graph (e.g. readbacks) must wait for the transition
+                const bool copiedAfter = finalLayout == vk::ImageLayout::eTransferSrcOptimal;
+                ImageBarrier barrier{
+                    .resource = resource,
+                    .source = states[resource],
+                    .destination = ResourceState{
+                        .layout = finalLayout,
+                        .stages = copiedAfter ? vk::PipelineStageFlagBits::eTransfer : vk::PipelineStageFlagBits::eBottomOfPipe,
+                        .access = copiedAfter ? vk::AccessFlagBits::eTransferRead : vk::AccessFlags{},
+                    },
+                };
+                barrier.source.access &= WRITE_ACCESS_MASK;
+                _finalBarriers.push_back(barrier);
+            }
+        }
+    }
+
+    void RenderGraph::CreateRenderPasses(const std::vector<uint32_t> &lastUses)
+    {
+        for (uint32_t g = 0; g < _groups.size(); g++)
+        {
+            auto &group = _groups[g];
+            if (group.attachments.empty())
+            {
+                continue;
+            }
+
+            // Each attachment takes its load operation from its first use in the group, and is left in the layout of its last use.
+            // The layouts before the render pass are already converted by the barriers.
+            const size_t attachmentCount = group.attachments.size();
+            std::vector<bool> seen(attachmentCount, false);
+            std::vector<vk::AttachmentLoadOp> loadOps(attachmentCount, vk::AttachmentLoadOp::eLoad);
+            std::vector<vk::ImageLayout> initialLayouts(attachmentCount);
+            std::vector<vk::ImageLayout> finalLayouts(attachmentCount);
+            group.clearValues.resize(attachmentCount);
+
+            auto builder = init::RenderPassBuilder().SetPipelineBindPoint(vk::PipelineBindPoint::eGraphics);
+            auto indexOf = [&](render_resource_id_t resource)
+            {
+                return static_cast<uint32_t>(std::find(group.attachments.begin(), group.attachments.end(), resource) - group.attachments.begin());
+            };
+            auto registerUse = [&](render_resource_id_t resource, vk::ImageLayout layout, vk::AttachmentLoadOp loadOp, const vk::ClearValue &clearValue)
+            {
+                const auto index = indexOf(resource);
+                if (!seen[index])
+                {
+                    seen[index] = true;
+                    loadOps[index] = loadOp;
+                    initialLayouts[index] = layout;
+                    group.clearValues[index] = clearValue;
+                }
+                finalLayouts[index] = layout;
+                return index;
+            };
+
+            // One subpass per pass
+            for (uint32_t i = group.first; i < group.first + group.count; i++)
+            {
+                const auto &pass = _passDescriptions[_executionOrder[i]];
+                if (i != group.first)
+                {
+                    builder.NextSubpass();
+                }
+
+                for (const auto &attachment : pass.colorAttachments)
+                {
+                    builder.UseColorAttachment(registerUse(attachment.resource, vk::ImageLayout::eColorAttachmentOptimal, attachment.loadOp, attachment.clearValue));
+                }
+                if (pass.depthAttachment.has_value())
+                {
+                    const auto &attachment = pass.depthAttachment.value();
+                    const auto layout = attachment.readOnly ? vk::ImageLayout::eDepthStencilReadOnlyOptimal : vk::ImageLayout::eDepthStencilAttachmentOptimal;
+                    builder.UseDepthAttachment(registerUse(attachment.resource, layout, attachment.loadOp, attachment.clearValue), attachment.readOnly);
+                }
+                for (auto resource : pass.inputAttachments)
+                {
+                    const auto layout = IsDepthFormat(_resourceDescriptions[resource].format) ? vk::ImageLayout::eDepthStencilReadOnlyOptimal : vk::ImageLayout::eShaderReadOnlyOptimal;
+                    builder.UseInputAttachment(registerUse(resource, layout, vk::AttachmentLoadOp::eLoad, vk::ClearValue{}), layout);
+                }
+            }
+
+            // The content only needs to be written to memory if something uses it after the render pass
+            for (uint32_t a = 0; a < attachmentCount; a++)
+            {
+                const auto resource = group.attachments[a];
+                auto attachmentBuilder = init::AttachmentBuilder()
+                                             .SetFormat(_resourceDescriptions[resource].format)
+                                             .SetInitialLayout(initialLayouts[a])
+                                             .SetFinalLayout(finalLayouts[a]);
+                if (loadOps[a] == vk::AttachmentLoadOp::eClear)
+                    attachmentBuilder.ClearOnLoad();
+                else if (loadOps[a] == vk::AttachmentLoadOp::eLoad)
+                    attachmentBuilder.KeepOnLoad();
+                if (_resourceImported[resource] || lastUses[resource] > g || std::find(_outputs.begin(), _outputs.end(), resource) != _outputs.end())
+                    attachmentBuilder.StoreAtEnd();
+
+                builder.AddAttachment(attachmentBuilder.Build());
+            }
+
+            group.renderPass = builder.Build(_device);
+        }
+    }
+
+    void RenderGraph::DestroyCompiledObjects()
+    {
+        // Framebuffers and render passes
+        InvalidateFramebuffers();
+        for (const auto &group : _groups)
+        {
+            if (group.renderPass)
+            {
+                _device.destroyRenderPass(group.renderPass);
+            }
+        }
+
+        // Transient images. Imported ones are owned by something else.
+        for (size_t resource = 0; resource < _images.size(); resource++)
+        {
+            if (!_resourceImported[resource] && _images[resource])
+            {
+                _device.destroyImageView(_imageViews[resource]);
+                _device.destroyImage(_images[resource]);
+                _imageViews[resource] = nullptr;
+                _images[resource] = nullptr;
+            }
+        }
+        for (const auto &block : _aliasingBlocks)
+        {
+            vmaFreeMemory(_allocator, block.allocation);
+        }
+        for (auto allocation : _lazyAllocations)
+        {
+            if (allocation != nullptr)
+            {
+                vmaFreeMemory(_allocator, allocation);
+            }
+        }
+
+        _executionOrder.clear();
+        _groups.clear();
+        _passGroups.clear();
+        _passSubpasses.clear();
+        _finalBarriers.clear();
+        _resourceBlocks.clear();
+        _aliasingBlocks.clear();
+        _lazyAllocations.clear();
+        _transientMemorySize = 0;
+        _unaliasedTransientMemorySize = 0;
+        _lazyTransientMemorySize = 0;
+        _compiled = false;
+    }
+
+    // ===== EXECUTION =====
+
+    void RenderGraph::RecordBarriers(const vk::CommandBuffer &cmd, const std::vector<ImageBarrier> &barriers, std::pmr::memory_resource *memory) const
+    {
+        if (barriers.empty())
+        {
+            return;
+        }
+
+        // Group every barrier of the pass in a single call
+        std::pmr::vector<vk::ImageMemoryBarrier> imageBarriers(memory);
+        imageBarriers.reserve(barriers.size());
+        vk::PipelineStageFlags sourceStages;
+        vk::PipelineStageFlags destinationStages;
+
+        for (const auto &barrier : barriers)
+        {
+            ADVANCED_CHECK(_images[barrier.resource] != static_cast<vk::Image>(nullptr), IMPORTED_IMAGE_NOT_SET_ERROR);
+
+            imageBarriers.push_back(vk::ImageMemoryBarrier{
+                .srcAccessMask = barrier.source.access,
+                .dstAccessMask = barrier.destination.access,
+                .oldLayout = barrier.source.layout,
+                .newLayout = barrier.destination.layout,
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .image = _images[barrier.resource],
+                .subresourceRange{
+                    .aspectMask = GetAspectMask(_resourceDescriptions[barrier.resource].format),
+                    .baseMipLevel = 0,
+                    .levelCount = 1,
+                    .baseArrayLayer = 0,
+                    .layerCount = 1,
+                },
+            });
+            sourceStages |= barrier.source.stages;
+            destinationStages |= barrier.destination.stages;
+        }
+
+        cmd.pipelineBarrier(sourceStages, destinationStages, {}, nullptr, nullptr, imageBarriers);
+    }
+
+    vk::Framebuffer RenderGraph::GetFramebuffer(PassGroup &group, std::pmr::memory_resource *memory)
+    {
+        // Gather the views in the same order as the attachments of the render pass
+        std::pmr::vector<vk::ImageView> attachments(memory);
+        attachments.reserve(group.attachments.size());
+        for (auto resource : group.attachments)
+        {
+            attachments.push_back(_imageViews[resource]);
+        }
+
+        // Imported views can change every frame, so there is one framebuffer per combination
+        auto key = utils::HashBytes(attachments.data(), attachments.size() * sizeof(vk::ImageView));
+        auto it = group.framebuffers.find(key);
+        if (it != group.framebuffers.end())
+        {
+            return it->second;
+        }
+
+        vk::FramebufferCreateInfo framebufferCreateInfo{
+            .renderPass = group.renderPass,
+            .attachmentCount = static_cast<uint32_t>(attachments.size()),
+            .pAttachments = attachments.data(),
+            .width = group.extent.width,
+            .height = group.extent.height,
+            .layers = 1,
+        };
+        auto framebuffer = _device.createFramebuffer(framebufferCreateInfo);
+        group.framebuffers[key] = framebuffer;
+        return framebuffer;
+    }
+
+    void RenderGraph::Execute(const vk::CommandBuffer &cmd, std::pmr::memory_resource *frameMemory)
+    {
+        ADVANCED_CHECK(_compiled, NOT_COMPILED_ERROR);
+
+        for (auto &group : _groups)
+        {
+            RecordBarriers(cmd, group.barriers, frameMemory);
+
+            // Passes without attachments (e.g. compute) are recorded outside of a render pass
+            if (!group.renderPass)
+            {
+                const auto &pass = _passDescriptions[_executionOrder[group.first]];
+                if (pass.execute)
+                    pass.execute(cmd);
+                continue;
+            }
+
+            vk::RenderPassBeginInfo renderPassBeginInfo{
+                .renderPass = group.renderPass,
+                .framebuffer = GetFramebuffer(group, frameMemory),
+                .renderArea = {
+                    .offset = {0, 0},
+                    .extent = group.extent,
+                },
+                .clearValueCount = static_cast<uint32_t>(group.clearValues.size()),
+                .pClearValues = group.clearValues.data(),
+            };
+
+            cmd.beginRenderPass(renderPassBeginInfo, vk::SubpassContents::eInline);
+            for (uint32_t i = group.first; i < group.first + group.count; i++)
+            {
+                if (i != group.first)
+                    cmd.nextSubpass(vk::SubpassContents::eInline);
+
+                const auto &pass = _passDescriptions[_executionOrder[i]];
+                if (pass.execute)
+                    pass.execute(cmd);
+            }
+            cmd.endRenderPass();
+        }
+
+        RecordBarriers(cmd, _finalBarriers, frameMemory);
+    }
+
+    void RenderGraph::InvalidateFramebuffers()
+    {
+        for (auto &group : _groups)
+        {
+            for (const auto &[_, framebuffer] : group.framebuffers)
+            {
+                _device.destroyFramebuffer(framebuffer);
+            }
+            group.framebuffers.clear();
+        }
+    }
+
+    // ===== GETTERS =====
+
+    vk::RenderPass RenderGraph::GetRenderPass(render_pass_id_t pass) const
+    {
+        ADVANCED_CHECK(_compiled, NOT_COMPILED_ERROR);
+
+        const auto group = _passGroups[pass];
+        return group == NO_GROUP ? nullptr : _groups[group].renderPass;
+    }
+
+    uint32_t RenderGraph::GetSubpassIndex(render_pass_id_t pass) const
+    {
+        ADVANCED_CHECK(_compiled, NOT_COMPILED_ERROR);
+
+        return _passSubpasses[pass];
+    }
+
+    bool RenderGraph::IsPassCulled(render_pass_id_t pass) const
+    {
+        ADVANCED_CHECK(_compiled, NOT_COMPILED_ERROR);
+
+        return _passGroups[pass] == NO_GROUP;
+    }
+
+    vk::DeviceSize RenderGraph::GetTransientMemorySize() const
+    {
+        return _transientMemorySize;
+    }
+
+    vk::DeviceSize RenderGraph::GetUnaliasedTransientMemorySize() const
+    {
+        return _unaliasedTransientMemorySize;
+    }
+
+    vk::DeviceSize RenderGraph::GetLazyTransientMemorySize() const
+    {
+        return _lazyTransientMemorySize;
+    }
+} // namespace railguard::rendering
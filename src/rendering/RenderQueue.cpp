@@ -0,0 +1,271 @@
+#include "../../include/rendering/RenderQueue.h"
+#include "../../include/rendering/Settings.h"
+#include "../../include/utils/Hash.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+// Layout of the sort key, from the most significant bits
+#define SORT_KEY_PASS_SHIFT 56
+#define SORT_KEY_EFFECT_SHIFT 40
+#define SORT_KEY_MATERIAL_SHIFT 24
+#define SORT_KEY_DEPTH_BITS 24
+
+namespace railguard::rendering
+{
+    uint64_t RenderQueue::GetSortKey(const structs::DrawItem &item)
+    {
+        uint64_t depthBucket;
+        if (item.instanced)
+        {
+            // Group the instances of the same mesh instead
+            size_t meshHash = static_cast<size_t>(item.elementCount);
+            utils::HashCombine(meshHash, static_cast<VkBuffer>(item.vertexBuffer));
+            utils::HashCombine(meshHash, item.vertexOffset);
+            utils::HashCombine(meshHash, static_cast<VkBuffer>(item.indexBuffer));
+            utils::HashCombine(meshHash, item.indexOffset);
+            utils::HashCombine(meshHash, item.firstElement);
+            utils::HashCombine(meshHash, item.baseVertex);
+            depthBucket = meshHash & ((1ull << SORT_KEY_DEPTH_BITS) - 1);
+        }
+        else
+        {
+            // Positive floats have the same order as their bits, so the highest bits are a logarithmic depth bucket
+            const uint32_t depthBits = std::bit_cast<uint32_t>(std::max(item.depth, 0.0f));
+            depthBucket = depthBits >> (32 - SORT_KEY_DEPTH_BITS);
+        }
+
+        return (static_cast<uint64_t>(item.pass & 0xFF) << SORT_KEY_PASS_SHIFT) |
+               (static_cast<uint64_t>(item.effect & 0xFFFF) << SORT_KEY_EFFECT_SHIFT) |
+               (static_cast<uint64_t>(item.material & 0xFFFF) << SORT_KEY_MATERIAL_SHIFT) |
+               depthBucket;
+    }
+
+    void RenderQueue::Push(const structs::DrawItem &item)
+    {
+        _items.push_back(item);
+    }
+
+    bool RenderQueue::CanMergeInstances(const structs::DrawItem &a, const structs::DrawItem &b)
+    {
+        return a.instanced && b.instanced &&
+               a.pass == b.pass && a.effect == b.effect && a.descriptorSet == b.descriptorSet &&
+               a.vertexBuffer == b.vertexBuffer && a.vertexOffset == b.vertexOffset &&
+               a.indexBuffer == b.indexBuffer && a.indexOffset == b.indexOffset && a.indexType == b.indexType &&
+               a.elementCount == b.elementCount && a.firstElement == b.firstElement && a.baseVertex == b.baseVertex &&
+               a.firstMeshlet == b.firstMeshlet && a.meshletCount == b.meshletCount;
+    }
+
+    void RenderQueue::Sort(BufferManager &bufferManager, ClusterCuller &clusterCuller, core::JobPool *jobPool)
+    {
+        _sortedEntries.resize(_items.size());
+        uint32_t instanceCount = 0;
+        for (uint32_t i = 0; i < _items.size(); i++)
+        {
+            _sortedEntries[i] = utils::SortEntry{
+                .key = GetSortKey(_items[i]),
+                .index = i,
+            };
+            instanceCount += _items[i].instanced ? 1 : 0;
+        }
+        utils::RadixSort(_sortedEntries, _sortScratch, jobPool);
+
+        // Every transform of the frame goes in the same region. Scenes can have more instances than the ring buffer can hold.
+        _instanceBuffer = structs::BufferRegion{};
+        if (instanceCount > 0)
+        {
+            _instanceBuffer = bufferManager.AllocateGrowableFrameData(instanceCount * sizeof(glm::mat4), alignof(glm::mat4));
+        }
+
+        // Merge the consecutive items that are the same mesh
+        _batches.clear();
+        vk::DeviceSize instanceOffset = 0;
+        for (uint32_t i = 0; i < _sortedEntries.size(); i++)
+        {
+            const auto &item = _items[_sortedEntries[i].index];
+            if (!_batches.empty() && CanMergeInstances(_items[_sortedEntries[_batches.back().first].index], item))
+            {
+                _batches.back().count++;
+            }
+            else
+            {
+                _batches.push_back(DrawBatch{
+                    .first = i,
+                    .count = 1,
+                    .instanceOffset = instanceOffset,
+                    .firstCommand = ClusterCuller::NO_COMMANDS,
+                    .commandCount = 0,
+                });
+            }
+
+            if (item.instanced)
+            {
+                std::memcpy(static_cast<uint8_t *>(_instanceBuffer.mappedData) + instanceOffset, &item.transform, sizeof(glm::mat4));
+                instanceOffset += sizeof(glm::mat4);
+            }
+        }
+
+        // Give the meshlets of each batch to the culler. Each instance gets its own commands, which are contiguous in the batch.
+        for (auto &batch : _batches)
+        {
+            const auto &firstItem = _items[_sortedEntries[batch.first].index];
+            // Indirect commands only draw a single instance
+            const bool canCull = firstItem.meshletCount > 0 && firstItem.indexBuffer != static_cast<vk::Buffer>(nullptr) &&
+                                 (firstItem.instanced || firstItem.instanceCount == 1);
+            const bool usesFirstInstance = firstItem.instanced ? batch.instanceOffset > 0 || batch.count > 1 : firstItem.firstInstance != 0;
+            if (!canCull || !clusterCuller.CanAddCommands(batch.count * firstItem.meshletCount, usesFirstInstance))
+            {
+                continue;
+            }
+
+            for (uint32_t i = 0; i < batch.count; i++)
+            {
+                const auto &item = _items[_sortedEntries[batch.first + i].index];
+                const uint32_t firstInstance = item.instanced ? static_cast<uint32_t>(batch.instanceOffset / sizeof(glm::mat4)) + i : item.firstInstance;
+                const uint32_t firstCommand = clusterCuller.AddInstance(item.transform, item.firstMeshlet, item.meshletCount, firstInstance, item.baseVertex);
+                if (i == 0)
+                {
+                    batch.firstCommand = firstCommand;
+                }
+            }
+            batch.commandCount = batch.count * firstItem.meshletCount;
+        }
+    }
+
+    void RenderQueue::Record(const vk::CommandBuffer &cmd, const ShaderEffectManager &shaderEffectManager, const ClusterCuller &clusterCuller, uint32_t pass,
+                             const structs::CameraView &camera, vk::DescriptorSet cameraDescriptorSet)
+    {
+        // Find the batches of the pass. They are contiguous since the pass is the highest part of the key.
+        const uint64_t passKey = static_cast<uint64_t>(pass & 0xFF) << SORT_KEY_PASS_SHIFT;
+        auto begin = std::lower_bound(_batches.begin(), _batches.end(), passKey, [this](const DrawBatch &batch, uint64_t key)
+                                      { return _sortedEntries[batch.first].key < key; });
+
+        // State of the command buffer, to skip redundant binds
+        bool hasEffect = false;
+        shader_effect_id_t boundEffect = 0;
+        vk::PipelineLayout boundLayout = nullptr;
+        vk::DescriptorSet boundDescriptorSet = nullptr;
+        bool cameraBound = false;
+        vk::Buffer boundVertexBuffer = nullptr;
+        vk::DeviceSize boundVertexOffset = 0;
+        vk::Buffer boundIndexBuffer = nullptr;
+        vk::DeviceSize boundIndexOffset = 0;
+        vk::IndexType boundIndexType = vk::IndexType::eUint32;
+        bool instanceBufferBound = false;
+
+        for (auto batch = begin; batch != _batches.end() && (_sortedEntries[batch->first].key >> SORT_KEY_PASS_SHIFT) == (pass & 0xFF); ++batch)
+        {
+            // Items of a batch only differ by their transform
+            const auto &item = _items[_sortedEntries[batch->first].index];
+            // The key only contains 8 bits of the pass
+            if (item.pass != pass)
+            {
+                continue;
+            }
+
+            if (!hasEffect || item.effect != boundEffect)
+            {
+                auto match = shaderEffectManager.LookupId(item.effect);
+                shaderEffectManager.Bind(match, cmd);
+                _statistics.pipelineBinds++;
+
+                // Sets stay bound if the new pipeline uses the same layout
+                auto layout = shaderEffectManager.GetPipelineLayout(match);
+                if (layout != boundLayout)
+                {
+                    boundLayout = layout;
+                    boundDescriptorSet = nullptr;
+                    cameraBound = false;
+                }
+                boundEffect = item.effect;
+                hasEffect = true;
+
+                // The data of the camera is at its own offset in the frame ring buffer
+                if (!cameraBound && shaderEffectManager.UsesCamera(match))
+                {
+                    cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, boundLayout, CAMERA_DESCRIPTOR_SET, cameraDescriptorSet, camera.uniformOffset);
+                    cameraBound = true;
+                    _statistics.descriptorSetBinds++;
+                }
+            }
+
+            if (item.descriptorSet != static_cast<vk::DescriptorSet>(nullptr) && item.descriptorSet != boundDescriptorSet)
+            {
+                cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, boundLayout, 0, item.descriptorSet, {});
+                boundDescriptorSet = item.descriptorSet;
+                _statistics.descriptorSetBinds++;
+            }
+
+            if (item.vertexBuffer != static_cast<vk::Buffer>(nullptr) && (item.vertexBuffer != boundVertexBuffer || item.vertexOffset != boundVertexOffset))
+            {
+                cmd.bindVertexBuffers(VERTEX_INPUT_BINDING, item.vertexBuffer, item.vertexOffset);
+                boundVertexBuffer = item.vertexBuffer;
+                boundVertexOffset = item.vertexOffset;
+                _statistics.vertexBufferBinds++;
+            }
+
+            // The instance buffer is bound once, and each batch starts at its own instance with firstInstance
+            uint32_t instanceCount = item.instanceCount;
+            uint32_t firstInstance = item.firstInstance;
+            if (item.instanced)
+            {
+                if (!instanceBufferBound)
+                {
+                    cmd.bindVertexBuffers(INSTANCE_INPUT_BINDING, _instanceBuffer.buffer, _instanceBuffer.offset);
+                    instanceBufferBound = true;
+                    _statistics.instanceBufferBinds++;
+                }
+                instanceCount = batch->count;
+                firstInstance = static_cast<uint32_t>(batch->instanceOffset / sizeof(glm::mat4));
+                _statistics.instanceCount += instanceCount;
+            }
+
+            if (item.indexBuffer != static_cast<vk::Buffer>(nullptr))
+            {
+                if (item.indexBuffer != boundIndexBuffer || item.indexOffset != boundIndexOffset || item.indexType != boundIndexType)
+                {
+                    cmd.bindIndexBuffer(item.indexBuffer, item.indexOffset, item.indexType);
+                    boundIndexBuffer = item.indexBuffer;
+                    boundIndexOffset = item.indexOffset;
+                    boundIndexType = item.indexType;
+                    _statistics.indexBufferBinds++;
+                }
+                if (batch->commandCount > 0)
+                {
+                    // The culler already wrote a command for each meshlet of each instance
+                    clusterCuller.DrawClusters(cmd, batch->firstCommand, batch->commandCount, camera.cullingGroup);
+                    _statistics.clusterCount += batch->commandCount;
+                }
+                else
+                {
+                    cmd.drawIndexed(item.elementCount, instanceCount, item.firstElement, item.baseVertex, firstInstance);
+                    _statistics.unculledClusterCount += item.meshletCount * instanceCount;
+                }
+            }
+            else
+            {
+                cmd.draw(item.elementCount, instanceCount, item.firstElement, firstInstance);
+            }
+            _statistics.drawCount++;
+        }
+    }
+
+    void RenderQueue::Reset()
+    {
+        _items.clear();
+        _sortedEntries.clear();
+        _batches.clear();
+        _lastStatistics = _statistics;
+        _statistics = structs::RenderQueueStatistics{};
+    }
+
+    size_t RenderQueue::GetItemCount() const
+    {
+        return _items.size();
+    }
+
+    const structs::RenderQueueStatistics &RenderQueue::GetLastStatistics() const
+    {
+        return _lastStatistics;
+    }
+} // namespace railguard::rendering
@@ -1,66 +1,203 @@
 #include "../../include/rendering/Settings.h"
 #include "../../include/rendering/Renderer.h"
-#include "../../include/rendering/init/RenderPassBuilder.h"
+#include "../../include/rendering/init/RenderGraphPassBuilder.h"
 #include "../../include/rendering/structs/Storages.h"
-#include "../../include/rendering/init/PipelineLayoutBuilder.h"
 #include "../../include/utils/Colors.h"
+#include <iostream>
+#include <algorithm>
+
+// Stages of the graphics work that may use the results of async compute jobs
+#define ASYNC_COMPUTE_WAIT_STAGES (vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexInput | vk::PipelineStageFlagBits::eVertexShader | vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eComputeShader)
 
 namespace railguard::rendering
 {
 
 	Renderer::Renderer(const core::WindowManager &windowManager)
+		: Renderer(init::RendererInitInfo{.windowManager = &windowManager})
+	{
+	}
+
+	Renderer::Renderer(const init::RendererInitInfo &initInfo)
 		: _swapchainCameraManager(1)
 	{
 		// Save current extent
-		_windowExtent = windowManager.GetWindowExtent();
+		_headless = initInfo.windowManager == nullptr;
+		_jobPool = initInfo.jobPool;
+		_targetExtent = _headless ? initInfo.headlessExtent : initInfo.windowManager->GetWindowExtent();
 
 		// Init instance
 		init::VulkanInitInfo vulkanInitInfo{
-			.windowManager = windowManager,
+			.windowManager = initInfo.windowManager,
 			.instance = &_instance,
 			.debugMessenger = &_debugMessenger,
 			.surface = &_surface,
 			.physicalDevice = &_physicalDevice,
 			.physicalDeviceProperties = &_physicalDeviceProperties,
+			.enabledFeatures = &_enabledFeatures,
 			.device = &_device,
 			.graphicsQueue = &_graphicsQueue,
 			.graphicsQueueFamily = &_graphicsQueueFamily,
+			.transferQueue = &_transferQueue,
+			.transferQueueFamily = &_transferQueueFamily,
+			.computeQueue = &_computeQueue,
+			.computeQueueFamily = &_computeQueueFamily,
 			.allocator = &_allocator,
 		};
 		init::VulkanInit::InitVulkan(vulkanInitInfo);
 
 		// Init frame manager
-		_frameManager.Init(_device, _graphicsQueueFamily);
-
-		// Init the render pass for the main swapchain
-		_mainRenderPass = init::RenderPassBuilder()
-							  .SetPipelineBindPoint(vk::PipelineBindPoint::eGraphics)
-							  .AddColorAttachment(init::AttachmentBuilder()
-													  .SetFormat(static_cast<vk::Format>(SWAPCHAIN_FORMAT))
-													  .ClearOnLoad()
-													  .StoreAtEnd()
-													  .SetFinalLayout(vk::ImageLayout::ePresentSrcKHR)
-													  .Build())
-							  .Build(_device);
-
-		// Init swapchain for window
+		_frameManager.Init(_device, _graphicsQueueFamily, _computeQueueFamily);
+
+		// Init buffer manager
+		// Buffers are shared between every queue, so they can be uploaded and used by async compute without ownership transfers
+		_bufferManager.Init(_allocator, _physicalDeviceProperties, {_graphicsQueueFamily, _transferQueueFamily, _computeQueueFamily});
+
+		// Init upload manager
+		_uploadManager.Init(_device, _allocator, _transferQueue, _transferQueueFamily, _graphicsQueueFamily);
+
+		// Init mesh manager
+		_meshManager.Init(MeshManagerStorage{
+			.bufferManager = &_bufferManager,
+			.uploadManager = &_uploadManager,
+		});
+
+		// Init texture manager
+		_textureManager.Init(TextureManagerStorage{
+			.vulkanDevice = _device,
+			.allocator = _allocator,
+			.uploadManager = &_uploadManager,
+		});
+
+		// Init timestamp queries, if both queues support them. The overlap compares timestamps of the two queues.
+		auto queueFamilyProperties = _physicalDevice.getQueueFamilyProperties();
+		_gpuTimingsSupported = _physicalDeviceProperties.limits.timestampComputeAndGraphics &&
+							   queueFamilyProperties[_graphicsQueueFamily].timestampValidBits > 0 &&
+							   queueFamilyProperties[_computeQueueFamily].timestampValidBits > 0;
+		if (_gpuTimingsSupported)
+		{
+			vk::QueryPoolCreateInfo queryPoolCreateInfo{
+				.queryType = vk::QueryType::eTimestamp,
+				.queryCount = 2 * NB_OVERLAPPING_FRAMES,
+			};
+			_graphicsTimestamps = _device.createQueryPool(queryPoolCreateInfo);
+			_computeTimestamps = _device.createQueryPool(queryPoolCreateInfo);
+		}
+
+		// Init the target: a swapchain for the window, or offscreen images
 		_swapchainManager.Init(structs::FullDeviceStorage{_device, _physicalDevice}, 1);
-		_mainWindowSwapchain = _swapchainManager.CreateWindowSwapchain(_surface, windowManager, _mainRenderPass).GetId();
+		vk::Format backbufferFormat;
+		if (_headless)
+		{
+			_offscreenTarget.Init(_device, _allocator, _targetExtent, static_cast<vk::Format>(SWAPCHAIN_FORMAT), initInfo.readbackDirectory);
+			backbufferFormat = _offscreenTarget.GetFormat();
+		}
+		else
+		{
+			_mainWindowSwapchain = _swapchainManager.CreateWindowSwapchain(_surface, *initInfo.windowManager).GetId();
+			backbufferFormat = _swapchainManager.GetSwapchainImageFormat(_swapchainManager.LookupId(_mainWindowSwapchain));
+		}
+
+		// Init the render graph
+		// The target image is imported, since it is owned by the swapchain or the offscreen target
+		// Offscreen images are left ready to be copied, for the readback
+		_renderGraph.Init(_device, _allocator);
+		_backbuffer = _renderGraph.ImportImage(structs::RenderGraphImageDescription{
+												   .name = "backbuffer",
+												   .format = backbufferFormat,
+												   .extent = _targetExtent,
+											   },
+											   vk::ImageLayout::eUndefined, _headless ? vk::ImageLayout::eTransferSrcOptimal : vk::ImageLayout::ePresentSrcKHR);
+		_depthBuffer = _renderGraph.CreateTransientImage(structs::RenderGraphImageDescription{
+			.name = "depth",
+			.format = static_cast<vk::Format>(DEPTH_FORMAT),
+			.extent = _targetExtent,
+		});
+		_mainPass = _renderGraph.AddPass(init::RenderGraphPassBuilder("main")
+											 .WriteColor(_backbuffer, utils::GetColorHex(0x1f2959ff))
+											 .WriteDepth(_depthBuffer)
+											 .Execute([this](const vk::CommandBuffer &cmd)
+													  {
+														  // Draw each object for each camera of the target, in the order of their sort keys
+														  for (const auto &camera : _targetCameraViews)
+														  {
+															  const float x = camera.viewport.x * static_cast<float>(_targetExtent.width);
+															  const float y = camera.viewport.y * static_cast<float>(_targetExtent.height);
+															  const float width = camera.viewport.z * static_cast<float>(_targetExtent.width);
+															  const float height = camera.viewport.w * static_cast<float>(_targetExtent.height);
+															  cmd.setViewport(0, vk::Viewport{
+																					 .x = x,
+																					 .y = y,
+																					 .width = width,
+																					 .height = height,
+																					 .minDepth = 0.0f,
+																					 .maxDepth = 1.0f,
+																				 });
+															  cmd.setScissor(0, vk::Rect2D{
+																					.offset = {static_cast<int32_t>(x), static_cast<int32_t>(y)},
+																					.extent = {static_cast<uint32_t>(width), static_cast<uint32_t>(height)},
+																				});
+															  _renderQueue.Record(cmd, _shaderEffectManager, _clusterCuller, _mainPass, camera, _cameraDescriptorSet);
+														  }
+													  })
+											 .Build());
+		_renderGraph.MarkAsOutput(_backbuffer);
+		_renderGraph.Compile();
 
 		// Init shader module manager
 		_shaderModuleManager.Init(structs::DeviceStorage{_device}, 5);
 
+		// Init pipeline layout cache
+		_pipelineLayoutCache.Init(_device);
+
 		// Init shader effect manager
-		_shaderEffectManager.Init(ShaderEffectManagerStorage{_device, _mainRenderPass, &_shaderModuleManager, &windowManager}, 5);
+		_shaderEffectManager.Init(ShaderEffectManagerStorage{_device, _renderGraph.GetRenderPass(_mainPass), &_shaderModuleManager, &_targetExtent, &_pipelineLayoutCache}, 5);
+
+		// Init the camera set. The ring buffer never moves, so the set is written once and shared by every frame.
+		_cameraSetLayout = _pipelineLayoutCache.GetDescriptorSetLayout(ShaderEffectManager::GetCameraSetLayoutDescription());
+		vk::DescriptorPoolSize cameraPoolSize{
+			.type = vk::DescriptorType::eUniformBufferDynamic,
+			.descriptorCount = 1,
+		};
+		_cameraDescriptorPool = _device.createDescriptorPool(vk::DescriptorPoolCreateInfo{
+			.maxSets = 1,
+			.poolSizeCount = 1,
+			.pPoolSizes = &cameraPoolSize,
+		});
+		_cameraDescriptorSet = _device.allocateDescriptorSets(vk::DescriptorSetAllocateInfo{
+																  .descriptorPool = _cameraDescriptorPool,
+																  .descriptorSetCount = 1,
+																  .pSetLayouts = &_cameraSetLayout,
+															  })[0];
+		vk::DescriptorBufferInfo cameraBufferInfo{
+			.buffer = _bufferManager.GetFrameBuffer(),
+			.offset = 0,
+			.range = sizeof(structs::CameraData),
+		};
+		_device.updateDescriptorSets(vk::WriteDescriptorSet{
+										 .dstSet = _cameraDescriptorSet,
+										 .dstBinding = 0,
+										 .descriptorCount = 1,
+										 .descriptorType = vk::DescriptorType::eUniformBufferDynamic,
+										 .pBufferInfo = &cameraBufferInfo,
+									 },
+									 nullptr);
+
+		// Load the shaders
+		_shaderModules = _shaderModuleManager.LoadShaderPack("./bin/shaders/shaders.rgpack");
 
-		// Test
-		auto vertexModule = _shaderModuleManager.LoadShaderModule(vk::ShaderStageFlagBits::eVertex, "./bin/shaders/triangle.vert.spv").GetId();
-		auto fragmentModule = _shaderModuleManager.LoadShaderModule(vk::ShaderStageFlagBits::eFragment, "./bin/shaders/triangle.frag.spv").GetId();
-		_triangleEffect = _shaderEffectManager.CreateShaderEffect(init::ShaderEffectInitInfo{
-																	  .pipelineLayout = init::PipelineLayoutBuilder().Build(_device),
-																	  .shaderStages = {vertexModule, fragmentModule}},
-																  true)
-							  .GetId(); // Build the effect after creation
+		// Init cluster culling
+		auto cullingModule = _shaderModuleManager.LookupId(_shaderModules.at("cluster_cull.comp"));
+		_clusterCuller.Init(_device, _pipelineLayoutCache, _bufferManager,
+							_shaderModuleManager.GetModule(cullingModule), _shaderModuleManager.GetReflection(cullingModule),
+							_meshManager.GetMeshletBuffer(), _enabledFeatures);
+		// The meshlets are culled on the async compute queue, while the graphics queue finishes the previous frame
+		AddAsyncComputeJob("Cluster culling", [this](const vk::CommandBuffer &cmd)
+						   { _clusterCuller.Record(cmd); });
+
+#ifdef USE_SHADER_HOT_RELOAD
+		// Recompile shaders when their sources are modified
+		_shaderWatcher.Init(SHADER_SOURCE_DIRECTORY, SHADER_BINARY_DIRECTORY);
+#endif
 	}
 
 	Renderer::~Renderer()
@@ -68,22 +205,55 @@ namespace railguard::rendering
 		// Wait for all fences
 		_frameManager.WaitForAllFences();
 
+#ifdef USE_SHADER_HOT_RELOAD
+		// Stop watching shaders
+		_shaderWatcher.Cleanup();
+#endif
 		// Destroy shader effect manager
 		_shaderEffectManager.Clear();
+		// Destroy cluster culler
+		_clusterCuller.Cleanup();
+		// Destroy camera set
+		_device.destroyDescriptorPool(_cameraDescriptorPool);
+		_pipelineLayoutCache.ReleaseDescriptorSetLayout(_cameraSetLayout);
+		// Destroy remaining layouts
+		_pipelineLayoutCache.Cleanup();
 		// Destroy shader module manager
 		_shaderModuleManager.Clear();
+		// Destroy render graph
+		_renderGraph.Cleanup();
 		// Destroy swapchains
 		_swapchainManager.Clear();
-		// Destroy main render pass
-		_device.destroyRenderPass(_mainRenderPass);
+		// Destroy offscreen images, after writing the last frames
+		if (_headless)
+		{
+			_offscreenTarget.Cleanup();
+		}
+		// Destroy timestamp queries
+		if (_gpuTimingsSupported)
+		{
+			_device.destroyQueryPool(_graphicsTimestamps);
+			_device.destroyQueryPool(_computeTimestamps);
+		}
 		// Destroy frame manager
 		_frameManager.Cleanup();
+		// Destroy meshes
+		_meshManager.Clear();
+		// Destroy upload manager
+		_uploadManager.Cleanup();
+		// Destroy textures, now that their uploads are finished
+		_textureManager.Clear();
+		// Destroy buffers
+		_bufferManager.Cleanup();
 		// Destroy allocator
 		vmaDestroyAllocator(_allocator);
 		// Destroy device
 		_device.destroy();
 		// Destroy surface
-		_instance.destroySurfaceKHR(_surface);
+		if (!_headless)
+		{
+			_instance.destroySurfaceKHR(_surface);
+		}
 // Destroy instance
 #ifdef USE_VK_VALIDATION_LAYERS
 		_instance.destroyDebugUtilsMessengerEXT(_debugMessenger);
@@ -105,18 +275,381 @@ namespace railguard::rendering
 		}
 	}
 
+	void Renderer::AddAsyncComputeJob(const std::string &name, const std::function<void(const vk::CommandBuffer &)> &record)
+	{
+		_asyncComputeJobs.push_back(structs::AsyncComputeJob{
+			.name = name,
+			.record = record,
+		});
+	}
+
+	const structs::GpuTimings &Renderer::GetLastGpuTimings() const
+	{
+		return _lastGpuTimings;
+	}
+
+	bool Renderer::AreGpuTimingsSupported() const
+	{
+		return _gpuTimingsSupported;
+	}
+
+	structs::MemoryStatistics Renderer::GetMemoryStatistics() const
+	{
+		const VkPhysicalDeviceMemoryProperties *memoryProperties = nullptr;
+		vmaGetMemoryProperties(_allocator, &memoryProperties);
+
+		// One budget per heap
+		VmaBudget budgets[VK_MAX_MEMORY_HEAPS];
+		vmaGetBudget(_allocator, budgets);
+
+		structs::MemoryStatistics statistics{};
+		for (uint32_t i = 0; i < memoryProperties->memoryHeapCount; i++)
+		{
+			statistics.allocatedSize += budgets[i].allocationBytes;
+			statistics.blockSize += budgets[i].blockBytes;
+			if (memoryProperties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+			{
+				statistics.deviceLocalBlockSize += budgets[i].blockBytes;
+			}
+		}
+		return statistics;
+	}
+
+	shader_effect_id_t Renderer::CreateShaderEffect(const std::vector<std::string> &shaderNames)
+	{
+		init::ShaderEffectInitInfo initInfo{};
+		for (const auto &name : shaderNames)
+		{
+			initInfo.shaderStages.push_back(_shaderModules.at(name));
+		}
+		auto effect = _shaderEffectManager.CreateShaderEffect(initInfo, true).GetId();
+		for (const auto &name : shaderNames)
+		{
+			_shaderEffects[name].push_back(effect);
+		}
+		return effect;
+	}
+
+	render_pass_id_t Renderer::GetMainPass() const
+	{
+		return _mainPass;
+	}
+
+	void Renderer::SubmitDraw(const structs::DrawItem &item)
+	{
+		_renderQueue.Push(item);
+	}
+
+	mesh_id_t Renderer::LoadMesh(const std::string &filePath)
+	{
+		return _meshManager.LoadMesh(filePath).GetId();
+	}
+
+	void Renderer::DestroyMesh(mesh_id_t mesh)
+	{
+		_meshManager.DestroyMesh(_meshManager.LookupId(mesh));
+	}
+
+	bool Renderer::IsMeshReady(mesh_id_t mesh) const
+	{
+		return _meshManager.IsMeshReady(_meshManager.LookupId(mesh));
+	}
+
+	void Renderer::SubmitMeshDraw(mesh_id_t mesh, structs::DrawItem item)
+	{
+		const auto match = _meshManager.LookupId(mesh);
+		if (!_meshManager.IsMeshReady(match))
+		{
+			return;
+		}
+
+		// LOD errors are in the units of the mesh, so they grow with the scale of the transform
+		const float scale = std::max({glm::length(glm::vec3(item.transform[0])),
+									  glm::length(glm::vec3(item.transform[1])),
+									  glm::length(glm::vec3(item.transform[2]))});
+		const auto lod = _meshManager.SelectLod(match, item.depth, scale);
+		_meshManager.FillDrawItem(match, lod, item);
+		_renderQueue.Push(item);
+	}
+
+	texture_id_t Renderer::LoadTexture(const std::string &filePath)
+	{
+		return _textureManager.LoadTexture(filePath).GetId();
+	}
+
+	void Renderer::DestroyTexture(texture_id_t texture)
+	{
+		_textureManager.DestroyTexture(_textureManager.LookupId(texture), _drawnFramesCount);
+	}
+
+	void Renderer::RequestTextureResolution(texture_id_t texture, float screenSize)
+	{
+		_textureManager.RequestResolution(_textureManager.LookupId(texture), screenSize);
+	}
+
+	vk::ImageView Renderer::GetTextureView(texture_id_t texture) const
+	{
+		return _textureManager.GetImageView(_textureManager.LookupId(texture));
+	}
+
+	const structs::TextureStreamingStatistics &Renderer::GetTextureStreamingStatistics() const
+	{
+		return _textureManager.GetLastStatistics();
+	}
+
+	const structs::RenderQueueStatistics &Renderer::GetLastRenderQueueStatistics() const
+	{
+		return _renderQueue.GetLastStatistics();
+	}
+
+	void Renderer::SubmitAsyncCompute(const FrameData &frame, uint32_t frameIndex)
+	{
+		frame.computeCommandBuffer.reset({});
+		frame.computeCommandBuffer.begin(vk::CommandBufferBeginInfo{
+			.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit,
+		});
+
+		if (_gpuTimingsSupported)
+		{
+			frame.computeCommandBuffer.resetQueryPool(_computeTimestamps, 2 * frameIndex, 2);
+			frame.computeCommandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, _computeTimestamps, 2 * frameIndex);
+		}
+
+		for (const auto &job : _asyncComputeJobs)
+		{
+			job.record(frame.computeCommandBuffer);
+		}
+
+		if (_gpuTimingsSupported)
+		{
+			frame.computeCommandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, _computeTimestamps, 2 * frameIndex + 1);
+			_computeTimestampsWritten[frameIndex] = true;
+		}
+		frame.computeCommandBuffer.end();
+
+		// The graphics work of this frame waits for the semaphore. No fence is needed since the render fence
+		// is only signaled after the graphics work, which itself waited for the compute work.
+		vk::SubmitInfo submitInfo{
+			.commandBufferCount = 1,
+			.pCommandBuffers = &frame.computeCommandBuffer,
+			.signalSemaphoreCount = 1,
+			.pSignalSemaphores = &frame.computeSemaphore,
+		};
+		_computeQueue.submit(submitInfo, nullptr);
+	}
+
+	void Renderer::ReadGpuTimings(uint32_t frameIndex)
+	{
+		if (!_gpuTimingsSupported || !_graphicsTimestampsWritten[frameIndex])
+		{
+			return;
+		}
+
+		uint64_t graphicsInterval[2];
+		auto result = _device.getQueryPoolResults(_graphicsTimestamps, 2 * frameIndex, 2, sizeof(graphicsInterval), graphicsInterval,
+												  sizeof(uint64_t), vk::QueryResultFlagBits::e64);
+		if (result != vk::Result::eSuccess)
+		{
+			return;
+		}
+
+		// Convert ticks to milliseconds
+		const double period = static_cast<double>(_physicalDeviceProperties.limits.timestampPeriod) / 1000000.0;
+		structs::GpuTimings timings{
+			.graphicsTime = static_cast<double>(graphicsInterval[1] - graphicsInterval[0]) * period,
+		};
+
+		if (_computeTimestampsWritten[frameIndex])
+		{
+			uint64_t computeInterval[2];
+			result = _device.getQueryPoolResults(_computeTimestamps, 2 * frameIndex, 2, sizeof(computeInterval), computeInterval,
+												 sizeof(uint64_t), vk::QueryResultFlagBits::e64);
+			if (result == vk::Result::eSuccess)
+			{
+				timings.computeTime = static_cast<double>(computeInterval[1] - computeInterval[0]) * period;
+
+				// Frames are read in order, so the previous interval is the graphics work of the previous frame
+				const uint64_t overlapStart = std::max(computeInterval[0], _previousGraphicsInterval[0]);
+				const uint64_t overlapEnd = std::min(computeInterval[1], _previousGraphicsInterval[1]);
+				timings.overlapTime = overlapEnd > overlapStart ? static_cast<double>(overlapEnd - overlapStart) * period : 0.0;
+			}
+		}
+		_previousGraphicsInterval[0] = graphicsInterval[0];
+		_previousGraphicsInterval[1] = graphicsInterval[1];
+		_lastGpuTimings = timings;
+
+#ifdef USE_RENDER_STATISTICS_REPORTS
+		// Regularly print the average timings, to see how much async compute overlaps graphics
+		_accumulatedGpuTimings.computeTime += timings.computeTime;
+		_accumulatedGpuTimings.graphicsTime += timings.graphicsTime;
+		_accumulatedGpuTimings.overlapTime += timings.overlapTime;
+		if (++_accumulatedGpuTimingsCount == GPU_TIMINGS_REPORT_INTERVAL)
+		{
+			const double count = static_cast<double>(_accumulatedGpuTimingsCount);
+			std::cout << "[GPU] graphics: " << _accumulatedGpuTimings.graphicsTime / count
+					  << " ms, async compute: " << _accumulatedGpuTimings.computeTime / count
+					  << " ms, overlap: " << _accumulatedGpuTimings.overlapTime / count << " ms\n";
+			_accumulatedGpuTimings = structs::GpuTimings{};
+			_accumulatedGpuTimingsCount = 0;
+		}
+#endif
+	}
+
+#ifdef USE_SHADER_HOT_RELOAD
+	void Renderer::ReloadShaders()
+	{
+		// Wait for the current rebuild to finish, since it uses the modules. The reloads stay in the watcher until then.
+		if (_shaderEffectManager.IsRebuilding())
+		{
+			return;
+		}
+
+		std::vector<shader_effect_id_t> effectsToRebuild;
+		for (const auto &reload : _shaderWatcher.PollReloads())
+		{
+			auto shaderModule = _shaderModules.find(reload.name);
+			if (shaderModule == _shaderModules.end())
+			{
+				std::cout << "[Shaders] \"" << reload.name << "\" is not used by the renderer, ignoring it.\n";
+				continue;
+			}
+
+			shader_module_id_t newModule;
+			try
+			{
+				newModule = _shaderModuleManager.ReplaceShaderModule(_shaderModuleManager.LookupId(shaderModule->second), reload.code.data(), reload.code.size() * sizeof(uint32_t))
+								.GetId();
+			}
+			catch (const std::exception &error)
+			{
+				std::cerr << "[Shaders] Couldn't reload \"" << reload.name << "\": " << error.what() << '\n';
+				continue;
+			}
+
+			// Only the effects created with that name use the new code
+			const auto &nameEffects = _shaderEffects[reload.name];
+			if (newModule != shaderModule->second)
+			{
+				_shaderEffectManager.ReplaceShaderModule(nameEffects, shaderModule->second, newModule);
+				shaderModule->second = newModule;
+			}
+
+			// Only rebuild those effects, and only once if several of their modules changed
+			for (auto effect : nameEffects)
+			{
+				if (std::find(effectsToRebuild.begin(), effectsToRebuild.end(), effect) == effectsToRebuild.end())
+				{
+					effectsToRebuild.push_back(effect);
+				}
+			}
+		}
+
+		if (!effectsToRebuild.empty())
+		{
+			_shaderEffectManager.RebuildEffectsAsync(effectsToRebuild);
+		}
+	}
+#endif
+
 	void Renderer::Draw()
 	{
 		// Get current frame
+		const uint32_t frameIndex = _drawnFramesCount % NB_OVERLAPPING_FRAMES;
 		auto currentFrame = GetCurrentFrame();
 
 		// Wait for fences
 		WaitForFence(currentFrame.renderFence);
 		_device.resetFences(currentFrame.renderFence);
+		ReadGpuTimings(frameIndex);
+
+		// The transient CPU data of the last use of the frame isn't needed anymore
+		auto &arena = _frameManager.GetArena(frameIndex);
+		arena.Reset();
+
+		// The GPU finished the frame, so its buffer memory can be reused
+		_bufferManager.BeginFrame(frameIndex);
+		_meshManager.BeginFrame(frameIndex);
+		_clusterCuller.BeginFrame(frameIndex);
+		if (_headless)
+		{
+			// Write the image that was drawn the last time the frame was used
+			_offscreenTarget.BeginFrame(frameIndex);
+		}
+
+#ifdef USE_SHADER_HOT_RELOAD
+		ReloadShaders();
+#endif
+		// Use the pipelines that were rebuilt in the background
+		_shaderEffectManager.UpdateRebuilds(_drawnFramesCount);
 
-		// Request image index from swapchain
-		auto swapchain = _swapchainManager.LookupId(_mainWindowSwapchain);
-		auto imageIndex = _swapchainManager.RequestNextImageIndex(swapchain, currentFrame.presentSemaphore);
+		// Write the matrices of the cameras, and group the ones that can share their culling
+		_cameraViews.clear();
+		_swapchainCameraManager.Draw(_bufferManager, _cameraViews);
+		if (_cameraViews.empty())
+		{
+			// Without cameras, the main target is drawn without transform, and nothing is culled
+			const auto uniforms = _bufferManager.PushFrameData(structs::CameraData{
+				.view = glm::mat4(1.0f),
+				.projection = glm::mat4(1.0f),
+				.viewProjection = glm::mat4(1.0f),
+				.position = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f),
+			});
+			_cameraViews.push_back(structs::CameraView{
+				.swapchainId = _mainWindowSwapchain,
+				.uniformOffset = static_cast<uint32_t>(uniforms.offset),
+				.culled = false,
+			});
+		}
+		_clusterCuller.SetViews(_cameraViews, &arena);
+
+		// Sort the draws of the frame, so that the passes can record them with as few binds as possible.
+		// This also gives the meshlets of the sorted draws to the culler.
+		_renderQueue.Sort(_bufferManager, _clusterCuller, _jobPool);
+
+		// Submit the compute work before recording the graphics work, so that it can run while the graphics work of the previous
+		// frame is still executing
+		const bool useAsyncCompute = !_asyncComputeJobs.empty();
+		if (useAsyncCompute)
+		{
+			SubmitAsyncCompute(currentFrame, frameIndex);
+		}
+		else
+		{
+			_computeTimestampsWritten[frameIndex] = false;
+		}
+
+		// Offscreen images are the only target when headless
+		if (!_headless)
+		{
+			std::stable_sort(_cameraViews.begin(), _cameraViews.end(), [](const structs::CameraView &a, const structs::CameraView &b)
+							 { return a.swapchainId < b.swapchainId; });
+		}
+
+		// Request an image from each swapchain in which a camera draws. Offscreen images don't need to be acquired, there is one per frame.
+		std::pmr::vector<core::Match> presentedSwapchains(&arena);
+		std::pmr::vector<uint32_t> imageIndices(&arena);
+		std::pmr::vector<vk::Semaphore> acquireSemaphores(&arena);
+		if (!_headless)
+		{
+			for (size_t i = 0; i < _cameraViews.size(); i++)
+			{
+				if (i > 0 && _cameraViews[i].swapchainId == _cameraViews[i - 1].swapchainId)
+				{
+					continue;
+				}
+
+				auto swapchain = _swapchainManager.LookupId(_cameraViews[i].swapchainId);
+				// The render graph was compiled for the extent of the main swapchain
+				if (_swapchainManager.GetSwapchainExtent(swapchain) != _targetExtent)
+				{
+					throw std::runtime_error("Every swapchain in which a camera draws must have the extent of the main swapchain.");
+				}
+				const auto semaphore = _frameManager.GetPresentSemaphore(frameIndex, static_cast<uint32_t>(acquireSemaphores.size()));
+				imageIndices.push_back(_swapchainManager.RequestNextImageIndex(swapchain, semaphore));
+				presentedSwapchains.push_back(swapchain);
+				acquireSemaphores.push_back(semaphore);
+			}
+		}
 
 		// Reset command buffer
 		currentFrame.commandBuffer.reset({});
@@ -127,54 +660,139 @@ namespace railguard::rendering
 		};
 		currentFrame.commandBuffer.begin(cmdBeginInfo);
 
-		// Create RenderPassBeginInfo
-		// TODO with camera
-
-		vk::ClearValue clearColorValue(utils::GetColorHex(0x1f2959ff));
-		vk::RenderPassBeginInfo rpBeginInfo {
-			.renderPass = _mainRenderPass,
-			.framebuffer = _swapchainManager.GetFramebuffers(swapchain)[imageIndex],
-			.renderArea = {
-				.offset = {0, 0},
-				.extent = _windowExtent,
-			},
-			.clearValueCount = 1,
-			.pClearValues = &clearColorValue,
-		};
+		if (_gpuTimingsSupported)
+		{
+			currentFrame.commandBuffer.resetQueryPool(_graphicsTimestamps, 2 * frameIndex, 2);
+			currentFrame.commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, _graphicsTimestamps, 2 * frameIndex);
+		}
+
+		// Stream the texture levels requested since the last frame
+		_textureManager.Update(_drawnFramesCount, &arena);
+
+		// Submit the pending uploads, and acquire the ones that are finished
+		_uploadManager.Update(currentFrame.commandBuffer, &arena);
+
+		// Execute the render graph once per target, with the cameras that draw in it
+		if (_headless)
+		{
+			_renderGraph.SetImportedImage(_backbuffer, _offscreenTarget.GetImage(frameIndex), _offscreenTarget.GetImageView(frameIndex));
+			_targetCameraViews = _cameraViews;
+			_renderGraph.Execute(currentFrame.commandBuffer, &arena);
+			_offscreenTarget.RecordReadback(currentFrame.commandBuffer, frameIndex, _drawnFramesCount);
+		}
+		else
+		{
+			auto firstView = _cameraViews.begin();
+			for (size_t t = 0; t < presentedSwapchains.size(); t++)
+			{
+				const auto lastView = std::find_if(firstView, _cameraViews.end(), [&](const structs::CameraView &view)
+												   { return view.swapchainId != firstView->swapchainId; });
+				_targetCameraViews = std::span<const structs::CameraView>(firstView, lastView);
+				firstView = lastView;
+
+				// The transient images are reused by every target: wait for the previous target to finish with them
+				if (t > 0)
+				{
+					vk::MemoryBarrier barrier{
+						.srcAccessMask = vk::AccessFlagBits::eColorAttachmentWrite | vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+						.dstAccessMask = vk::AccessFlagBits::eColorAttachmentWrite | vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+					};
+					const auto stages = vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests;
+					currentFrame.commandBuffer.pipelineBarrier(stages, stages, {}, barrier, nullptr, nullptr);
+				}
 
-		// Begin recording of commands in the render pass
-		currentFrame.commandBuffer.beginRenderPass(rpBeginInfo, vk::SubpassContents::eInline);
+				const auto swapchain = presentedSwapchains[t];
+				_renderGraph.SetImportedImage(_backbuffer,
+											  _swapchainManager.GetSwapchainImages(swapchain)[imageIndices[t]],
+											  _swapchainManager.GetSwapchainImageViews(swapchain)[imageIndices[t]]);
+				_renderGraph.Execute(currentFrame.commandBuffer, &arena);
+			}
+		}
+		_targetCameraViews = {};
+		_renderQueue.Reset();
 
-		// Draw each object
-		_shaderEffectManager.Bind(_shaderEffectManager.LookupId(_triangleEffect), currentFrame.commandBuffer);
-		currentFrame.commandBuffer.draw(3, 1, 0, 0);
+#ifdef USE_RENDER_STATISTICS_REPORTS
+		// Regularly print the number of binds, to see how well the draws are sorted
+		if ((_drawnFramesCount + 1) % RENDER_QUEUE_REPORT_INTERVAL == 0)
+		{
+			const auto &statistics = _renderQueue.GetLastStatistics();
+			std::cout << "[Draw] draws: " << statistics.drawCount
+					  << ", pipeline binds: " << statistics.pipelineBinds
+					  << ", descriptor set binds: " << statistics.descriptorSetBinds
+					  << ", vertex buffer binds: " << statistics.vertexBufferBinds
+					  << ", index buffer binds: " << statistics.indexBufferBinds
+					  << ", instances: " << statistics.instanceCount
+					  << ", clusters: " << statistics.clusterCount << '\n';
 
-		// End the render pass and the command buffer
-		currentFrame.commandBuffer.endRenderPass();
+			const auto &textureStatistics = _textureManager.GetLastStatistics();
+			std::cout << "[Textures] resident: " << textureStatistics.residentSize / (1024 * 1024)
+					  << " MiB / " << textureStatistics.budget / (1024 * 1024)
+					  << " MiB budget, requested: " << textureStatistics.requestedSize / (1024 * 1024)
+					  << " MiB, satisfied: " << textureStatistics.satisfiedTextureCount << '/' << textureStatistics.textureCount
+					  << ", evictions: " << textureStatistics.evictionCount << '\n';
+		}
+#endif
+
+		if (_gpuTimingsSupported)
+		{
+			currentFrame.commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, _graphicsTimestamps, 2 * frameIndex + 1);
+			_graphicsTimestampsWritten[frameIndex] = true;
+		}
+
+		// End the command buffer
 		currentFrame.commandBuffer.end();
 
 		// Submit command buffer to the graphics queue
-		vk::PipelineStageFlags waitStage = vk::PipelineStageFlagBits::eColorAttachmentOutput;
+		// Wait until the images to render to are ready, and until the compute work is finished
+		std::pmr::vector<vk::Semaphore> waitSemaphores(acquireSemaphores, &arena);
+		std::pmr::vector<vk::PipelineStageFlags> waitStages(acquireSemaphores.size(), vk::PipelineStageFlagBits::eColorAttachmentOutput, &arena);
+		if (useAsyncCompute)
+		{
+			waitSemaphores.push_back(currentFrame.computeSemaphore);
+			waitStages.push_back(ASYNC_COMPUTE_WAIT_STAGES);
+		}
 		vk::SubmitInfo submitInfo{
-			// Wait until the image to render to is ready
-			.waitSemaphoreCount = 1,
-			.pWaitSemaphores = &currentFrame.presentSemaphore,
+			.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size()),
+			.pWaitSemaphores = waitSemaphores.data(),
 			// Pipeline stage
-			.pWaitDstStageMask = &waitStage,
+			.pWaitDstStageMask = waitStages.data(),
 			// Link the command buffer
 			.commandBufferCount = 1,
 			.pCommandBuffers = &currentFrame.commandBuffer,
-			// Signal the render semaphore
-			.signalSemaphoreCount = 1,
+			// Signal the render semaphore, which is only waited for by the presentation
+			.signalSemaphoreCount = _headless ? 0u : 1u,
 			.pSignalSemaphores = &currentFrame.renderSemaphore,
 		};
 		_graphicsQueue.submit(submitInfo, currentFrame.renderFence);
 
-		// Present the image on the screen
-		_swapchainManager.PresentImage(swapchain, imageIndex, currentFrame.renderSemaphore, _graphicsQueue);
+		// Present the images of every swapchain at once
+		if (!_headless)
+		{
+			_swapchainManager.PresentImages(presentedSwapchains, imageIndices, currentFrame.renderSemaphore, _graphicsQueue);
+		}
 
 		// Increase the number of frames drawn
 		_drawnFramesCount++;
 	}
 
+	bool Renderer::IsHeadless() const
+	{
+		return _headless;
+	}
+
+	SwapchainCameraManager &Renderer::GetSwapchainCameraManager()
+	{
+		return _swapchainCameraManager;
+	}
+
+	const SwapchainCameraManager &Renderer::GetSwapchainCameraManager() const
+	{
+		return _swapchainCameraManager;
+	}
+
+	swapchain_id_t Renderer::GetMainWindowSwapchain() const
+	{
+		return _mainWindowSwapchain;
+	}
+
 } // namespace railguard::rendering
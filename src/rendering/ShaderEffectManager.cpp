@@ -1,8 +1,30 @@
-#include "../../../include/rendering/ShaderEffectManager.h"
-#include "../../../include/rendering/init/PipelineBuilder.h"
+#include "../../include/rendering/ShaderEffectManager.h"
+#include "../../include/rendering/Settings.h"
+#include "../../include/utils/Hash.h"
+#include <algorithm>
+#include <iostream>
+#include <string>
 
 namespace railguard::rendering
 {
+    size_t ShaderVariantKeyHash::operator()(const ShaderVariantKey &key) const
+    {
+        size_t seed = key.effect;
+        for (const auto &[constantId, value] : key.variant.specialization.values)
+        {
+            utils::HashCombine(seed, constantId);
+            utils::HashCombine(seed, value);
+        }
+
+        const auto &renderState = key.variant.renderState;
+        utils::HashCombine(seed, renderState.topology);
+        utils::HashCombine(seed, renderState.polygonMode);
+        utils::HashCombine(seed, renderState.depthTest);
+        utils::HashCombine(seed, renderState.depthWrite);
+        utils::HashCombine(seed, renderState.depthCompareOp);
+        return seed;
+    }
+
     void ShaderEffectManager::Init(ShaderEffectManagerStorage storage, size_t defaultCapacity)
     {
         // Call parent function
@@ -12,12 +34,37 @@ namespace railguard::rendering
         _pipelineLayouts.reserve(defaultCapacity);
         _pipelines.reserve(defaultCapacity);
         _shaderStages.reserve(defaultCapacity);
+        _derivedLayouts.reserve(defaultCapacity);
     }
 
     void ShaderEffectManager::Clear()
     {
         super::Clear();
 
+        // Wait for the pipelines that are being built, and destroy them
+        for (auto &rebuild : _pendingRebuilds)
+        {
+            for (vk::Pipeline pipeline : rebuild.pipelines.get())
+            {
+                if (pipeline != static_cast<vk::Pipeline>(nullptr))
+                {
+                    _storage.vulkanDevice.destroyPipeline(pipeline);
+                }
+            }
+            for (vk::PipelineLayout layout : rebuild.layouts)
+            {
+                _storage.pipelineLayoutCache->ReleasePipelineLayout(layout);
+            }
+        }
+        for (const auto &[_, pipeline] : _retiredPipelines)
+        {
+            _storage.vulkanDevice.destroyPipeline(pipeline);
+        }
+        for (const auto &[_, pipeline] : _variantPipelines)
+        {
+            _storage.vulkanDevice.destroyPipeline(pipeline);
+        }
+
         // Destroy pipelines that are built
         for (vk::Pipeline pipeline : _pipelines)
         {
@@ -27,25 +74,44 @@ namespace railguard::rendering
             }
         }
 
-        // Destroy pipeline layouts
+        // Release pipeline layouts. They may be shared with other effects, so the cache decides when to destroy them
         for (vk::PipelineLayout layout : _pipelineLayouts)
         {
-            _storage.vulkanDevice.destroyPipelineLayout(layout);
+            _storage.pipelineLayoutCache->ReleasePipelineLayout(layout);
         }
 
         // Clear vectors
         _pipelineLayouts.clear();
         _pipelines.clear();
         _shaderStages.clear();
+        _derivedLayouts.clear();
+        _moduleEffects.clear();
+        _pendingRebuilds.clear();
+        _retiredPipelines.clear();
+        _variantPipelines.clear();
     }
 
     core::CompleteMatch<shader_effect_id_t> ShaderEffectManager::CreateShaderEffect(init::ShaderEffectInitInfo initInfo, bool buildEffectAfterCreation)
     {
+        // Derive the layout from the shaders if none was given
+        const bool deriveLayout = initInfo.pipelineLayout == static_cast<vk::PipelineLayout>(nullptr);
+        if (deriveLayout)
+        {
+            initInfo.pipelineLayout = _storage.pipelineLayoutCache->GetPipelineLayout(DeriveLayoutDescription(initInfo.shaderStages));
+        }
+
         auto match = super::CreateItem();
 
         _pipelineLayouts.push_back(initInfo.pipelineLayout);
         _shaderStages.push_back(initInfo.shaderStages);
         _pipelines.push_back(nullptr);
+        _derivedLayouts.push_back(deriveLayout);
+
+        // Register the effect in the reverse index
+        for (shader_module_id_t shaderModule : initInfo.shaderStages)
+        {
+            _moduleEffects[shaderModule].push_back(match.GetId());
+        }
 
         // Build if we should
         if (buildEffectAfterCreation)
@@ -56,25 +122,116 @@ namespace railguard::rendering
         return match;
     }
 
-    vk::Pipeline ShaderEffectManager::BuildEffect(const core::Match &match)
+    structs::DescriptorSetLayoutDescription ShaderEffectManager::GetCameraSetLayoutDescription()
     {
-        auto index = match.GetIndex();
+        // Dynamic, so that a single set can point to the data of every camera in the frame ring buffer
+        return structs::DescriptorSetLayoutDescription{
+            .bindings = {vk::DescriptorSetLayoutBinding{
+                .binding = 0,
+                .descriptorType = vk::DescriptorType::eUniformBufferDynamic,
+                .descriptorCount = 1,
+                .stageFlags = vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment,
+            }},
+        };
+    }
+
+    structs::PipelineLayoutDescription ShaderEffectManager::DeriveLayoutDescription(const std::vector<shader_module_id_t> &shaderStages) const
+    {
+        structs::PipelineLayoutDescription description;
+
+        for (shader_module_id_t shaderModuleId : shaderStages)
+        {
+            const auto &reflection = _storage.shaderModuleManager->GetReflection(_storage.shaderModuleManager->LookupId(shaderModuleId));
+
+            // Merge the bindings: a binding used by several stages is visible in all of them
+            if (description.setLayouts.size() < reflection.setLayouts.size())
+            {
+                description.setLayouts.resize(reflection.setLayouts.size());
+            }
+            for (size_t set = 0; set < reflection.setLayouts.size(); set++)
+            {
+                auto &mergedBindings = description.setLayouts[set].bindings;
+                for (const auto &binding : reflection.setLayouts[set].bindings)
+                {
+                    auto existing = std::find_if(mergedBindings.begin(), mergedBindings.end(), [&binding](const vk::DescriptorSetLayoutBinding &b)
+                                                 { return b.binding == binding.binding; });
+                    if (existing == mergedBindings.end())
+                    {
+                        mergedBindings.push_back(binding);
+                    }
+                    else if (existing->descriptorType != binding.descriptorType || existing->descriptorCount != binding.descriptorCount)
+                    {
+                        throw std::runtime_error("The binding " + std::to_string(binding.binding) + " of the set " + std::to_string(set) + " is declared differently in two stages of the effect.");
+                    }
+                    else
+                    {
+                        existing->stageFlags |= binding.stageFlags;
+                    }
+                }
+            }
+
+            // Stages that use the same range share it
+            for (const auto &range : reflection.pushConstantRanges)
+            {
+                auto existing = std::find_if(description.pushConstantRanges.begin(), description.pushConstantRanges.end(), [&range](const vk::PushConstantRange &r)
+                                             { return r.offset == range.offset && r.size == range.size; });
+                if (existing == description.pushConstantRanges.end())
+                {
+                    description.pushConstantRanges.push_back(range);
+                }
+                else
+                {
+                    existing->stageFlags |= range.stageFlags;
+                }
+            }
+        }
 
+        // The camera set is created by the renderer, so it must have the same layout in every effect
+        if (description.setLayouts.size() > CAMERA_DESCRIPTOR_SET && !description.setLayouts[CAMERA_DESCRIPTOR_SET].bindings.empty())
+        {
+            const auto &bindings = description.setLayouts[CAMERA_DESCRIPTOR_SET].bindings;
+            if (bindings.size() != 1 || bindings[0].binding != 0 || bindings[0].descriptorType != vk::DescriptorType::eUniformBuffer)
+            {
+                throw std::runtime_error("The set " + std::to_string(CAMERA_DESCRIPTOR_SET) + " is reserved for the camera, and must only contain a uniform buffer at binding 0.");
+            }
+            description.setLayouts[CAMERA_DESCRIPTOR_SET] = GetCameraSetLayoutDescription();
+        }
+
+        return description;
+    }
+
+    init::PipelineBuilder ShaderEffectManager::GetPipelineBuilder(size_t index, vk::PipelineLayout pipelineLayout, const structs::SpecializationConstants &specialization) const
+    {
         auto builder = init::PipelineBuilder()
-                           .WithPipelineLayout(_pipelineLayouts[index])
-                           .GetDefaultsForExtent(_storage.windowManager->GetWindowExtent());
+                           .WithPipelineLayout(pipelineLayout)
+                           .GetDefaultsForExtent(*_storage.targetExtent)
+                           .WithDynamicViewport();
 
         // Register shader stages
         for (shader_module_id_t shaderModuleId : _shaderStages[index])
         {
             // Find that module
             auto match = _storage.shaderModuleManager->LookupId(shaderModuleId);
+            auto stage = _storage.shaderModuleManager->GetStage(match);
             // Register the stage
-            builder.AddShaderStage(_storage.shaderModuleManager->GetStage(match), _storage.shaderModuleManager->GetModule(match));
+            builder.AddShaderStage(stage, _storage.shaderModuleManager->GetModule(match), specialization);
+
+            // The vertex input is the one expected by the vertex shader
+            if (stage == vk::ShaderStageFlagBits::eVertex)
+            {
+                builder.WithVertexInput(_storage.shaderModuleManager->GetReflection(match).vertexInput);
+            }
         }
 
+        return builder;
+    }
+
+    vk::Pipeline ShaderEffectManager::BuildEffect(const core::Match &match)
+    {
+        auto index = match.GetIndex();
+
         // Build the pipeline
-        vk::Pipeline pipeline = builder.Build(_storage.vulkanDevice, _storage.renderPass);
+        vk::Pipeline pipeline = GetPipelineBuilder(index, _pipelineLayouts[index]).Build(_storage.vulkanDevice, _storage.renderPass);
 
         // Store the pipeline
         _pipelines[index] = pipeline;
@@ -82,21 +239,227 @@ namespace railguard::rendering
         return pipeline;
     }
 
-    void ShaderEffectManager::DestroyShaderEffect(const core::Match &match)
+    vk::Pipeline ShaderEffectManager::GetVariantPipeline(const core::Match &match, const structs::ShaderVariant &variant)
     {
-        super::DestroyItem(match);
+        auto index = match.GetIndex();
+        auto &pipeline = _variantPipelines[ShaderVariantKey{
+            .effect = _ids[index],
+            .variant = variant,
+        }];
+
+        // Build it the first time
+        if (pipeline == static_cast<vk::Pipeline>(nullptr))
+        {
+            pipeline = GetPipelineBuilder(index, _pipelineLayouts[index], variant.specialization)
+                           .WithRenderState(variant.renderState)
+                           .Build(_storage.vulkanDevice, _storage.renderPass);
+        }
+        return pipeline;
+    }
+
+    void ShaderEffectManager::BindVariant(const core::Match &match, const structs::ShaderVariant &variant, const vk::CommandBuffer &cmd)
+    {
+        cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, GetVariantPipeline(match, variant));
+    }
+
+    size_t ShaderEffectManager::GetVariantCount() const
+    {
+        return _variantPipelines.size();
+    }
+
+    void ShaderEffectManager::RetireVariants(shader_effect_id_t effect, uint64_t frameNumber)
+    {
+        std::erase_if(_variantPipelines, [this, effect, frameNumber](const auto &variant)
+                      {
+                          if (variant.first.effect != effect)
+                          {
+                              return false;
+                          }
+                          _retiredPipelines.emplace_back(frameNumber, variant.second);
+                          return true;
+                      });
+    }
+
+    void ShaderEffectManager::RebuildEffectsAsync(const std::vector<shader_effect_id_t> &effects)
+    {
+        // Prepare the builders on this thread, since they read the managers
+        std::vector<init::PipelineBuilder> builders;
+        std::vector<vk::PipelineLayout> layouts;
+        builders.reserve(effects.size());
+        layouts.reserve(effects.size());
+        for (shader_effect_id_t effect : effects)
+        {
+            auto index = LookupId(effect).GetIndex();
+
+            // The shaders may declare other resources than before, so derive the layout again if it was derived
+            vk::PipelineLayout layout = _pipelineLayouts[index];
+            if (_derivedLayouts[index])
+            {
+                try
+                {
+                    layout = _storage.pipelineLayoutCache->GetPipelineLayout(DeriveLayoutDescription(_shaderStages[index]));
+                }
+                catch (const std::runtime_error &error)
+                {
+                    std::cerr << "[Shaders] Couldn't derive the new layout of an effect: " << error.what() << '\n';
+                    _storage.pipelineLayoutCache->RetainPipelineLayout(layout);
+                }
+            }
+            else
+            {
+                _storage.pipelineLayoutCache->RetainPipelineLayout(layout);
+            }
+
+            builders.push_back(GetPipelineBuilder(index, layout));
+            layouts.push_back(layout);
+        }
+
+        // Pipeline creation is the slow part, and vkCreateGraphicsPipelines doesn't need external synchronization
+        auto pipelines = std::async(std::launch::async, [builders = std::move(builders), device = _storage.vulkanDevice, renderPass = _storage.renderPass]() mutable
+                                    {
+                                        std::vector<vk::Pipeline> result;
+                                        result.reserve(builders.size());
+                                        for (auto &builder : builders)
+                                        {
+                                            // If a pipeline can't be built, the effect keeps its previous pipeline
+                                            try
+                                            {
+                                                result.push_back(builder.Build(device, renderPass));
+                                            }
+                                            catch (const std::exception &error)
+                                            {
+                                                std::cerr << "[Shaders] Couldn't rebuild a pipeline: " << error.what() << '\n';
+                                                result.push_back(nullptr);
+                                            }
+                                        }
+                                        return result;
+                                    });
+
+        _pendingRebuilds.push_back(PendingRebuild{
+            .effects = effects,
+            .layouts = std::move(layouts),
+            .pipelines = std::move(pipelines),
+        });
+    }
+
+    void ShaderEffectManager::UpdateRebuilds(uint64_t frameNumber)
+    {
+        // Destroy the retired pipelines that can't be used by a frame in flight anymore
+        std::erase_if(_retiredPipelines, [this, frameNumber](const std::pair<uint64_t, vk::Pipeline> &retired)
+                      {
+                          if (frameNumber < retired.first + NB_OVERLAPPING_FRAMES)
+                          {
+                              return false;
+                          }
+                          _storage.vulkanDevice.destroyPipeline(retired.second);
+                          return true;
+                      });
+
+        // Swap the pipelines that are ready
+        std::erase_if(_pendingRebuilds, [this, frameNumber](PendingRebuild &rebuild)
+                      {
+                          if (rebuild.pipelines.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+                          {
+                              return false;
+                          }
+
+                          auto pipelines = rebuild.pipelines.get();
+                          for (size_t i = 0; i < rebuild.effects.size(); i++)
+                          {
+                              // The effect may have been destroyed during the build
+                              auto lookup = _idLookupMap.find(rebuild.effects[i]);
+                              if (pipelines[i] == static_cast<vk::Pipeline>(nullptr) || lookup == _idLookupMap.end())
+                              {
+                                  if (pipelines[i] != static_cast<vk::Pipeline>(nullptr))
+                                  {
+                                      _storage.vulkanDevice.destroyPipeline(pipelines[i]);
+                                  }
+                                  _storage.pipelineLayoutCache->ReleasePipelineLayout(rebuild.layouts[i]);
+                                  continue;
+                              }
+
+                              auto index = core::Match(lookup->second).GetIndex();
+                              if (_pipelines[index] != static_cast<vk::Pipeline>(nullptr))
+                              {
+                                  _retiredPipelines.emplace_back(frameNumber, _pipelines[index]);
+                              }
+                              _pipelines[index] = pipelines[i];
+
+                              // Layouts only need to be alive while command buffers using them are recorded
+                              _storage.pipelineLayoutCache->ReleasePipelineLayout(_pipelineLayouts[index]);
+                              _pipelineLayouts[index] = rebuild.layouts[i];
+
+                              // The variants use the old shaders, so build them again when they are requested
+                              RetireVariants(rebuild.effects[i], frameNumber);
+                          }
+                          return true;
+                      });
+    }
+
+    bool ShaderEffectManager::IsRebuilding() const
+    {
+        return !_pendingRebuilds.empty();
+    }
+
+    void ShaderEffectManager::ReplaceShaderModule(const std::vector<shader_effect_id_t> &effects, shader_module_id_t previousModule, shader_module_id_t newModule)
+    {
+        auto &previousEffects = _moduleEffects[previousModule];
+        auto &newEffects = _moduleEffects[newModule];
+        for (auto effect : effects)
+        {
+            auto &stages = _shaderStages[LookupId(effect).GetIndex()];
+            std::replace(stages.begin(), stages.end(), previousModule, newModule);
+
+            // Update the reverse index
+            std::erase(previousEffects, effect);
+            if (std::find(newEffects.begin(), newEffects.end(), effect) == newEffects.end())
+            {
+                newEffects.push_back(effect);
+            }
+        }
+        if (previousEffects.empty())
+        {
+            _moduleEffects.erase(previousModule);
+        }
+    }
 
+    void ShaderEffectManager::DestroyShaderEffect(const core::Match &match)
+    {
         // Get index
         auto index = match.GetIndex();
-        size_t lastIndex = _ids.size() - 1;
+        auto id = _ids[index];
+
+        // Remove the effect from the reverse index
+        for (shader_module_id_t shaderModule : _shaderStages[index])
+        {
+            auto &effects = _moduleEffects[shaderModule];
+            std::erase(effects, id);
+            if (effects.empty())
+            {
+                _moduleEffects.erase(shaderModule);
+            }
+        }
+
+        super::DestroyItem(match);
+        size_t lastIndex = _ids.size();
 
         // Destroy the pipeline if needed
         if (_pipelines[index] != static_cast<vk::Pipeline>(nullptr))
         {
             _storage.vulkanDevice.destroyPipeline(_pipelines[index]);
         }
-        // Destroy the pipeline layout
-        _storage.vulkanDevice.destroyPipelineLayout(_pipelineLayouts[index]);
+        // Release the pipeline layout
+        _storage.pipelineLayoutCache->ReleasePipelineLayout(_pipelineLayouts[index]);
+        // Destroy its variants
+        std::erase_if(_variantPipelines, [this, id](const auto &variant)
+                      {
+                          if (variant.first.effect != id)
+                          {
+                              return false;
+                          }
+                          _storage.vulkanDevice.destroyPipeline(variant.second);
+                          return true;
+                      });
 
         // If the index is smaller then, the destroyed item is not the last and the last one should be moved where
         // the destroyed item was
@@ -105,12 +468,14 @@ namespace railguard::rendering
             _pipelineLayouts[index] = _pipelineLayouts[lastIndex];
             _pipelines[index] = _pipelines[lastIndex];
             _shaderStages[index] = _shaderStages[lastIndex];
+            _derivedLayouts[index] = _derivedLayouts[lastIndex];
         }
 
         // Destroy the last item
         _pipelineLayouts.pop_back();
         _pipelines.pop_back();
         _shaderStages.pop_back();
+        _derivedLayouts.pop_back();
     }
 
     void ShaderEffectManager::Bind(const core::Match &match, const vk::CommandBuffer &cmd) const
@@ -126,9 +491,25 @@ namespace railguard::rendering
     {
         return _pipelines[match.GetIndex()];
     }
-    const std::vector<shader_module_id_t> ShaderEffectManager::GetShaderStages(const core::Match &match) const
+
+    bool ShaderEffectManager::UsesCamera(const core::Match &match) const
+    {
+        const auto &description = _storage.pipelineLayoutCache->GetDescription(_pipelineLayouts[match.GetIndex()]);
+        return description.setLayouts.size() > CAMERA_DESCRIPTOR_SET && description.setLayouts[CAMERA_DESCRIPTOR_SET] == GetCameraSetLayoutDescription();
+    }
+    std::span<const shader_module_id_t> ShaderEffectManager::GetShaderStages(const core::Match &match) const
     {
         return _shaderStages[match.GetIndex()];
     }
 
+    std::vector<shader_effect_id_t> ShaderEffectManager::GetEffectsUsingModule(shader_module_id_t shaderModule) const
+    {
+        auto effects = _moduleEffects.find(shaderModule);
+        if (effects == _moduleEffects.end())
+        {
+            return {};
+        }
+        return effects->second;
+    }
+
 }
\ No newline at end of file
@@ -1,7 +1,14 @@
 #include "../../include/rendering/ShaderModuleManager.h"
+#include "../../include/rendering/ShaderPack.h"
+#include "../../include/rendering/SpirvReflector.h"
 #include "../../include/utils/GetError.h"
-#include <fstream>
+#include "../../include/utils/Hash.h"
+#include "../../include/utils/MappedFile.h"
+#include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <thread>
 
 namespace railguard::rendering
 {
@@ -13,6 +20,10 @@ namespace railguard::rendering
         // Init vectors that weren't initialized by parent
         _stages.reserve(defaultCapacity);
         _modules.reserve(defaultCapacity);
+        _codeHashes.reserve(defaultCapacity);
+        _codeSizes.reserve(defaultCapacity);
+        _referenceCounts.reserve(defaultCapacity);
+        _reflections.reserve(defaultCapacity);
     }
 
     void ShaderModuleManager::Clear()
@@ -28,64 +39,299 @@ namespace railguard::rendering
         // Once everything is properly destroyed, we can safely clear the vectors and the map
         _stages.clear();
         _modules.clear();
+        _codeHashes.clear();
+        _codeSizes.clear();
+        _referenceCounts.clear();
+        _reflections.clear();
+        _hashLookupMap.clear();
     }
 
-    core::CompleteMatch<shader_module_id_t> ShaderModuleManager::LoadShaderModule(vk::ShaderStageFlagBits stage, const std::vector<uint32_t> &codeBuffer)
+    uint64_t ShaderModuleManager::HashCode(vk::ShaderStageFlagBits stage, const uint32_t *code, size_t codeSize)
     {
+        size_t seed = utils::HashBytes(code, codeSize);
+        utils::HashCombine(seed, static_cast<VkShaderStageFlags>(stage));
+        return seed;
+    }
+
+    core::CompleteMatch<shader_module_id_t> ShaderModuleManager::LoadShaderModule(vk::ShaderStageFlagBits stage, const uint32_t *code, size_t codeSize)
+    {
+        // If the same code was already loaded, reuse the module
+        auto hash = HashCode(stage, code, codeSize);
+        auto cached = _hashLookupMap.find(hash);
+        if (cached != _hashLookupMap.end() && _codeSizes[LookupId(cached->second).GetIndex()] == codeSize)
+        {
+            auto match = LookupId(cached->second);
+            _referenceCounts[match.GetIndex()]++;
+            return match.AttachId(cached->second);
+        }
+
+        // Reflect first, so that nothing is created if the code is invalid
+        auto reflection = SpirvReflector::Reflect(stage, code, codeSize);
+
         auto match = super::CreateItem();
 
         vk::ShaderModuleCreateInfo shaderCreateInfo{
-            .codeSize = codeBuffer.size() * sizeof(uint32_t),
-            .pCode = codeBuffer.data(),
+            .codeSize = codeSize,
+            .pCode = code,
         };
         auto shaderModule = _storage.vulkanDevice.createShaderModule(shaderCreateInfo);
 
         // Add it to the vectors
         _modules.push_back(shaderModule);
         _stages.push_back(stage);
+        _codeHashes.push_back(hash);
+        _codeSizes.push_back(codeSize);
+        _referenceCounts.push_back(1);
+        _reflections.push_back(std::move(reflection));
+        // On a collision, the first module stays in the map
+        _hashLookupMap.try_emplace(hash, match.GetId());
 
         return match;
     }
 
-    core::CompleteMatch<shader_module_id_t> ShaderModuleManager::LoadShaderModule(vk::ShaderStageFlagBits stage, const std::string &filePath)
+    core::CompleteMatch<shader_module_id_t> ShaderModuleManager::LoadShaderModule(vk::ShaderStageFlagBits stage, const std::vector<uint32_t> &codeBuffer)
     {
-        // Load the SPIR-V code from the given file.
-
-        // Load the binary file with the cursor at the end
-        std::ifstream file(filePath, std::ios::ate | std::ios::binary);
+        return LoadShaderModule(stage, codeBuffer.data(), codeBuffer.size() * sizeof(uint32_t));
+    }
 
-        if (!file.is_open())
+    core::CompleteMatch<shader_module_id_t> ShaderModuleManager::LoadShaderModule(vk::ShaderStageFlagBits stage, const std::string &filePath)
+    {
+        // Map the SPIR-V file in memory. The mapping is page aligned, so it can be read as 32-bit words directly.
+        try
+        {
+            utils::MappedFile file(filePath);
+            return LoadShaderModule(stage, static_cast<const uint32_t *>(file.GetData()), file.GetSize());
+        }
+        catch (const std::runtime_error &error)
         {
             // Display error
-            std::cerr << "Couldn't load shader \"" << std::string(filePath) << "\": " << utils::GetError() << '\n';
+            std::cerr << "Couldn't load shader \"" << std::string(filePath) << "\": " << error.what() << '\n';
             throw std::runtime_error("Couldn't load shader " + std::string(filePath));
         }
+    }
+
+    std::unordered_map<std::string, shader_module_id_t> ShaderModuleManager::LoadShaderPack(const std::string &packPath)
+    {
+        std::unique_ptr<ShaderPack> pack;
+        try
+        {
+            pack = std::make_unique<ShaderPack>(packPath);
+        }
+        catch (const std::runtime_error &error)
+        {
+            // Display error
+            std::cerr << "Couldn't load shader pack \"" << packPath << "\": " << error.what() << '\n';
+            throw std::runtime_error("Couldn't load shader pack " + packPath);
+        }
+
+        const uint32_t entryCount = pack->GetEntryCount();
+        const uint32_t threadCount = std::max(1u, std::min(std::thread::hardware_concurrency(), entryCount));
+
+        // Runs the function for every index in [0, count), split in contiguous chunks between the threads
+        auto parallelFor = [threadCount](uint32_t count, const auto &function)
+        {
+            std::vector<std::thread> threads;
+            threads.reserve(threadCount);
+            const uint32_t chunkSize = (count + threadCount - 1) / threadCount;
+            for (uint32_t start = 0; start < count; start += chunkSize)
+            {
+                threads.emplace_back([start, end = std::min(count, start + chunkSize), &function]()
+                                     {
+                                         for (uint32_t i = start; i < end; i++)
+                                         {
+                                             function(i);
+                                         }
+                                     });
+            }
+            for (auto &thread : threads)
+            {
+                thread.join();
+            }
+        };
+
+        // Hash every shader in parallel, since it reads the whole code
+        std::vector<uint64_t> hashes(entryCount);
+        parallelFor(entryCount, [&](uint32_t i)
+                    {
+                        const auto &entry = pack->GetEntry(i);
+                        hashes[i] = HashCode(static_cast<vk::ShaderStageFlagBits>(entry.stage), pack->GetCode(entry), entry.codeSize);
+                    });
+
+        // Find the shaders that need a new module. Those that are already loaded only need a new reference.
+        std::unordered_map<std::string, shader_module_id_t> result;
+        std::vector<uint32_t> missingEntries;
+        // Index in missingEntries of the module of each entry that isn't loaded yet
+        std::vector<uint32_t> entryModules(entryCount, UINT32_MAX);
+        std::unordered_map<uint64_t, uint32_t> missingHashes;
+        for (uint32_t i = 0; i < entryCount; i++)
+        {
+            const auto &entry = pack->GetEntry(i);
+            auto cached = _hashLookupMap.find(hashes[i]);
+            if (cached != _hashLookupMap.end() && _codeSizes[LookupId(cached->second).GetIndex()] == entry.codeSize)
+            {
+                _referenceCounts[LookupId(cached->second).GetIndex()]++;
+                result[std::string(pack->GetName(entry))] = cached->second;
+                continue;
+            }
+
+            // Identical shaders in the pack only need one module. Both are mapped, so the code itself can be compared.
+            auto [missing, inserted] = missingHashes.try_emplace(hashes[i], static_cast<uint32_t>(missingEntries.size()));
+            if (!inserted)
+            {
+                const auto &first = pack->GetEntry(missingEntries[missing->second]);
+                if (first.codeSize == entry.codeSize && std::memcmp(pack->GetCode(first), pack->GetCode(entry), entry.codeSize) == 0)
+                {
+                    entryModules[i] = missing->second;
+                    continue;
+                }
+            }
+            entryModules[i] = static_cast<uint32_t>(missingEntries.size());
+            missingEntries.push_back(i);
+        }
+
+        // Reflect and create the missing modules in parallel. vkCreateShaderModule doesn't need external synchronization.
+        std::vector<vk::ShaderModule> createdModules(missingEntries.size());
+        std::vector<structs::ShaderReflection> reflections(missingEntries.size());
+        std::vector<vk::Result> results(missingEntries.size(), vk::Result::eSuccess);
+        std::vector<std::string> reflectionErrors(missingEntries.size());
+        parallelFor(static_cast<uint32_t>(missingEntries.size()), [&](uint32_t i)
+                    {
+                        const auto &entry = pack->GetEntry(missingEntries[i]);
+                        try
+                        {
+                            reflections[i] = SpirvReflector::Reflect(static_cast<vk::ShaderStageFlagBits>(entry.stage), pack->GetCode(entry), entry.codeSize);
+                        }
+                        catch (const std::runtime_error &error)
+                        {
+                            // Don't create the module, it will be reported below
+                            reflectionErrors[i] = error.what();
+                            return;
+                        }
+                        vk::ShaderModuleCreateInfo shaderCreateInfo{
+                            .codeSize = entry.codeSize,
+                            .pCode = pack->GetCode(entry),
+                        };
+                        results[i] = _storage.vulkanDevice.createShaderModule(&shaderCreateInfo, nullptr, &createdModules[i]);
+                    });
+
+        // If one of them failed, destroy the others so that nothing leaks
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            if (results[i] != vk::Result::eSuccess || !reflectionErrors[i].empty())
+            {
+                for (size_t j = 0; j < createdModules.size(); j++)
+                {
+                    if (results[j] == vk::Result::eSuccess)
+                    {
+                        _storage.vulkanDevice.destroyShaderModule(createdModules[j]);
+                    }
+                }
+                const auto &entry = pack->GetEntry(missingEntries[i]);
+                const auto reason = reflectionErrors[i].empty() ? vk::to_string(results[i]) : reflectionErrors[i];
+                throw std::runtime_error("Couldn't create the shader module \"" + std::string(pack->GetName(entry)) + "\" from pack " + packPath + ": " + reason);
+            }
+        }
+
+        // Register the new modules
+        std::vector<shader_module_id_t> createdIds;
+        createdIds.reserve(missingEntries.size());
+        for (size_t i = 0; i < missingEntries.size(); i++)
+        {
+            const auto &entry = pack->GetEntry(missingEntries[i]);
+            auto match = super::CreateItem();
+
+            _modules.push_back(createdModules[i]);
+            _stages.push_back(static_cast<vk::ShaderStageFlagBits>(entry.stage));
+            _codeHashes.push_back(hashes[missingEntries[i]]);
+            _codeSizes.push_back(entry.codeSize);
+            _referenceCounts.push_back(1);
+            _reflections.push_back(std::move(reflections[i]));
+            _hashLookupMap.try_emplace(hashes[missingEntries[i]], match.GetId());
+            createdIds.push_back(match.GetId());
+        }
+
+        // Give the ids to the entries of the pack, including the duplicates
+        for (uint32_t i = 0; i < entryCount; i++)
+        {
+            if (entryModules[i] == UINT32_MAX)
+            {
+                continue;
+            }
+            auto id = createdIds[entryModules[i]];
+            // The first entry with that code already has the reference of the creation
+            if (missingEntries[entryModules[i]] != i)
+            {
+                _referenceCounts[LookupId(id).GetIndex()]++;
+            }
+            result[std::string(pack->GetName(pack->GetEntry(i)))] = id;
+        }
+
+        return result;
+    }
+
+    core::CompleteMatch<shader_module_id_t> ShaderModuleManager::ReplaceShaderModule(const core::Match &match, const uint32_t *code, size_t codeSize)
+    {
+        auto index = match.GetIndex();
+
+        // Other shaders share the module: they keep the previous code, and the caller gets its own module
+        if (_referenceCounts[index] > 1)
+        {
+            // Load it first, so that the caller keeps its reference if the code is invalid
+            auto replacement = LoadShaderModule(_stages[index], code, codeSize);
+            _referenceCounts[index]--;
+            return replacement;
+        }
+
+        // Create the new module first, so that the old one is kept if the code is invalid
+        auto reflection = SpirvReflector::Reflect(_stages[index], code, codeSize);
+        vk::ShaderModuleCreateInfo shaderCreateInfo{
+            .codeSize = codeSize,
+            .pCode = code,
+        };
+        auto shaderModule = _storage.vulkanDevice.createShaderModule(shaderCreateInfo);
+
+        // Pipelines don't need the module once they are created, so it can be destroyed right away
+        _storage.vulkanDevice.destroyShaderModule(_modules[index]);
+        _modules[index] = shaderModule;
+        _reflections[index] = std::move(reflection);
+
+        // Update the hash so that loading the new code returns this module
+        auto lookup = _hashLookupMap.find(_codeHashes[index]);
+        if (lookup != _hashLookupMap.end() && lookup->second == _ids[index])
+        {
+            _hashLookupMap.erase(lookup);
+        }
+        _codeHashes[index] = HashCode(_stages[index], code, codeSize);
+        _codeSizes[index] = codeSize;
+        _hashLookupMap.try_emplace(_codeHashes[index], _ids[index]);
 
-        // Since the cursor is at the end, tellg gives the size of the file
-        size_t fileSize = file.tellg();
-        // Create a vector long enough to hold the content
-        std::vector<uint32_t> buffer(fileSize / sizeof(uint32_t));
-        // Cursor at the beginning
-        file.seekg(0);
-        // Load the file into the buffer
-        file.read((char *)buffer.data(), fileSize);
-        // Close the file
-        file.close();
-
-        return LoadShaderModule(stage, buffer);
+        return match.AttachId(_ids[index]);
     }
 
 //! [Example of derivation of StandaloneManager::DestroyItem]
     void ShaderModuleManager::DestroyShaderModule(const core::Match &match)
     {
-        super::DestroyItem(match);
-
         // Get index
         auto index = match.GetIndex();
-        size_t lastIndex = _ids.size() - 1;
+
+        // Other users still need the module
+        if (--_referenceCounts[index] > 0)
+        {
+            return;
+        }
+
+        auto id = _ids[index];
+        super::DestroyItem(match);
+        size_t lastIndex = _ids.size();
 
         // Destroy the module
         _storage.vulkanDevice.destroyShaderModule(_modules[index]);
+        // After a hot reload, another module may own that hash
+        auto lookup = _hashLookupMap.find(_codeHashes[index]);
+        if (lookup != _hashLookupMap.end() && lookup->second == id)
+        {
+            _hashLookupMap.erase(lookup);
+        }
 
         // If the index is smaller then, the destroyed item is not the last and the last one should be moved where
         // the destroyed item was
@@ -93,11 +339,19 @@ namespace railguard::rendering
         {
             _stages[index] = _stages[lastIndex];
             _modules[index] = _modules[lastIndex];
+            _codeHashes[index] = _codeHashes[lastIndex];
+            _codeSizes[index] = _codeSizes[lastIndex];
+            _referenceCounts[index] = _referenceCounts[lastIndex];
+            _reflections[index] = std::move(_reflections[lastIndex]);
         }
 
         // Destroy the last item
         _stages.pop_back();
         _modules.pop_back();
+        _codeHashes.pop_back();
+        _codeSizes.pop_back();
+        _referenceCounts.pop_back();
+        _reflections.pop_back();
     }
 //! [Example of derivation of StandaloneManager::DestroyItem]
 
@@ -111,4 +365,14 @@ namespace railguard::rendering
         return _modules[match.GetIndex()];
     }
 
+    uint32_t ShaderModuleManager::GetReferenceCount(const core::Match &match) const
+    {
+        return _referenceCounts[match.GetIndex()];
+    }
+
+    const structs::ShaderReflection &ShaderModuleManager::GetReflection(const core::Match &match) const
+    {
+        return _reflections[match.GetIndex()];
+    }
+
 }
\ No newline at end of file
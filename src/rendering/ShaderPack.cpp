@@ -0,0 +1,65 @@
+#include "../../include/rendering/ShaderPack.h"
+#include "../../include/utils/Hash.h"
+#include <stdexcept>
+
+namespace railguard::rendering
+{
+    ShaderPack::ShaderPack(const std::string &filePath) : _file(filePath)
+    {
+        const auto *data = static_cast<const uint8_t *>(_file.GetData());
+
+        // Check that the file is a complete pack of the current version
+        _header = reinterpret_cast<const structs::ShaderPackHeader *>(data);
+        if (_file.GetSize() < sizeof(structs::ShaderPackHeader) || _header->magic != SHADER_PACK_MAGIC)
+        {
+            throw std::runtime_error("\"" + filePath + "\" is not a shader pack.");
+        }
+        if (_header->version != SHADER_PACK_VERSION)
+        {
+            throw std::runtime_error("The shader pack \"" + filePath + "\" was created with another version of the packer.");
+        }
+        if (_header->fileSize != _file.GetSize())
+        {
+            throw std::runtime_error("The shader pack \"" + filePath + "\" is truncated.");
+        }
+
+        _entries = reinterpret_cast<const structs::ShaderPackEntry *>(data + _header->entriesOffset);
+        _buckets = reinterpret_cast<const uint32_t *>(data + _header->bucketsOffset);
+        _names = reinterpret_cast<const char *>(data + _header->namesOffset);
+    }
+
+    uint32_t ShaderPack::GetEntryCount() const
+    {
+        return _header->entryCount;
+    }
+
+    const structs::ShaderPackEntry &ShaderPack::GetEntry(uint32_t index) const
+    {
+        return _entries[index];
+    }
+
+    std::string_view ShaderPack::GetName(const structs::ShaderPackEntry &entry) const
+    {
+        return std::string_view(_names + entry.nameOffset, entry.nameLength);
+    }
+
+    const uint32_t *ShaderPack::GetCode(const structs::ShaderPackEntry &entry) const
+    {
+        return reinterpret_cast<const uint32_t *>(static_cast<const uint8_t *>(_file.GetData()) + entry.codeOffset);
+    }
+
+    const structs::ShaderPackEntry *ShaderPack::Find(std::string_view name) const
+    {
+        const auto hash = utils::HashBytes(name.data(), name.size());
+
+        for (uint32_t index = _buckets[hash & (_header->bucketCount - 1)]; index != SHADER_PACK_NO_ENTRY; index = _entries[index].nextInBucket)
+        {
+            const auto &entry = _entries[index];
+            if (entry.nameHash == hash && GetName(entry) == name)
+            {
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+} // namespace railguard::rendering
@@ -0,0 +1,232 @@
+#include "../../include/rendering/ShaderWatcher.h"
+#include "../../include/rendering/Settings.h"
+#include "../../include/utils/AdvancedCheck.h"
+#include "../../include/utils/GetError.h"
+#include "../../include/utils/MappedFile.h"
+#include <algorithm>
+#include <cerrno>
+#include <filesystem>
+#include <iostream>
+#include <set>
+#include <utility>
+
+#ifndef _WIN32
+#include <poll.h>
+#include <spawn.h>
+#include <sys/inotify.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char **environ;
+#endif
+
+#ifdef USE_ADVANCED_CHECKS
+// Define local error messages
+#define INITIALIZED_TWICE_ERROR "ShaderWatcher should not be initialized twice."
+#define NOT_INITIALIZED_ERROR "ShaderWatcher should be initialized with Init before calling this method."
+#define NOT_CLEANED_ERROR "ShaderWatcher should be cleaned up with Cleanup before it is destroyed."
+#endif
+
+// Time after which the thread checks if it should stop, when no file is modified
+#define WATCH_POLL_TIMEOUT_MS 100
+
+namespace railguard::rendering
+{
+    namespace
+    {
+        /**
+         * @brief Runs the shader compiler on the source file, and returns true if it succeeded.
+         * The paths are given as separate arguments, without going through a shell, so that the file name can't inject a command.
+         */
+        bool RunShaderCompiler(const std::string &sourcePath, const std::string &binaryPath)
+        {
+#ifdef _WIN32
+            return false;
+#else
+            std::string compiler = SHADER_COMPILER_COMMAND;
+            std::string versionFlag = "-V";
+            std::string outputFlag = "-o";
+            std::string source = sourcePath;
+            std::string binary = binaryPath;
+            char *arguments[] = {compiler.data(), versionFlag.data(), source.data(), outputFlag.data(), binary.data(), nullptr};
+
+            pid_t process;
+            if (posix_spawnp(&process, compiler.c_str(), nullptr, nullptr, arguments, environ) != 0)
+            {
+                std::cerr << "[Shaders] Couldn't start " << SHADER_COMPILER_COMMAND << ".\n";
+                return false;
+            }
+
+            int status;
+            while (waitpid(process, &status, 0) < 0)
+            {
+                if (errno != EINTR)
+                {
+                    return false;
+                }
+            }
+            return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+#endif
+        }
+    } // namespace
+
+    void ShaderWatcher::Init(const std::string &sourceDirectory, const std::string &binaryDirectory)
+    {
+        ADVANCED_CHECK(!_initialized, INITIALIZED_TWICE_ERROR);
+
+        _sourceDirectory = sourceDirectory;
+        _binaryDirectory = binaryDirectory;
+
+#ifdef _WIN32
+        std::cout << "[Shaders] Hot reload is not supported on this platform.\n";
+#else
+        _inotifyDescriptor = inotify_init1(IN_NONBLOCK);
+        if (_inotifyDescriptor < 0)
+        {
+            throw std::runtime_error("Couldn't init inotify: " + utils::GetError());
+        }
+        // Editors either write the file directly or replace it with a new one
+        if (inotify_add_watch(_inotifyDescriptor, sourceDirectory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+        {
+            close(_inotifyDescriptor);
+            _inotifyDescriptor = -1;
+            throw std::runtime_error("Couldn't watch the shader directory \"" + sourceDirectory + "\": " + utils::GetError());
+        }
+
+        _running = true;
+        _thread = std::thread(&ShaderWatcher::Watch, this);
+#endif
+
+#ifdef USE_ADVANCED_CHECKS
+        _initialized = true;
+#endif
+    }
+
+    void ShaderWatcher::Cleanup()
+    {
+        ADVANCED_CHECK(_initialized, NOT_INITIALIZED_ERROR);
+
+        // Stop the thread. It checks the flag at least every WATCH_POLL_TIMEOUT_MS.
+        _running = false;
+        if (_thread.joinable())
+        {
+            _thread.join();
+        }
+#ifndef _WIN32
+        if (_inotifyDescriptor >= 0)
+        {
+            close(_inotifyDescriptor);
+            _inotifyDescriptor = -1;
+        }
+#endif
+        _reloads.clear();
+
+#ifdef USE_ADVANCED_CHECKS
+        // Back to the beginning
+        _initialized = false;
+#endif
+    }
+
+    ShaderWatcher::~ShaderWatcher()
+    {
+        ADVANCED_CHECK(!_initialized, NOT_CLEANED_ERROR);
+    }
+
+    void ShaderWatcher::Watch()
+    {
+#ifndef _WIN32
+        // Aligned like an inotify_event, as required by the man page
+        alignas(inotify_event) char buffer[4096];
+        pollfd descriptor{
+            .fd = _inotifyDescriptor,
+            .events = POLLIN,
+        };
+
+        while (_running)
+        {
+            if (poll(&descriptor, 1, WATCH_POLL_TIMEOUT_MS) <= 0)
+            {
+                continue;
+            }
+
+            // Saving a file often creates several events, so only recompile each file once
+            std::set<std::string> modifiedFiles;
+            ssize_t length;
+            while ((length = read(_inotifyDescriptor, buffer, sizeof(buffer))) > 0)
+            {
+                for (char *pointer = buffer; pointer < buffer + length;)
+                {
+                    const auto *event = reinterpret_cast<const inotify_event *>(pointer);
+                    if (event->len > 0)
+                    {
+                        modifiedFiles.emplace(event->name);
+                    }
+                    pointer += sizeof(inotify_event) + event->len;
+                }
+            }
+
+            for (const auto &name : modifiedFiles)
+            {
+                Recompile(name);
+            }
+        }
+#endif
+    }
+
+    void ShaderWatcher::Recompile(const std::string &name)
+    {
+        // Ignore the files that are not shaders (e.g. temporary files of editors)
+        auto extension = std::filesystem::path(name).extension().string();
+        if (extension != ".vert" && extension != ".frag" && extension != ".comp")
+        {
+            return;
+        }
+
+        // Compile it to the same path as the build
+        auto sourcePath = _sourceDirectory + "/" + name;
+        auto binaryPath = _binaryDirectory + "/" + name + ".spv";
+        if (!RunShaderCompiler(sourcePath, binaryPath))
+        {
+            // The compiler already printed the errors. Keep the previous version.
+            std::cerr << "[Shaders] Couldn't compile \"" << name << "\", keeping the previous version.\n";
+            return;
+        }
+
+        structs::ShaderReload reload{
+            .name = name,
+        };
+        try
+        {
+            utils::MappedFile file(binaryPath);
+            const auto *code = static_cast<const uint32_t *>(file.GetData());
+            reload.code.assign(code, code + file.GetSize() / sizeof(uint32_t));
+        }
+        catch (const std::runtime_error &error)
+        {
+            std::cerr << "[Shaders] Couldn't read \"" << binaryPath << "\": " << error.what() << '\n';
+            return;
+        }
+        std::cout << "[Shaders] Recompiled \"" << name << "\".\n";
+
+        // Replace the previous version if it was not polled yet
+        std::lock_guard lock(_reloadsMutex);
+        auto previous = std::find_if(_reloads.begin(), _reloads.end(), [&name](const structs::ShaderReload &r)
+                                     { return r.name == name; });
+        if (previous != _reloads.end())
+        {
+            *previous = std::move(reload);
+        }
+        else
+        {
+            _reloads.push_back(std::move(reload));
+        }
+    }
+
+    std::vector<structs::ShaderReload> ShaderWatcher::PollReloads()
+    {
+        ADVANCED_CHECK(_initialized, NOT_INITIALIZED_ERROR);
+
+        std::lock_guard lock(_reloadsMutex);
+        return std::exchange(_reloads, {});
+    }
+} // namespace railguard::rendering
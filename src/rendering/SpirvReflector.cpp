@@ -0,0 +1,406 @@
+#include "../../include/rendering/SpirvReflector.h"
+#include "../../include/rendering/Settings.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+// Values from the SPIR-V specification, only the ones that are needed
+#define SPIRV_MAGIC 0x07230203
+#define SPIRV_HEADER_SIZE 5
+
+#define SPIRV_OP_DECORATE 71
+#define SPIRV_OP_MEMBER_DECORATE 72
+#define SPIRV_OP_TYPE_BOOL 20
+#define SPIRV_OP_TYPE_INT 21
+#define SPIRV_OP_TYPE_FLOAT 22
+#define SPIRV_OP_TYPE_VECTOR 23
+#define SPIRV_OP_TYPE_MATRIX 24
+#define SPIRV_OP_TYPE_IMAGE 25
+#define SPIRV_OP_TYPE_SAMPLER 26
+#define SPIRV_OP_TYPE_SAMPLED_IMAGE 27
+#define SPIRV_OP_TYPE_ARRAY 28
+#define SPIRV_OP_TYPE_RUNTIME_ARRAY 29
+#define SPIRV_OP_TYPE_STRUCT 30
+#define SPIRV_OP_TYPE_POINTER 32
+#define SPIRV_OP_CONSTANT 43
+#define SPIRV_OP_SPEC_CONSTANT 50
+#define SPIRV_OP_VARIABLE 59
+
+#define SPIRV_DECORATION_BUFFER_BLOCK 3
+#define SPIRV_DECORATION_ARRAY_STRIDE 6
+#define SPIRV_DECORATION_MATRIX_STRIDE 7
+#define SPIRV_DECORATION_BUILT_IN 11
+#define SPIRV_DECORATION_LOCATION 30
+#define SPIRV_DECORATION_BINDING 33
+#define SPIRV_DECORATION_DESCRIPTOR_SET 34
+#define SPIRV_DECORATION_OFFSET 35
+
+#define SPIRV_STORAGE_CLASS_UNIFORM_CONSTANT 0
+#define SPIRV_STORAGE_CLASS_INPUT 1
+#define SPIRV_STORAGE_CLASS_UNIFORM 2
+#define SPIRV_STORAGE_CLASS_PUSH_CONSTANT 9
+#define SPIRV_STORAGE_CLASS_STORAGE_BUFFER 12
+
+#define SPIRV_DIM_BUFFER 5
+#define SPIRV_DIM_SUBPASS_DATA 6
+
+namespace railguard::rendering
+{
+    SpirvReflector::SpirvReflector(const uint32_t *code, size_t codeSize)
+    {
+        const size_t wordCount = codeSize / sizeof(uint32_t);
+        if (wordCount < SPIRV_HEADER_SIZE || code[0] != SPIRV_MAGIC)
+        {
+            throw std::runtime_error("The shader code is not valid SPIR-V.");
+        }
+
+        // Every id is smaller than the bound given in the header
+        _ids.resize(code[3]);
+        auto getId = [this](uint32_t id) -> IdInfo &
+        {
+            if (id >= _ids.size())
+            {
+                throw std::runtime_error("The shader code uses an id that is out of bounds.");
+            }
+            return _ids[id];
+        };
+
+        for (size_t position = SPIRV_HEADER_SIZE; position < wordCount;)
+        {
+            // Each instruction starts with its length in words and its opcode
+            const uint32_t length = code[position] >> 16;
+            const uint32_t opcode = code[position] & 0xFFFF;
+            if (length == 0 || position + length > wordCount)
+            {
+                throw std::runtime_error("The shader code contains a truncated instruction.");
+            }
+            const uint32_t *words = code + position;
+
+            switch (opcode)
+            {
+            case SPIRV_OP_DECORATE:
+            {
+                auto &target = getId(words[1]);
+                const uint32_t value = length > 3 ? words[3] : 0;
+                switch (words[2])
+                {
+                case SPIRV_DECORATION_BUFFER_BLOCK:
+                    target.isBufferBlock = true;
+                    break;
+                case SPIRV_DECORATION_ARRAY_STRIDE:
+                    target.arrayStride = value;
+                    break;
+                case SPIRV_DECORATION_BUILT_IN:
+                    target.isBuiltIn = true;
+                    break;
+                case SPIRV_DECORATION_LOCATION:
+                    target.location = value;
+                    target.hasLocation = true;
+                    break;
+                case SPIRV_DECORATION_BINDING:
+                    target.binding = value;
+                    break;
+                case SPIRV_DECORATION_DESCRIPTOR_SET:
+                    target.set = value;
+                    break;
+                default:
+                    break;
+                }
+                break;
+            }
+            case SPIRV_OP_MEMBER_DECORATE:
+            {
+                auto &target = getId(words[1]);
+                const uint32_t member = words[2];
+                const uint32_t value = length > 4 ? words[4] : 0;
+                if (words[3] == SPIRV_DECORATION_OFFSET || words[3] == SPIRV_DECORATION_MATRIX_STRIDE)
+                {
+                    auto &values = words[3] == SPIRV_DECORATION_OFFSET ? target.memberOffsets : target.memberMatrixStrides;
+                    if (values.size() <= member)
+                    {
+                        values.resize(member + 1, 0);
+                    }
+                    values[member] = value;
+                }
+                break;
+            }
+            case SPIRV_OP_TYPE_BOOL:
+            case SPIRV_OP_TYPE_INT:
+            case SPIRV_OP_TYPE_FLOAT:
+            case SPIRV_OP_TYPE_VECTOR:
+            case SPIRV_OP_TYPE_MATRIX:
+            case SPIRV_OP_TYPE_IMAGE:
+            case SPIRV_OP_TYPE_SAMPLER:
+            case SPIRV_OP_TYPE_SAMPLED_IMAGE:
+            case SPIRV_OP_TYPE_ARRAY:
+            case SPIRV_OP_TYPE_RUNTIME_ARRAY:
+            case SPIRV_OP_TYPE_STRUCT:
+            case SPIRV_OP_TYPE_POINTER:
+            {
+                // Types: the result id is the first operand
+                auto &type = getId(words[1]);
+                type.opcode = opcode;
+                type.operands.assign(words + 2, words + length);
+                break;
+            }
+            case SPIRV_OP_CONSTANT:
+            case SPIRV_OP_SPEC_CONSTANT:
+            case SPIRV_OP_VARIABLE:
+            {
+                // Result type, then result id
+                auto &value = getId(words[2]);
+                value.opcode = opcode;
+                value.typeId = words[1];
+                value.operands.assign(words + 3, words + length);
+                if (opcode == SPIRV_OP_VARIABLE)
+                {
+                    _variables.push_back(words[2]);
+                }
+                break;
+            }
+            default:
+                break;
+            }
+
+            position += length;
+        }
+    }
+
+    uint32_t SpirvReflector::GetConstantValue(uint32_t constantId) const
+    {
+        const auto &constant = _ids[constantId];
+        if ((constant.opcode != SPIRV_OP_CONSTANT && constant.opcode != SPIRV_OP_SPEC_CONSTANT) || constant.operands.empty())
+        {
+            throw std::runtime_error("Array lengths must be constants.");
+        }
+        // Specialization constants are reflected with their default value
+        return constant.operands[0];
+    }
+
+    uint32_t SpirvReflector::GetTypeSize(uint32_t typeId, uint32_t matrixStride) const
+    {
+        const auto &type = _ids[typeId];
+        switch (type.opcode)
+        {
+        case SPIRV_OP_TYPE_BOOL:
+            return 4;
+        case SPIRV_OP_TYPE_INT:
+        case SPIRV_OP_TYPE_FLOAT:
+            return type.operands[0] / 8;
+        case SPIRV_OP_TYPE_VECTOR:
+            return type.operands[1] * GetTypeSize(type.operands[0]);
+        case SPIRV_OP_TYPE_MATRIX:
+            // Columns are aligned on the matrix stride when it is given
+            return type.operands[1] * (matrixStride != 0 ? matrixStride : GetTypeSize(type.operands[0]));
+        case SPIRV_OP_TYPE_ARRAY:
+        {
+            const uint32_t length = GetConstantValue(type.operands[1]);
+            return length * (type.arrayStride != 0 ? type.arrayStride : GetTypeSize(type.operands[0], matrixStride));
+        }
+        case SPIRV_OP_TYPE_RUNTIME_ARRAY:
+            // Doesn't take any space in the fixed part of the block
+            return 0;
+        case SPIRV_OP_TYPE_STRUCT:
+        {
+            // The struct ends after its last member
+            uint32_t size = 0;
+            for (size_t member = 0; member < type.operands.size(); member++)
+            {
+                const uint32_t offset = member < type.memberOffsets.size() ? type.memberOffsets[member] : 0;
+                const uint32_t memberMatrixStride = member < type.memberMatrixStrides.size() ? type.memberMatrixStrides[member] : 0;
+                size = std::max(size, offset + GetTypeSize(type.operands[member], memberMatrixStride));
+            }
+            return size;
+        }
+        default:
+            throw std::runtime_error("Unable to compute the size of a type of the shader.");
+        }
+    }
+
+    vk::DescriptorType SpirvReflector::GetDescriptorType(uint32_t typeId, uint32_t storageClass) const
+    {
+        const auto &type = _ids[typeId];
+        switch (type.opcode)
+        {
+        case SPIRV_OP_TYPE_STRUCT:
+            // Old GLSL versions declare storage buffers with the Uniform storage class and the BufferBlock decoration
+            if (storageClass == SPIRV_STORAGE_CLASS_STORAGE_BUFFER || type.isBufferBlock)
+            {
+                return vk::DescriptorType::eStorageBuffer;
+            }
+            return vk::DescriptorType::eUniformBuffer;
+        case SPIRV_OP_TYPE_SAMPLED_IMAGE:
+            return vk::DescriptorType::eCombinedImageSampler;
+        case SPIRV_OP_TYPE_SAMPLER:
+            return vk::DescriptorType::eSampler;
+        case SPIRV_OP_TYPE_IMAGE:
+        {
+            // Operands: sampled type, dim, depth, arrayed, multisampled, sampled (1 = with sampler, 2 = storage)
+            const uint32_t dim = type.operands[1];
+            const uint32_t sampled = type.operands[5];
+            if (dim == SPIRV_DIM_SUBPASS_DATA)
+            {
+                return vk::DescriptorType::eInputAttachment;
+            }
+            if (dim == SPIRV_DIM_BUFFER)
+            {
+                return sampled == 2 ? vk::DescriptorType::eStorageTexelBuffer : vk::DescriptorType::eUniformTexelBuffer;
+            }
+            return sampled == 2 ? vk::DescriptorType::eStorageImage : vk::DescriptorType::eSampledImage;
+        }
+        default:
+            throw std::runtime_error("The shader uses a type of descriptor that is not supported.");
+        }
+    }
+
+    vk::Format SpirvReflector::GetVertexFormat(uint32_t typeId) const
+    {
+        const auto &type = _ids[typeId];
+        uint32_t componentCount = 1;
+        const IdInfo *component = &type;
+        if (type.opcode == SPIRV_OP_TYPE_VECTOR)
+        {
+            componentCount = type.operands[1];
+            component = &_ids[type.operands[0]];
+        }
+
+        if (component->operands.empty() || component->operands[0] != 32)
+        {
+            throw std::runtime_error("Vertex inputs must use 32-bit components.");
+        }
+
+        static constexpr vk::Format floatFormats[] = {vk::Format::eR32Sfloat, vk::Format::eR32G32Sfloat, vk::Format::eR32G32B32Sfloat, vk::Format::eR32G32B32A32Sfloat};
+        static constexpr vk::Format intFormats[] = {vk::Format::eR32Sint, vk::Format::eR32G32Sint, vk::Format::eR32G32B32Sint, vk::Format::eR32G32B32A32Sint};
+        static constexpr vk::Format uintFormats[] = {vk::Format::eR32Uint, vk::Format::eR32G32Uint, vk::Format::eR32G32B32Uint, vk::Format::eR32G32B32A32Uint};
+
+        if (component->opcode == SPIRV_OP_TYPE_FLOAT)
+        {
+            return floatFormats[componentCount - 1];
+        }
+        if (component->opcode == SPIRV_OP_TYPE_INT)
+        {
+            // Second operand of OpTypeInt is the signedness
+            return component->operands[1] != 0 ? intFormats[componentCount - 1] : uintFormats[componentCount - 1];
+        }
+        throw std::runtime_error("The type of a vertex input is not supported.");
+    }
+
+    void SpirvReflector::ReflectDescriptor(const IdInfo &variable, uint32_t storageClass, vk::ShaderStageFlagBits stage, structs::ShaderReflection &reflection) const
+    {
+        // The variable is a pointer to the resource, or to an array of resources
+        uint32_t typeId = _ids[variable.typeId].operands[1];
+        uint32_t count = 1;
+        while (_ids[typeId].opcode == SPIRV_OP_TYPE_ARRAY || _ids[typeId].opcode == SPIRV_OP_TYPE_RUNTIME_ARRAY)
+        {
+            if (_ids[typeId].opcode == SPIRV_OP_TYPE_RUNTIME_ARRAY)
+            {
+                throw std::runtime_error("Unbounded descriptor arrays are not supported.");
+            }
+            count *= GetConstantValue(_ids[typeId].operands[1]);
+            typeId = _ids[typeId].operands[0];
+        }
+
+        if (reflection.setLayouts.size() <= variable.set)
+        {
+            reflection.setLayouts.resize(variable.set + 1);
+        }
+        reflection.setLayouts[variable.set].bindings.push_back(vk::DescriptorSetLayoutBinding{
+            .binding = variable.binding,
+            .descriptorType = GetDescriptorType(typeId, storageClass),
+            .descriptorCount = count,
+            .stageFlags = stage,
+        });
+    }
+
+    void SpirvReflector::ReflectPushConstants(const IdInfo &variable, vk::ShaderStageFlagBits stage, structs::ShaderReflection &reflection) const
+    {
+        const uint32_t blockId = _ids[variable.typeId].operands[1];
+        const auto &block = _ids[blockId];
+
+        // The range starts at the first member, since several stages may use different parts of the block
+        uint32_t offset = block.memberOffsets.empty() ? 0 : *std::min_element(block.memberOffsets.begin(), block.memberOffsets.end());
+        reflection.pushConstantRanges.push_back(vk::PushConstantRange{
+            .stageFlags = stage,
+            .offset = offset,
+            .size = GetTypeSize(blockId) - offset,
+        });
+    }
+
+    void SpirvReflector::ReflectVertexInputs(structs::ShaderReflection &reflection) const
+    {
+        // Find the inputs with a location. Built-ins such as gl_VertexIndex don't come from a buffer.
+        std::vector<std::pair<uint32_t, vk::Format>> inputs;
+        for (uint32_t variableId : _variables)
+        {
+            const auto &variable = _ids[variableId];
+            if (variable.operands[0] != SPIRV_STORAGE_CLASS_INPUT || variable.isBuiltIn || !variable.hasLocation)
+            {
+                continue;
+            }
+
+            // Matrices use one location per column
+            const auto &type = _ids[_ids[variable.typeId].operands[1]];
+            if (type.opcode == SPIRV_OP_TYPE_MATRIX)
+            {
+                for (uint32_t column = 0; column < type.operands[1]; column++)
+                {
+                    inputs.emplace_back(variable.location + column, GetVertexFormat(type.operands[0]));
+                }
+            }
+            else
+            {
+                inputs.emplace_back(variable.location, GetVertexFormat(_ids[variable.typeId].operands[1]));
+            }
+        }
+        if (inputs.empty())
+        {
+            return;
+        }
+
+        // Interleave them in the order of the locations. Inputs with high locations are read per instance, from another binding.
+        std::sort(inputs.begin(), inputs.end(), [](const auto &a, const auto &b)
+                  { return a.first < b.first; });
+        auto firstInstanceInput = std::find_if(inputs.begin(), inputs.end(), [](const auto &input)
+                                               { return input.first >= FIRST_INSTANCE_INPUT_LOCATION; });
+        if (firstInstanceInput != inputs.begin())
+        {
+            reflection.vertexInput.AddBinding(VERTEX_INPUT_BINDING, vk::VertexInputRate::eVertex, {inputs.begin(), firstInstanceInput});
+        }
+        if (firstInstanceInput != inputs.end())
+        {
+            reflection.vertexInput.AddBinding(INSTANCE_INPUT_BINDING, vk::VertexInputRate::eInstance, {firstInstanceInput, inputs.end()});
+        }
+    }
+
+    structs::ShaderReflection SpirvReflector::Reflect(vk::ShaderStageFlagBits stage, const uint32_t *code, size_t codeSize)
+    {
+        SpirvReflector reflector(code, codeSize);
+        structs::ShaderReflection reflection;
+
+        for (uint32_t variableId : reflector._variables)
+        {
+            const auto &variable = reflector._ids[variableId];
+            const uint32_t storageClass = variable.operands[0];
+            switch (storageClass)
+            {
+            case SPIRV_STORAGE_CLASS_UNIFORM_CONSTANT:
+            case SPIRV_STORAGE_CLASS_UNIFORM:
+            case SPIRV_STORAGE_CLASS_STORAGE_BUFFER:
+                reflector.ReflectDescriptor(variable, storageClass, stage, reflection);
+                break;
+            case SPIRV_STORAGE_CLASS_PUSH_CONSTANT:
+                reflector.ReflectPushConstants(variable, stage, reflection);
+                break;
+            default:
+                break;
+            }
+        }
+
+        if (stage == vk::ShaderStageFlagBits::eVertex)
+        {
+            reflector.ReflectVertexInputs(reflection);
+        }
+
+        return reflection;
+    }
+} // namespace railguard::rendering
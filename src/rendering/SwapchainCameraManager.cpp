@@ -1,19 +1,40 @@
 #include "../../include/rendering/SwapchainCameraManager.h"
+#include <stdexcept>
+
+#define SNAPSHOT_TAG core::structs::SnapshotTag("CAMS")
 
 namespace railguard::rendering
 {
+    namespace
+    {
+        // Columns of the camera manager in snapshots. The entities are in SNAPSHOT_ENTITIES_COLUMN.
+        enum SnapshotColumns : uint32_t
+        {
+            ENABLED_COLUMN = 1,
+            SWAPCHAIN_IDS_COLUMN = 2,
+            VIEWPORTS_COLUMN = 3,
+            VIEW_MATRICES_COLUMN = 4,
+            PROJECTION_MATRICES_COLUMN = 5,
+        };
+    } // namespace
 
-    SwapchainCameraManager::SwapchainCameraManager(const core::component_id_t defaultComponentCapacity) : ComponentManager(defaultComponentCapacity)
+    SwapchainCameraManager::SwapchainCameraManager(const core::component_id_t defaultComponentCapacity) : core::ComponentManager(defaultComponentCapacity)
     {
-        _enabledCameras.reserve(defaultComponentCapacity);
+        _enabledCameras.Reserve(defaultComponentCapacity);
         _swapchainIds.reserve(defaultComponentCapacity);
+        _viewports.reserve(defaultComponentCapacity);
+        _viewMatrices.reserve(defaultComponentCapacity);
+        _projectionMatrices.reserve(defaultComponentCapacity);
     }
 
     core::Match SwapchainCameraManager::CreateComponent(const core::Entity &entity, const init::SwapchainCameraInitInfo &initInfo)
     {
         // Create a new camera
-        _enabledCameras.push_back(initInfo.enabled);
+        _enabledCameras.PushBack(initInfo.enabled);
         _swapchainIds.push_back(initInfo.swapchainId);
+        _viewports.push_back(initInfo.viewport);
+        _viewMatrices.push_back(initInfo.view);
+        _projectionMatrices.push_back(initInfo.projection);
 
         // Run boilerplate for entity management
         return this->RegisterComponent(entity);
@@ -25,20 +46,25 @@ namespace railguard::rendering
         core::ComponentManager::DestroyComponent(index);
 
         // Move the last item of vectors to the destroyed index if it is not the last
-        core::component_id_t lastIndex = _enabledCameras.size() - 1;
+        core::component_id_t lastIndex = _swapchainIds.size() - 1;
         if (index < lastIndex)
         {
-            _enabledCameras[index] = _enabledCameras[lastIndex];
             _swapchainIds[index] = _swapchainIds[lastIndex];
+            _viewports[index] = _viewports[lastIndex];
+            _viewMatrices[index] = _viewMatrices[lastIndex];
+            _projectionMatrices[index] = _projectionMatrices[lastIndex];
         }
         // Remove the last element
-        _enabledCameras.pop_back();
+        _enabledCameras.RemoveSwap(index);
         _swapchainIds.pop_back();
+        _viewports.pop_back();
+        _viewMatrices.pop_back();
+        _projectionMatrices.pop_back();
     }
 
     bool SwapchainCameraManager::GetEnabled(const core::Match &match) const
     {
-        return _enabledCameras[match.GetIndex()];
+        return _enabledCameras.Get(match.GetIndex());
     }
 
     swapchain_id_t SwapchainCameraManager::GetSwapchainId(const core::Match &match) const
@@ -46,16 +72,94 @@ namespace railguard::rendering
         return _swapchainIds[match.GetIndex()];
     }
 
-    void SwapchainCameraManager::Draw() {
-        // For each enabled camera
-        for (size_t i = 0; i < _enabledCameras.size(); i++) {
-            if (_enabledCameras[i] == true) {
+    glm::vec4 SwapchainCameraManager::GetViewport(const core::Match &match) const
+    {
+        return _viewports[match.GetIndex()];
+    }
+
+    const glm::mat4 &SwapchainCameraManager::GetView(const core::Match &match) const
+    {
+        return _viewMatrices[match.GetIndex()];
+    }
+
+    const glm::mat4 &SwapchainCameraManager::GetProjection(const core::Match &match) const
+    {
+        return _projectionMatrices[match.GetIndex()];
+    }
 
-                // Render the appropriate image
-                
+    void SwapchainCameraManager::SetEnabled(const core::Match &match, bool enabled)
+    {
+        _enabledCameras.Set(match.GetIndex(), enabled);
+        MarkChanged(match.GetIndex());
+    }
 
+    void SwapchainCameraManager::SetViewport(const core::Match &match, const glm::vec4 &viewport)
+    {
+        _viewports[match.GetIndex()] = viewport;
+        MarkChanged(match.GetIndex());
+    }
 
-            }
+    void SwapchainCameraManager::SetView(const core::Match &match, const glm::mat4 &view)
+    {
+        _viewMatrices[match.GetIndex()] = view;
+        MarkChanged(match.GetIndex());
+    }
+
+    void SwapchainCameraManager::SetProjection(const core::Match &match, const glm::mat4 &projection)
+    {
+        _projectionMatrices[match.GetIndex()] = projection;
+        MarkChanged(match.GetIndex());
+    }
+
+    void SwapchainCameraManager::Draw(BufferManager &bufferManager, std::vector<structs::CameraView> &views) const
+    {
+        // For each enabled camera, skipping the disabled ones a word at a time
+        _enabledCameras.ForEachSet([&](core::component_id_t i)
+                                   {
+                                       // Give its matrices to the shaders
+                                       const glm::mat4 viewProjection = _projectionMatrices[i] * _viewMatrices[i];
+                                       const glm::vec3 position = glm::inverse(_viewMatrices[i])[3];
+                                       const auto uniforms = bufferManager.PushFrameData(structs::CameraData{
+                                           .view = _viewMatrices[i],
+                                           .projection = _projectionMatrices[i],
+                                           .viewProjection = viewProjection,
+                                           .position = glm::vec4(position, 1.0f),
+                                       });
+
+                                       // Render the appropriate image
+                                       views.push_back(structs::CameraView{
+                                           .swapchainId = _swapchainIds[i],
+                                           .viewport = _viewports[i],
+                                           .uniformOffset = static_cast<uint32_t>(uniforms.offset),
+                                           .viewProjection = viewProjection,
+                                           .position = position,
+                                       });
+                                   });
+    }
+
+    void SwapchainCameraManager::SaveSnapshot(core::SnapshotWriter &writer) const
+    {
+        SaveEntities(writer, SNAPSHOT_TAG);
+        writer.AddColumn(SNAPSHOT_TAG, ENABLED_COLUMN, _enabledCameras.GetWords());
+        writer.AddColumn(SNAPSHOT_TAG, SWAPCHAIN_IDS_COLUMN, _swapchainIds);
+        writer.AddColumn(SNAPSHOT_TAG, VIEWPORTS_COLUMN, _viewports);
+        writer.AddColumn(SNAPSHOT_TAG, VIEW_MATRICES_COLUMN, _viewMatrices);
+        writer.AddColumn(SNAPSHOT_TAG, PROJECTION_MATRICES_COLUMN, _projectionMatrices);
+    }
+
+    void SwapchainCameraManager::LoadSnapshot(const core::Snapshot &snapshot)
+    {
+        LoadEntities(snapshot, SNAPSHOT_TAG);
+        _enabledCameras.Assign(snapshot.GetColumn<uint64_t>(SNAPSHOT_TAG, ENABLED_COLUMN), GetComponentCount());
+        snapshot.ReadColumn(SNAPSHOT_TAG, SWAPCHAIN_IDS_COLUMN, _swapchainIds);
+        snapshot.ReadColumn(SNAPSHOT_TAG, VIEWPORTS_COLUMN, _viewports);
+        snapshot.ReadColumn(SNAPSHOT_TAG, VIEW_MATRICES_COLUMN, _viewMatrices);
+        snapshot.ReadColumn(SNAPSHOT_TAG, PROJECTION_MATRICES_COLUMN, _projectionMatrices);
+
+        const auto count = GetComponentCount();
+        if (_swapchainIds.size() != count || _viewports.size() != count || _viewMatrices.size() != count || _projectionMatrices.size() != count)
+        {
+            throw std::runtime_error("The cameras of the snapshot are corrupted.");
         }
     }
-}
\ No newline at end of file
+}
@@ -19,24 +19,15 @@ namespace railguard::rendering
         // Init vectors that weren't initialized by parent
         _swapchains.reserve(defaultCapacity);
         _swapchainImageFormats.reserve(defaultCapacity);
+        _swapchainExtents.reserve(defaultCapacity);
         _swapchainsImages.reserve(defaultCapacity);
         _swapchainsImageViews.reserve(defaultCapacity);
-        _frameBuffers.reserve(defaultCapacity);
     }
 
     void SwapchainManager::Clear()
     {
         super::Clear();
 
-        // Destroy the framebuffers
-        for (auto framebufferVector : _frameBuffers)
-        {
-            for (auto framebuffer : framebufferVector)
-            {
-                _storage.vulkanDevice.destroyFramebuffer(framebuffer);
-            }
-        }
-
         // Destroy image views
         for (auto imageViewVector : _swapchainsImageViews)
         {
@@ -56,11 +47,12 @@ namespace railguard::rendering
         // Clear everything
         _swapchains.clear();
         _swapchainImageFormats.clear();
+        _swapchainExtents.clear();
         _swapchainsImageViews.clear();
         _swapchainsImages.clear();
     }
 
-    core::CompleteMatch<swapchain_id_t> SwapchainManager::CreateWindowSwapchain(const vk::SurfaceKHR &surface, const core::WindowManager &windowManager, const vk::RenderPass &renderPass)
+    core::CompleteMatch<swapchain_id_t> SwapchainManager::CreateWindowSwapchain(const vk::SurfaceKHR &surface, const core::WindowManager &windowManager)
     {
         auto match = super::CreateItem();
 
@@ -69,7 +61,6 @@ namespace railguard::rendering
         vk::Format newSwapchainImageFormat;
         std::vector<vk::Image> newSwapchainImages;
         std::vector<vk::ImageView> newSwapchainImageViews;
-        std::vector<vk::Framebuffer> newSwapchainFramebuffers;
 
         // Create the swapchain
         init::SwapchainInitInfo swapchainInitInfo{
@@ -77,21 +68,19 @@ namespace railguard::rendering
             .physicalDevice = _storage.vulkanPhysicalDevice,
             .surface = surface,
             .windowManager = windowManager,
-            .renderPass = renderPass,
             .swapchain = &newSwapchain,
             .swapchainImages = &newSwapchainImages,
             .swapchainImageFormat = &newSwapchainImageFormat,
             .swapchainImageViews = &newSwapchainImageViews,
-            .swapchainFramebuffers = &newSwapchainFramebuffers,
         };
         init::VulkanInit::InitWindowSwapchain(swapchainInitInfo);
 
         // Push the new swapchain to vectors
         _swapchains.push_back(newSwapchain);
         _swapchainImageFormats.push_back(newSwapchainImageFormat);
+        _swapchainExtents.push_back(windowManager.GetWindowExtent());
         _swapchainsImages.push_back(newSwapchainImages);
         _swapchainsImageViews.push_back(newSwapchainImageViews);
-        _frameBuffers.push_back(newSwapchainFramebuffers);
 
         return match;
     }
@@ -104,12 +93,6 @@ namespace railguard::rendering
         auto index = match.GetIndex();
         size_t lastIndex = _ids.size() - 1;
 
-        // Destroy the framebuffers
-        for (auto framebuffer : _frameBuffers[index])
-        {
-            _storage.vulkanDevice.destroyFramebuffer(framebuffer);
-        }
-
         // Destroy the image views
         for (auto imageView : _swapchainsImageViews[index])
         {
@@ -124,32 +107,26 @@ namespace railguard::rendering
         {
             _swapchains[index] = _swapchains[lastIndex];
             _swapchainImageFormats[index] = _swapchainImageFormats[lastIndex];
+            _swapchainExtents[index] = _swapchainExtents[lastIndex];
             _swapchainsImages[index] = _swapchainsImages[lastIndex];
             _swapchainsImageViews[index] = _swapchainsImageViews[lastIndex];
-            _frameBuffers[index] = _frameBuffers[lastIndex];
         }
 
         // Remove last elements
         _swapchains.pop_back();
         _swapchainImageFormats.pop_back();
+        _swapchainExtents.pop_back();
         _swapchainsImages.pop_back();
         _swapchainsImageViews.pop_back();
-        _frameBuffers.pop_back();
     }
 
-    void SwapchainManager::RecreateWindowSwapchain(const core::Match &match, const vk::SurfaceKHR &surface, const core::WindowManager &windowManager, const vk::RenderPass &renderPass)
+    void SwapchainManager::RecreateWindowSwapchain(const core::Match &match, const vk::SurfaceKHR &surface, const core::WindowManager &windowManager)
     {
         ADVANCED_CHECK(_initialized, NOT_INITIALIZED_ERROR);
 
         // Get index
         auto index = match.GetIndex();
 
-        // Destroy the framebuffers
-        for (auto framebuffer : _frameBuffers[index])
-        {
-            _storage.vulkanDevice.destroyFramebuffer(framebuffer);
-        }
-
         // Destroy image views
 
         for (auto imageView : _swapchainsImageViews[index])
@@ -166,14 +143,13 @@ namespace railguard::rendering
             .physicalDevice = _storage.vulkanPhysicalDevice,
             .surface = surface,
             .windowManager = windowManager,
-            .renderPass = renderPass,
             .swapchain = &_swapchains[index],
             .swapchainImages = &_swapchainsImages[index],
             .swapchainImageFormat = &_swapchainImageFormats[index],
             .swapchainImageViews = &_swapchainsImageViews[index],
-            .swapchainFramebuffers = &_frameBuffers[index],
         };
         init::VulkanInit::InitWindowSwapchain(swapchainInitInfo);
+        _swapchainExtents[index] = windowManager.GetWindowExtent();
     }
 
     uint32_t SwapchainManager::RequestNextImageIndex(const core::Match &match, const vk::Semaphore &presentSemaphore)
@@ -206,31 +182,50 @@ namespace railguard::rendering
 
     void SwapchainManager::PresentImage(const core::Match &match, uint32_t imageIndex, const vk::Semaphore &renderSemaphore, const vk::Queue &graphicsQueue)
     {
-        // Get index
-        auto index = match.GetIndex();
+        PresentImages(std::span(&match, 1), std::span(&imageIndex, 1), renderSemaphore, graphicsQueue);
+    }
 
-        // Present the image on the screen
+    void SwapchainManager::PresentImages(std::span<const core::Match> matches, std::span<const uint32_t> imageIndices, const vk::Semaphore &renderSemaphore, const vk::Queue &graphicsQueue)
+    {
+        // Get the swapchains. The vectors are kept between calls, so that presenting doesn't allocate.
+        auto &swapchains = _presentedSwapchains;
+        auto &results = _presentResults;
+        swapchains.clear();
+        for (const auto &match : matches)
+        {
+            swapchains.push_back(_swapchains[match.GetIndex()]);
+        }
+        results.assign(swapchains.size(), vk::Result::eSuccess);
+
+        // Present the images on the screens
         vk::PresentInfoKHR presentInfo{
             // Wait until the rendering is complete
             .waitSemaphoreCount = 1,
             .pWaitSemaphores = &renderSemaphore,
-            // Specify the swapchain to present
-            .swapchainCount = 1,
-            .pSwapchains = &_swapchains[index],
-            // Specify the index of the image
-            .pImageIndices = &imageIndex,
+            // Specify the swapchains to present
+            .swapchainCount = static_cast<uint32_t>(swapchains.size()),
+            .pSwapchains = swapchains.data(),
+            // Specify the index of the image of each swapchain
+            .pImageIndices = imageIndices.data(),
+            // Result of each swapchain
+            .pResults = results.data(),
         };
         auto result = graphicsQueue.presentKHR(presentInfo);
-        switch (result)
+        // The global result is the worst one, but check each of them in case a swapchain was suboptimal and another one failed
+        results.push_back(result);
+        for (auto swapchainResult : results)
         {
-        case vk::Result::eSuccess:
-        case vk::Result::eSuboptimalKHR:
-            // Success
-            break;
-
-        default:
-            // Error
-            throw std::runtime_error("Failed to present image.");
+            switch (swapchainResult)
+            {
+            case vk::Result::eSuccess:
+            case vk::Result::eSuboptimalKHR:
+                // Success
+                break;
+
+            default:
+                // Error
+                throw std::runtime_error("Failed to present image.");
+            }
         }
     }
 
@@ -244,18 +239,18 @@ namespace railguard::rendering
         return _swapchainImageFormats[match.GetIndex()];
     }
 
-    std::vector<vk::Image> SwapchainManager::GetSwapchainImages(const core::Match &match) const
+    vk::Extent2D SwapchainManager::GetSwapchainExtent(const core::Match &match) const
     {
-        return _swapchainsImages[match.GetIndex()];
+        return _swapchainExtents[match.GetIndex()];
     }
 
-    std::vector<vk::ImageView> SwapchainManager::GetSwapchainImageViews(const core::Match &match) const
+    std::span<const vk::Image> SwapchainManager::GetSwapchainImages(const core::Match &match) const
     {
-        return _swapchainsImageViews[match.GetIndex()];
+        return _swapchainsImages[match.GetIndex()];
     }
 
-    std::vector<vk::Framebuffer> SwapchainManager::GetFramebuffers(const core::Match &match) const
+    std::span<const vk::ImageView> SwapchainManager::GetSwapchainImageViews(const core::Match &match) const
     {
-        return _frameBuffers[match.GetIndex()];
+        return _swapchainsImageViews[match.GetIndex()];
     }
 }
\ No newline at end of file
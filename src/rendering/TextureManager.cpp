@@ -0,0 +1,460 @@
+#include "../../include/rendering/TextureManager.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace railguard::rendering
+{
+    void TextureManager::Init(TextureManagerStorage storage, size_t defaultCapacity)
+    {
+        super::Init(storage, defaultCapacity);
+
+        _files.reserve(defaultCapacity);
+        _levelIndices.reserve(defaultCapacity);
+        _formats.reserve(defaultCapacity);
+        _extents.reserve(defaultCapacity);
+        _levelCounts.reserve(defaultCapacity);
+        _finestLoadableLevels.reserve(defaultCapacity);
+        _residentBaseLevels.reserve(defaultCapacity);
+        _currentImages.reserve(defaultCapacity);
+        _pendingImages.reserve(defaultCapacity);
+        _requestedLevels.reserve(defaultCapacity);
+        _lastUsedFrames.reserve(defaultCapacity);
+
+        _lastStatistics.budget = TEXTURE_STREAMING_BUDGET;
+    }
+
+    void TextureManager::Clear()
+    {
+        for (const auto &retired : _retiredImages)
+        {
+            DestroyResidentImage(retired.image);
+        }
+        for (size_t i = 0; i < _ids.size(); i++)
+        {
+            DestroyResidentImage(_currentImages[i]);
+            DestroyResidentImage(_pendingImages[i]);
+        }
+
+        _retiredImages.clear();
+        _files.clear();
+        _levelIndices.clear();
+        _formats.clear();
+        _extents.clear();
+        _levelCounts.clear();
+        _finestLoadableLevels.clear();
+        _residentBaseLevels.clear();
+        _currentImages.clear();
+        _pendingImages.clear();
+        _requestedLevels.clear();
+        _lastUsedFrames.clear();
+        _residentSize = 0;
+        _releasingSize = 0;
+
+        super::Clear();
+    }
+
+    // ===== LOADING =====
+
+    core::CompleteMatch<texture_id_t> TextureManager::LoadTexture(const std::string &filePath)
+    {
+        utils::MappedFile file(filePath);
+        const auto *data = static_cast<const uint8_t *>(file.GetData());
+
+        // Check that the file is a KTX2 texture that can be uploaded as is
+        const auto *header = reinterpret_cast<const structs::Ktx2Header *>(data);
+        if (file.GetSize() < sizeof(structs::Ktx2Header) || std::memcmp(header->identifier, structs::KTX2_IDENTIFIER, KTX2_IDENTIFIER_SIZE) != 0)
+        {
+            throw std::runtime_error("\"" + filePath + "\" is not a KTX2 file.");
+        }
+        if (header->supercompressionScheme != KTX2_SUPERCOMPRESSION_NONE || header->pixelDepth > 1 || header->layerCount > 1 || header->faceCount != 1)
+        {
+            throw std::runtime_error("The texture \"" + filePath + "\" must be a 2D texture without supercompression.");
+        }
+        if (header->vkFormat < VK_FORMAT_BC1_RGB_UNORM_BLOCK || header->vkFormat > VK_FORMAT_BC7_SRGB_BLOCK)
+        {
+            throw std::runtime_error("The texture \"" + filePath + "\" must use a block compressed format (BC1 to BC7).");
+        }
+
+        const uint32_t levelCount = std::max(header->levelCount, 1u);
+        const auto *levelIndex = reinterpret_cast<const structs::Ktx2LevelIndex *>(data + sizeof(structs::Ktx2Header));
+        if (sizeof(structs::Ktx2Header) + levelCount * sizeof(structs::Ktx2LevelIndex) > file.GetSize())
+        {
+            throw std::runtime_error("The texture \"" + filePath + "\" is truncated.");
+        }
+        for (uint32_t level = 0; level < levelCount; level++)
+        {
+            if (levelIndex[level].byteOffset + levelIndex[level].byteLength > file.GetSize())
+            {
+                throw std::runtime_error("The texture \"" + filePath + "\" is truncated.");
+            }
+        }
+
+        // Levels get smaller, so the loadable ones are at the end
+        uint32_t finestLoadableLevel = 0;
+        while (finestLoadableLevel < levelCount - 1 && levelIndex[finestLoadableLevel].byteLength > STAGING_BUFFER_SIZE)
+        {
+            finestLoadableLevel++;
+        }
+        // Find the coarse levels, which are always resident
+        uint32_t residentBaseLevel = finestLoadableLevel;
+        while (residentBaseLevel < levelCount - 1 &&
+               std::max(header->pixelWidth >> residentBaseLevel, header->pixelHeight >> residentBaseLevel) > TEXTURE_RESIDENT_MIP_SIZE)
+        {
+            residentBaseLevel++;
+        }
+
+        _levelIndices.push_back(levelIndex);
+        _files.push_back(std::move(file));
+        _formats.push_back(static_cast<vk::Format>(header->vkFormat));
+        _extents.push_back(vk::Extent2D{
+            .width = header->pixelWidth,
+            .height = header->pixelHeight,
+        });
+        _levelCounts.push_back(levelCount);
+        _finestLoadableLevels.push_back(finestLoadableLevel);
+        _residentBaseLevels.push_back(residentBaseLevel);
+        _currentImages.emplace_back();
+        _pendingImages.emplace_back();
+        _requestedLevels.push_back(UINT32_MAX);
+        _lastUsedFrames.push_back(0);
+
+        // Upload the coarse levels right away
+        StreamLevels(_ids.size(), residentBaseLevel);
+
+        return super::CreateItem();
+    }
+
+    void TextureManager::DestroyTexture(const core::Match &match, uint64_t frameNumber)
+    {
+        const auto index = match.GetIndex();
+
+        // The images may still be used by a frame or an upload. They are counted until they are destroyed.
+        // If there is a pending image, the current one is already counted as releasing.
+        _releasingSize += _pendingImages[index].image ? _pendingImages[index].size : _currentImages[index].size;
+        Retire(_currentImages[index], frameNumber);
+        Retire(_pendingImages[index], frameNumber);
+
+        // Run boilerplate deletion
+        super::DestroyItem(match);
+
+        // Move the last item of vectors to the destroyed index if it is not the last
+        size_t lastIndex = _ids.size();
+        if (index < lastIndex)
+        {
+            _files[index] = std::move(_files[lastIndex]);
+            _levelIndices[index] = _levelIndices[lastIndex];
+            _formats[index] = _formats[lastIndex];
+            _extents[index] = _extents[lastIndex];
+            _levelCounts[index] = _levelCounts[lastIndex];
+            _finestLoadableLevels[index] = _finestLoadableLevels[lastIndex];
+            _residentBaseLevels[index] = _residentBaseLevels[lastIndex];
+            _currentImages[index] = _currentImages[lastIndex];
+            _pendingImages[index] = _pendingImages[lastIndex];
+            _requestedLevels[index] = _requestedLevels[lastIndex];
+            _lastUsedFrames[index] = _lastUsedFrames[lastIndex];
+        }
+        // Remove the last element
+        _files.pop_back();
+        _levelIndices.pop_back();
+        _formats.pop_back();
+        _extents.pop_back();
+        _levelCounts.pop_back();
+        _finestLoadableLevels.pop_back();
+        _residentBaseLevels.pop_back();
+        _currentImages.pop_back();
+        _pendingImages.pop_back();
+        _requestedLevels.pop_back();
+        _lastUsedFrames.pop_back();
+    }
+
+    // ===== IMAGES =====
+
+    vk::DeviceSize TextureManager::GetLevelsSize(size_t index, uint32_t baseLevel) const
+    {
+        vk::DeviceSize size = 0;
+        for (uint32_t level = baseLevel; level < _levelCounts[index]; level++)
+        {
+            size += _levelIndices[index][level].byteLength;
+        }
+        return size;
+    }
+
+    TextureManager::ResidentImage TextureManager::CreateResidentImage(size_t index, uint32_t baseLevel)
+    {
+        const auto &extent = _extents[index];
+        const uint32_t levelCount = _levelCounts[index] - baseLevel;
+
+        VkImageCreateInfo imageCreateInfo = vk::ImageCreateInfo{
+            .imageType = vk::ImageType::e2D,
+            .format = _formats[index],
+            .extent = vk::Extent3D{
+                .width = std::max(extent.width >> baseLevel, 1u),
+                .height = std::max(extent.height >> baseLevel, 1u),
+                .depth = 1,
+            },
+            .mipLevels = levelCount,
+            .arrayLayers = 1,
+            .samples = vk::SampleCountFlagBits::e1,
+            .tiling = vk::ImageTiling::eOptimal,
+            .usage = vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst,
+            .sharingMode = vk::SharingMode::eExclusive,
+            .initialLayout = vk::ImageLayout::eUndefined,
+        };
+        VmaAllocationCreateInfo allocationCreateInfo{
+            .usage = VMA_MEMORY_USAGE_GPU_ONLY,
+        };
+        VkImage image;
+        ResidentImage result{
+            .baseLevel = baseLevel,
+        };
+        VmaAllocationInfo allocationInfo;
+        if (vmaCreateImage(_storage.allocator, &imageCreateInfo, &allocationCreateInfo, &image, &result.allocation, &allocationInfo) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to create a texture image.");
+        }
+        result.image = image;
+        result.size = allocationInfo.size;
+
+        vk::ImageViewCreateInfo imageViewCreateInfo{
+            .image = result.image,
+            .viewType = vk::ImageViewType::e2D,
+            .format = _formats[index],
+            .subresourceRange{
+                .aspectMask = vk::ImageAspectFlagBits::eColor,
+                .baseMipLevel = 0,
+                .levelCount = levelCount,
+                .baseArrayLayer = 0,
+                .layerCount = 1,
+            },
+        };
+        result.view = _storage.vulkanDevice.createImageView(imageViewCreateInfo);
+
+        // Copy every level straight from the mapped file
+        const auto *data = static_cast<const uint8_t *>(_files[index].GetData());
+        for (uint32_t level = baseLevel; level < _levelCounts[index]; level++)
+        {
+            const auto &levelIndex = _levelIndices[index][level];
+            result.ticket = _storage.uploadManager->UploadToImage(data + levelIndex.byteOffset, levelIndex.byteLength, result.image,
+                                                                  vk::Extent3D{
+                                                                      .width = std::max(extent.width >> level, 1u),
+                                                                      .height = std::max(extent.height >> level, 1u),
+                                                                      .depth = 1,
+                                                                  },
+                                                                  vk::ImageAspectFlagBits::eColor, level - baseLevel, vk::ImageLayout::eShaderReadOnlyOptimal);
+        }
+        return result;
+    }
+
+    void TextureManager::DestroyResidentImage(const ResidentImage &image) const
+    {
+        if (image.image)
+        {
+            _storage.vulkanDevice.destroyImageView(image.view);
+            vmaDestroyImage(_storage.allocator, static_cast<VkImage>(image.image), image.allocation);
+        }
+    }
+
+    void TextureManager::Retire(ResidentImage &image, uint64_t frameNumber)
+    {
+        if (image.image)
+        {
+            _retiredImages.push_back(RetiredImage{
+                .frame = frameNumber,
+                .image = image,
+            });
+            image = ResidentImage{};
+        }
+    }
+
+    void TextureManager::StreamLevels(size_t index, uint32_t baseLevel)
+    {
+        auto &pending = _pendingImages[index];
+        assert(!pending.image && "The previous levels of the texture are still being uploaded.");
+
+        pending = CreateResidentImage(index, baseLevel);
+        // The current image stays alive until the new one is ready and the frames using it are finished
+        _residentSize += pending.size;
+        if (_currentImages[index].image)
+        {
+            _releasingSize += _currentImages[index].size;
+        }
+        _lastStatistics.streamedLevelCount += _levelCounts[index] - baseLevel;
+    }
+
+    // ===== STREAMING =====
+
+    void TextureManager::RequestResolution(const core::Match &match, float screenSize)
+    {
+        const auto index = match.GetIndex();
+        const auto &extent = _extents[index];
+
+        // Each level halves the resolution: use the first one that is not bigger than the screen size
+        const float largestSide = static_cast<float>(std::max(extent.width, extent.height));
+        const float ratio = largestSide / std::max(screenSize, 1.0f);
+        const auto level = ratio <= 1.0f ? 0u : static_cast<uint32_t>(std::floor(std::log2(ratio)));
+
+        _requestedLevels[index] = std::min(_requestedLevels[index], level);
+    }
+
+    uint32_t TextureManager::GetTargetLevel(size_t index) const
+    {
+        // Unused textures keep their levels until they are evicted
+        if (_requestedLevels[index] == UINT32_MAX)
+        {
+            const auto &latest = _pendingImages[index].image ? _pendingImages[index] : _currentImages[index];
+            return latest.image ? latest.baseLevel : _residentBaseLevels[index];
+        }
+        return std::clamp(_requestedLevels[index], _finestLoadableLevels[index], _residentBaseLevels[index]);
+    }
+
+    bool TextureManager::EvictLeastRecentlyUsed(uint64_t frameNumber)
+    {
+        size_t evicted = SIZE_MAX;
+        for (size_t i = 0; i < _ids.size(); i++)
+        {
+            // Only textures that were not used during this frame, and whose finer levels are resident, can be evicted
+            const auto &current = _currentImages[i];
+            if (_lastUsedFrames[i] < frameNumber && !_pendingImages[i].image && current.image && current.baseLevel < _residentBaseLevels[i] &&
+                (evicted == SIZE_MAX || _lastUsedFrames[i] < _lastUsedFrames[evicted]))
+            {
+                evicted = i;
+            }
+        }
+
+        if (evicted == SIZE_MAX)
+        {
+            return false;
+        }
+        StreamLevels(evicted, _residentBaseLevels[evicted]);
+        _lastStatistics.evictionCount++;
+        return true;
+    }
+
+    void TextureManager::Update(uint64_t frameNumber, std::pmr::memory_resource *frameMemory)
+    {
+        _lastStatistics = structs::TextureStreamingStatistics{
+            .budget = TEXTURE_STREAMING_BUDGET,
+            .textureCount = static_cast<uint32_t>(_ids.size()),
+        };
+
+        // Destroy the images that can't be used by a frame or an upload anymore
+        std::erase_if(_retiredImages, [this, frameNumber](const RetiredImage &retired)
+                      {
+                          if (retired.frame + NB_OVERLAPPING_FRAMES <= frameNumber && _storage.uploadManager->IsUploadReady(retired.image.ticket))
+                          {
+                              DestroyResidentImage(retired.image);
+                              _residentSize -= retired.image.size;
+                              _releasingSize -= retired.image.size;
+                              return true;
+                          }
+                          return false;
+                      });
+
+        // Use the images that finished uploading
+        for (size_t i = 0; i < _ids.size(); i++)
+        {
+            auto &pending = _pendingImages[i];
+            if (pending.image && _storage.uploadManager->IsUploadReady(pending.ticket))
+            {
+                Retire(_currentImages[i], frameNumber);
+                _currentImages[i] = pending;
+                pending = ResidentImage{};
+            }
+        }
+
+        // Find the textures that need finer levels
+        std::pmr::vector<size_t> upgrades(frameMemory);
+        for (size_t i = 0; i < _ids.size(); i++)
+        {
+            const auto target = GetTargetLevel(i);
+            if (_requestedLevels[i] != UINT32_MAX)
+            {
+                _lastUsedFrames[i] = frameNumber;
+            }
+            _lastStatistics.requestedSize += GetLevelsSize(i, target);
+
+            const auto &current = _currentImages[i];
+            if (current.image && current.baseLevel <= target)
+            {
+                _lastStatistics.satisfiedTextureCount++;
+            }
+            else if (!_pendingImages[i].image)
+            {
+                upgrades.push_back(i);
+            }
+        }
+
+        // Serve the textures that miss the most levels first
+        std::sort(upgrades.begin(), upgrades.end(), [this](size_t a, size_t b)
+                  { return _currentImages[a].baseLevel - GetTargetLevel(a) > _currentImages[b].baseLevel - GetTargetLevel(b); });
+
+        vk::DeviceSize streamedSize = 0;
+        for (auto i : upgrades)
+        {
+            // Evicted during this loop
+            if (_pendingImages[i].image)
+            {
+                continue;
+            }
+            const auto currentLevel = _currentImages[i].baseLevel;
+            auto target = GetTargetLevel(i);
+            auto size = GetLevelsSize(i, target);
+
+            // Don't fill the staging ring in a single frame, but always allow at least one texture to progress
+            if (streamedSize > 0 && streamedSize + size > TEXTURE_STREAMING_BYTES_PER_FRAME)
+            {
+                break;
+            }
+
+            // Make room in the budget by evicting textures. Their memory is only released once the frames using them are finished,
+            // so the check counts the memory that will remain. The current image of this texture is kept until the new one is ready.
+            while (_residentSize - _releasingSize + size > TEXTURE_STREAMING_BUDGET && EvictLeastRecentlyUsed(frameNumber))
+            {
+            }
+            // Settle for coarser levels if it is not enough
+            while (target < currentLevel && _residentSize - _releasingSize + size > TEXTURE_STREAMING_BUDGET)
+            {
+                target++;
+                size = GetLevelsSize(i, target);
+            }
+            // Wait for the evicted images to be released rather than exceeding the budget
+            if (target >= currentLevel || _residentSize + size > TEXTURE_STREAMING_BUDGET)
+            {
+                continue;
+            }
+
+            StreamLevels(i, target);
+            streamedSize += size;
+        }
+
+        _lastStatistics.residentSize = _residentSize;
+
+        // Requests are only valid for one frame
+        std::fill(_requestedLevels.begin(), _requestedLevels.end(), UINT32_MAX);
+    }
+
+    // ===== GETTERS =====
+
+    bool TextureManager::IsTextureReady(const core::Match &match) const
+    {
+        return _currentImages[match.GetIndex()].image;
+    }
+
+    vk::ImageView TextureManager::GetImageView(const core::Match &match) const
+    {
+        return _currentImages[match.GetIndex()].view;
+    }
+
+    uint32_t TextureManager::GetResidentLevel(const core::Match &match) const
+    {
+        return _currentImages[match.GetIndex()].baseLevel;
+    }
+
+    const structs::TextureStreamingStatistics &TextureManager::GetLastStatistics() const
+    {
+        return _lastStatistics;
+    }
+} // namespace railguard::rendering
@@ -0,0 +1,424 @@
+#include "../../include/rendering/UploadManager.h"
+#include "../../include/utils/AdvancedCheck.h"
+#include <cstring>
+
+#ifdef USE_ADVANCED_CHECKS
+// Define local error messages
+#define INITIALIZED_TWICE_ERROR "UploadManager should not be initialized twice."
+#define NOT_INITIALIZED_ERROR "UploadManager should be initialized with Init before calling this method."
+#define NOT_CLEANED_ERROR "UploadManager should be cleaned up with Cleanup before it is destroyed."
+#endif
+
+// Texel blocks are at most 16 bytes, so this alignment works for both buffers and images
+#define STAGING_ALIGNMENT 16
+// Every way in which an uploaded resource can be read afterwards
+#define UPLOAD_DESTINATION_STAGES (vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexInput | vk::PipelineStageFlagBits::eVertexShader | vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eComputeShader)
+#define UPLOAD_DESTINATION_ACCESS (vk::AccessFlagBits::eIndirectCommandRead | vk::AccessFlagBits::eIndexRead | vk::AccessFlagBits::eVertexAttributeRead | vk::AccessFlagBits::eUniformRead | vk::AccessFlagBits::eShaderRead)
+
+namespace railguard::rendering
+{
+    void UploadManager::Init(const vk::Device &device, VmaAllocator allocator, vk::Queue transferQueue, uint32_t transferQueueFamily, uint32_t graphicsQueueFamily)
+    {
+        ADVANCED_CHECK(!_initialized, INITIALIZED_TWICE_ERROR);
+
+        _device = device;
+        _allocator = allocator;
+        _transferQueue = transferQueue;
+        _transferQueueFamily = transferQueueFamily;
+        _graphicsQueueFamily = graphicsQueueFamily;
+
+        // Create the staging ring. It stays mapped during its whole lifetime.
+        VkBufferCreateInfo bufferCreateInfo = vk::BufferCreateInfo{
+            .size = STAGING_BUFFER_SIZE,
+            .usage = vk::BufferUsageFlagBits::eTransferSrc,
+            .sharingMode = vk::SharingMode::eExclusive,
+        };
+        VmaAllocationCreateInfo allocationCreateInfo{
+            .flags = VMA_ALLOCATION_CREATE_MAPPED_BIT,
+            .usage = VMA_MEMORY_USAGE_CPU_ONLY,
+        };
+        VkBuffer buffer;
+        VmaAllocationInfo allocationInfo;
+        if (vmaCreateBuffer(_allocator, &bufferCreateInfo, &allocationCreateInfo, &buffer, &_stagingAllocation, &allocationInfo) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to create the staging buffer.");
+        }
+        _stagingBuffer = buffer;
+        _stagingMappedData = static_cast<uint8_t *>(allocationInfo.pMappedData);
+
+        // Create the command buffers of the batches
+        vk::CommandPoolCreateInfo commandPoolCreateInfo{
+            .flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer | vk::CommandPoolCreateFlagBits::eTransient,
+            .queueFamilyIndex = _transferQueueFamily,
+        };
+        _commandPool = _device.createCommandPool(commandPoolCreateInfo);
+
+        vk::CommandBufferAllocateInfo commandBufferAllocateInfo{
+            .commandPool = _commandPool,
+            .level = vk::CommandBufferLevel::ePrimary,
+            .commandBufferCount = NB_UPLOAD_BATCHES,
+        };
+        auto commandBuffers = _device.allocateCommandBuffers(commandBufferAllocateInfo);
+        for (uint32_t i = 0; i < NB_UPLOAD_BATCHES; i++)
+        {
+            _batches[i].commandBuffer = commandBuffers[i];
+            _batches[i].fence = _device.createFence(vk::FenceCreateInfo{});
+        }
+
+#ifdef USE_ADVANCED_CHECKS
+        _initialized = true;
+#endif
+    }
+
+    void UploadManager::Cleanup()
+    {
+        ADVANCED_CHECK(_initialized, NOT_INITIALIZED_ERROR);
+
+        for (auto &batch : _batches)
+        {
+            if (batch.submitted)
+            {
+                auto waitResult = _device.waitForFences(batch.fence, true, WAIT_FOR_FENCES_TIMEOUT);
+                if (waitResult != vk::Result::eSuccess)
+                {
+                    throw std::runtime_error("Error while waiting for fences");
+                }
+            }
+            _device.destroyFence(batch.fence);
+            batch = UploadBatch{};
+        }
+        _device.destroyCommandPool(_commandPool);
+        _commandPool = nullptr;
+        _readyAcquires.clear();
+
+        vmaDestroyBuffer(_allocator, static_cast<VkBuffer>(_stagingBuffer), _stagingAllocation);
+        _stagingBuffer = nullptr;
+        _stagingAllocation = nullptr;
+        _stagingMappedData = nullptr;
+        _stagingHead = 0;
+        _stagingUsed = 0;
+
+#ifdef USE_ADVANCED_CHECKS
+        // Back to the beginning
+        _initialized = false;
+#endif
+    }
+
+    UploadManager::~UploadManager()
+    {
+        ADVANCED_CHECK(!_initialized, NOT_CLEANED_ERROR);
+    }
+
+    // ===== BATCHES =====
+
+    bool UploadManager::IsOwnershipTransferNeeded() const
+    {
+        return _transferQueueFamily != _graphicsQueueFamily;
+    }
+
+    UploadManager::UploadBatch &UploadManager::GetRecordingBatch()
+    {
+        auto &batch = _batches[_currentBatch];
+        if (batch.recording)
+        {
+            return batch;
+        }
+
+        // The slot may still be used by an old submission
+        if (batch.submitted)
+        {
+            auto waitResult = _device.waitForFences(batch.fence, true, WAIT_FOR_FENCES_TIMEOUT);
+            if (waitResult != vk::Result::eSuccess)
+            {
+                throw std::runtime_error("Error while waiting for fences");
+            }
+            Retire(batch);
+        }
+
+        batch.commandBuffer.reset({});
+        batch.commandBuffer.begin(vk::CommandBufferBeginInfo{
+            .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit,
+        });
+        batch.recording = true;
+        batch.ticket = _nextTicket++;
+        return batch;
+    }
+
+    void UploadManager::Submit(std::pmr::memory_resource *memory)
+    {
+        auto &batch = _batches[_currentBatch];
+        if (!batch.recording)
+        {
+            return;
+        }
+
+        // Release the images so that the graphics queue can use them
+        std::pmr::vector<vk::ImageMemoryBarrier> imageBarriers(memory);
+        const uint32_t sourceFamily = IsOwnershipTransferNeeded() ? _transferQueueFamily : VK_QUEUE_FAMILY_IGNORED;
+        const uint32_t destinationFamily = IsOwnershipTransferNeeded() ? _graphicsQueueFamily : VK_QUEUE_FAMILY_IGNORED;
+        for (const auto &acquire : batch.acquires)
+        {
+            if (acquire.image)
+            {
+                imageBarriers.push_back(vk::ImageMemoryBarrier{
+                    .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+                    .dstAccessMask = {},
+                    .oldLayout = vk::ImageLayout::eTransferDstOptimal,
+                    .newLayout = acquire.finalLayout,
+                    .srcQueueFamilyIndex = sourceFamily,
+                    .dstQueueFamilyIndex = destinationFamily,
+                    .image = acquire.image,
+                    .subresourceRange = acquire.subresourceRange,
+                });
+            }
+            // Buffers of the BufferManager are shared between the queue families, so they don't need to be released
+        }
+        if (!imageBarriers.empty())
+        {
+            batch.commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eAllCommands, {}, nullptr, nullptr, imageBarriers);
+        }
+        batch.commandBuffer.end();
+
+        // The fence tells when the batch is finished, without blocking the frame
+        _device.resetFences(batch.fence);
+        vk::SubmitInfo submitInfo{
+            .commandBufferCount = 1,
+            .pCommandBuffers = &batch.commandBuffer,
+        };
+        _transferQueue.submit(submitInfo, batch.fence);
+
+        batch.recording = false;
+        batch.submitted = true;
+        _currentBatch = (_currentBatch + 1) % NB_UPLOAD_BATCHES;
+    }
+
+    void UploadManager::Retire(UploadBatch &batch)
+    {
+        // Batches are retired in submission order, so the staging ring is freed from its tail
+        _stagingUsed -= batch.stagingSize;
+        batch.stagingSize = 0;
+        _readyAcquires.insert(_readyAcquires.end(), batch.acquires.begin(), batch.acquires.end());
+        batch.acquires.clear();
+        batch.submitted = false;
+        _lastRetiredTicket = batch.ticket;
+    }
+
+    void UploadManager::WaitForOldestBatch()
+    {
+        // The oldest submitted batch is the first one after the current one
+        for (uint32_t i = 0; i < NB_UPLOAD_BATCHES; i++)
+        {
+            auto &batch = _batches[(_currentBatch + i) % NB_UPLOAD_BATCHES];
+            if (batch.submitted)
+            {
+                auto waitResult = _device.waitForFences(batch.fence, true, WAIT_FOR_FENCES_TIMEOUT);
+                if (waitResult != vk::Result::eSuccess)
+                {
+                    throw std::runtime_error("Error while waiting for fences");
+                }
+                Retire(batch);
+                return;
+            }
+        }
+
+        // Nothing is in flight: the current batch uses the whole ring, so submit it
+        Submit();
+    }
+
+    void UploadManager::RetireFinishedBatches()
+    {
+        for (uint32_t i = 0; i < NB_UPLOAD_BATCHES; i++)
+        {
+            auto &batch = _batches[(_currentBatch + i) % NB_UPLOAD_BATCHES];
+            if (!batch.submitted)
+            {
+                continue;
+            }
+            // Stop at the first unfinished batch to keep the submission order
+            if (_device.getFenceStatus(batch.fence) != vk::Result::eSuccess)
+            {
+                return;
+            }
+            Retire(batch);
+        }
+    }
+
+    vk::DeviceSize UploadManager::AllocateStaging(vk::DeviceSize size, vk::DeviceSize alignment)
+    {
+        if (size > STAGING_BUFFER_SIZE)
+        {
+            throw std::runtime_error("The upload is bigger than the staging buffer. Increase STAGING_BUFFER_SIZE or split the upload.");
+        }
+
+        vk::DeviceSize offset;
+        vk::DeviceSize padding;
+        while (true)
+        {
+            offset = (_stagingHead + alignment - 1) / alignment * alignment;
+            padding = offset - _stagingHead;
+            // Wrap around: the end of the ring is skipped
+            if (offset + size > STAGING_BUFFER_SIZE)
+            {
+                padding = STAGING_BUFFER_SIZE - _stagingHead;
+                offset = 0;
+            }
+
+            if (_stagingUsed + padding + size <= STAGING_BUFFER_SIZE)
+            {
+                break;
+            }
+            WaitForOldestBatch();
+        }
+
+        GetRecordingBatch().stagingSize += padding + size;
+        _stagingUsed += padding + size;
+        _stagingHead = offset + size;
+        return offset;
+    }
+
+    // ===== UPLOADS =====
+
+    upload_ticket_t UploadManager::UploadToBuffer(const void *data, vk::DeviceSize size, const structs::BufferRegion &destination)
+    {
+        ADVANCED_CHECK(_initialized, NOT_INITIALIZED_ERROR);
+
+        const auto stagingOffset = AllocateStaging(size, STAGING_ALIGNMENT);
+        std::memcpy(_stagingMappedData + stagingOffset, data, size);
+
+        auto &batch = GetRecordingBatch();
+        batch.commandBuffer.copyBuffer(_stagingBuffer, destination.buffer, vk::BufferCopy{
+                                                                               .srcOffset = stagingOffset,
+                                                                               .dstOffset = destination.offset,
+                                                                               .size = size,
+                                                                           });
+        batch.acquires.push_back(PendingAcquire{
+            .buffer = destination.buffer,
+            .offset = destination.offset,
+            .size = size,
+        });
+        return batch.ticket;
+    }
+
+    upload_ticket_t UploadManager::UploadToImage(const void *data, vk::DeviceSize size, vk::Image image, vk::Extent3D extent,
+                                                 vk::ImageAspectFlags aspect, uint32_t mipLevel, vk::ImageLayout finalLayout)
+    {
+        ADVANCED_CHECK(_initialized, NOT_INITIALIZED_ERROR);
+
+        const auto stagingOffset = AllocateStaging(size, STAGING_ALIGNMENT);
+        std::memcpy(_stagingMappedData + stagingOffset, data, size);
+
+        auto &batch = GetRecordingBatch();
+        const vk::ImageSubresourceRange subresourceRange{
+            .aspectMask = aspect,
+            .baseMipLevel = mipLevel,
+            .levelCount = 1,
+            .baseArrayLayer = 0,
+            .layerCount = 1,
+        };
+
+        // The previous content is discarded, so the layout can be converted from undefined
+        vk::ImageMemoryBarrier toTransferBarrier{
+            .srcAccessMask = {},
+            .dstAccessMask = vk::AccessFlagBits::eTransferWrite,
+            .oldLayout = vk::ImageLayout::eUndefined,
+            .newLayout = vk::ImageLayout::eTransferDstOptimal,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = image,
+            .subresourceRange = subresourceRange,
+        };
+        batch.commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, {}, nullptr, nullptr, toTransferBarrier);
+
+        batch.commandBuffer.copyBufferToImage(_stagingBuffer, image, vk::ImageLayout::eTransferDstOptimal,
+                                              vk::BufferImageCopy{
+                                                  .bufferOffset = stagingOffset,
+                                                  .bufferRowLength = 0,
+                                                  .bufferImageHeight = 0,
+                                                  .imageSubresource{
+                                                      .aspectMask = aspect,
+                                                      .mipLevel = mipLevel,
+                                                      .baseArrayLayer = 0,
+                                                      .layerCount = 1,
+                                                  },
+                                                  .imageOffset = {0, 0, 0},
+                                                  .imageExtent = extent,
+                                              });
+        batch.acquires.push_back(PendingAcquire{
+            .image = image,
+            .subresourceRange = subresourceRange,
+            .finalLayout = finalLayout,
+        });
+        return batch.ticket;
+    }
+
+    void UploadManager::Update(const vk::CommandBuffer &graphicsCommandBuffer, std::pmr::memory_resource *frameMemory)
+    {
+        ADVANCED_CHECK(_initialized, NOT_INITIALIZED_ERROR);
+
+        Submit(frameMemory);
+        RetireFinishedBatches();
+
+        if (_readyAcquires.empty())
+        {
+            return;
+        }
+
+        // Acquire the finished resources on the graphics queue.
+        // When the ownership is transferred, the barriers must match the release barriers recorded in Submit.
+        // Otherwise, they only make the transfer writes visible.
+        const bool ownershipTransfer = IsOwnershipTransferNeeded();
+        const uint32_t sourceFamily = ownershipTransfer ? _transferQueueFamily : VK_QUEUE_FAMILY_IGNORED;
+        const uint32_t destinationFamily = ownershipTransfer ? _graphicsQueueFamily : VK_QUEUE_FAMILY_IGNORED;
+        const vk::AccessFlags sourceAccess = ownershipTransfer ? vk::AccessFlags{} : vk::AccessFlags(vk::AccessFlagBits::eTransferWrite);
+
+        std::pmr::vector<vk::BufferMemoryBarrier> bufferBarriers(frameMemory);
+        std::pmr::vector<vk::ImageMemoryBarrier> imageBarriers(frameMemory);
+        for (const auto &acquire : _readyAcquires)
+        {
+            if (acquire.image)
+            {
+                imageBarriers.push_back(vk::ImageMemoryBarrier{
+                    .srcAccessMask = sourceAccess,
+                    .dstAccessMask = UPLOAD_DESTINATION_ACCESS,
+                    .oldLayout = ownershipTransfer ? vk::ImageLayout::eTransferDstOptimal : acquire.finalLayout,
+                    .newLayout = acquire.finalLayout,
+                    .srcQueueFamilyIndex = sourceFamily,
+                    .dstQueueFamilyIndex = destinationFamily,
+                    .image = acquire.image,
+                    .subresourceRange = acquire.subresourceRange,
+                });
+            }
+            else
+            {
+                bufferBarriers.push_back(vk::BufferMemoryBarrier{
+                    .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+                    .dstAccessMask = UPLOAD_DESTINATION_ACCESS,
+                    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                    .buffer = acquire.buffer,
+                    .offset = acquire.offset,
+                    .size = acquire.size,
+                });
+            }
+        }
+
+        // Without ownership transfer, the same queue is used, so the barrier waits for the previous transfers
+        const auto sourceStages = ownershipTransfer ? vk::PipelineStageFlagBits::eTopOfPipe : vk::PipelineStageFlagBits::eAllCommands;
+        graphicsCommandBuffer.pipelineBarrier(sourceStages, UPLOAD_DESTINATION_STAGES, {}, nullptr, bufferBarriers, imageBarriers);
+
+        _readyAcquires.clear();
+        _lastReadyTicket = _lastRetiredTicket;
+    }
+
+    // ===== GETTERS =====
+
+    bool UploadManager::IsUploadReady(upload_ticket_t ticket) const
+    {
+        return ticket <= _lastReadyTicket;
+    }
+
+    vk::DeviceSize UploadManager::GetStagingUsage() const
+    {
+        return _stagingUsed;
+    }
+} // namespace railguard::rendering
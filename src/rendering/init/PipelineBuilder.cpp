@@ -14,7 +14,8 @@ namespace railguard::rendering::init
     // ===== PIPELINE BUILDER =====
 
     PipelineBuilder PipelineBuilder::AddShaderStage(vk::ShaderStageFlagBits stage,
-                                                    vk::ShaderModule shaderModule)
+                                                    vk::ShaderModule shaderModule,
+                                                    const structs::SpecializationConstants &specialization)
     {
 
         // Add a new shader stage to the vector
@@ -24,19 +25,23 @@ namespace railguard::rendering::init
             // Entry function of the shader, we use main conventionally
             .pName = "main",
         });
+        _specializations.push_back(specialization);
 
         // Return this so it is easier to chain functions
         return *this;
     }
+    PipelineBuilder PipelineBuilder::WithRenderState(const structs::RenderState &renderState)
+    {
+        WithAssemblyTopology(renderState.topology);
+        WithPolygonMode(renderState.polygonMode);
+        WithDepthTestingSettings(renderState.depthTest, renderState.depthWrite, renderState.depthCompareOp);
+
+        return *this;
+    }
     PipelineBuilder PipelineBuilder::WithVertexInput(const structs::VertexInputDescription &vertexInputDescription)
     {
-        // Empty for now
-        _vertexInputInfo = vk::PipelineVertexInputStateCreateInfo{
-            .vertexBindingDescriptionCount = static_cast<uint32_t>(vertexInputDescription.bindings.size()),
-            .pVertexBindingDescriptions = vertexInputDescription.bindings.data(),
-            .vertexAttributeDescriptionCount = static_cast<uint32_t>(vertexInputDescription.attributes.size()),
-            .pVertexAttributeDescriptions = vertexInputDescription.attributes.data(),
-        };
+        // The create info points to the copy, and is updated in Build since the builder may have been copied since
+        _vertexInputDescription = vertexInputDescription;
         _vertexInputInitialized = true;
 
         return *this;
@@ -165,7 +170,14 @@ namespace railguard::rendering::init
         return *this;
     }
 
-    vk::Pipeline PipelineBuilder::Build(vk::Device device, vk::RenderPass pass)
+    PipelineBuilder PipelineBuilder::WithDynamicViewport()
+    {
+        _dynamicViewport = true;
+
+        return *this;
+    }
+
+    vk::Pipeline PipelineBuilder::Build(vk::Device device, vk::RenderPass pass, uint32_t subpass)
     {
 
         // Set pipeline blend
@@ -195,9 +207,44 @@ namespace railguard::rendering::init
                 .bindings = {},
                 .attributes = {},
             });
+        _vertexInputInfo = vk::PipelineVertexInputStateCreateInfo{
+            .flags = _vertexInputDescription.flags,
+            .vertexBindingDescriptionCount = static_cast<uint32_t>(_vertexInputDescription.bindings.size()),
+            .pVertexBindingDescriptions = _vertexInputDescription.bindings.data(),
+            .vertexAttributeDescriptionCount = static_cast<uint32_t>(_vertexInputDescription.attributes.size()),
+            .pVertexAttributeDescriptions = _vertexInputDescription.attributes.data(),
+        };
         if (!_depthSettingsProvided)
             WithDepthTestingSettings(false, false);
 
+        // Point the stages to their specialization. Every value takes 4 bytes in the data of the stage.
+        _specializationEntries.resize(_shaderStages.size());
+        _specializationInfos.resize(_shaderStages.size());
+        std::vector<std::vector<uint32_t>> specializationData(_shaderStages.size());
+        for (size_t i = 0; i < _shaderStages.size(); i++)
+        {
+            const auto &values = _specializations[i].values;
+            auto &entries = _specializationEntries[i];
+            entries.clear();
+            for (uint32_t j = 0; j < values.size(); j++)
+            {
+                entries.push_back(vk::SpecializationMapEntry{
+                    .constantID = values[j].first,
+                    .offset = j * static_cast<uint32_t>(sizeof(uint32_t)),
+                    .size = sizeof(uint32_t),
+                });
+                specializationData[i].push_back(values[j].second);
+            }
+
+            _specializationInfos[i] = vk::SpecializationInfo{
+                .mapEntryCount = static_cast<uint32_t>(entries.size()),
+                .pMapEntries = entries.data(),
+                .dataSize = specializationData[i].size() * sizeof(uint32_t),
+                .pData = specializationData[i].data(),
+            };
+            _shaderStages[i].pSpecializationInfo = values.empty() ? nullptr : &_specializationInfos[i];
+        }
+
         // Create viewport state from stored viewport and scissors
         vk::PipelineViewportStateCreateInfo viewportState{
             .viewportCount = 1,
@@ -205,6 +252,12 @@ namespace railguard::rendering::init
             .scissorCount = 1,
             .pScissors = &_scissor,
         };
+        // The given viewport and scissors are ignored if they are dynamic
+        const vk::DynamicState dynamicStates[] = {vk::DynamicState::eViewport, vk::DynamicState::eScissor};
+        vk::PipelineDynamicStateCreateInfo dynamicState{
+            .dynamicStateCount = 2,
+            .pDynamicStates = dynamicStates,
+        };
         // Create color blending state
         vk::PipelineColorBlendStateCreateInfo colorBlending{
             .logicOpEnable = false,
@@ -229,9 +282,10 @@ namespace railguard::rendering::init
             .pMultisampleState = &_multisampling,
             .pDepthStencilState = &_depthStencilCreateInfo,
             .pColorBlendState = &colorBlending,
+            .pDynamicState = _dynamicViewport ? &dynamicState : nullptr,
             .layout = _pipelineLayout,
             .renderPass = pass,
-            .subpass = 0,
+            .subpass = subpass,
             .basePipelineHandle = nullptr,
         };
 
@@ -3,19 +3,53 @@
 namespace railguard::rendering::init
 {
 
-    vk::PipelineLayout PipelineLayoutBuilder::Build(const vk::Device &vulkanDevice) {
-        // Create default create info
-        vk::PipelineLayoutCreateInfo layoutCreateInfo {
-            .flags = {},
-            .setLayoutCount = 0,
-            .pSetLayouts = nullptr,
-            .pushConstantRangeCount = 0,
-            .pPushConstantRanges = nullptr,
-        };
-
-        // Changes can be added here
-
-        return vulkanDevice.createPipelineLayout(layoutCreateInfo);
+    PipelineLayoutBuilder PipelineLayoutBuilder::AddDescriptorSetLayout(const structs::DescriptorSetLayoutDescription &setLayout)
+    {
+        _description.setLayouts.push_back(setLayout);
+
+        // Return this so it is easier to chain functions
+        return *this;
+    }
+
+    PipelineLayoutBuilder PipelineLayoutBuilder::AddDescriptorBinding(uint32_t set, uint32_t binding, vk::DescriptorType type,
+                                                                      vk::ShaderStageFlags stages, uint32_t count)
+    {
+        // Sets can't have holes, so create empty ones up to the requested index
+        if (set >= _description.setLayouts.size())
+        {
+            _description.setLayouts.resize(set + 1);
+        }
+
+        _description.setLayouts[set].bindings.push_back(vk::DescriptorSetLayoutBinding{
+            .binding = binding,
+            .descriptorType = type,
+            .descriptorCount = count,
+            .stageFlags = stages,
+            .pImmutableSamplers = nullptr,
+        });
+
+        return *this;
+    }
+
+    PipelineLayoutBuilder PipelineLayoutBuilder::AddPushConstantRange(vk::ShaderStageFlags stages, uint32_t offset, uint32_t size)
+    {
+        _description.pushConstantRanges.push_back(vk::PushConstantRange{
+            .stageFlags = stages,
+            .offset = offset,
+            .size = size,
+        });
+
+        return *this;
+    }
+
+    const structs::PipelineLayoutDescription &PipelineLayoutBuilder::GetDescription() const
+    {
+        return _description;
+    }
+
+    vk::PipelineLayout PipelineLayoutBuilder::Build(PipelineLayoutCache &cache) const
+    {
+        return cache.GetPipelineLayout(_description);
     }
 
 } // namespace railguard::rendering::init
@@ -0,0 +1,89 @@
+#include "../../../include/rendering/init/RenderGraphPassBuilder.h"
+
+namespace railguard::rendering::init
+{
+    RenderGraphPassBuilder::RenderGraphPassBuilder(const std::string &name)
+    {
+        _description.name = name;
+    }
+
+    RenderGraphPassBuilder RenderGraphPassBuilder::WriteColor(render_resource_id_t resource, const std::array<float, 4> &clearColor)
+    {
+        _description.colorAttachments.push_back(structs::RenderGraphAttachmentUse{
+            .resource = resource,
+            .loadOp = vk::AttachmentLoadOp::eClear,
+            .clearValue = vk::ClearValue(clearColor),
+        });
+
+        // Return this so it is easier to chain functions
+        return *this;
+    }
+
+    RenderGraphPassBuilder RenderGraphPassBuilder::WriteColor(render_resource_id_t resource)
+    {
+        _description.colorAttachments.push_back(structs::RenderGraphAttachmentUse{
+            .resource = resource,
+            .loadOp = vk::AttachmentLoadOp::eLoad,
+        });
+
+        return *this;
+    }
+
+    RenderGraphPassBuilder RenderGraphPassBuilder::WriteDepth(render_resource_id_t resource, float clearDepth)
+    {
+        _description.depthAttachment = structs::RenderGraphAttachmentUse{
+            .resource = resource,
+            .loadOp = vk::AttachmentLoadOp::eClear,
+            .clearValue = vk::ClearValue(vk::ClearDepthStencilValue{
+                .depth = clearDepth,
+                .stencil = 0,
+            }),
+        };
+
+        return *this;
+    }
+
+    RenderGraphPassBuilder RenderGraphPassBuilder::ReadDepth(render_resource_id_t resource)
+    {
+        _description.depthAttachment = structs::RenderGraphAttachmentUse{
+            .resource = resource,
+            .loadOp = vk::AttachmentLoadOp::eLoad,
+            .readOnly = true,
+        };
+
+        return *this;
+    }
+
+    RenderGraphPassBuilder RenderGraphPassBuilder::ReadInputAttachment(render_resource_id_t resource)
+    {
+        _description.inputAttachments.push_back(resource);
+
+        return *this;
+    }
+
+    RenderGraphPassBuilder RenderGraphPassBuilder::ReadTexture(render_resource_id_t resource)
+    {
+        _description.sampledImages.push_back(resource);
+
+        return *this;
+    }
+
+    RenderGraphPassBuilder RenderGraphPassBuilder::WithSideEffects()
+    {
+        _description.hasSideEffects = true;
+
+        return *this;
+    }
+
+    RenderGraphPassBuilder RenderGraphPassBuilder::Execute(const std::function<void(const vk::CommandBuffer &)> &callback)
+    {
+        _description.execute = callback;
+
+        return *this;
+    }
+
+    structs::RenderGraphPassDescription RenderGraphPassBuilder::Build() const
+    {
+        return _description;
+    }
+} // namespace railguard::rendering::init
@@ -1,4 +1,5 @@
 #include "../../../include/rendering/init/RenderPassBuilder.h"
+#include <algorithm>
 
 namespace railguard::rendering::init
 {
@@ -18,6 +19,13 @@ namespace railguard::rendering::init
         // Return this to be able to chain the calls
         return *this;
     }
+    AttachmentBuilder AttachmentBuilder::KeepOnLoad()
+    {
+        _loadOp = vk::AttachmentLoadOp::eLoad;
+
+        // Return this to be able to chain the calls
+        return *this;
+    }
     AttachmentBuilder AttachmentBuilder::StoreAtEnd()
     {
         _storeOp = vk::AttachmentStoreOp::eStore;
@@ -39,6 +47,13 @@ namespace railguard::rendering::init
         // Return this to be able to chain the calls
         return *this;
     }
+    AttachmentBuilder AttachmentBuilder::SetInitialLayout(vk::ImageLayout layout)
+    {
+        _initialLayout = layout;
+
+        // Return this to be able to chain the calls
+        return *this;
+    }
     AttachmentBuilder AttachmentBuilder::SetFinalLayout(vk::ImageLayout layout)
     {
         _finalLayout = layout;
@@ -58,60 +73,226 @@ namespace railguard::rendering::init
             .storeOp = _storeOp,
             .stencilLoadOp = _stencilLoadOp,
             .stencilStoreOp = _stencilStoreOp,
-            .initialLayout = vk::ImageLayout::eUndefined,
+            .initialLayout = _initialLayout,
             .finalLayout = _finalLayout,
         };
     }
 
+    RenderPassBuilder RenderPassBuilder::AddAttachment(const vk::AttachmentDescription &attachment)
+    {
+        _attachments.push_back(attachment);
+
+        return *this;
+    }
+
     RenderPassBuilder RenderPassBuilder::AddColorAttachment(const vk::AttachmentDescription &attachment)
     {
         _attachments.push_back(attachment);
 
+        return UseColorAttachment(static_cast<uint32_t>(_attachments.size()) - 1);
+    }
+
+    RenderPassBuilder RenderPassBuilder::AddDepthAttachment(const vk::AttachmentDescription &attachment, bool readOnly)
+    {
+        _attachments.push_back(attachment);
+
+        return UseDepthAttachment(static_cast<uint32_t>(_attachments.size()) - 1, readOnly);
+    }
+
+    RenderPassBuilder RenderPassBuilder::UseColorAttachment(uint32_t attachmentIndex)
+    {
         // Save reference to the attachment
-        _attachmentReferences.push_back(vk::AttachmentReference{
-            .attachment = static_cast<uint32_t>(_attachments.size()) - 1,
+        // The pointers of the subpass are only set in Build, since the vector may be reallocated until then
+        _subpasses.back().colorAttachments.push_back(vk::AttachmentReference{
+            .attachment = attachmentIndex,
             .layout = vk::ImageLayout::eColorAttachmentOptimal,
         });
 
-        // Only allow 1 color attachment for now max.
-        _subpass.colorAttachmentCount = 1;
-        _subpass.pColorAttachments = &_attachmentReferences[_attachmentReferences.size() - 1];
-
         return *this;
     }
 
-    RenderPassBuilder RenderPassBuilder::AddDepthAttachment(const vk::AttachmentDescription &attachment)
+    RenderPassBuilder RenderPassBuilder::UseDepthAttachment(uint32_t attachmentIndex, bool readOnly)
     {
-        _attachments.push_back(attachment);
+        // Only one depth attachment can be used in a subpass
+        auto &subpass = _subpasses.back();
+        subpass.depthAttachment = vk::AttachmentReference{
+            .attachment = attachmentIndex,
+            .layout = readOnly ? vk::ImageLayout::eDepthStencilReadOnlyOptimal : vk::ImageLayout::eDepthStencilAttachmentOptimal,
+        };
+        subpass.hasDepthAttachment = true;
+        subpass.depthReadOnly = readOnly;
 
-        // Save reference to the attachment
-        _attachmentReferences.push_back(vk::AttachmentReference{
-            .attachment = static_cast<uint32_t>(_attachments.size()) - 1,
-            .layout = vk::ImageLayout::eDepthStencilAttachmentOptimal,
+        return *this;
+    }
+
+    RenderPassBuilder RenderPassBuilder::UseInputAttachment(uint32_t attachmentIndex, vk::ImageLayout layout)
+    {
+        _subpasses.back().inputAttachments.push_back(vk::AttachmentReference{
+            .attachment = attachmentIndex,
+            .layout = layout,
         });
 
-        // Only allow 1 color attachment for now max.
-        _subpass.pDepthStencilAttachment = &_attachmentReferences[_attachmentReferences.size() - 1];
+        return *this;
+    }
+
+    RenderPassBuilder RenderPassBuilder::NextSubpass()
+    {
+        // Keep the same bind point by default
+        _subpasses.push_back(SubpassInfo{
+            .bindPoint = _subpasses.back().bindPoint,
+        });
 
         return *this;
     }
 
     RenderPassBuilder RenderPassBuilder::SetPipelineBindPoint(vk::PipelineBindPoint bindPoint)
     {
-        _subpass.pipelineBindPoint = bindPoint;
+        _subpasses.back().bindPoint = bindPoint;
 
         return *this;
     }
 
+    RenderPassBuilder RenderPassBuilder::AddDependency(const vk::SubpassDependency &dependency)
+    {
+        _dependencies.push_back(dependency);
+
+        return *this;
+    }
+
+    uint32_t RenderPassBuilder::GetSubpassCount() const
+    {
+        return static_cast<uint32_t>(_subpasses.size());
+    }
+
+    std::vector<vk::SubpassDependency> RenderPassBuilder::ComputeDependencies() const
+    {
+        std::vector<vk::SubpassDependency> dependencies = _dependencies;
+
+        // For each attachment, the last subpass that wrote it
+        std::vector<uint32_t> lastWriters(_attachments.size(), VK_SUBPASS_EXTERNAL);
+
+        for (uint32_t s = 0; s < _subpasses.size(); s++)
+        {
+            const auto &subpass = _subpasses[s];
+
+            // Find the previous subpasses that wrote an attachment used by this one
+            std::vector<uint32_t> sources;
+            auto addSource = [&](const vk::AttachmentReference &reference)
+            {
+                uint32_t writer = lastWriters[reference.attachment];
+                if (writer != VK_SUBPASS_EXTERNAL && writer != s && std::find(sources.begin(), sources.end(), writer) == sources.end())
+                {
+                    sources.push_back(writer);
+                }
+            };
+            for (const auto &reference : subpass.inputAttachments)
+                addSource(reference);
+            for (const auto &reference : subpass.colorAttachments)
+                addSource(reference);
+            if (subpass.hasDepthAttachment)
+                addSource(subpass.depthAttachment);
+
+            // By region: each pixel only depends on the same pixel of the previous subpasses, so it can stay in tile memory
+            for (auto source : sources)
+            {
+                dependencies.push_back(vk::SubpassDependency{
+                    .srcSubpass = source,
+                    .dstSubpass = s,
+                    .srcStageMask = vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eLateFragmentTests,
+                    .dstStageMask = vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eColorAttachmentOutput,
+                    .srcAccessMask = vk::AccessFlagBits::eColorAttachmentWrite | vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+                    .dstAccessMask = vk::AccessFlagBits::eInputAttachmentRead | vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite |
+                                     vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+                    .dependencyFlags = vk::DependencyFlagBits::eByRegion,
+                });
+            }
+
+            // Update the writers
+            for (const auto &reference : subpass.colorAttachments)
+                lastWriters[reference.attachment] = s;
+            if (subpass.hasDepthAttachment && !subpass.depthReadOnly)
+                lastWriters[subpass.depthAttachment.attachment] = s;
+        }
+
+        return dependencies;
+    }
+
+    std::vector<std::vector<uint32_t>> RenderPassBuilder::ComputePreservedAttachments() const
+    {
+        const auto subpassCount = static_cast<uint32_t>(_subpasses.size());
+
+        // For each attachment, the first subpass that writes it and the last subpass that uses it
+        std::vector<uint32_t> firstWriters(_attachments.size(), subpassCount);
+        std::vector<uint32_t> lastUsers(_attachments.size(), 0);
+        // For each subpass, whether it references each attachment
+        std::vector<std::vector<bool>> referenced(subpassCount, std::vector<bool>(_attachments.size(), false));
+        for (uint32_t s = 0; s < subpassCount; s++)
+        {
+            const auto &subpass = _subpasses[s];
+            auto use = [&](const vk::AttachmentReference &reference, bool writes)
+            {
+                referenced[s][reference.attachment] = true;
+                lastUsers[reference.attachment] = s;
+                if (writes)
+                {
+                    firstWriters[reference.attachment] = std::min(firstWriters[reference.attachment], s);
+                }
+            };
+            for (const auto &reference : subpass.inputAttachments)
+                use(reference, false);
+            for (const auto &reference : subpass.colorAttachments)
+                use(reference, true);
+            if (subpass.hasDepthAttachment)
+                use(subpass.depthAttachment, !subpass.depthReadOnly);
+        }
+
+        // The content of an attachment is undefined after a subpass that doesn't reference it, unless it preserves it
+        std::vector<std::vector<uint32_t>> preserved(subpassCount);
+        for (uint32_t a = 0; a < _attachments.size(); a++)
+        {
+            for (uint32_t s = firstWriters[a] + 1; s < lastUsers[a]; s++)
+            {
+                if (!referenced[s][a])
+                {
+                    preserved[s].push_back(a);
+                }
+            }
+        }
+        return preserved;
+    }
+
     vk::RenderPass RenderPassBuilder::Build(const vk::Device &device)
     {
+        const auto dependencies = ComputeDependencies();
+        const auto preservedAttachments = ComputePreservedAttachments();
+
+        // Link the references to the subpasses
+        std::vector<vk::SubpassDescription> subpasses;
+        subpasses.reserve(_subpasses.size());
+        for (uint32_t s = 0; s < _subpasses.size(); s++)
+        {
+            const auto &subpass = _subpasses[s];
+            subpasses.push_back(vk::SubpassDescription{
+                .pipelineBindPoint = subpass.bindPoint,
+                .inputAttachmentCount = static_cast<uint32_t>(subpass.inputAttachments.size()),
+                .pInputAttachments = subpass.inputAttachments.data(),
+                .colorAttachmentCount = static_cast<uint32_t>(subpass.colorAttachments.size()),
+                .pColorAttachments = subpass.colorAttachments.data(),
+                .pDepthStencilAttachment = subpass.hasDepthAttachment ? &subpass.depthAttachment : nullptr,
+                .preserveAttachmentCount = static_cast<uint32_t>(preservedAttachments[s].size()),
+                .pPreserveAttachments = preservedAttachments[s].data(),
+            });
+        }
+
         vk::RenderPassCreateInfo renderPassCreateInfo{
             .attachmentCount = static_cast<uint32_t>(_attachments.size()),
             .pAttachments = _attachments.data(),
-            .subpassCount = 1,
-            .pSubpasses = &_subpass,
+            .subpassCount = static_cast<uint32_t>(subpasses.size()),
+            .pSubpasses = subpasses.data(),
+            .dependencyCount = static_cast<uint32_t>(dependencies.size()),
+            .pDependencies = dependencies.data(),
         };
         return device.createRenderPass(renderPassCreateInfo);
     }
 
-} // namespace railguard::rendering::init
\ No newline at end of file
+} // namespace railguard::rendering::init
@@ -22,19 +22,25 @@ namespace railguard::rendering::init
 			.use_default_debug_messenger();
 #endif
 
-		// Get required SDL extensions
-		auto requiredSDLExtensions = initInfo.windowManager.GetRequiredVulkanExtensions();
-
 		vkbInstanceBuilder.set_app_name("My wonderful game")
 			.set_app_version(0, 1, 0)
 			.set_engine_version(0, 1, 0)
 			.require_api_version(1, 1, 0)
 			.set_engine_name("Railguard");
 
-		// Add sdl extensions
-		for (const char *ext : requiredSDLExtensions)
+		const bool headless = initInfo.windowManager == nullptr;
+		if (headless)
+		{
+			// No surface extension, so that it also works on machines without a display (e.g. with lavapipe on a CI server)
+			vkbInstanceBuilder.set_headless(true);
+		}
+		else
 		{
-			vkbInstanceBuilder.enable_extension(ext);
+			// Add sdl extensions
+			for (const char *ext : initInfo.windowManager->GetRequiredVulkanExtensions())
+			{
+				vkbInstanceBuilder.enable_extension(ext);
+			}
 		}
 
 		// Build instance
@@ -49,15 +55,32 @@ namespace railguard::rendering::init
 		VULKAN_HPP_DEFAULT_DISPATCHER.init(*initInfo.instance);
 
 		// Get the surface of the SDL window
-		*initInfo.surface = initInfo.windowManager.GetVulkanSurface(*initInfo.instance);
+		*initInfo.surface = headless ? vk::SurfaceKHR(nullptr) : initInfo.windowManager->GetVulkanSurface(*initInfo.instance);
 
 		// Select a physical device
+		// Without a window, it doesn't need to present, so any device with a graphics queue is enough (including CPU implementations)
 		vkb::PhysicalDeviceSelector gpuSelector{vkbInstance};
-		auto vkbPhysicalDevice = gpuSelector.set_minimum_version(1, 1)
-									 .set_surface(*initInfo.surface)
-									 .add_required_extension(VK_KHR_SWAPCHAIN_EXTENSION_NAME)
-									 .select()
-									 .value();
+		gpuSelector.set_minimum_version(1, 1);
+		if (headless)
+		{
+			gpuSelector.require_present(false);
+		}
+		else
+		{
+			gpuSelector.set_surface(*initInfo.surface)
+				.add_required_extension(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+		}
+		auto vkbPhysicalDevice = gpuSelector.select().value();
+		// Enable the optional features that the device supports
+		// They allow the meshlets of a draw to be drawn with a single indirect command, even for instanced draws
+		const auto supportedFeatures = vk::PhysicalDevice(vkbPhysicalDevice.physical_device).getFeatures();
+		vkbPhysicalDevice.features.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+		vkbPhysicalDevice.features.drawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance;
+		*initInfo.enabledFeatures = vk::PhysicalDeviceFeatures{
+			.multiDrawIndirect = supportedFeatures.multiDrawIndirect,
+			.drawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance,
+		};
+
 		// Get logical device
 		vkb::DeviceBuilder deviceBuilder{vkbPhysicalDevice};
 		auto vkbDevice = deviceBuilder.build().value();
@@ -73,6 +96,47 @@ namespace railguard::rendering::init
 		*initInfo.graphicsQueue = vkbDevice.get_queue(vkb::QueueType::graphics).value();
 		*initInfo.graphicsQueueFamily = vkbDevice.get_queue_index(vkb::QueueType::graphics).value();
 
+		// Get transfer queue
+		// Prefer a family that only supports transfers (usually backed by DMA engines), then any family other than the graphics one
+		auto transferQueue = vkbDevice.get_dedicated_queue(vkb::QueueType::transfer);
+		auto transferQueueFamily = vkbDevice.get_dedicated_queue_index(vkb::QueueType::transfer);
+		if (!transferQueue.has_value())
+		{
+			transferQueue = vkbDevice.get_queue(vkb::QueueType::transfer);
+			transferQueueFamily = vkbDevice.get_queue_index(vkb::QueueType::transfer);
+		}
+		if (transferQueue.has_value())
+		{
+			*initInfo.transferQueue = transferQueue.value();
+			*initInfo.transferQueueFamily = transferQueueFamily.value();
+		}
+		else
+		{
+			// Otherwise, use the graphics queue for transfers too
+			*initInfo.transferQueue = *initInfo.graphicsQueue;
+			*initInfo.transferQueueFamily = *initInfo.graphicsQueueFamily;
+		}
+
+		// Get async compute queue
+		// Same thing: a family without graphics allows compute work to run alongside graphics work
+		auto computeQueue = vkbDevice.get_dedicated_queue(vkb::QueueType::compute);
+		auto computeQueueFamily = vkbDevice.get_dedicated_queue_index(vkb::QueueType::compute);
+		if (!computeQueue.has_value())
+		{
+			computeQueue = vkbDevice.get_queue(vkb::QueueType::compute);
+			computeQueueFamily = vkbDevice.get_queue_index(vkb::QueueType::compute);
+		}
+		if (computeQueue.has_value())
+		{
+			*initInfo.computeQueue = computeQueue.value();
+			*initInfo.computeQueueFamily = computeQueueFamily.value();
+		}
+		else
+		{
+			*initInfo.computeQueue = *initInfo.graphicsQueue;
+			*initInfo.computeQueueFamily = *initInfo.graphicsQueueFamily;
+		}
+
 		// Get physical device properties
 		*initInfo.physicalDeviceProperties = (*initInfo.physicalDevice).getProperties();
 
@@ -159,31 +223,7 @@ namespace railguard::rendering::init
 			(*initInfo.swapchainImageViews)[i] = initInfo.device.createImageView(createInfo);
 		}
 
-		// TODO depth image
-
-		// Create framebuffers
-
-#define ATTACHMENTS_COUNT 1
-		vk::ImageView attachments[ATTACHMENTS_COUNT];
-		// TODO insert depth image view when done
-
-		// Define the init info
-		vk::FramebufferCreateInfo framebufferCreateInfo{
-			.renderPass = initInfo.renderPass,
-			.attachmentCount = ATTACHMENTS_COUNT,
-			.pAttachments = attachments,
-			.width = windowExtent.width,
-			.height = windowExtent.height,
-			.layers = 1,
-		};
-
-		initInfo.swapchainFramebuffers->resize(swapchainImageCount);
-
-		// Create a framebuffer for each image
-		for (uint32_t i = 0; i < swapchainImageCount; i++)
-		{
-			attachments[0] = (*initInfo.swapchainImageViews)[i];
-			(*initInfo.swapchainFramebuffers)[i] = initInfo.device.createFramebuffer(framebufferCreateInfo);
-		}
+		// The depth image and the framebuffers are created by the render graph,
+		// which imports the swapchain images
 	}
 }
\ No newline at end of file
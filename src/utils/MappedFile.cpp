@@ -0,0 +1,141 @@
+#include "../../include/utils/MappedFile.h"
+#include "../../include/utils/GetError.h"
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace railguard::utils
+{
+    MappedFile::MappedFile(const std::string &filePath)
+    {
+#ifdef _WIN32
+        _fileHandle = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (_fileHandle == INVALID_HANDLE_VALUE)
+        {
+            _fileHandle = nullptr;
+            throw std::runtime_error("Couldn't open file " + filePath);
+        }
+
+        LARGE_INTEGER fileSize;
+        GetFileSizeEx(_fileHandle, &fileSize);
+        _size = static_cast<size_t>(fileSize.QuadPart);
+
+        // Empty files can't be mapped
+        if (_size > 0)
+        {
+            _mappingHandle = CreateFileMappingA(_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (_mappingHandle != nullptr)
+            {
+                _data = MapViewOfFile(_mappingHandle, FILE_MAP_READ, 0, 0, 0);
+            }
+            if (_data == nullptr)
+            {
+                Unmap();
+                throw std::runtime_error("Couldn't map file " + filePath);
+            }
+        }
+#else
+        int fileDescriptor = open(filePath.c_str(), O_RDONLY);
+        if (fileDescriptor < 0)
+        {
+            throw std::runtime_error("Couldn't open file " + filePath + ": " + GetError());
+        }
+
+        struct stat fileStat
+        {
+        };
+        if (fstat(fileDescriptor, &fileStat) != 0)
+        {
+            close(fileDescriptor);
+            throw std::runtime_error("Couldn't read the size of file " + filePath + ": " + GetError());
+        }
+        _size = static_cast<size_t>(fileStat.st_size);
+
+        // Empty files can't be mapped
+        if (_size > 0)
+        {
+            void *data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+            if (data == MAP_FAILED)
+            {
+                close(fileDescriptor);
+                throw std::runtime_error("Couldn't map file " + filePath + ": " + GetError());
+            }
+            _data = data;
+        }
+
+        // The mapping stays valid after the file is closed
+        close(fileDescriptor);
+#endif
+    }
+
+    MappedFile::~MappedFile()
+    {
+        Unmap();
+    }
+
+    MappedFile::MappedFile(MappedFile &&other) noexcept
+    {
+        *this = std::move(other);
+    }
+
+    MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+    {
+        if (this != &other)
+        {
+            Unmap();
+            std::swap(_data, other._data);
+            std::swap(_size, other._size);
+#ifdef _WIN32
+            std::swap(_fileHandle, other._fileHandle);
+            std::swap(_mappingHandle, other._mappingHandle);
+#endif
+        }
+        return *this;
+    }
+
+    void MappedFile::Unmap()
+    {
+#ifdef _WIN32
+        if (_data != nullptr)
+        {
+            UnmapViewOfFile(_data);
+        }
+        if (_mappingHandle != nullptr)
+        {
+            CloseHandle(_mappingHandle);
+        }
+        if (_fileHandle != nullptr)
+        {
+            CloseHandle(_fileHandle);
+        }
+        _mappingHandle = nullptr;
+        _fileHandle = nullptr;
+#else
+        if (_data != nullptr)
+        {
+            munmap(const_cast<void *>(_data), _size);
+        }
+#endif
+        _data = nullptr;
+        _size = 0;
+    }
+
+    const void *MappedFile::GetData() const
+    {
+        return _data;
+    }
+
+    size_t MappedFile::GetSize() const
+    {
+        return _size;
+    }
+} // namespace railguard::utils
@@ -0,0 +1,101 @@
+#include "../../include/utils/RadixSort.h"
+#include "../../include/core/JobPool.h"
+#include <algorithm>
+#include <utility>
+
+// Below that number of entries per chunk, submitting jobs costs more than it saves
+#define MIN_ENTRIES_PER_CHUNK 4096
+#define RADIX_BITS 8
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+
+namespace railguard::utils
+{
+    void RadixSort(std::vector<SortEntry> &entries, RadixSortScratch &scratch, core::JobPool *jobPool)
+    {
+        const auto count = static_cast<uint32_t>(entries.size());
+        if (count < 2)
+        {
+            return;
+        }
+
+        const uint32_t maxChunkCount = jobPool != nullptr ? jobPool->GetConcurrency() : 1;
+        const uint32_t chunkCount = std::clamp(count / MIN_ENTRIES_PER_CHUNK, 1u, maxChunkCount);
+        const uint32_t chunkSize = (count + chunkCount - 1) / chunkCount;
+
+        scratch.buffer.resize(count);
+        scratch.histograms.resize(chunkCount * RADIX_BUCKETS);
+        scratch.offsets.resize(chunkCount * RADIX_BUCKETS);
+        SortEntry *source = entries.data();
+        SortEntry *destination = scratch.buffer.data();
+
+        // Runs the function on every chunk, in parallel if there are several
+        auto forEachChunk = [&](const auto &function)
+        {
+            if (chunkCount == 1)
+            {
+                function(0u, 0u, count);
+                return;
+            }
+            jobPool->ParallelFor(chunkCount, 1, [&](size_t firstChunk, size_t lastChunk)
+                                 {
+                                     for (auto chunk = static_cast<uint32_t>(firstChunk); chunk < lastChunk; chunk++)
+                                     {
+                                         const uint32_t begin = std::min(count, chunk * chunkSize);
+                                         function(chunk, begin, std::min(count, begin + chunkSize));
+                                     }
+                                 });
+        };
+
+        for (uint32_t shift = 0; shift < 64; shift += RADIX_BITS)
+        {
+            // Count the keys of each chunk
+            forEachChunk([&](uint32_t chunk, uint32_t begin, uint32_t end)
+                         {
+                             uint32_t *histogram = scratch.histograms.data() + chunk * RADIX_BUCKETS;
+                             std::fill(histogram, histogram + RADIX_BUCKETS, 0u);
+                             for (uint32_t i = begin; i < end; i++)
+                             {
+                                 histogram[(source[i].key >> shift) & (RADIX_BUCKETS - 1)]++;
+                             }
+                         });
+
+            // Compute where each chunk will write its entries
+            uint32_t position = 0;
+            uint32_t usedBuckets = 0;
+            for (uint32_t bucket = 0; bucket < RADIX_BUCKETS; bucket++)
+            {
+                uint32_t bucketSize = 0;
+                for (uint32_t chunk = 0; chunk < chunkCount; chunk++)
+                {
+                    scratch.offsets[chunk * RADIX_BUCKETS + bucket] = position + bucketSize;
+                    bucketSize += scratch.histograms[chunk * RADIX_BUCKETS + bucket];
+                }
+                position += bucketSize;
+                usedBuckets += bucketSize > 0 ? 1 : 0;
+            }
+            // If every key has the same byte, the order wouldn't change
+            if (usedBuckets == 1)
+            {
+                continue;
+            }
+
+            // Move them. Chunks write to distinct ranges, in their order, so the sort is stable.
+            forEachChunk([&](uint32_t chunk, uint32_t begin, uint32_t end)
+                         {
+                             uint32_t *offset = scratch.offsets.data() + chunk * RADIX_BUCKETS;
+                             for (uint32_t i = begin; i < end; i++)
+                             {
+                                 destination[offset[(source[i].key >> shift) & (RADIX_BUCKETS - 1)]++] = source[i];
+                             }
+                         });
+            std::swap(source, destination);
+        }
+
+        // The result may be in the scratch buffer, depending on the number of skipped passes.
+        // Both vectors are kept by the caller, so exchanging them keeps their capacity.
+        if (source != entries.data())
+        {
+            entries.swap(scratch.buffer);
+        }
+    }
+} // namespace railguard::utils
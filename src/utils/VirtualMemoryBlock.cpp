@@ -0,0 +1,155 @@
+#include "../../include/utils/VirtualMemoryBlock.h"
+#include "../../include/utils/GetError.h"
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Memory is committed by chunks of that size, to limit the number of system calls
+#define COMMIT_GRANULARITY (64 * 1024)
+// Size of the transparent huge pages on x86-64 and most ARM64 kernels
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+namespace railguard::utils
+{
+    namespace
+    {
+        size_t AlignUp(size_t value, size_t alignment)
+        {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+    } // namespace
+
+    VirtualMemoryBlock::VirtualMemoryBlock(size_t reservedSize, bool hugePages)
+        : _hugePages(hugePages)
+    {
+        _reservedSize = AlignUp(reservedSize, hugePages ? HUGE_PAGE_SIZE : COMMIT_GRANULARITY);
+        if (_reservedSize == 0)
+        {
+            return;
+        }
+
+#ifdef _WIN32
+        _data = static_cast<std::byte *>(VirtualAlloc(nullptr, _reservedSize, MEM_RESERVE, PAGE_NOACCESS));
+        if (_data == nullptr)
+        {
+            throw std::runtime_error("Couldn't reserve " + std::to_string(_reservedSize) + " bytes of address space.");
+        }
+#else
+        // Over-reserve to be able to align the range on a huge page
+        _mappingSize = _reservedSize + (hugePages ? HUGE_PAGE_SIZE : 0);
+        _mapping = mmap(nullptr, _mappingSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (_mapping == MAP_FAILED)
+        {
+            _mapping = nullptr;
+            throw std::runtime_error("Couldn't reserve " + std::to_string(_reservedSize) + " bytes of address space: " + GetError());
+        }
+        const auto address = reinterpret_cast<uintptr_t>(_mapping);
+        _data = reinterpret_cast<std::byte *>(hugePages ? AlignUp(address, HUGE_PAGE_SIZE) : address);
+
+#ifdef MADV_HUGEPAGE
+        // Only a hint: without transparent huge pages, the range is simply backed by regular pages
+        if (hugePages)
+        {
+            madvise(_data, _reservedSize, MADV_HUGEPAGE);
+        }
+#endif
+#endif
+    }
+
+    VirtualMemoryBlock::~VirtualMemoryBlock()
+    {
+        Release();
+    }
+
+    VirtualMemoryBlock::VirtualMemoryBlock(VirtualMemoryBlock &&other) noexcept
+    {
+        *this = std::move(other);
+    }
+
+    VirtualMemoryBlock &VirtualMemoryBlock::operator=(VirtualMemoryBlock &&other) noexcept
+    {
+        if (this != &other)
+        {
+            Release();
+            std::swap(_data, other._data);
+            std::swap(_reservedSize, other._reservedSize);
+            std::swap(_committedSize, other._committedSize);
+            std::swap(_hugePages, other._hugePages);
+#ifndef _WIN32
+            std::swap(_mapping, other._mapping);
+            std::swap(_mappingSize, other._mappingSize);
+#endif
+        }
+        return *this;
+    }
+
+    void VirtualMemoryBlock::Release()
+    {
+#ifdef _WIN32
+        if (_data != nullptr)
+        {
+            VirtualFree(_data, 0, MEM_RELEASE);
+        }
+#else
+        if (_mapping != nullptr)
+        {
+            munmap(_mapping, _mappingSize);
+        }
+        _mapping = nullptr;
+        _mappingSize = 0;
+#endif
+        _data = nullptr;
+        _reservedSize = 0;
+        _committedSize = 0;
+    }
+
+    void VirtualMemoryBlock::Commit(size_t size)
+    {
+        if (size <= _committedSize)
+        {
+            return;
+        }
+        if (size > _reservedSize)
+        {
+            throw std::length_error("Can't commit " + std::to_string(size) + " bytes in a block of " + std::to_string(_reservedSize) + " bytes.");
+        }
+
+        const size_t newCommittedSize = std::min(AlignUp(size, _hugePages ? HUGE_PAGE_SIZE : COMMIT_GRANULARITY), _reservedSize);
+#ifdef _WIN32
+        if (VirtualAlloc(_data + _committedSize, newCommittedSize - _committedSize, MEM_COMMIT, PAGE_READWRITE) == nullptr)
+        {
+            throw std::runtime_error("Couldn't commit " + std::to_string(newCommittedSize) + " bytes of memory.");
+        }
+#else
+        if (mprotect(_data + _committedSize, newCommittedSize - _committedSize, PROT_READ | PROT_WRITE) != 0)
+        {
+            throw std::runtime_error("Couldn't commit " + std::to_string(newCommittedSize) + " bytes of memory: " + GetError());
+        }
+#endif
+        _committedSize = newCommittedSize;
+    }
+
+    std::byte *VirtualMemoryBlock::GetData() const
+    {
+        return _data;
+    }
+
+    size_t VirtualMemoryBlock::GetReservedSize() const
+    {
+        return _reservedSize;
+    }
+
+    size_t VirtualMemoryBlock::GetCommittedSize() const
+    {
+        return _committedSize;
+    }
+} // namespace railguard::utils
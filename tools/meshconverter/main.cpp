@@ -0,0 +1,744 @@
+// Converts a Wavefront OBJ file to the mesh format of the engine (see include/rendering/structs/MeshFormat.h).
+// The LODs are generated by vertex clustering, and the triangles of each LOD are reordered for the post-transform vertex cache.
+// Each LOD is then split in meshlets, which the renderer culls on the GPU.
+// Usage: meshconverter <input .obj file> <output file>
+
+#include "../../include/rendering/structs/MeshFormat.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using namespace railguard;
+using rendering::structs::Meshlet;
+using rendering::structs::MeshVertex;
+
+// Size of the vertex cache that the triangle order is optimized for. Most GPUs have a cache at least that big.
+#define VERTEX_CACHE_SIZE 16
+// Number of cells along the diagonal of the bounding box for the first simplified LOD. Each next LOD halves it.
+#define FIRST_LOD_GRID_RESOLUTION 128
+// A LOD is only kept if it has at most that fraction of the triangles of the previous one
+#define MIN_LOD_REDUCTION 0.75f
+
+struct Mesh
+{
+    std::vector<MeshVertex> vertices;
+    // Indices of each LOD, the first one being the original mesh
+    std::vector<std::vector<uint32_t>> lods;
+    std::vector<float> lodErrors;
+    rendering::structs::MeshBounds bounds;
+    // Meshlets of each LOD. Their first triangle is relative to the LOD.
+    std::vector<std::vector<Meshlet>> lodMeshlets;
+    std::vector<uint32_t> meshletVertices;
+    std::vector<uint8_t> meshletTriangles;
+};
+
+uint64_t AlignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// ===== OBJ PARSING =====
+
+// Converts an OBJ index, which starts at 1 and can be relative to the end when negative
+int64_t ResolveIndex(int64_t index, size_t count)
+{
+    return index < 0 ? static_cast<int64_t>(count) + index : index - 1;
+}
+
+Mesh ReadObj(const std::filesystem::path &path)
+{
+    std::ifstream stream(path);
+    if (!stream)
+    {
+        throw std::runtime_error("Unable to open \"" + path.string() + "\".");
+    }
+
+    std::vector<std::array<float, 3>> positions;
+    std::vector<std::array<float, 3>> normals;
+    std::vector<std::array<float, 2>> uvs;
+
+    Mesh mesh;
+    auto &indices = mesh.lods.emplace_back();
+    // OBJ vertices are made of separate position, uv and normal indices: create a vertex for each combination
+    std::unordered_map<std::string, uint32_t> vertexLookup;
+    std::vector<bool> hasNormal;
+
+    std::string line;
+    while (std::getline(stream, line))
+    {
+        std::istringstream lineStream(line);
+        std::string keyword;
+        lineStream >> keyword;
+
+        if (keyword == "v")
+        {
+            auto &position = positions.emplace_back();
+            lineStream >> position[0] >> position[1] >> position[2];
+        }
+        else if (keyword == "vn")
+        {
+            auto &normal = normals.emplace_back();
+            lineStream >> normal[0] >> normal[1] >> normal[2];
+        }
+        else if (keyword == "vt")
+        {
+            auto &uv = uvs.emplace_back();
+            lineStream >> uv[0] >> uv[1];
+            // OBJ textures have their origin at the bottom, vulkan ones at the top
+            uv[1] = 1.0f - uv[1];
+        }
+        else if (keyword == "f")
+        {
+            std::vector<uint32_t> polygon;
+            std::string corner;
+            while (lineStream >> corner)
+            {
+                auto [it, inserted] = vertexLookup.try_emplace(corner, static_cast<uint32_t>(mesh.vertices.size()));
+                if (inserted)
+                {
+                    // Corners are written "position", "position/uv", "position//normal" or "position/uv/normal"
+                    int64_t attributes[3] = {0, 0, 0};
+                    std::istringstream cornerStream(corner);
+                    std::string attribute;
+                    for (int i = 0; i < 3 && std::getline(cornerStream, attribute, '/'); i++)
+                    {
+                        attributes[i] = attribute.empty() ? 0 : std::stoll(attribute);
+                    }
+
+                    MeshVertex vertex{};
+                    const auto positionIndex = ResolveIndex(attributes[0], positions.size());
+                    if (positionIndex < 0 || positionIndex >= static_cast<int64_t>(positions.size()))
+                    {
+                        throw std::runtime_error("Invalid position index in \"" + line + "\".");
+                    }
+                    std::copy_n(positions[positionIndex].begin(), 3, vertex.position);
+                    if (attributes[1] != 0)
+                    {
+                        std::copy_n(uvs.at(ResolveIndex(attributes[1], uvs.size())).begin(), 2, vertex.uv);
+                    }
+                    if (attributes[2] != 0)
+                    {
+                        std::copy_n(normals.at(ResolveIndex(attributes[2], normals.size())).begin(), 3, vertex.normal);
+                    }
+                    mesh.vertices.push_back(vertex);
+                    hasNormal.push_back(attributes[2] != 0);
+                }
+                polygon.push_back(it->second);
+            }
+
+            // Triangulate the polygon as a fan
+            for (size_t i = 2; i < polygon.size(); i++)
+            {
+                indices.insert(indices.end(), {polygon[0], polygon[i - 1], polygon[i]});
+            }
+        }
+    }
+
+    if (indices.empty())
+    {
+        throw std::runtime_error("\"" + path.string() + "\" does not contain any triangle.");
+    }
+
+    // Compute the missing normals by accumulating the (area weighted) normals of the triangles
+    if (std::find(hasNormal.begin(), hasNormal.end(), false) != hasNormal.end())
+    {
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            const auto &a = mesh.vertices[indices[i]].position;
+            const auto &b = mesh.vertices[indices[i + 1]].position;
+            const auto &c = mesh.vertices[indices[i + 2]].position;
+            const float ab[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+            const float ac[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+            const float normal[3] = {ab[1] * ac[2] - ab[2] * ac[1], ab[2] * ac[0] - ab[0] * ac[2], ab[0] * ac[1] - ab[1] * ac[0]};
+
+            for (size_t corner = 0; corner < 3; corner++)
+            {
+                const auto vertex = indices[i + corner];
+                if (!hasNormal[vertex])
+                {
+                    for (int axis = 0; axis < 3; axis++)
+                    {
+                        mesh.vertices[vertex].normal[axis] += normal[axis];
+                    }
+                }
+            }
+        }
+        for (size_t vertex = 0; vertex < mesh.vertices.size(); vertex++)
+        {
+            auto &normal = mesh.vertices[vertex].normal;
+            const float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            if (!hasNormal[vertex] && length > 0.0f)
+            {
+                for (auto &component : normal)
+                {
+                    component /= length;
+                }
+            }
+        }
+    }
+
+    return mesh;
+}
+
+// ===== BOUNDS =====
+
+void ComputeBounds(Mesh &mesh)
+{
+    auto &bounds = mesh.bounds;
+    std::fill_n(bounds.min, 3, INFINITY);
+    std::fill_n(bounds.max, 3, -INFINITY);
+    for (const auto &vertex : mesh.vertices)
+    {
+        for (int axis = 0; axis < 3; axis++)
+        {
+            bounds.min[axis] = std::min(bounds.min[axis], vertex.position[axis]);
+            bounds.max[axis] = std::max(bounds.max[axis], vertex.position[axis]);
+        }
+    }
+
+    // The sphere is centered on the box, which is good enough for culling
+    bounds.radius = 0.0f;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        bounds.center[axis] = (bounds.min[axis] + bounds.max[axis]) * 0.5f;
+    }
+    for (const auto &vertex : mesh.vertices)
+    {
+        float squaredDistance = 0.0f;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            const float delta = vertex.position[axis] - bounds.center[axis];
+            squaredDistance += delta * delta;
+        }
+        bounds.radius = std::max(bounds.radius, squaredDistance);
+    }
+    bounds.radius = std::sqrt(bounds.radius);
+}
+
+// ===== LOD GENERATION =====
+
+// Merges the vertices that are in the same cell of a grid, and removes the triangles that became degenerate.
+// Every vertex of a cell is replaced by the one closest to the average position of the cell, so that LODs can share the vertex stream.
+std::vector<uint32_t> SimplifyByClustering(const Mesh &mesh, float cellSize, float &error)
+{
+    const auto &vertices = mesh.vertices;
+    auto getCell = [&](const MeshVertex &vertex)
+    {
+        uint64_t key = 0;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            const auto coordinate = static_cast<uint64_t>((vertex.position[axis] - mesh.bounds.min[axis]) / cellSize);
+            key = (key << 21) | (coordinate & 0x1FFFFF);
+        }
+        return key;
+    };
+
+    // Average position of each cell
+    struct Cell
+    {
+        float sum[3] = {0.0f, 0.0f, 0.0f};
+        uint32_t count = 0;
+        uint32_t representative = UINT32_MAX;
+        float representativeDistance = INFINITY;
+    };
+    std::unordered_map<uint64_t, Cell> cells;
+    std::vector<uint64_t> vertexCells(vertices.size());
+    for (uint32_t i = 0; i < vertices.size(); i++)
+    {
+        vertexCells[i] = getCell(vertices[i]);
+        auto &cell = cells[vertexCells[i]];
+        for (int axis = 0; axis < 3; axis++)
+        {
+            cell.sum[axis] += vertices[i].position[axis];
+        }
+        cell.count++;
+    }
+
+    auto squaredDistance = [](const float *a, const float *b)
+    {
+        float result = 0.0f;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            result += (a[axis] - b[axis]) * (a[axis] - b[axis]);
+        }
+        return result;
+    };
+
+    // Choose the representative of each cell
+    for (uint32_t i = 0; i < vertices.size(); i++)
+    {
+        auto &cell = cells[vertexCells[i]];
+        const float average[3] = {cell.sum[0] / cell.count, cell.sum[1] / cell.count, cell.sum[2] / cell.count};
+        const float distance = squaredDistance(vertices[i].position, average);
+        if (distance < cell.representativeDistance)
+        {
+            cell.representative = i;
+            cell.representativeDistance = distance;
+        }
+    }
+
+    // The error is the largest distance by which a vertex moved
+    float squaredError = 0.0f;
+    std::vector<uint32_t> remap(vertices.size());
+    for (uint32_t i = 0; i < vertices.size(); i++)
+    {
+        remap[i] = cells[vertexCells[i]].representative;
+        squaredError = std::max(squaredError, squaredDistance(vertices[i].position, vertices[remap[i]].position));
+    }
+    error = std::sqrt(squaredError);
+
+    // Keep the triangles that still have 3 different vertices, once each
+    const auto &originalIndices = mesh.lods[0];
+    std::vector<uint32_t> indices;
+    std::unordered_set<std::string> addedTriangles;
+    for (size_t i = 0; i < originalIndices.size(); i += 3)
+    {
+        std::array<uint32_t, 3> triangle = {remap[originalIndices[i]], remap[originalIndices[i + 1]], remap[originalIndices[i + 2]]};
+        if (triangle[0] == triangle[1] || triangle[1] == triangle[2] || triangle[0] == triangle[2])
+        {
+            continue;
+        }
+
+        // Rotate the triangle so that its smallest index is first, which keeps its winding
+        std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+        const std::string key(reinterpret_cast<const char *>(triangle.data()), sizeof(triangle));
+        if (addedTriangles.insert(key).second)
+        {
+            indices.insert(indices.end(), triangle.begin(), triangle.end());
+        }
+    }
+    return indices;
+}
+
+void GenerateLods(Mesh &mesh)
+{
+    mesh.lodErrors.push_back(0.0f);
+
+    float diagonal = 0.0f;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        diagonal += (mesh.bounds.max[axis] - mesh.bounds.min[axis]) * (mesh.bounds.max[axis] - mesh.bounds.min[axis]);
+    }
+    diagonal = std::sqrt(diagonal);
+    if (diagonal == 0.0f)
+    {
+        return;
+    }
+
+    for (uint32_t resolution = FIRST_LOD_GRID_RESOLUTION; resolution >= 2 && mesh.lods.size() < MESH_MAX_LODS; resolution /= 2)
+    {
+        float error;
+        auto indices = SimplifyByClustering(mesh, diagonal / static_cast<float>(resolution), error);
+        if (indices.empty())
+        {
+            break;
+        }
+
+        // Skip the levels that don't remove enough triangles to be worth it
+        if (static_cast<float>(indices.size()) <= MIN_LOD_REDUCTION * static_cast<float>(mesh.lods.back().size()))
+        {
+            mesh.lods.push_back(std::move(indices));
+            // Errors must increase with the LOD for the selection to work
+            mesh.lodErrors.push_back(std::max(error, mesh.lodErrors.back()));
+        }
+    }
+}
+
+// ===== VERTEX CACHE OPTIMIZATION =====
+
+// Reorders the triangles so that consecutive ones share vertices that are still in the post-transform cache.
+// Implementation of "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw" (Sander et al., "Tipsify").
+std::vector<uint32_t> OptimizeVertexCache(const std::vector<uint32_t> &indices, uint32_t vertexCount)
+{
+    const size_t triangleCount = indices.size() / 3;
+
+    // Triangles of each vertex
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+    for (auto index : indices)
+    {
+        adjacencyOffsets[index + 1]++;
+    }
+    for (uint32_t i = 0; i < vertexCount; i++)
+    {
+        adjacencyOffsets[i + 1] += adjacencyOffsets[i];
+    }
+    std::vector<uint32_t> adjacency(indices.size());
+    std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    for (size_t i = 0; i < indices.size(); i++)
+    {
+        adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    // Number of triangles not emitted yet for each vertex
+    std::vector<uint32_t> liveTriangles(vertexCount);
+    for (uint32_t i = 0; i < vertexCount; i++)
+    {
+        liveTriangles[i] = adjacencyOffsets[i + 1] - adjacencyOffsets[i];
+    }
+    std::vector<uint32_t> cacheTimestamps(vertexCount, 0);
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<uint32_t> deadEnd;
+    std::vector<uint32_t> candidates;
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    uint32_t timestamp = VERTEX_CACHE_SIZE + 1;
+    uint32_t cursor = 0;
+    int64_t fanningVertex = 0;
+
+    while (fanningVertex >= 0)
+    {
+        candidates.clear();
+
+        // Emit every remaining triangle around the fanning vertex
+        for (auto a = adjacencyOffsets[fanningVertex]; a < adjacencyOffsets[fanningVertex + 1]; a++)
+        {
+            const auto triangle = adjacency[a];
+            if (emitted[triangle])
+            {
+                continue;
+            }
+            for (int corner = 0; corner < 3; corner++)
+            {
+                const auto vertex = indices[triangle * 3 + corner];
+                result.push_back(vertex);
+                deadEnd.push_back(vertex);
+                candidates.push_back(vertex);
+                liveTriangles[vertex]--;
+                if (timestamp - cacheTimestamps[vertex] > VERTEX_CACHE_SIZE)
+                {
+                    cacheTimestamps[vertex] = timestamp++;
+                }
+            }
+            emitted[triangle] = true;
+        }
+
+        // Next fanning vertex: the candidate that will still be in the cache after its triangles are emitted, and was added the earliest
+        fanningVertex = -1;
+        int64_t bestPriority = -1;
+        for (auto vertex : candidates)
+        {
+            if (liveTriangles[vertex] == 0)
+            {
+                continue;
+            }
+            int64_t priority = 0;
+            if (timestamp - cacheTimestamps[vertex] + 2 * liveTriangles[vertex] <= VERTEX_CACHE_SIZE)
+            {
+                priority = timestamp - cacheTimestamps[vertex];
+            }
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                fanningVertex = vertex;
+            }
+        }
+
+        // Dead end: use a recently used vertex, or else the next one with remaining triangles
+        while (fanningVertex < 0 && !deadEnd.empty())
+        {
+            const auto vertex = deadEnd.back();
+            deadEnd.pop_back();
+            if (liveTriangles[vertex] > 0)
+            {
+                fanningVertex = vertex;
+            }
+        }
+        while (fanningVertex < 0 && cursor < vertexCount)
+        {
+            if (liveTriangles[cursor] > 0)
+            {
+                fanningVertex = cursor;
+            }
+            cursor++;
+        }
+    }
+
+    return result;
+}
+
+// Reorders the vertices in the order in which they are first used, so that vertex fetches are as linear as possible
+void OptimizeVertexFetch(Mesh &mesh)
+{
+    std::vector<uint32_t> remap(mesh.vertices.size(), UINT32_MAX);
+    std::vector<MeshVertex> vertices;
+    vertices.reserve(mesh.vertices.size());
+
+    for (auto &lod : mesh.lods)
+    {
+        for (auto &index : lod)
+        {
+            if (remap[index] == UINT32_MAX)
+            {
+                remap[index] = static_cast<uint32_t>(vertices.size());
+                vertices.push_back(mesh.vertices[index]);
+            }
+            index = remap[index];
+        }
+    }
+    mesh.vertices = std::move(vertices);
+}
+
+// ===== MESHLETS =====
+
+// Computes the bounding sphere and the normal cone of the meshlet, from its vertices and triangles
+void ComputeMeshletBounds(const Mesh &mesh, Meshlet &meshlet)
+{
+    const uint32_t *vertices = mesh.meshletVertices.data() + meshlet.firstVertex;
+    const uint8_t *triangles = mesh.meshletTriangles.data() + meshlet.firstTriangle * 3;
+
+    // Sphere around the center of the bounding box
+    float min[3] = {INFINITY, INFINITY, INFINITY};
+    float max[3] = {-INFINITY, -INFINITY, -INFINITY};
+    for (uint32_t i = 0; i < meshlet.vertexCount; i++)
+    {
+        const auto &position = mesh.vertices[vertices[i]].position;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            min[axis] = std::min(min[axis], position[axis]);
+            max[axis] = std::max(max[axis], position[axis]);
+        }
+    }
+    float squaredRadius = 0.0f;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        meshlet.center[axis] = (min[axis] + max[axis]) * 0.5f;
+    }
+    for (uint32_t i = 0; i < meshlet.vertexCount; i++)
+    {
+        const auto &position = mesh.vertices[vertices[i]].position;
+        float squaredDistance = 0.0f;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            squaredDistance += (position[axis] - meshlet.center[axis]) * (position[axis] - meshlet.center[axis]);
+        }
+        squaredRadius = std::max(squaredRadius, squaredDistance);
+    }
+    meshlet.radius = std::sqrt(squaredRadius);
+
+    // The axis of the cone is the average of the face normals
+    std::vector<std::array<float, 3>> normals;
+    normals.reserve(meshlet.triangleCount);
+    float axis[3] = {0.0f, 0.0f, 0.0f};
+    for (uint32_t i = 0; i < meshlet.triangleCount; i++)
+    {
+        const auto &a = mesh.vertices[vertices[triangles[i * 3]]].position;
+        const auto &b = mesh.vertices[vertices[triangles[i * 3 + 1]]].position;
+        const auto &c = mesh.vertices[vertices[triangles[i * 3 + 2]]].position;
+        const float ab[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+        const float ac[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+        std::array<float, 3> normal = {ab[1] * ac[2] - ab[2] * ac[1], ab[2] * ac[0] - ab[0] * ac[2], ab[0] * ac[1] - ab[1] * ac[0]};
+        const float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        // Degenerate triangles are never visible, so they don't constrain the cone
+        if (length == 0.0f)
+        {
+            continue;
+        }
+        for (int j = 0; j < 3; j++)
+        {
+            normal[j] /= length;
+            axis[j] += normal[j];
+        }
+        normals.push_back(normal);
+    }
+    const float axisLength = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+    for (int j = 0; j < 3; j++)
+    {
+        meshlet.coneAxis[j] = axisLength == 0.0f ? 0.0f : axis[j] / axisLength;
+    }
+
+    // The cone must contain every normal. The cutoff is the sine of its half angle, so that the test doesn't need the apex of the cone.
+    float minDot = 1.0f;
+    for (const auto &normal : normals)
+    {
+        minDot = std::min(minDot, normal[0] * meshlet.coneAxis[0] + normal[1] * meshlet.coneAxis[1] + normal[2] * meshlet.coneAxis[2]);
+    }
+    meshlet.coneCutoff = axisLength == 0.0f || minDot <= 0.0f ? 1.0f : std::sqrt(1.0f - minDot * minDot);
+}
+
+// Splits each LOD in meshlets, following the order of its triangles.
+// Since the triangles were ordered for the vertex cache, consecutive triangles share most of their vertices,
+// so a greedy split gives compact meshlets, and the meshlet triangles stay in the order of the index stream.
+void BuildMeshlets(Mesh &mesh)
+{
+    std::vector<uint8_t> localIndices(mesh.vertices.size(), UINT8_MAX);
+    mesh.lodMeshlets.clear();
+    mesh.meshletVertices.clear();
+    mesh.meshletTriangles.clear();
+
+    for (const auto &indices : mesh.lods)
+    {
+        auto &meshlets = mesh.lodMeshlets.emplace_back();
+        uint32_t lodFirstTriangle = static_cast<uint32_t>(mesh.meshletTriangles.size() / 3);
+
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            // Count the vertices of the triangle that are not in the current meshlet yet
+            uint32_t newVertices = 0;
+            for (size_t j = 0; j < 3; j++)
+            {
+                newVertices += localIndices[indices[i + j]] == UINT8_MAX ? 1 : 0;
+            }
+
+            if (meshlets.empty() || meshlets.back().vertexCount + newVertices > MESHLET_MAX_VERTICES || meshlets.back().triangleCount == MESHLET_MAX_TRIANGLES)
+            {
+                // Start a new meshlet
+                if (!meshlets.empty())
+                {
+                    for (uint32_t j = 0; j < meshlets.back().vertexCount; j++)
+                    {
+                        localIndices[mesh.meshletVertices[meshlets.back().firstVertex + j]] = UINT8_MAX;
+                    }
+                }
+                meshlets.push_back(Meshlet{
+                    .firstVertex = static_cast<uint32_t>(mesh.meshletVertices.size()),
+                    .firstTriangle = static_cast<uint32_t>(mesh.meshletTriangles.size() / 3),
+                });
+            }
+
+            auto &meshlet = meshlets.back();
+            for (size_t j = 0; j < 3; j++)
+            {
+                auto &localIndex = localIndices[indices[i + j]];
+                if (localIndex == UINT8_MAX)
+                {
+                    localIndex = static_cast<uint8_t>(meshlet.vertexCount++);
+                    mesh.meshletVertices.push_back(indices[i + j]);
+                }
+                mesh.meshletTriangles.push_back(localIndex);
+            }
+            meshlet.triangleCount++;
+        }
+
+        // Reset the local indices for the next LOD
+        if (!meshlets.empty())
+        {
+            for (uint32_t j = 0; j < meshlets.back().vertexCount; j++)
+            {
+                localIndices[mesh.meshletVertices[meshlets.back().firstVertex + j]] = UINT8_MAX;
+            }
+        }
+
+        for (auto &meshlet : meshlets)
+        {
+            ComputeMeshletBounds(mesh, meshlet);
+            meshlet.firstTriangle -= lodFirstTriangle;
+        }
+    }
+}
+
+// ===== OUTPUT =====
+
+void WriteMesh(const Mesh &mesh, const std::filesystem::path &outputPath)
+{
+    using namespace rendering::structs;
+
+    MeshFileHeader header{
+        .magic = MESH_FILE_MAGIC,
+        .version = MESH_FILE_VERSION,
+        .vertexCount = static_cast<uint32_t>(mesh.vertices.size()),
+        .lodCount = static_cast<uint32_t>(mesh.lods.size()),
+        .meshletVertexCount = static_cast<uint32_t>(mesh.meshletVertices.size()),
+        .meshletTriangleCount = static_cast<uint32_t>(mesh.meshletTriangles.size() / 3),
+        .bounds = mesh.bounds,
+    };
+
+    // Concatenate the indices and the meshlets of the LODs
+    std::vector<MeshLod> lods;
+    std::vector<uint32_t> indices;
+    std::vector<Meshlet> meshlets;
+    for (size_t i = 0; i < mesh.lods.size(); i++)
+    {
+        lods.push_back(MeshLod{
+            .firstIndex = static_cast<uint32_t>(indices.size()),
+            .indexCount = static_cast<uint32_t>(mesh.lods[i].size()),
+            .firstMeshlet = static_cast<uint32_t>(meshlets.size()),
+            .meshletCount = static_cast<uint32_t>(mesh.lodMeshlets[i].size()),
+            .error = mesh.lodErrors[i],
+        });
+        // The meshlet triangles follow the index stream, so the first triangle of the LOD is at the same place in both
+        for (auto meshlet : mesh.lodMeshlets[i])
+        {
+            meshlet.firstTriangle += static_cast<uint32_t>(indices.size() / 3);
+            meshlets.push_back(meshlet);
+        }
+        indices.insert(indices.end(), mesh.lods[i].begin(), mesh.lods[i].end());
+    }
+    header.indexCount = static_cast<uint32_t>(indices.size());
+    header.meshletCount = static_cast<uint32_t>(meshlets.size());
+
+    header.lodsOffset = sizeof(MeshFileHeader);
+    header.meshletsOffset = header.lodsOffset + lods.size() * sizeof(MeshLod);
+    header.verticesOffset = AlignUp(header.meshletsOffset + meshlets.size() * sizeof(Meshlet), MESH_FILE_ALIGNMENT);
+    // Vertices are 32 bytes, so the indices directly follow them and stay aligned
+    header.indicesOffset = header.verticesOffset + mesh.vertices.size() * sizeof(MeshVertex);
+    header.meshletVerticesOffset = AlignUp(header.indicesOffset + indices.size() * sizeof(uint32_t), MESH_FILE_ALIGNMENT);
+    header.meshletTrianglesOffset = header.meshletVerticesOffset + mesh.meshletVertices.size() * sizeof(uint32_t);
+    header.fileSize = header.meshletTrianglesOffset + mesh.meshletTriangles.size();
+
+    std::ofstream stream(outputPath, std::ios::binary | std::ios::trunc);
+    const char padding[MESH_FILE_ALIGNMENT] = {};
+    stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    stream.write(reinterpret_cast<const char *>(lods.data()), static_cast<std::streamsize>(lods.size() * sizeof(MeshLod)));
+    stream.write(reinterpret_cast<const char *>(meshlets.data()), static_cast<std::streamsize>(meshlets.size() * sizeof(Meshlet)));
+    stream.write(padding, static_cast<std::streamsize>(header.verticesOffset - (header.meshletsOffset + meshlets.size() * sizeof(Meshlet))));
+    stream.write(reinterpret_cast<const char *>(mesh.vertices.data()), static_cast<std::streamsize>(mesh.vertices.size() * sizeof(MeshVertex)));
+    stream.write(reinterpret_cast<const char *>(indices.data()), static_cast<std::streamsize>(indices.size() * sizeof(uint32_t)));
+    stream.write(padding, static_cast<std::streamsize>(header.meshletVerticesOffset - (header.indicesOffset + indices.size() * sizeof(uint32_t))));
+    stream.write(reinterpret_cast<const char *>(mesh.meshletVertices.data()), static_cast<std::streamsize>(mesh.meshletVertices.size() * sizeof(uint32_t)));
+    stream.write(reinterpret_cast<const char *>(mesh.meshletTriangles.data()), static_cast<std::streamsize>(mesh.meshletTriangles.size()));
+
+    if (!stream)
+    {
+        throw std::runtime_error("Unable to write \"" + outputPath.string() + "\".");
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " <input .obj file> <output file>\n";
+        return 1;
+    }
+
+    try
+    {
+        if (std::filesystem::path(argv[1]).extension() != ".obj")
+        {
+            throw std::runtime_error("Only OBJ files are supported.");
+        }
+
+        auto mesh = ReadObj(argv[1]);
+        ComputeBounds(mesh);
+        GenerateLods(mesh);
+        for (auto &lod : mesh.lods)
+        {
+            lod = OptimizeVertexCache(lod, static_cast<uint32_t>(mesh.vertices.size()));
+        }
+        OptimizeVertexFetch(mesh);
+        BuildMeshlets(mesh);
+        WriteMesh(mesh, argv[2]);
+
+        std::cout << "Converted \"" << argv[1] << "\": " << mesh.vertices.size() << " vertices, " << mesh.lods.size() << " LODs (";
+        for (size_t i = 0; i < mesh.lods.size(); i++)
+        {
+            std::cout << (i == 0 ? "" : ", ") << mesh.lods[i].size() / 3;
+        }
+        std::cout << " triangles), " << mesh.lodMeshlets[0].size() << " meshlets in the first LOD.\n";
+    }
+    catch (const std::exception &error)
+    {
+        std::cerr << error.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
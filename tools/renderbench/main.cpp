@@ -0,0 +1,409 @@
+// Draws deterministic scenes with a headless renderer for a fixed number of frames, and writes statistics about each frame
+// (CPU frame time, GPU graphics, async compute and overlap times, draw, bind and cluster counts, memory) as percentiles in a
+// JSON file, to compare two versions of the renderer.
+// Must be run from the root of the repository, like the engine, to find the shader pack and the converted meshes.
+// Usage: renderbench [--frames N] [--warmup N] [--size WIDTHxHEIGHT] [--scene NAME] [--output FILE]
+
+#include "../../include/core/EntityManager.h"
+#include "../../include/core/JobPool.h"
+#include "../../include/rendering/Renderer.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace railguard;
+
+struct Scene
+{
+    std::string name;
+    std::string description;
+    // Number of items drawn each frame, spread over the effects
+    uint32_t itemCount;
+    uint32_t effectCount;
+    // If true, the items are instanced triangles with their own transform. Otherwise, each item is a separate draw.
+    bool instanced;
+    // Number of enabled cameras splitting the image in a grid, each looking at another part of the items.
+    // Without cameras, the items are drawn once, without transform.
+    uint32_t cameraCount;
+    // If not empty, the items are instances of that mesh, created by meshconverter. They are drawn with their LODs and
+    // culled cluster by cluster, and seen by a single perspective camera.
+    std::string meshPath;
+};
+
+struct Options
+{
+    uint32_t frameCount = 1000;
+    // Frames drawn before the measures start, so that pipelines and buffers are created and GPU timings are available
+    uint32_t warmupFrameCount = 60;
+    vk::Extent2D extent{1280, 720};
+    // If empty, every scene is drawn
+    std::string sceneName;
+    std::string outputPath = "renderbench.json";
+};
+
+// Values measured for every frame of a scene
+struct Metric
+{
+    const char *name;
+    std::vector<double> samples;
+};
+
+const std::vector<Scene> SCENES = {
+    {"empty", "Nothing drawn, to measure the fixed cost of a frame", 0, 1, false, 0},
+    {"instances", "16384 instanced triangles using a single effect, merged in a few draws", 16384, 1, true, 0},
+    {"effects", "8192 instanced triangles spread over 64 effects", 8192, 64, true, 0},
+    {"draws", "4096 separate draws spread over 16 effects", 4096, 16, false, 0},
+    {"cameras", "8192 instanced triangles over 4 effects, seen by 16 cameras in split viewports", 8192, 4, true, 16},
+    {"mesh", "2304 instanced spheres in a grid going away from a perspective camera, with LODs and cluster culling", 2304, 1, true, 1, "bin/assets/bench_sphere.rgmesh"},
+};
+
+// Camera of the mesh scenes, above the front of the grid and looking at its center
+const glm::vec3 MESH_CAMERA_POSITION(0.0f, 6.0f, -4.0f);
+const glm::vec3 MESH_CAMERA_TARGET(0.0f, 0.0f, 40.0f);
+const float MESH_GRID_SPACING = 3.0f;
+
+bool ParseArguments(int argc, char **argv, Options &options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--frames") == 0 && hasValue)
+        {
+            if (std::sscanf(argv[++i], "%u", &options.frameCount) != 1 || options.frameCount == 0)
+            {
+                return false;
+            }
+        }
+        else if (std::strcmp(argv[i], "--warmup") == 0 && hasValue)
+        {
+            if (std::sscanf(argv[++i], "%u", &options.warmupFrameCount) != 1)
+            {
+                return false;
+            }
+        }
+        else if (std::strcmp(argv[i], "--size") == 0 && hasValue)
+        {
+            if (std::sscanf(argv[++i], "%ux%u", &options.extent.width, &options.extent.height) != 2 || options.extent.width == 0 || options.extent.height == 0)
+            {
+                return false;
+            }
+        }
+        else if (std::strcmp(argv[i], "--scene") == 0 && hasValue)
+        {
+            options.sceneName = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--output") == 0 && hasValue)
+        {
+            options.outputPath = argv[++i];
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// The items are laid out in a grid covering the image, and rotate at a fixed speed so that the transforms change every frame
+glm::mat4 GetItemTransform(uint32_t index, uint32_t itemCount, uint32_t frame)
+{
+    const auto columns = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(itemCount))));
+    const float cellSize = 2.0f / static_cast<float>(columns);
+    const float x = -1.0f + (static_cast<float>(index % columns) + 0.5f) * cellSize;
+    const float y = -1.0f + (static_cast<float>(index / columns) + 0.5f) * cellSize;
+    const float angle = static_cast<float>(frame) * 0.01f + static_cast<float>(index) * 0.1f;
+
+    auto transform = glm::translate(glm::mat4(1.0f), glm::vec3(x, y, 0.5f));
+    transform = glm::rotate(transform, angle, glm::vec3(0.0f, 0.0f, 1.0f));
+    return glm::scale(transform, glm::vec3(0.4f * cellSize));
+}
+
+// The meshes are laid out in a square grid on the ground, starting in front of the camera. It is wider than the field of view,
+// so that some of them are culled, and deep enough to use every LOD. They spin so that the transforms change every frame.
+glm::mat4 GetMeshTransform(uint32_t index, uint32_t itemCount, uint32_t frame)
+{
+    const auto columns = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(itemCount))));
+    const float x = (static_cast<float>(index % columns) - 0.5f * static_cast<float>(columns - 1)) * MESH_GRID_SPACING;
+    const float z = static_cast<float>(index / columns) * MESH_GRID_SPACING;
+    const float angle = static_cast<float>(frame) * 0.01f + static_cast<float>(index) * 0.1f;
+
+    const auto transform = glm::translate(glm::mat4(1.0f), glm::vec3(x, 0.0f, z));
+    return glm::rotate(transform, angle, glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+void CreateMeshCamera(rendering::Renderer &renderer, core::EntityManager &entityManager, const vk::Extent2D &extent)
+{
+    const float aspect = static_cast<float>(extent.width) / static_cast<float>(extent.height);
+    renderer.GetSwapchainCameraManager().CreateComponent(entityManager.CreateEntity(), rendering::init::SwapchainCameraInitInfo{
+                                                                                           .enabled = true,
+                                                                                           .swapchainId = renderer.GetMainWindowSwapchain(),
+                                                                                           .viewport = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f),
+                                                                                           .view = glm::lookAtLH(MESH_CAMERA_POSITION, MESH_CAMERA_TARGET, glm::vec3(0.0f, 1.0f, 0.0f)),
+                                                                                           .projection = glm::perspectiveLH_ZO(glm::radians(60.0f), aspect, 0.1f, 500.0f),
+                                                                                       });
+}
+
+// The cameras split the image in a grid. Each one looks at the part of the items below its viewport, zoomed out so that
+// the neighbouring cameras see some of the same items.
+void CreateCameras(rendering::Renderer &renderer, core::EntityManager &entityManager, uint32_t cameraCount)
+{
+    const auto columns = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(cameraCount))));
+    const auto rows = (cameraCount + columns - 1) / columns;
+    const float width = 1.0f / static_cast<float>(columns);
+    const float height = 1.0f / static_cast<float>(rows);
+
+    auto &cameraManager = renderer.GetSwapchainCameraManager();
+    for (uint32_t i = 0; i < cameraCount; i++)
+    {
+        const float x = static_cast<float>(i % columns) * width;
+        const float y = static_cast<float>(i / columns) * height;
+        const glm::vec2 center(-1.0f + 2.0f * (x + 0.5f * width), -1.0f + 2.0f * (y + 0.5f * height));
+        const glm::vec2 halfSize(1.5f * width, 1.5f * height);
+
+        // The items are between depths 0 and 1
+        cameraManager.CreateComponent(entityManager.CreateEntity(), rendering::init::SwapchainCameraInitInfo{
+                                                                        .enabled = true,
+                                                                        .swapchainId = renderer.GetMainWindowSwapchain(),
+                                                                        .viewport = glm::vec4(x, y, width, height),
+                                                                        .view = glm::translate(glm::mat4(1.0f), glm::vec3(-center, 0.0f)),
+                                                                        .projection = glm::orthoLH_ZO(-halfSize.x, halfSize.x, -halfSize.y, halfSize.y, 0.0f, 1.0f),
+                                                                    });
+    }
+}
+
+std::vector<Metric> RunScene(const Scene &scene, const Options &options)
+{
+    core::JobPool jobPool;
+    rendering::Renderer renderer(rendering::init::RendererInitInfo{
+        .windowManager = nullptr,
+        .headlessExtent = options.extent,
+        .jobPool = &jobPool,
+    });
+    core::EntityManager entityManager(scene.cameraCount);
+    const bool drawsMesh = !scene.meshPath.empty();
+    if (drawsMesh)
+    {
+        CreateMeshCamera(renderer, entityManager, options.extent);
+    }
+    else
+    {
+        CreateCameras(renderer, entityManager, scene.cameraCount);
+    }
+
+    // Each effect has its own pipeline, even if they use the same shaders
+    std::vector<rendering::shader_effect_id_t> effects;
+    for (uint32_t i = 0; i < scene.effectCount; i++)
+    {
+        if (drawsMesh)
+        {
+            effects.push_back(renderer.CreateShaderEffect({"bench_mesh.vert", "triangle.frag"}));
+        }
+        else
+        {
+            effects.push_back(scene.instanced ? renderer.CreateShaderEffect({"bench_instance.vert", "triangle.frag"})
+                                              : renderer.CreateShaderEffect({"triangle.vert", "triangle.frag"}));
+        }
+    }
+
+    // The mesh is uploaded by the frames, and nothing is drawn until it is ready: wait for it before counting the warmup frames
+    rendering::mesh_id_t mesh = 0;
+    if (drawsMesh)
+    {
+        mesh = renderer.LoadMesh(scene.meshPath);
+        while (!renderer.IsMeshReady(mesh))
+        {
+            renderer.Draw();
+        }
+    }
+
+    std::vector<Metric> metrics = {
+        {"cpuFrameTimeMs", {}},
+        {"gpuFrameTimeMs", {}},
+        {"gpuComputeTimeMs", {}},
+        {"gpuOverlapTimeMs", {}},
+        {"draws", {}},
+        {"pipelineBinds", {}},
+        {"descriptorSetBinds", {}},
+        {"vertexBufferBinds", {}},
+        {"indexBufferBinds", {}},
+        {"instanceBufferBinds", {}},
+        {"instances", {}},
+        {"clusters", {}},
+        {"unculledClusters", {}},
+        {"allocatedBytes", {}},
+        {"blockBytes", {}},
+        {"deviceLocalBlockBytes", {}},
+    };
+    for (auto &metric : metrics)
+    {
+        metric.samples.reserve(options.frameCount);
+    }
+
+    const uint32_t totalFrameCount = options.warmupFrameCount + options.frameCount;
+    for (uint32_t frame = 0; frame < totalFrameCount; frame++)
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        for (uint32_t i = 0; i < scene.itemCount; i++)
+        {
+            if (drawsMesh)
+            {
+                const auto transform = GetMeshTransform(i, scene.itemCount, frame);
+                renderer.SubmitMeshDraw(mesh, rendering::structs::DrawItem{
+                                                  .pass = renderer.GetMainPass(),
+                                                  .effect = effects[i % scene.effectCount],
+                                                  .depth = glm::distance(MESH_CAMERA_POSITION, glm::vec3(transform[3])),
+                                                  .instanced = true,
+                                                  .transform = transform,
+                                              });
+            }
+            else
+            {
+                renderer.SubmitDraw(rendering::structs::DrawItem{
+                    .pass = renderer.GetMainPass(),
+                    .effect = effects[i % scene.effectCount],
+                    .elementCount = 3,
+                    .instanced = scene.instanced,
+                    .transform = GetItemTransform(i, scene.itemCount, frame),
+                });
+            }
+        }
+        renderer.Draw();
+
+        const auto end = std::chrono::steady_clock::now();
+        if (frame < options.warmupFrameCount)
+        {
+            continue;
+        }
+
+        // The GPU timings are the ones of the last finished frame, a few frames behind
+        const auto &statistics = renderer.GetLastRenderQueueStatistics();
+        const auto memory = renderer.GetMemoryStatistics();
+        const double values[] = {
+            std::chrono::duration<double, std::milli>(end - start).count(),
+            renderer.GetLastGpuTimings().graphicsTime,
+            renderer.GetLastGpuTimings().computeTime,
+            renderer.GetLastGpuTimings().overlapTime,
+            static_cast<double>(statistics.drawCount),
+            static_cast<double>(statistics.pipelineBinds),
+            static_cast<double>(statistics.descriptorSetBinds),
+            static_cast<double>(statistics.vertexBufferBinds),
+            static_cast<double>(statistics.indexBufferBinds),
+            static_cast<double>(statistics.instanceBufferBinds),
+            static_cast<double>(statistics.instanceCount),
+            static_cast<double>(statistics.clusterCount),
+            static_cast<double>(statistics.unculledClusterCount),
+            static_cast<double>(memory.allocatedSize),
+            static_cast<double>(memory.blockSize),
+            static_cast<double>(memory.deviceLocalBlockSize),
+        };
+        for (size_t i = 0; i < metrics.size(); i++)
+        {
+            metrics[i].samples.push_back(values[i]);
+        }
+    }
+
+    // Without timestamps, the GPU times would only be zeros
+    if (!renderer.AreGpuTimingsSupported())
+    {
+        metrics.erase(metrics.begin() + 1, metrics.begin() + 4);
+    }
+    return metrics;
+}
+
+// Nearest-rank percentile of sorted samples
+double GetPercentile(const std::vector<double> &sortedSamples, double percentile)
+{
+    const auto rank = static_cast<size_t>(std::ceil(percentile / 100.0 * static_cast<double>(sortedSamples.size())));
+    return sortedSamples[std::clamp<size_t>(rank, 1, sortedSamples.size()) - 1];
+}
+
+void WriteMetric(std::ostream &stream, Metric metric)
+{
+    std::sort(metric.samples.begin(), metric.samples.end());
+    double sum = 0.0;
+    for (double sample : metric.samples)
+    {
+        sum += sample;
+    }
+
+    stream << "        \"" << metric.name << "\": {"
+           << "\"min\": " << metric.samples.front()
+           << ", \"p50\": " << GetPercentile(metric.samples, 50.0)
+           << ", \"p90\": " << GetPercentile(metric.samples, 90.0)
+           << ", \"p99\": " << GetPercentile(metric.samples, 99.0)
+           << ", \"max\": " << metric.samples.back()
+           << ", \"mean\": " << sum / static_cast<double>(metric.samples.size()) << '}';
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!ParseArguments(argc, argv, options))
+    {
+        std::cerr << "Usage: " << argv[0] << " [--frames N] [--warmup N] [--size WIDTHxHEIGHT] [--scene NAME] [--output FILE]\n";
+        return 1;
+    }
+
+    std::vector<Scene> scenes;
+    std::copy_if(SCENES.begin(), SCENES.end(), std::back_inserter(scenes), [&](const Scene &scene)
+                 { return options.sceneName.empty() || scene.name == options.sceneName; });
+    if (scenes.empty())
+    {
+        std::cerr << "Unknown scene \"" << options.sceneName << "\".\n";
+        return 1;
+    }
+
+    try
+    {
+        std::ofstream stream(options.outputPath, std::ios::trunc);
+        stream << std::fixed << std::setprecision(3);
+        stream << "{\n"
+               << "  \"frames\": " << options.frameCount << ",\n"
+               << "  \"warmupFrames\": " << options.warmupFrameCount << ",\n"
+               << "  \"width\": " << options.extent.width << ",\n"
+               << "  \"height\": " << options.extent.height << ",\n"
+               << "  \"scenes\": [\n";
+
+        for (size_t i = 0; i < scenes.size(); i++)
+        {
+            std::cout << "Drawing scene \"" << scenes[i].name << "\"...\n";
+            const auto metrics = RunScene(scenes[i], options);
+
+            stream << "    {\n"
+                   << "      \"name\": \"" << scenes[i].name << "\",\n"
+                   << "      \"description\": \"" << scenes[i].description << "\",\n"
+                   << "      \"metrics\": {\n";
+            for (size_t j = 0; j < metrics.size(); j++)
+            {
+                WriteMetric(stream, metrics[j]);
+                stream << (j + 1 < metrics.size() ? ",\n" : "\n");
+            }
+            stream << "      }\n"
+                   << "    }" << (i + 1 < scenes.size() ? ",\n" : "\n");
+        }
+        stream << "  ]\n"
+               << "}\n";
+
+        if (!stream)
+        {
+            throw std::runtime_error("Unable to write \"" + options.outputPath + "\".");
+        }
+        std::cout << "Results written to \"" << options.outputPath << "\".\n";
+    }
+    catch (const std::exception &error)
+    {
+        std::cerr << error.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
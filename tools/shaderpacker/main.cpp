@@ -0,0 +1,171 @@
+// Bundles every SPIR-V file of a directory in a single shader pack (see include/rendering/structs/ShaderPackFormat.h).
+// Usage: shaderpacker <input directory> <output file>
+
+#include "../../include/rendering/structs/ShaderPackFormat.h"
+#include "../../include/utils/Hash.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace railguard;
+
+struct InputShader
+{
+    std::string name;
+    uint32_t stage;
+    std::vector<char> code;
+};
+
+// Values of VkShaderStageFlagBits. Vulkan isn't included so that the tool doesn't depend on the SDK.
+uint32_t GetStage(const std::string &name)
+{
+    // Files are named like "triangle.vert", so the stage is the extension
+    auto extension = std::filesystem::path(name).extension().string();
+    if (extension == ".vert")
+        return 0x00000001;
+    if (extension == ".tesc")
+        return 0x00000002;
+    if (extension == ".tese")
+        return 0x00000004;
+    if (extension == ".geom")
+        return 0x00000008;
+    if (extension == ".frag")
+        return 0x00000010;
+    if (extension == ".comp")
+        return 0x00000020;
+    throw std::runtime_error("Unable to find the stage of the shader \"" + name + "\".");
+}
+
+uint64_t AlignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+std::vector<InputShader> ReadShaders(const std::filesystem::path &directory)
+{
+    std::vector<InputShader> shaders;
+    for (const auto &file : std::filesystem::directory_iterator(directory))
+    {
+        if (!file.is_regular_file() || file.path().extension() != ".spv")
+        {
+            continue;
+        }
+
+        InputShader shader;
+        shader.name = file.path().stem().string();
+        shader.stage = GetStage(shader.name);
+
+        std::ifstream stream(file.path(), std::ios::binary | std::ios::ate);
+        shader.code.resize(static_cast<size_t>(stream.tellg()));
+        stream.seekg(0);
+        stream.read(shader.code.data(), static_cast<std::streamsize>(shader.code.size()));
+        if (!stream || shader.code.size() % 4 != 0)
+        {
+            throw std::runtime_error("\"" + file.path().string() + "\" is not a valid SPIR-V file.");
+        }
+
+        shaders.push_back(std::move(shader));
+    }
+
+    // Sort by name so that the pack is the same on every machine
+    std::sort(shaders.begin(), shaders.end(), [](const InputShader &a, const InputShader &b)
+              { return a.name < b.name; });
+    return shaders;
+}
+
+void WritePack(const std::vector<InputShader> &shaders, const std::filesystem::path &outputPath)
+{
+    // Size the hash table so that it is at most half full
+    uint32_t bucketCount = 1;
+    while (bucketCount < shaders.size() * 2)
+    {
+        bucketCount <<= 1;
+    }
+
+    rendering::structs::ShaderPackHeader header{
+        .magic = SHADER_PACK_MAGIC,
+        .version = SHADER_PACK_VERSION,
+        .entryCount = static_cast<uint32_t>(shaders.size()),
+        .bucketCount = bucketCount,
+    };
+    header.entriesOffset = sizeof(rendering::structs::ShaderPackHeader);
+    header.bucketsOffset = header.entriesOffset + shaders.size() * sizeof(rendering::structs::ShaderPackEntry);
+    header.namesOffset = header.bucketsOffset + bucketCount * sizeof(uint32_t);
+
+    // Fill the entries and the names
+    std::vector<rendering::structs::ShaderPackEntry> entries(shaders.size());
+    std::vector<uint32_t> buckets(bucketCount, SHADER_PACK_NO_ENTRY);
+    std::string names;
+    for (uint32_t i = 0; i < shaders.size(); i++)
+    {
+        const auto &shader = shaders[i];
+        auto &entry = entries[i];
+        entry.nameHash = utils::HashBytes(shader.name.data(), shader.name.size());
+        entry.nameOffset = static_cast<uint32_t>(names.size());
+        entry.nameLength = static_cast<uint32_t>(shader.name.size());
+        entry.codeSize = shader.code.size();
+        entry.stage = shader.stage;
+
+        // Insert at the head of the chain of the bucket
+        auto &bucket = buckets[entry.nameHash & (bucketCount - 1)];
+        entry.nextInBucket = bucket;
+        bucket = i;
+
+        names += shader.name;
+    }
+
+    // Then place the code after the names
+    uint64_t offset = header.namesOffset + names.size();
+    for (auto &entry : entries)
+    {
+        entry.codeOffset = AlignUp(offset, SHADER_PACK_ALIGNMENT);
+        offset = entry.codeOffset + entry.codeSize;
+    }
+    header.fileSize = offset;
+
+    // Write everything
+    std::ofstream stream(outputPath, std::ios::binary | std::ios::trunc);
+    stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    stream.write(reinterpret_cast<const char *>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(rendering::structs::ShaderPackEntry)));
+    stream.write(reinterpret_cast<const char *>(buckets.data()), static_cast<std::streamsize>(buckets.size() * sizeof(uint32_t)));
+    stream.write(names.data(), static_cast<std::streamsize>(names.size()));
+
+    const char padding[SHADER_PACK_ALIGNMENT] = {};
+    uint64_t position = header.namesOffset + names.size();
+    for (uint32_t i = 0; i < shaders.size(); i++)
+    {
+        stream.write(padding, static_cast<std::streamsize>(entries[i].codeOffset - position));
+        stream.write(shaders[i].code.data(), static_cast<std::streamsize>(entries[i].codeSize));
+        position = entries[i].codeOffset + entries[i].codeSize;
+    }
+
+    if (!stream)
+    {
+        throw std::runtime_error("Unable to write \"" + outputPath.string() + "\".");
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " <input directory> <output file>\n";
+        return 1;
+    }
+
+    try
+    {
+        auto shaders = ReadShaders(argv[1]);
+        WritePack(shaders, argv[2]);
+        std::cout << "Packed " << shaders.size() << " shaders in \"" << argv[2] << "\".\n";
+    }
+    catch (const std::exception &error)
+    {
+        std::cerr << error.what() << '\n';
+        return 1;
+    }
+    return 0;
+}